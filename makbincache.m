@@ -0,0 +1,396 @@
+
+classdef  makbincache  <  handle
+% 
+% b = makbincache (  C  )
+% b = makbincache (  C  ,  cap  )
+% X = b.get (  kind  ,  g  )
+% X = b.get (  kind  ,  g  ,  j  )
+% b.flush
+% 
+% MET Analysis Kit. Returns the handle to a cache of binned spike counts
+% for one session. Analyses such as makrccg, PSTHs, makroc and makmi often
+% bin the same spike trains on the same grid of time bins, one after
+% another. Given the cache, each unit's spike trains are binned on each
+% grid once, the first time that they are asked for. Later calls get the
+% same counts back from the cache. MATLAB shares arrays until they are
+% changed, so cached counts are not copied when they are returned, nor
+% when the cache is passed to another function.
+% 
+% C is a T x U cell array of spike trains, with trials over rows and units
+% over columns, or packed spike trains from makspkpack with the same
+% layout. C is checked once, as by makspkchk, and kept as packed spike
+% trains. Optional cap is the most memory that cached counts may use, in
+% bytes, default 2 ^ 30. Once the cap is passed, the counts that were used
+% least recently are dropped from the cache.
+% 
+% get returns binned counts X, a T x Q x numel( j ) double array with
+% trials over rows, bins over columns, and units over the third dimension.
+% g = [ t0 , dt , Q ] is the grid of Q bins, each dt seconds wide, where
+% the first bin starts at time t0. Bin q counts spikes from time
+% t0 + ( q - 1 ) * dt up to, but not including, t0 + q * dt. The last bin
+% also counts spikes at its end, as histcounts does. Optional j is a
+% vector of unit indices, default all units. kind is one of the following
+% strings.
+% 
+%   'count' - Spike counts, Q bins.
+%   'cumsum' - Prefix sums over bins, Q + 1 columns starting at zero. The
+%     number of spikes in bins a to b is X( : , b + 1 , : ) -
+%     X( : , a , : ).
+%   'fft' - Discrete Fourier transform of the counts over bins, zero
+%     padded to 2 ^ nextpow2( 2 * Q - 1 ) columns, enough for cross-
+%     correlations without wrap-around.
+% 
+% Each kind is cached separately for each unit and grid, with all trials.
+% 'cumsum' and 'fft' are found from cached counts. Counts are made by
+% makspkcount.
+% 
+% flush empties the cache. Read-only properties report the size of the
+% session in .T and .U, the memory cap in .cap, the memory used by cached
+% counts in .bytes, and the number of units that were found in the cache,
+% .hits, or had to be binned, .misses.
+% 
+% For example
+% 
+%   b = makbincache (  C  ) ;
+%   r = makrccg (  [ 0 , 0.5 ]  ,  b  ) ;
+%   P = b.get (  'count'  ,  [ 0 , 1e-3 , 500 ]  ) ;
+% 
+% makrccg uses counts from the cache if b is given in place of C. The
+% second call to get then finds its counts in the cache.
+% 
+% Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+% 
+  
+  
+  % Constant object properties
+  properties  (  Constant  )
+    
+    % Default memory cap , in bytes
+    defcap = 2 ^ 30 ;
+    
+    % Kinds of cached data
+    kinds = {  'count'  ,  'cumsum'  ,  'fft'  } ;
+  
+  end % constant properties
+  
+  
+  % Read-only object properties
+  properties  (  SetAccess  =  private  )
+    
+    % Packed spike trains
+    P
+    
+    % Number of trials and units
+    T
+    U
+    
+    % Memory cap , and memory used by cached counts , in bytes
+    cap
+    bytes = 0 ;
+    
+    % Number of units that were found in the cache , or had to be binned
+    hits = 0 ;
+    misses = 0 ;
+  
+  end % read-only properties
+  
+  
+  % Hidden object properties
+  properties  (  Access  =  private  )
+    
+    % Cached counts. Maps a key string to a struct with fields .x , the
+    % counts ; .n , their size in bytes ; and .t , the time of last use.
+    map
+    
+    % Time of last use is a counter
+    tick = 0 ;
+  
+  end % hidden properties
+  
+  
+  % Object methods
+  methods
+    
+    function  b = makbincache (  C  ,  cap  )
+    % 
+    % Create object
+    % 
+      
+      % Default cap
+      if  nargin  <  2  ,  cap = b.defcap ;  end
+      
+      % Must be a non-negative scalar
+      if  ~ isscalar (  cap  )  ||  ~ isnumeric (  cap  )  ||  ...
+          ~ isreal (  cap  )  ||  ~ ( 0  <=  cap )
+        
+        error (  'MAK:makbincache:cap'  ,  ...
+          'makbincache: cap must be a non-negative scalar'  )
+      
+      end
+      
+      % Check spike trains once , and keep them packed
+      [ ok , k , why ] = makspkchk (  C  ) ;
+      
+      if  ~ ok  &&  k
+        
+        error (  'MAK:makbincache:spktrains'  ,  ...
+          'makbincache: spike train %d %s'  ,  k  ,  why  )
+      
+      elseif  ~ ok
+        
+        error (  'MAK:makbincache:C'  ,  ...
+          'makbincache: C must be a cell array or packed spike trains'  )
+      
+      elseif  iscell (  C  )
+        
+        C = makspkpack (  C  ) ;
+      
+      end
+      
+      % Trials over rows and units over columns
+      if  numel (  C.size  )  ~=  2
+        
+        error (  'MAK:makbincache:Csize'  ,  ...
+          'makbincache: C must be a trials x units matrix of trains'  )
+      
+      end
+      
+      b.P = C ;
+      b.P.valid = true ;
+      b.T = C.size( 1 ) ;
+      b.U = C.size( 2 ) ;
+      b.cap = double (  cap  ) ;
+      b.map = containers.Map (  'KeyType'  ,  'char'  ,  ...
+        'ValueType'  ,  'any'  ) ;
+    
+    end % create object
+    
+    
+    function  X = get (  b  ,  kind  ,  g  ,  j  )
+    % 
+    % Binned counts of units j on grid g
+    % 
+      
+      % All units by default
+      if  nargin  <  4  ,  j = 1 : b.U ;  end
+      
+      % Check input
+      if  ~ ischar (  kind  )  ||  ~ any ( strcmp(  kind  ,  b.kinds  ) )
+        
+        error (  'MAK:makbincache:kind'  ,  ...
+          'makbincache: kind must be ''count'' , ''cumsum'' , or ''fft'''  )
+      
+      elseif  ~ isnumeric (  g  )  ||  ~ isreal (  g  )  ||  ...
+          numel (  g  )  ~=  3  ||  ~ all ( isfinite(  g  ) )  ||  ...
+            g( 2 )  <=  0  ||  g( 3 ) < 1  ||  mod (  g( 3 )  ,  1  )
+        
+        error (  'MAK:makbincache:g'  ,  [ 'makbincache: g must be ' , ...
+          '[ t0 , dt , Q ] with dt > 0 and integer Q of 1 or more' ]  )
+      
+      elseif  ~ isnumeric (  j  )  ||  any (  mod( j , 1 )  )  ||  ...
+          any (  j( : ) < 1  |  b.U < j( : )  )
+        
+        error (  'MAK:makbincache:j'  ,  ...
+          'makbincache: j must be unit indices from 1 to %d'  ,  b.U  )
+      
+      end % check input
+      
+      % Grid in double precision
+      g = double (  g( : )'  ) ;
+      
+      X = b.fetch (  kind  ,  g  ,  j  ,  true  ) ;
+    
+    end % get
+    
+    
+    function  flush (  b  )
+    % 
+    % Empty the cache
+    % 
+      
+      remove (  b.map  ,  keys( b.map )  ) ;
+      b.bytes = 0 ;
+    
+    end % flush
+  
+  
+  end % methods
+  
+  
+  % Hidden object methods
+  methods  (  Access  =  private  )
+    
+    function  X = fetch (  b  ,  kind  ,  g  ,  j  ,  tally  )
+    % 
+    % Data of kind for units j on grid g , from the cache or made anew.
+    % Hits and misses are only counted if tally is true , so that counts
+    % fetched for 'cumsum' or 'fft' do not count the same units again.
+    % 
+      
+      % Each unit once , so that none is binned or added twice. r puts them
+      % back in the order of j.
+      [ j , ~ , r ] = unique (  j( : )'  ,  'stable'  ) ;
+      
+      % Cached data of each unit , and units that are not in the cache
+      x = cell (  1  ,  numel( j )  ) ;
+      miss = false (  size( x )  ) ;
+      
+      for  i = 1 : numel (  j  )
+        
+        k = key (  kind  ,  j( i )  ,  g  ) ;
+        
+        if  isKey (  b.map  ,  k  )
+          
+          x{ i } = b.touch (  k  ) ;
+        
+        else
+          
+          miss( i ) = true ;
+        
+        end
+      
+      end % units
+      
+      % Count hits and misses
+      if  tally
+        b.hits = b.hits  +  sum (  ~ miss  ) ;
+        b.misses = b.misses  +  sum (  miss  ) ;
+      end
+      
+      % Fill in missing units
+      if  any (  miss  )
+        
+        % Spike counts
+        if  strcmp (  kind  ,  'count'  )
+          
+          x( miss ) = b.bin (  j( miss )  ,  g  ) ;
+        
+        % Found from counts , which may be cached
+        else
+          
+          N = b.fetch (  'count'  ,  g  ,  j( miss )  ,  false  ) ;
+          
+          switch  kind
+            case  'cumsum'
+              N = cat (  2  ,  zeros( b.T , 1 , size( N , 3 ) )  ,  ...
+                cumsum( N , 2 )  ) ;
+            case  'fft'
+              N = fft (  N  ,  2 ^ nextpow2( 2 * g( 3 ) - 1 )  ,  2  ) ;
+          end
+          
+          x( miss ) = reshape (  num2cell( N , [ 1 , 2 ] )  ,  1  ,  [ ]  ) ;
+        
+        end % new data
+        
+        % Add to the cache
+        for  i = find (  miss  )
+          b.add (  key( kind , j( i ) , g )  ,  x{ i }  )
+        end
+      
+      end % missing units
+      
+      % Units over the third dimension , in the order of j
+      X = cat (  3  ,  x{ r }  ) ;
+    
+    end % fetch
+    
+    
+    function  x = touch (  b  ,  k  )
+    % 
+    % Cached data of key k , marked as used now
+    % 
+      
+      b.tick = b.tick  +  1 ;
+      e = b.map(  k  ) ;
+      e.t = b.tick ;
+      b.map(  k  ) = e ;
+      x = e.x ;
+    
+    end % touch
+    
+    
+    function  add (  b  ,  k  ,  x  )
+    % 
+    % Adds data x to the cache under key k , then drops the least recently
+    % used data until the memory cap is met. Data bigger than the cap is
+    % not cached.
+    % 
+      
+      % Bytes used by x
+      n = numel (  x  )  *  8  *  ( 1  +  ~ isreal( x ) ) ;
+      
+      if  b.cap  <  n  ,  return  ,  end
+      
+      % Add new data
+      b.tick = b.tick  +  1 ;
+      b.map(  k  ) = struct (  'x'  ,  x  ,  'n'  ,  n  ,  't'  ,  b.tick  ) ;
+      b.bytes = b.bytes  +  n ;
+      
+      % Least recently used data is dropped first
+      if  b.bytes  <=  b.cap  ,  return  ,  end
+      
+      k = keys (  b.map  ) ;
+      e = values (  b.map  ) ;
+      e = [ e{ : } ] ;
+      [ ~ , i ] = sort (  [ e.t ]  ) ;
+      
+      for  i = i
+        
+        remove (  b.map  ,  k{ i }  ) ;
+        b.bytes = b.bytes  -  e( i ).n ;
+        
+        if  b.bytes  <=  b.cap  ,  break  ,  end
+      
+      end % drop data
+    
+    end % add
+    
+    
+    function  x = bin (  b  ,  j  ,  g  )
+    % 
+    % Counts spikes of units j on grid g. Returns a cell array with one
+    % T x Q matrix per unit.
+    % 
+      
+      % Trains of units j , packed. The trains of each unit are one block.
+      o = b.P.off ;
+      i = arrayfun (  @( u ) o( b.T * ( u - 1 ) + 1 ) + 1 : ...
+        o( b.T * u + 1 )  ,  j  ,  'UniformOutput'  ,  false  ) ;
+      n = diff (  reshape( o , [ ] , 1 )  ) ;
+      n = reshape (  n  ,  b.T  ,  b.U  ) ;
+      
+      p.t = b.P.t(  [ i{ : } ]  ) ;
+      p.off = [  0  ;  cumsum( reshape( n( : , j ) , [ ] , 1 ) )  ] ;
+      p.size = [  b.T  ,  numel( j )  ] ;
+      p.valid = true ;
+      
+      % Bin edges , as windows over the third dimension. makrccg finds the
+      % same edges in the same way.
+      e = g( 1 )  +  ( 0 : g( 3 ) )  *  g( 2 ) ;
+      w = permute (  [ e( 1 : end - 1 ) ; e( 2 : end ) ]  ,  [ 3 , 1 , 2 ]  ) ;
+      
+      % Counts of trials x units x bins , one T x Q matrix per unit. The
+      % last bin is closed , like that of histcounts.
+      N = makspkcount (  p  ,  w  ,  'double'  ,  false  ,  true  ) ;
+      N = permute (  N  ,  [ 1 , 3 , 2 ]  ) ;
+      x = num2cell (  N  ,  [ 1 , 2 ]  ) ;
+      x = reshape (  x  ,  1  ,  [ ]  ) ;
+    
+    end % bin
+  
+  
+  end % hidden methods
+  
+  
+end % makbincache
+  
+  
+%%% Subroutines %%%
+  
+% Key of cached data
+function  k = key (  kind  ,  j  ,  g  )
+  
+  k = sprintf (  '%s:%d:%.17g:%.17g:%d'  ,  kind  ,  j  ,  g  ) ;
+  
+end % key
+
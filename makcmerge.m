@@ -1,7 +1,7 @@
 
-function  [ n , c , E , m ] = makcmerge (  n  ,  c  ,  E  ,  cut  )
+function  [ n , c , E , m , D ] = makcmerge (  n  ,  c  ,  E  ,  cut  )
 % 
-% [ n , c , E , m ] = makcmerge (  n  ,  c  ,  E  ,  cut  )
+% [ n , c , E , m , D ] = makcmerge (  n  ,  c  ,  E  ,  cut  )
 % 
 % MET Analysis Kit, pre-processing. Initial spike clusters are merged
 % together on the basis of their connection strength. Merging is done
@@ -11,6 +11,11 @@ function  [ n , c , E , m ] = makcmerge (  n  ,  c  ,  E  ,  cut  )
 %   2) Merge clusters and compute new raw interface energies
 %   3) Repeat 1 and 2 until a cutoff connection strength is reached
 % 
+% If cut is empty [ ] then merging runs to the end, until no pair of
+% clusters has any connection strength left. The returned dendrogram D
+% then holds every merger that any cutoff value could produce, and
+% makcreplay can apply a new cutoff without repeating the agglomeration.
+% 
 % 
 % Input
 % 
@@ -20,20 +25,28 @@ function  [ n , c , E , m ] = makcmerge (  n  ,  c  ,  E  ,  cut  )
 %   
 %   E - Raw interface-energy matrix
 %   
-%   cut - Connection strength cutoff value
+%   cut - Connection strength cutoff value. Empty [ ] runs all mergers.
 % 
 % 
 % Output
 % 
 %   n - Final number of spikes per cluster
 %   
-%   c - Final cluster assignment of all spikes
+%   c - Final cluster assignment of all spikes. makspktrains gathers the
+%     spike train of each cluster in one pass.
 %   
 %   E - Final raw interface energy matrix
 %   
 %   m - 2 x M list of cluster mergers. The top row holds the lower cluster
 %     number of each merger, and the bottom row holds the higher. Mergers
 %     are ordered as they happened from left-to-right.
+%   
+%   D - Dendrogram struct with fields .m , a copy of merger list m ; .s ,
+%     a 1 x M double vector with the connection strength of each merger ;
+%     and .cut , the cutoff that was used , or zero if merging ran to the
+%     end. The first k mergers in D.m are the ones made by makcmerge with
+%     any cutoff above D.cut, where k is the number of leading values in
+%     D.s that are not below that cutoff. See makcreplay.
 % 
 % 
 % References:
@@ -49,9 +62,15 @@ function  [ n , c , E , m ] = makcmerge (  n  ,  c  ,  E  ,  cut  )
   % Number of clusters
   cnum = numel (  n  ) ;
   
+  % No cutoff given , run mergers to the end. Only pairs with some positive
+  % connection strength are merged.
+  full = isempty (  cut  ) ;
+  if  full  ,  cut = 0 ;  end
+  
   % There is only one cluster , return empty merger list
   if  cnum  ==  1
     m = zeros (  2  ,  0  ,  'uint8'  ) ;
+    D = struct (  'm'  ,  m  ,  's'  ,  zeros( 1 , 0 )  ,  'cut'  ,  cut  );
     return
   end
   
@@ -64,6 +83,9 @@ function  [ n , c , E , m ] = makcmerge (  n  ,  c  ,  E  ,  cut  )
   % Allocate list of cluster mergers
   mi = 0 ;
   m = zeros (  2  ,  cnum - 1  ,  'uint8'  ) ;
+  
+  % Connection strength of each merger
+  s = zeros (  1  ,  cnum - 1  ) ;
 
   % Aggregation loop runs so long as there are untested pairs
   while  any (  U( : )  )
@@ -77,8 +99,9 @@ function  [ n , c , E , m ] = makcmerge (  n  ,  c  ,  E  ,  cut  )
     % Find cluster pair with the maximum connection strength
     [ cmax , pmax ] = max (  J( : )  ) ;
 
-    % Connection strengths have fallen to below the cutoff point , end now
-    if  cmax  <  cut  ,  break  ,  end
+    % Connection strengths have fallen to below the cutoff point , end now.
+    % When running to the end, stop once no connection strength is left.
+    if  cmax  <  cut  ||  (  full  &&  cmax  <=  0  )  ,  break  ,  end
     
     % Get the number of each cluster in the pair. c1 and c2 are necessarily
     % the low and high cluster numbers because of the upper-triangular
@@ -92,6 +115,7 @@ function  [ n , c , E , m ] = makcmerge (  n  ,  c  ,  E  ,  cut  )
     % Record the merger
     mi = mi  +  1 ;
     m( : , mi ) = [  c1  ;  c2  ] ;
+    s( mi ) = cmax ;
     
     % Re-assign spikes in the high-number cluster to the low-number cluster
     c( c  ==  c2 ) = c1 ;
@@ -131,6 +155,12 @@ function  [ n , c , E , m ] = makcmerge (  n  ,  c  ,  E  ,  cut  )
   
   % Remove empty tail from merge list
   m( : , mi + 1 : end ) = [] ;
+  s( mi + 1 : end ) = [] ;
+  
+  % Dendrogram of mergers and their connection strengths
+  if  4  <  nargout
+    D = struct (  'm'  ,  m  ,  's'  ,  s  ,  'cut'  ,  cut  ) ;
+  end
   
   % Convert interface energy matrix to sparse matrix
   E = sparse (  E  ) ;
@@ -20,6 +20,10 @@ function  c = makconv (  x  ,  k  ,  t  )
 % 
 % If t is an empty string then it is ignored.
 % 
+% Convolution is done with FFTs. But if maktune has found that direct
+% convolution is faster on this computer for the size of x and k, then
+% conv2 is used instead.
+% 
 % Written by Jackson Smith - August 2019 - DPAG , University of Oxford
 % 
   
@@ -67,18 +71,38 @@ function  c = makconv (  x  ,  k  ,  t  )
   % Optimal size for fast fft run time
   nf = 2  ^  ceil( log2(  L  ) ) ;
   
-  % Fourier transform of the inputs
-  fx = fft (  x  ,  nf  ) ;
-  fk = fft (  k  ,  nf  ) ;
-  
-  % Convolution is equal to multiplication in Fourier domain
-  c = ifft ( bsxfun(  @times  ,  fx  ,  fk  ) ) ;
-  
   % Get colon operator for each dimension of c, excluding rows
   co = repmat (  { ':' }  ,  1  ,  N  ) ;
   
-  % Get rid of excess data points used for Fourier transformations
-  c( L + 1 : end , co{ : } ) = [ ] ;
+  % Longest kernel for which direct convolution is faster on this
+  % computer, at this FFT length. See maktune.
+  tune = maktune ;
+  i = find (  nf  <=  tune.convnf  ,  1  ) ;
+  
+  % Direct convolution of each column
+  if  ~ isempty (  i  )  &&  K  <=  tune.convK( i )
+    
+    % Size of c
+    s = size (  x  ) ;
+    s( 1 ) = L ;
+    
+    % Convolve columns , then restore higher dimensions
+    c = reshape (  conv2( x( : , : ) , k )  ,  s  ) ;
+    
+  % FFT convolution
+  else
+    
+    % Fourier transform of the inputs
+    fx = fft (  x  ,  nf  ) ;
+    fk = fft (  k  ,  nf  ) ;
+    
+    % Convolution is equal to multiplication in Fourier domain
+    c = ifft ( bsxfun(  @times  ,  fx  ,  fk  ) ) ;
+    
+    % Get rid of excess data points used for Fourier transformations
+    c( L + 1 : end , co{ : } ) = [ ] ;
+    
+  end % convolution
   
   % Kernel type
   switch  t
@@ -0,0 +1,104 @@
+
+function  [ n , c , E , m ] = makcreplay (  n  ,  c  ,  E  ,  D  ,  cut  )
+% 
+% [ n , c , E , m ] = makcreplay (  n  ,  c  ,  E  ,  D  ,  cut  )
+% 
+% MET Analysis Kit, pre-processing. Applies a new connection strength
+% cutoff to a set of initial spike clusters without repeating the
+% automated merging of makcmerge. Instead, the first mergers listed in
+% dendrogram D are replayed. These are all mergers up to, but not
+% including, the first one with a connection strength below cut. The
+% result is identical to that of makcmerge (  n  ,  c  ,  E  ,  cut  ).
+% 
+% Each replayed merger costs O( cnum ) for cnum initial clusters, because
+% connection strengths are never recomputed. Spikes are re-labelled in a
+% single pass once all mergers are known. Hence, many cutoff values can be
+% explored quickly, for instance in makmergetool.
+% 
+% 
+% Input
+% 
+%   n , c , E - Initial spike counts per cluster, cluster assignment of
+%     each spike, and raw interface-energy matrix ; these are the same
+%     values that were given to makcmerge when D was made.
+% 
+%   D - Dendrogram struct returned by makcmerge. Run makcmerge with an
+%     empty cutoff, [ ], to get a dendrogram that allows any cutoff value.
+% 
+%   cut - Connection strength cutoff value. Must be greater than zero, and
+%     not less than D.cut. A cutoff of zero is not replayed, because
+%     makcmerge with no cutoff stops at the first connection strength that
+%     is not positive, while a cutoff of zero would not.
+% 
+% 
+% Output
+% 
+%   n , c , E , m - As returned by makcmerge (  n  ,  c  ,  E  ,  cut  ).
+% 
+% 
+% Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+% 
+  
+  % Replay is only identical to makcmerge for positive cutoffs
+  if  ~isscalar( cut )  ||  ~( 0  <  cut )
+    
+    error (  'MAK:makcreplay:cut'  ,  'makcreplay: cut must be above zero'  )
+  
+  % Mergers below D.cut were never tried , so they cannot be replayed
+  elseif  cut  <  D.cut
+    
+    error (  'MAK:makcreplay:cut'  ,  [ 'makcreplay: cut must be ' , ...
+      'at least %f , the cutoff used to make D' ]  ,  D.cut  )
+  
+  end % check cut
+  
+  % Number of clusters
+  cnum = numel (  n  ) ;
+  
+  % Number of mergers to replay , all those before the first connection
+  % strength that falls below the cutoff
+  k = find (  D.s  <  cut  ,  1  ,  'first'  ) ;
+  if  isempty (  k  )  ,  k = numel (  D.s  ) ;  else  ,  k = k - 1 ;  end
+  
+  % Merger list
+  m = D.m (  :  ,  1 : k  ) ;
+  
+  % Maps each initial cluster to the cluster it is merged into
+  map = cast (  1 : cnum  ,  'like'  ,  c  ) ;
+  
+  % Mergers
+  for  i = 1 : k
+    
+    % Low and high cluster numbers
+    c1 = double (  m( 1 , i )  ) ;
+    c2 = double (  m( 2 , i )  ) ;
+    
+    % Initial clusters that now belong to the high-number cluster go to the
+    % low-number cluster
+    map(  map  ==  c2  ) = c1 ;
+    
+    % Compute new intra-cluster energy
+    E( c1 , c1 ) = E( c1 , c1 )  +  E( c2 , c2 )  +  E( c1 , c2 ) ;
+    
+    % Compute new inter-cluster energies between the low cluster and all
+    % others , then clear those of the high cluster following makcmerge
+    [ i1 , i2 ] = makcind (  c1  ,  c2  ,  cnum  ) ;
+    E( i1 ) = E( i1 )  +  E( i2 ) ;
+    E( i2 ) = 0 ;
+    E( c1 , c2 ) = 0 ;
+    E( c2 , c2 ) = 1 ;
+    
+    % Update number of waveforms
+    n( c1 ) = n( c1 )  +  n( c2 ) ;
+    n( c2 ) = 0 ;
+  
+  end % mergers
+  
+  % Re-assign all spikes at once
+  c( : ) = map (  c  ) ;
+  
+  % Convert interface energy matrix to sparse matrix
+  E = sparse (  E  ) ;
+  
+end % makcreplay
+
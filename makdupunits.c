@@ -0,0 +1,508 @@
+
+/*  makdupunits
+  
+  [ p , k , e , f ] = makdupunits ( t , u , w , T , rmin )
+  
+  MET Analysis Kit. Finds candidate duplicate units , such as the same
+  neurone sorted on neighbouring electrodes. Zero-lag coincidences are
+  counted for every pair of units at once. Each spike is hashed into a
+  time bucket that is w seconds wide. Then one pass over the buckets pairs
+  each spike with the spikes of other units in the same or next bucket that
+  are no more than w seconds away. Pair counts are kept in a hash table ,
+  so only pairs of units that ever coincide take up memory.
+  
+  t is a vector of spike times in seconds , single or double , and u is a
+  vector of the same length with the unit index of each spike ; u is
+  uint8 , uint16 , uint32 , or double with values from 1 to U. w is the
+  coincidence window in seconds. T is the recording duration in seconds ;
+  if empty then T is max( t ) - min( t ). rmin is optional , default 0 ;
+  only pairs that have at least rmin times the coincidences expected by
+  chance are returned.
+  
+  p is a 2 x P uint32 matrix of unit pairs , with p( 1 , : ) < p( 2 , : ),
+  in ascending order. k is the 1 x P number of coincidences for each pair.
+  e is the 1 x P number expected by chance from independent Poisson
+  trains , Na * Nb * 2 * w / T for units with Na and Nb spikes. f is the
+  1 x P fraction of the smaller unit's spikes that are coincident.
+  
+  Compile with OpenMP to divide buckets between threads.
+  
+  Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+
+*/
+
+
+/*-- Include block --*/
+
+#include    <math.h>
+#include  <stdint.h>
+#include  <stdlib.h>
+#include  <string.h>
+#include     "mex.h"
+#include  "matrix.h"
+
+#ifdef  _OPENMP
+  #include  <omp.h>
+#endif
+
+
+/*-- Define block --*/
+
+#define  NARGINMIN  4
+#define  NARGINMAX  5
+#define    NARGOUT  4
+#define       TARG  0
+#define       UARG  1
+#define       WARG  2
+#define     TDRARG  3
+#define    RMINARG  4
+#define       POUT  0
+#define       KOUT  1
+#define       EOUT  2
+#define       FOUT  3
+
+/* Marks an empty hash table slot */
+#define  EMPTY  UINT64_MAX
+
+/* Hash of a 64-bit key , Fibonacci hashing into a table with 2 ^ b slots */
+#define  HASH( key , b )  \
+  ( ( ( key ) * 0x9E3779B97F4A7C15ULL )  >>  ( 64 - ( b ) ) )
+
+
+/*-- Data types --*/
+
+/* Open-addressing hash table of 64-bit keys and values. Holds up to half
+   of 2 ^ b slots before it grows. */
+typedef struct
+{
+  
+  uint64_t  * key , * val ;
+  mwSize  n ;
+  int  b ;
+
+} map_t ;
+
+
+/*-- Subroutines --*/
+
+/* Initialise map m with 2 ^ b empty slots. Returns non-zero if out of
+   memory. */
+static int  mapinit ( map_t * m , int b )
+{
+  m->b = b ;
+  m->n = 0 ;
+  m->key = malloc (  ( ( size_t ) 1 << b ) * sizeof( uint64_t )  ) ;
+  m->val = calloc (  ( size_t ) 1 << b  ,  sizeof( uint64_t )  ) ;
+  if  ( !m->key  ||  !m->val )  return  1 ;
+  memset (  m->key ,  0xFF ,  ( ( size_t ) 1 << b ) * sizeof( uint64_t )  );
+  return  0 ;
+}
+
+/* Release the memory of map m */
+static void  mapfree ( map_t * m )
+{
+  free (  m->key  ) ;
+  free (  m->val  ) ;
+}
+
+/* Slot of key in map m. This is either the slot that holds key , or the
+   empty slot where it would go. */
+static uint64_t  mapslot ( const map_t * m , uint64_t key )
+{
+  uint64_t  mask = ( ( uint64_t ) 1 << m->b )  -  1 ,
+            s = HASH (  key  ,  m->b  ) ;
+  
+  while  ( m->key[ s ] != EMPTY  &&  m->key[ s ] != key )
+    s = ( s  +  1 )  &  mask ;
+  
+  return  s ;
+}
+
+/* Adds v to the value of key in map m , inserting the key if it is new.
+   Returns non-zero if out of memory. */
+static int  mapadd ( map_t * m , uint64_t key , uint64_t v )
+{
+  uint64_t  s = mapslot (  m  ,  key  ) , i ;
+  map_t  g ;
+  
+  if  ( m->key[ s ] == key )
+  {
+    m->val[ s ] += v ;
+    return  0 ;
+  }
+  
+  m->key[ s ] = key ;
+  m->val[ s ] = v ;
+  
+  /* Half full , double the size */
+  if  ( ++m->n  <=  ( ( mwSize ) 1 << ( m->b - 1 ) ) )  return  0 ;
+  
+  if  ( mapinit(  &g  ,  m->b + 1  ) )  return  1 ;
+  for  ( i = 0 ; i < ( ( uint64_t ) 1 << m->b ) ; i++ )
+    if  ( m->key[ i ] != EMPTY )
+    {
+      s = mapslot (  &g  ,  m->key[ i ]  ) ;
+      g.key[ s ] = m->key[ i ] ;
+      g.val[ s ] = m->val[ i ] ;
+    }
+  g.n = m->n ;
+  mapfree (  m  ) ;
+  *m = g ;
+  
+  return  0 ;
+}
+
+/* Writes the 0-based unit labels of u to l and the largest label to U.
+   Returns non-zero if any label is not an integer of 1 or more. */
+static int  getlabels ( const mxArray * u , mwSize * l , mwSize * U )
+{
+  mwSize  i , N = mxGetNumberOfElements (  u  ) ;
+  double  v ;
+  
+  for  ( *U = 0 , i = 0 ; i < N ; i++ )
+  {
+    switch  ( mxGetClassID(  u  ) )
+    {
+      case  mxUINT8_CLASS:
+        v = ( ( const unsigned char * ) mxGetData( u ) )[ i ] ;  break ;
+      case  mxUINT16_CLASS:
+        v = ( ( const unsigned short * ) mxGetData( u ) )[ i ] ;  break ;
+      case  mxUINT32_CLASS:
+        v = ( ( const unsigned int * ) mxGetData( u ) )[ i ] ;  break ;
+      default:
+        v = mxGetPr (  u  )[ i ] ;
+    }
+    
+    if  ( !( 1 <= v )  ||  v != ( double ) ( mwSize ) v )  return  1 ;
+    
+    l[ i ] = ( mwSize ) v  -  1 ;
+    if  ( *U  <  ( mwSize ) v )  *U = ( mwSize ) v ;
+  }
+  
+  return  0 ;
+}
+
+/* Ascending order of 64-bit keys */
+static int  cmpkey ( const void * a , const void * b )
+{
+  uint64_t  x = *( const uint64_t * ) a , y = *( const uint64_t * ) b ;
+  return  ( y < x )  -  ( x < y ) ;
+}
+
+
+/*** MEX gateway function ***/
+
+void  mexFunction (  int nlhs  ,        mxArray * plhs[ ] ,
+                     int nrhs  ,  const mxArray * prhs[ ]  )
+{
+  
+  
+  /*-- Variables --*/
+  
+  /* Generic counters */
+  mwSize  i , j ;
+  
+  /* Number of spikes , units , distinct buckets , and unit pairs */
+  mwSize  N , U , B , P ;
+  
+  /* Coincidence window , duration , minimum ratio to chance , and first
+     spike time */
+  double  w , T , rmin = 0 , t0 ;
+  
+  /* Spike times and unit labels */
+  double  * t ;
+  mwSize  * l ;
+  
+  /* Spikes per unit */
+  double  * n ;
+  
+  /* Bucket of each spike , buckets in order of first use , map of bucket to
+     its first spike , and the next spike in the same bucket */
+  uint64_t  * bk , * bu ;
+  map_t  bm , pm ;
+  mwSize  * nx ;
+  
+  /* Error flag raised by any thread */
+  int  err = 0 ;
+  
+  /* Sorted pair keys , and outputs */
+  uint64_t  * pk ;
+  mxArray  * o[ NARGOUT ] ;
+  
+  
+  /*-- Input check --*/
+  
+  /* Must be 4 or 5 input args */
+  if  ( nrhs < NARGINMIN  ||  NARGINMAX < nrhs )
+    
+    mexErrMsgIdAndTxt (  "MAK:makdupunits:nargsin"  ,
+      "makdupunits: requires %d or %d input arguments"  ,
+      NARGINMIN  ,  NARGINMAX  ) ;
+  
+  /* Must be no more than 4 output args */
+  else if  ( NARGOUT  <  nlhs )
+    
+    mexErrMsgIdAndTxt (  "MAK:makdupunits:nargsout"  ,
+      "makdupunits: returns at most %d output arguments"  ,  NARGOUT  ) ;
+  
+  /* t must be real single or double */
+  else if  (  !( mxIsDouble( prhs[ TARG ] ) || mxIsSingle( prhs[ TARG ] ) )
+              ||  mxIsComplex( prhs[ TARG ] )  )
+    
+    mexErrMsgIdAndTxt (  "MAK:makdupunits:t"  ,
+      "makdupunits: t must be a real single or double vector"  ) ;
+  
+  /* u must have one label per spike */
+  else if  (  !( mxIsUint8( prhs[ UARG ] )  ||  mxIsUint16( prhs[ UARG ] )
+                 ||  mxIsUint32( prhs[ UARG ] )  ||
+                 ( mxIsDouble( prhs[ UARG ] ) && !mxIsComplex( prhs[ UARG ] )
+                   && !mxIsSparse( prhs[ UARG ] ) ) )  ||
+              mxGetNumberOfElements( prhs[ UARG ] ) !=
+              mxGetNumberOfElements( prhs[ TARG ] )  )
+    
+    mexErrMsgIdAndTxt (  "MAK:makdupunits:u"  ,
+      "makdupunits: u must be uint8 , uint16 , uint32 , or double with "
+      "one value per spike"  ) ;
+  
+  /* w must be a positive scalar */
+  else if  (  !mxIsScalar( prhs[ WARG ] )  ||  !mxIsNumeric( prhs[ WARG ] )
+              ||  !( 0  <  mxGetScalar( prhs[ WARG ] ) )  )
+    
+    mexErrMsgIdAndTxt (  "MAK:makdupunits:w"  ,
+      "makdupunits: w must be a positive scalar"  ) ;
+  
+  /* T must be empty or a positive scalar */
+  else if  (  !mxIsEmpty( prhs[ TDRARG ] )  &&
+              ( !mxIsScalar( prhs[ TDRARG ] )  ||
+                !mxIsNumeric( prhs[ TDRARG ] )  ||
+                !( 0  <  mxGetScalar( prhs[ TDRARG ] ) ) )  )
+    
+    mexErrMsgIdAndTxt (  "MAK:makdupunits:T"  ,
+      "makdupunits: T must be empty or a positive scalar"  ) ;
+  
+  /* Optional rmin must be a non-negative scalar */
+  if  ( NARGINMAX  ==  nrhs )
+  {
+    if  (  !mxIsScalar( prhs[ RMINARG ] )  ||
+           !mxIsNumeric( prhs[ RMINARG ] )  ||
+           !( 0  <=  mxGetScalar( prhs[ RMINARG ] ) )  )
+      
+      mexErrMsgIdAndTxt (  "MAK:makdupunits:rmin"  ,
+        "makdupunits: rmin must be a non-negative scalar"  ) ;
+    
+    rmin = mxGetScalar (  prhs[ RMINARG ]  ) ;
+  }
+  
+  
+  /*-- Preparation --*/
+  
+  N = mxGetNumberOfElements (  prhs[ TARG ]  ) ;
+  w = mxGetScalar (  prhs[ WARG ]  ) ;
+  
+  /* Unit labels */
+  l = mxMalloc (  ( N + 1 ) * sizeof( mwSize )  ) ;
+  
+  if  ( getlabels(  prhs[ UARG ]  ,  l  ,  &U  ) )
+    
+    mexErrMsgIdAndTxt (  "MAK:makdupunits:uval"  ,
+      "makdupunits: u values must be integers of 1 or more"  ) ;
+  
+  /* Spike times in double precision , and spikes per unit */
+  t = mxMalloc (  ( N + 1 ) * sizeof( double )  ) ;
+  n = mxCalloc (  U + 1  ,  sizeof( double )  ) ;
+  
+  for  ( i = 0 ; i < N ; i++ )
+  {
+    t[ i ] = mxIsDouble (  prhs[ TARG ]  )  ?  mxGetPr( prhs[ TARG ] )[ i ]
+      :  ( ( const float * ) mxGetData( prhs[ TARG ] ) )[ i ] ;
+    
+    if  ( !isfinite(  t[ i ]  ) )
+      mexErrMsgIdAndTxt (  "MAK:makdupunits:tval"  ,
+        "makdupunits: t values must be finite"  ) ;
+    
+    n[ l[ i ] ] += 1 ;
+  }
+  
+  /* Recording duration */
+  for  ( t0 = N ? t[ 0 ] : 0 , T = t0 , i = 1 ; i < N ; i++ )
+  {
+    if  ( t[ i ] < t0 )  t0 = t[ i ] ;
+    if  ( T < t[ i ] )   T = t[ i ] ;
+  }
+  
+  T = mxIsEmpty (  prhs[ TDRARG ]  )  ?  T - t0  :
+    mxGetScalar (  prhs[ TDRARG ]  ) ;
+  
+  /* Chance is undefined if spikes span no time */
+  if  ( !( 0  <  T ) )
+    mexErrMsgIdAndTxt (  "MAK:makdupunits:Tval"  ,
+      "makdupunits: spikes span no time , T must be given"  ) ;
+  
+  
+  /*-- Hash spikes into time buckets --*/
+  
+  /* Bucket of each spike , counted from the first spike */
+  bk = mxMalloc (  ( N + 1 ) * sizeof( uint64_t )  ) ;
+  bu = mxMalloc (  ( N + 1 ) * sizeof( uint64_t )  ) ;
+  nx = mxMalloc (  ( N + 1 ) * sizeof( mwSize )  ) ;
+  
+  for  ( i = 0 ; i < N ; i++ )
+    bk[ i ] = ( uint64_t ) floor (  ( t[ i ]  -  t0 )  /  w  ) ;
+  
+  /* Chain the spikes of each bucket. The map value is the bucket's first
+     spike plus 1. */
+  if  ( mapinit(  &bm  ,  4  ) )  err = 1 ;
+  
+  for  ( B = 0 , i = 0 ; !err  &&  i < N ; i++ )
+  {
+    uint64_t  s = mapslot (  &bm  ,  bk[ i ]  ) ;
+    
+    if  ( bm.key[ s ] == bk[ i ] )
+    {
+      nx[ i ] = ( mwSize ) bm.val[ s ] ;
+      bm.val[ s ] = i  +  1 ;
+    }
+    else
+    {
+      nx[ i ] = 0 ;
+      bu[ B++ ] = bk[ i ] ;
+      err = mapadd (  &bm  ,  bk[ i ]  ,  i + 1  ) ;
+    }
+  }
+  
+  if  ( err )
+    mexErrMsgIdAndTxt (  "MAK:makdupunits:mem"  ,
+      "makdupunits: out of memory"  ) ;
+  
+  
+  /*-- Count coincidences --*/
+  
+  /* Unit pair a < b is counted under key a * U + b */
+  if  ( mapinit(  &pm  ,  4  ) )
+    mexErrMsgIdAndTxt (  "MAK:makdupunits:mem"  ,
+      "makdupunits: out of memory"  ) ;
+  
+  #pragma omp parallel
+  {
+    
+    /* Thread's pair counts */
+    map_t  m ;
+    mwSignedIndex  b ;
+    mwSize  a , c , x , y ;
+    uint64_t  s ;
+    int  e = mapinit (  &m  ,  4  ) ;
+    
+    /* Buckets */
+    #pragma omp for schedule( dynamic , 256 )
+    for  ( b = 0 ; b < ( mwSignedIndex ) B ; b++ )
+    {
+      if  ( e )  continue ;
+      
+      /* First spike of this bucket and of the next one */
+      x = ( mwSize ) bm.val[ mapslot( &bm , bu[ b ] ) ] ;
+      s = mapslot (  &bm  ,  bu[ b ] + 1  ) ;
+      y = bm.key[ s ] == bu[ b ] + 1  ?  ( mwSize ) bm.val[ s ]  :  0 ;
+      
+      /* Spikes in this bucket , paired with later spikes in the chain and
+         with all spikes in the next bucket */
+      for  ( ; x ; x = nx[ x - 1 ] )
+      {
+        for  ( c = nx[ x - 1 ] ; c ; c = nx[ c - 1 ] )
+          if  ( l[ x - 1 ] != l[ c - 1 ]  &&
+                fabs( t[ x - 1 ] - t[ c - 1 ] ) <= w )
+          {
+            a = l[ x - 1 ] < l[ c - 1 ] ? l[ x - 1 ] : l[ c - 1 ] ;
+            e |= mapadd (  &m  ,  a * U  +  l[ x - 1 ] + l[ c - 1 ] - a  ,
+              1  ) ;
+          }
+        
+        for  ( c = y ; c ; c = nx[ c - 1 ] )
+          if  ( l[ x - 1 ] != l[ c - 1 ]  &&
+                fabs( t[ x - 1 ] - t[ c - 1 ] ) <= w )
+          {
+            a = l[ x - 1 ] < l[ c - 1 ] ? l[ x - 1 ] : l[ c - 1 ] ;
+            e |= mapadd (  &m  ,  a * U  +  l[ x - 1 ] + l[ c - 1 ] - a  ,
+              1  ) ;
+          }
+      }
+    } /* buckets */
+    
+    /* Add thread's counts to the total */
+    #pragma omp critical
+    {
+      for  ( s = 0 ; !e  &&  s < ( ( uint64_t ) 1 << m.b ) ; s++ )
+        if  ( m.key[ s ] != EMPTY )  e = mapadd (  &pm ,  m.key[ s ] ,
+          m.val[ s ]  ) ;
+      err |= e ;
+    }
+    
+    mapfree (  &m  ) ;
+  
+  } /* parallel */
+  
+  mapfree (  &bm  ) ;
+  mxFree (  bk  ) ;
+  mxFree (  bu  ) ;
+  mxFree (  nx  ) ;
+  
+  if  ( err )
+    mexErrMsgIdAndTxt (  "MAK:makdupunits:mem"  ,
+      "makdupunits: out of memory"  ) ;
+  
+  
+  /*-- Compare with chance --*/
+  
+  /* Keep pairs with enough coincidences , in ascending order */
+  pk = mxMalloc (  ( pm.n + 1 ) * sizeof( uint64_t )  ) ;
+  
+  for  ( P = 0 , i = 0 ; i < ( ( mwSize ) 1 << pm.b ) ; i++ )
+  {
+    uint64_t  a , b ;
+    
+    if  ( pm.key[ i ] == EMPTY )  continue ;
+    
+    a = pm.key[ i ]  /  U ;
+    b = pm.key[ i ]  %  U ;
+    
+    if  ( ( double ) pm.val[ i ]  >=  rmin * n[ a ] * n[ b ] * 2 * w / T )
+      pk[ P++ ] = pm.key[ i ] ;
+  }
+  
+  qsort (  pk  ,  P  ,  sizeof( uint64_t )  ,  cmpkey  ) ;
+  
+  /* Allocate outputs */
+  o[ POUT ] = mxCreateNumericMatrix (  2  ,  P  ,  mxUINT32_CLASS  ,
+    mxREAL  ) ;
+  o[ KOUT ] = mxCreateDoubleMatrix (  1  ,  P  ,  mxREAL  ) ;
+  o[ EOUT ] = mxCreateDoubleMatrix (  1  ,  P  ,  mxREAL  ) ;
+  o[ FOUT ] = mxCreateDoubleMatrix (  1  ,  P  ,  mxREAL  ) ;
+  
+  for  ( j = 0 ; j < P ; j++ )
+  {
+    uint64_t  a = pk[ j ]  /  U , b = pk[ j ]  %  U ;
+    double  k = ( double ) pm.val[ mapslot( &pm , pk[ j ] ) ] ;
+    
+    ( ( unsigned int * ) mxGetData( o[ POUT ] ) )[ 2 * j     ] = a  +  1 ;
+    ( ( unsigned int * ) mxGetData( o[ POUT ] ) )[ 2 * j + 1 ] = b  +  1 ;
+    mxGetPr (  o[ KOUT ]  )[ j ] = k ;
+    mxGetPr (  o[ EOUT ]  )[ j ] = n[ a ]  *  n[ b ]  *  2  *  w  /  T ;
+    mxGetPr (  o[ FOUT ]  )[ j ] = k  /
+      ( n[ a ]  <  n[ b ]  ?  n[ a ]  :  n[ b ] ) ;
+  }
+  
+  mapfree (  &pm  ) ;
+  mxFree (  pk  ) ;
+  mxFree (  t  ) ;
+  mxFree (  l  ) ;
+  mxFree (  n  ) ;
+  
+  /* Return requested outputs */
+  for  ( i = 0 ; i < NARGOUT ; i++ )
+    if  ( i  <  ( mwSize ) ( nlhs < 1 ? 1 : nlhs ) )
+      plhs[ i ] = o[ i ] ;
+    else
+      mxDestroyArray (  o[ i ]  ) ;
+
+
+} /* mexFunction */
+
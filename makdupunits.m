@@ -0,0 +1,47 @@
+
+% [ p , k , e , f ] = makdupunits ( t , u , w , T , rmin )
+% 
+% MET Analysis Kit, pre-processing. Finds candidate duplicate units, such
+% as the same neurone sorted on neighbouring electrodes after makcmerge
+% was run on each electrode separately. Zero-lag coincidences are counted
+% for every pair of units at once, and compared with the number expected
+% by chance from their firing rates. This avoids computing a dense cross-
+% correlation, with makrccg or makxcorr, for every pair of units.
+% 
+% t is a vector of spike times in seconds, single or double, pooled from
+% all electrodes. u is a vector of the same length with the unit index of
+% each spike ; it is uint8, uint16, uint32, or double with integer values
+% from 1 to U. w is the coincidence window in seconds, usually less than a
+% millisecond ; spikes from two units are coincident if they are no more
+% than w seconds apart. T is the recording duration in seconds. If T is
+% empty then max( t ) - min( t ) is used. rmin is optional, default 0.
+% Only pairs of units with at least rmin times the number of coincidences
+% expected by chance are returned.
+% 
+% p is a 2 x P uint32 matrix of unit pairs, with p( 1 , : ) < p( 2 , : ),
+% in ascending order. k is the 1 x P number of coincidences for each pair.
+% e is the 1 x P number of coincidences expected by chance from two
+% independent Poisson spike trains, Na * Nb * 2 * w / T for units with Na
+% and Nb spikes. f is the 1 x P fraction of the smaller unit's spikes that
+% are coincident. A duplicate unit has k much greater than e, and f near
+% the fraction of spikes that the two electrodes both detected.
+% 
+% 
+% Algorithm:
+% 
+% Each spike is hashed into a time bucket that is w seconds wide ; only
+% the buckets that contain spikes take up memory. Then, one pass over the
+% buckets pairs each spike with the spikes of other units in the same
+% bucket and in the next one that are no more than w seconds away. Pair
+% counts are kept in a hash table, so only pairs of units that coincide at
+% least once take up memory. The cost is O( n ) for n spikes, plus the
+% number of coincident spike pairs.
+% 
+% If MEX is compiled with OpenMP then buckets are divided between threads,
+% e.g.
+% 
+%   mex CFLAGS='$CFLAGS -fopenmp' LDFLAGS='$LDFLAGS -fopenmp' makdupunits.c
+% 
+% Otherwise, it runs on a single thread.
+% 
+% Written by Jackson Smith - October 2026 - ESI (Fries Lab)
@@ -0,0 +1,418 @@
+
+/*  makenergyadd
+  
+  [ E , n ] = makenergyadd ( E , n , d0 , c , ca , cn , can )
+  
+  MET Analysis Kit, pre-processing. Adds a batch of new spikes to an
+  existing raw interface-energy matrix, without computing again the
+  energies between spikes that were already there. Interface energy is a
+  sum over pairs of spikes. So the new spikes only add the energy of each
+  new spike paired with every old spike, and of each pair of new spikes.
+  This takes O( Nn x ( N + Nn ) ) time for N old and Nn new spikes.
+  
+  E is the Nc x Nc raw interface-energy matrix from makenergymat ; it must
+  be a full double matrix. n is the vector of spikes per cluster, of type
+  uint32 or double. d0 is the scalar scaling term that E was computed
+  with. c is the S x N matrix of old spike components and ca is the uint8
+  vector of their cluster assignments. cn is the S x Nn matrix of new spike
+  components, the same type as c, and can is the uint8 vector of their
+  cluster assignments. Values of can greater than Nc add new clusters.
+  
+  Returns the updated energy matrix E and spike counts n.
+  
+  Compile with OpenMP to divide new spikes between threads. Work is cut
+  into fixed tiles of new spikes , and the energy of each tile is summed
+  in a fixed order. E is therefore bitwise identical for any number of
+  threads. The energy kernel is compiled for each instruction set level of
+  makisa.h , and the highest level that the CPU supports is used. Vector
+  widths differ between levels , so the last bits of E may too.
+  
+  Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+
+*/
+
+
+/*-- Include block --*/
+
+#include    <math.h>
+#include  <stdlib.h>
+#include  <string.h>
+#include     "mex.h"
+#include  "matrix.h"
+#include  "makisa.h"
+
+#ifdef  _OPENMP
+  #include  <omp.h>
+#endif
+
+
+/*-- Define block --*/
+
+#define   NARGIN  7
+#define  NARGOUT  2
+#define     EARG  0
+#define     NARG  1
+#define    D0ARG  2
+#define     CARG  3
+#define    CAARG  4
+#define    CNARG  5
+#define   CANARG  6
+#define    EOUT   0
+#define    NOUT   1
+
+/* Number of new spikes per tile of work */
+#define    TILE   256
+
+
+/*-- Spike lists --*/
+
+/* Old and new spikes grouped by cluster , and tiles of new spikes. Old
+   spikes of cluster i are listed from io[ oo[ i ] ] to
+   io[ oo[ i + 1 ] - 1 ] , and new spikes likewise in in and on. Tile g has
+   tn[ g ] new spikes of cluster tc[ g ] , listed from in[ ts[ g ] ]. */
+typedef struct
+{
+  
+  /* Number of clusters and tiles */
+  mwSize  Nc , G ;
+  
+  /* Offsets and spike lists of old and new spikes */
+  mwSize  * oo , * io , * on , * in ;
+  
+  /* Cluster , first spike in list , and number of spikes of each tile */
+  mwSize  * tc , * ts , * tn ;
+  
+} lists_t ;
+
+
+/*-- Energy kernel --*/
+
+/* Declares a function that adds the energy between each new spike and all
+   old spikes, and between each pair of new spikes. One version is made for
+   each floating point type of the spike components , and each instruction
+   set level of makisa.h with function attribute ATTR.
+   
+   The work is divided into tasks , one per tile of new spikes and cluster
+   of other spikes. Each task sums in a fixed order into its own element
+   of buffer e , and the buffer is then added to E in task order. The
+   shape of every sum is fixed by the data , so E is bitwise identical for
+   any number of threads. NAME_sum is the energy of all pairs between
+   spikes x listed in ix and spikes y listed in iy , with y from index
+   a + 1 if tri is non-zero , when x and y are the same spikes. */
+#define  ADDENERGY( NAME , TYPE , ATTR )                                   \
+static ATTR double  NAME ## _sum ( double d0 , mwSize S ,                  \
+  const TYPE * x , const mwSize * ix , mwSize nx ,                         \
+  const TYPE * y , const mwSize * iy , mwSize ny , int tri )               \
+{                                                                          \
+  mwSize  a , b , i ;                                                      \
+  double  d , e = 0 , v ;                                                  \
+  const TYPE * sa , * sb ;                                                 \
+                                                                           \
+  for  ( a = 0 ; a < nx ; a++ )                                            \
+  {                                                                        \
+    sa = x  +  ix[ a ] * S ;                                               \
+                                                                           \
+    for  ( b = tri ? a + 1 : 0 ; b < ny ; b++ )                            \
+    {                                                                      \
+      sb = y  +  iy[ b ] * S ;                                             \
+      d = 0 ;                                                              \
+      _Pragma( "omp simd reduction( + : d )" )                             \
+      for  ( i = 0 ; i < S ; i++ )                                         \
+      {                                                                    \
+        v = ( double ) sa[ i ]  -  ( double ) sb[ i ] ;                    \
+        d += v * v ;                                                       \
+      }                                                                    \
+      e += exp (  - sqrt( d )  /  d0  ) ;                                  \
+    }                                                                      \
+  }                                                                        \
+                                                                           \
+  return  e ;                                                              \
+}                                                                          \
+                                                                           \
+static ATTR void  NAME ( double * E , double * e , double d0 , mwSize S ,  \
+  const TYPE * c , const TYPE * cn , const lists_t * L )                   \
+{                                                                          \
+  mwSize  Nc = L->Nc ;                                                     \
+  mwSignedIndex  t ;                                                       \
+                                                                           \
+  /* Tasks , tile g of new spikes from cluster p with spikes of cluster   \
+     q */                                                                  \
+  _Pragma( "omp parallel for schedule( dynamic )" )                        \
+  for  ( t = 0 ; t < ( mwSignedIndex ) ( L->G * Nc ) ; t++ )               \
+  {                                                                        \
+    mwSize  g = t / Nc , q = t % Nc , p = L->tc[ g ] ;                     \
+    const mwSize  * ix = L->in  +  L->ts[ g ] ;                            \
+    const mwSize  * iq = L->in  +  L->on[ q ] ;                            \
+                                                                           \
+    /* Pair with every old spike of q */                                   \
+    e[ t ] = NAME ## _sum (  d0 ,  S ,  cn ,  ix ,  L->tn[ g ] ,  c ,       \
+      L->io + L->oo[ q ] ,  L->oo[ q + 1 ] - L->oo[ q ] ,  0  ) ;          \
+                                                                           \
+    /* Pair with later new spikes of the same cluster , so each pair is   \
+       counted once */                                                     \
+    if  ( p  ==  q )                                                       \
+      e[ t ] += NAME ## _sum (  d0 ,  S ,  cn ,  ix ,  L->tn[ g ] ,  cn ,  \
+        ix ,  L->on[ q + 1 ] - L->ts[ g ] ,  1  ) ;                        \
+                                                                           \
+    /* Pair with all new spikes of a later cluster */                      \
+    else if  ( p  <  q )                                                   \
+      e[ t ] += NAME ## _sum (  d0 ,  S ,  cn ,  ix ,  L->tn[ g ] ,  cn ,  \
+        iq ,  L->on[ q + 1 ] - L->on[ q ] ,  0  ) ;                        \
+  }                                                                        \
+                                                                           \
+  /* Add tasks in order , first summing new energy of each pair of        \
+     clusters */                                                           \
+  for  ( t = 0 ; t < ( mwSignedIndex ) ( L->G * Nc ) ; t++ )               \
+  {                                                                        \
+    mwSize  p = L->tc[ t / Nc ] , q = t % Nc ;                             \
+    e[ L->G * Nc  +  ( p < q  ?  p + q * Nc  :  q + p * Nc ) ] += e[ t ] ; \
+  }                                                                        \
+                                                                           \
+  for  ( t = 0 ; t < ( mwSignedIndex ) ( Nc * Nc ) ; t++ )                 \
+    E[ t ] += e[ L->G * Nc + t ] ;                                         \
+}
+
+MAKISA_CLONES( ADDENERGY , addenergy_d , double )
+MAKISA_CLONES( ADDENERGY , addenergy_s , float  )
+
+/* Versions of each kernel , indexed by instruction set level */
+static void  ( * const addenergy_d[ MAKISA_NUM ] ) ( double * , double * ,
+  double , mwSize , const double * , const double * , const lists_t * ) =
+  MAKISA_TABLE( addenergy_d ) ;
+
+static void  ( * const addenergy_s[ MAKISA_NUM ] ) ( double * , double * ,
+  double , mwSize , const float * , const float * , const lists_t * ) =
+  MAKISA_TABLE( addenergy_s ) ;
+
+
+/*-- Subroutines --*/
+
+/* Groups n spikes by their cluster labels l from 1 to Nc. Returns Nc + 1
+   offsets in o , and the spike indices of each cluster in x , in order. */
+static void  listspikes ( const unsigned char * l , mwSize n , mwSize Nc ,
+  mwSize * o , mwSize * x )
+{
+  mwSize  i ;
+  mwSize  * p = mxMalloc (  Nc * sizeof( mwSize )  ) ;
+  
+  /* Count spikes , then offsets */
+  memset (  o  ,  0  ,  ( Nc + 1 ) * sizeof( mwSize )  ) ;
+  for  ( i = 0 ; i < n  ; i++ )  o[ l[ i ] ]++ ;
+  for  ( i = 1 ; i <= Nc ; i++ )  o[ i ] += o[ i - 1 ] ;
+  
+  /* List spikes */
+  memcpy (  p  ,  o  ,  Nc * sizeof( mwSize )  ) ;
+  for  ( i = 0 ; i < n ; i++ )  x[ p[ l[ i ] - 1 ]++ ] = i ;
+  
+  mxFree (  p  ) ;
+}
+
+
+/*** MEX gateway function ***/
+
+void  mexFunction (  int nlhs  ,        mxArray * plhs[ ] ,
+                     int nrhs  ,  const mxArray * prhs[ ]  )
+{
+  
+  
+  /*-- Variables --*/
+  
+  /* Generic counters */
+  mwSize  i , j ;
+  
+  /* Number of old clusters , new clusters , components , old spikes , and
+     new spikes */
+  mwSize  Nc , Nco , S , N , Nn ;
+  
+  /* Scaling term */
+  double  d0 ;
+  
+  /* Cluster assignments */
+  const unsigned char  * ca , * can ;
+  
+  /* Energy matrices , and energy of each task */
+  const double  * Ei ;
+        double  * Eo , * e ;
+  
+  /* Spike lists and tiles */
+  lists_t  L ;
+  
+  
+  /*-- Input check --*/
+  
+  /* Must be exactly 7 input args */
+  if  ( nrhs  !=  NARGIN )
+    
+    mexErrMsgIdAndTxt (  "MAK:makenergyadd:nargsin"  ,
+      "makenergyadd: requires %d input arguments"  ,  NARGIN  ) ;
+  
+  /* Must be no more than 2 output args */
+  else if  ( NARGOUT  <  nlhs )
+    
+    mexErrMsgIdAndTxt (  "MAK:makenergyadd:nargsout"  ,
+      "makenergyadd: returns at most %d output arguments"  ,  NARGOUT  ) ;
+  
+  /* E must be a full, real, square double matrix */
+  else if  (  !mxIsDouble( prhs[ EARG ] )  ||  mxIsSparse( prhs[ EARG ] )
+              ||  mxIsComplex( prhs[ EARG ] )  ||
+              mxGetNumberOfDimensions( prhs[ EARG ] ) != 2  ||
+              mxGetM( prhs[ EARG ] ) != mxGetN( prhs[ EARG ] )  )
+    
+    mexErrMsgIdAndTxt (  "MAK:makenergyadd:E"  ,
+      "makenergyadd: E must be a full, real, square double matrix"  ) ;
+  
+  /* Number of existing clusters */
+  Nc = mxGetM (  prhs[ EARG ]  ) ;
+  
+  /* n must be uint32 or double , one per cluster */
+  if  (  ( !mxIsUint32( prhs[ NARG ] )  &&  !mxIsDouble( prhs[ NARG ] ) )
+         ||  mxGetNumberOfElements( prhs[ NARG ] ) != Nc  )
+    
+    mexErrMsgIdAndTxt (  "MAK:makenergyadd:n"  ,
+      "makenergyadd: n must be uint32 or double with %d elements"  ,
+      ( int ) Nc  ) ;
+  
+  /* d0 must be a positive scalar */
+  else if  (  !mxIsScalar( prhs[ D0ARG ] )  ||
+              !( mxIsDouble( prhs[ D0ARG ] ) || mxIsSingle( prhs[ D0ARG ] ) )
+              ||  !( 0  <  mxGetScalar( prhs[ D0ARG ] ) )  )
+    
+    mexErrMsgIdAndTxt (  "MAK:makenergyadd:d0"  ,
+      "makenergyadd: d0 must be a positive single or double scalar"  ) ;
+  
+  /* c and cn must be real , the same floating point type */
+  else if  (  !( mxIsDouble( prhs[ CARG ] ) || mxIsSingle( prhs[ CARG ] ) )
+              ||  mxGetClassID( prhs[ CARG ] ) !=
+                  mxGetClassID( prhs[ CNARG ] )  ||
+              mxIsComplex( prhs[ CARG ] )  ||  mxIsComplex( prhs[ CNARG ] ) )
+    
+    mexErrMsgIdAndTxt (  "MAK:makenergyadd:c"  ,
+      "makenergyadd: c and cn must both be real single or both double"  ) ;
+  
+  /* Same number of components */
+  else if  (  mxGetM( prhs[ CARG ] )  !=  mxGetM( prhs[ CNARG ] )  )
+    
+    mexErrMsgIdAndTxt (  "MAK:makenergyadd:S"  ,
+      "makenergyadd: c and cn must have the same number of rows"  ) ;
+  
+  /* Cluster assignments must be uint8 , one per spike */
+  else if  (  !mxIsUint8( prhs[ CAARG ] )  ||  !mxIsUint8( prhs[ CANARG ] )
+              ||  mxGetNumberOfElements( prhs[ CAARG ] ) !=
+                  mxGetN( prhs[ CARG ] )
+              ||  mxGetNumberOfElements( prhs[ CANARG ] ) !=
+                  mxGetN( prhs[ CNARG ] )  )
+    
+    mexErrMsgIdAndTxt (  "MAK:makenergyadd:ca"  ,
+      "makenergyadd: ca and can must be uint8 with one value per spike" ) ;
+  
+  
+  /*-- Preparation --*/
+  
+  /* Scaling term , sizes , and cluster assignments */
+  d0 = mxGetScalar (  prhs[ D0ARG ]  ) ;
+   S = mxGetM (  prhs[ CARG ]  ) ;
+   N = mxGetN (  prhs[  CARG ]  ) ;
+  Nn = mxGetN (  prhs[ CNARG ]  ) ;
+   ca = ( const unsigned char * ) mxGetData (  prhs[  CAARG ]  ) ;
+  can = ( const unsigned char * ) mxGetData (  prhs[ CANARG ]  ) ;
+  
+  /* Old spikes must belong to existing clusters */
+  for  ( i = 0 ; i < N ; i++ )
+    if  ( ca[ i ] == 0  ||  Nc < ca[ i ] )
+      mexErrMsgIdAndTxt (  "MAK:makenergyadd:caval"  ,
+        "makenergyadd: ca values must be from 1 to %d"  ,  ( int ) Nc  ) ;
+  
+  /* New spikes can add clusters */
+  for  ( Nco = Nc , i = 0 ; i < Nn ; i++ )
+  {
+    if  ( can[ i ] == 0 )
+      mexErrMsgIdAndTxt (  "MAK:makenergyadd:canval"  ,
+        "makenergyadd: can values must be 1 or more"  ) ;
+    if  ( Nco < can[ i ] )  Nco = can[ i ] ;
+  }
+  
+  /* Copy E into the top-left of the new energy matrix */
+  plhs[ EOUT ] = mxCreateDoubleMatrix (  Nco  ,  Nco  ,  mxREAL  ) ;
+  Eo = mxGetPr (  plhs[ EOUT ]  ) ;
+  Ei = mxGetPr (  prhs[ EARG ]  ) ;
+  
+  for  ( j = 0 ; j < Nc ; j++ )
+    memcpy (  Eo + j * Nco  ,  Ei + j * Nc  ,  Nc * sizeof( double )  ) ;
+  
+  
+  /* Group old and new spikes by cluster */
+  L.Nc = Nco ;
+  L.oo = mxMalloc (  ( Nco + 1 ) * sizeof( mwSize )  ) ;
+  L.on = mxMalloc (  ( Nco + 1 ) * sizeof( mwSize )  ) ;
+  L.io = mxMalloc (  ( N  + 1 ) * sizeof( mwSize )  ) ;
+  L.in = mxMalloc (  ( Nn + 1 ) * sizeof( mwSize )  ) ;
+  listspikes (  ca   ,  N   ,  Nco  ,  L.oo  ,  L.io  ) ;
+  listspikes (  can  ,  Nn  ,  Nco  ,  L.on  ,  L.in  ) ;
+  
+  /* Tiles of each cluster's new spikes */
+  for  ( L.G = 0 , i = 0 ; i < Nco ; i++ )
+    L.G += ( L.on[ i + 1 ] - L.on[ i ]  +  TILE - 1 )  /  TILE ;
+  
+  L.tc = mxMalloc (  ( L.G + 1 ) * sizeof( mwSize )  ) ;
+  L.ts = mxMalloc (  ( L.G + 1 ) * sizeof( mwSize )  ) ;
+  L.tn = mxMalloc (  ( L.G + 1 ) * sizeof( mwSize )  ) ;
+  
+  for  ( L.G = 0 , i = 0 ; i < Nco ; i++ )
+    for  ( j = L.on[ i ] ; j < L.on[ i + 1 ] ; j += TILE , L.G++ )
+    {
+      L.tc[ L.G ] = i ;
+      L.ts[ L.G ] = j ;
+      L.tn[ L.G ] = L.on[ i + 1 ] - j  <  TILE  ?  L.on[ i + 1 ] - j  :  TILE;
+    }
+  
+  /* Energy of each task , and total of each pair of clusters */
+  e = mxCalloc (  L.G * Nco  +  Nco * Nco  ,  sizeof( double )  ) ;
+  
+  
+  /*-- Add energy --*/
+  
+  if  ( mxIsDouble(  prhs[ CARG ]  ) )
+    
+    addenergy_d[ makisa( ) ] (  Eo ,  e ,  d0 ,  S ,
+      ( const double * ) mxGetData( prhs[ CARG ] ) ,
+      ( const double * ) mxGetData( prhs[ CNARG ] ) ,  &L  ) ;
+  
+  else
+    
+    addenergy_s[ makisa( ) ] (  Eo ,  e ,  d0 ,  S ,
+      ( const float * ) mxGetData( prhs[ CARG ] ) ,
+      ( const float * ) mxGetData( prhs[ CNARG ] ) ,  &L  ) ;
+  
+  mxFree (  e  ) ;
+  mxFree (  L.oo  ) ;  mxFree (  L.on  ) ;
+  mxFree (  L.io  ) ;  mxFree (  L.in  ) ;
+  mxFree (  L.tc  ) ;  mxFree (  L.ts  ) ;  mxFree (  L.tn  ) ;
+  
+  
+  /*-- Spike counts --*/
+  
+  /* n not requested , end now */
+  if  ( nlhs  <=  1 )
+    return ;
+  
+  /* Return n as a row vector of the same type */
+  plhs[ NOUT ] = mxCreateNumericMatrix (  1  ,  Nco  ,
+    mxGetClassID( prhs[ NARG ] )  ,  mxREAL  ) ;
+  
+  if  ( mxIsDouble(  prhs[ NARG ]  ) )
+  {
+    double  * no = mxGetPr (  plhs[ NOUT ]  ) ;
+    memcpy (  no  ,  mxGetPr( prhs[ NARG ] )  ,  Nc * sizeof( double )  ) ;
+    for  ( i = 0 ; i < Nn ; i++ )  no[ can[ i ] - 1 ] += 1 ;
+  }
+  else
+  {
+    unsigned int  * no = ( unsigned int * ) mxGetData (  plhs[ NOUT ]  ) ;
+    memcpy (  no  ,  mxGetData( prhs[ NARG ] )  ,
+      Nc * sizeof( unsigned int )  ) ;
+    for  ( i = 0 ; i < Nn ; i++ )  no[ can[ i ] - 1 ] += 1 ;
+  }
+
+
+} /* mexFunction */
+
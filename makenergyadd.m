@@ -0,0 +1,42 @@
+
+% [ E , n ] = makenergyadd ( E , n , d0 , c , ca , cn , can )
+% 
+% MET Analysis Kit, pre-processing. Adds a batch of new spikes to an
+% existing raw interface-energy matrix, without computing again the
+% energies between spikes that were already there. Interface energy is a
+% sum over pairs of spikes. So the new spikes only add the energy of each
+% new spike paired with every old spike, and of each pair of new spikes.
+% This takes O( Nn x ( N + Nn ) ) time for N old and Nn new spikes, rather
+% than the O( ( N + Nn ) ^ 2 ) time of a new call to makenergymat. Hence,
+% energies can be kept up to date as a recording grows, ready for
+% makcmerge.
+% 
+% E is the Nc x Nc raw interface-energy matrix from makenergymat, for Nc
+% clusters ; it must be a full double matrix. n is the vector of spikes
+% per cluster, of type uint32 or double. d0 is the scalar scaling term that
+% E was computed with. c is the S x N matrix of old spike components, with
+% one spike per column, and ca is the uint8 vector of their cluster
+% assignments. cn is the S x Nn matrix of new spike components, the same
+% type as c, either single or double. can is the uint8 vector of cluster
+% assignments for the new spikes. A new spike may belong to a cluster
+% that is greater than Nc, which then becomes a new cluster.
+% 
+% Returns the updated energy matrix E and spike counts n. Both grow in
+% size if any value of can is greater than Nc. The result matches that of
+% makenergymat on all spikes together, up to floating point round-off.
+% 
+% Distances are computed in double precision. If MEX is compiled with
+% OpenMP then new spikes are divided between threads, e.g.
+% 
+%   mex CFLAGS='$CFLAGS -fopenmp' LDFLAGS='$LDFLAGS -fopenmp' makenergyadd.c
+% 
+% Otherwise, it runs on a single thread. The energy kernel is compiled for
+% several instruction sets, and the best one for the CPU is chosen at run
+% time ; see makisa.
+% 
+% References:
+% 
+% Fee MS, Mitra PP, Kleinfeld D. J Neurosci Methods. 1996 Nov;69(2):175-88.
+% Hill DN, Mehta SB, Kleinfeld D. J Neurosci. 2011 Jun 15;31(24):8699-705.
+% 
+% Written by Jackson Smith - October 2026 - ESI (Fries Lab)
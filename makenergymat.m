@@ -1,7 +1,9 @@
 
-function  E = makenergymat (  n  ,  ca  ,  c  ,  d0  )
+function  [ E , emiss ] = makenergymat (  n  ,  ca  ,  c  ,  d0  ,  tol  )
 % 
 % E = makenergymat (  n  ,  ca  ,  c  ,  d0  )
+% [ E , emiss ] = makenergymat (  n  ,  ca  ,  c  ,  d0  ,  tol  )
+% E = makenergymat (  E  ,  a  )
 %
 % MET Analysis Kit, pre-processing. After initial clustering, the next
 % step in spike sorting (Fee et al. 1996) is to compute the interface-
@@ -25,6 +27,10 @@ function  E = makenergymat (  n  ,  ca  ,  c  ,  d0  )
 %   
 %   d0 - Scalar value , the scaling term returned by makspkclust.
 % 
+%   tol - Optional scalar energy tolerance , default 0. Pairs of different
+%     clusters are skipped if their interface energy cannot reach tol. See
+%     Pruning, below.
+% 
 % 
 % Output
 % 
@@ -33,6 +39,51 @@ function  E = makenergymat (  n  ,  ca  ,  c  ,  d0  )
 %     and along the diagonal. Thus E( i , j ), where i <= j, is the raw
 %     interface energy between spike clusters i and j.
 % 
+%   emiss - Upper bound on the total interface energy that was not computed
+%     because of pruning. Zero if no pair was skipped.
+% 
+% 
+% Pruning
+% 
+% Many cluster pairs are far apart, and their interface energy is
+% vanishingly small. Each cluster is bounded by a sphere centred on the
+% mean of its spikes, with a radius equal to the distance of its furthest
+% spike. No pair of spikes from clusters i and j can be closer than
+% dmin = max( 0 , | cen_i - cen_j | - r_i - r_j ). Hence, their interface
+% energy cannot exceed n( i ) * n( j ) * exp( - dmin / d0 ). If this bound
+% is less than tol then the pairwise distances are not computed, and
+% E( i , j ) is zero. The bounds of all skipped pairs are summed in emiss.
+% 
+% Distances between two clusters are computed for a tile of spikes at a
+% time, with the number of spikes per tile taken from this computer's
+% maktune profile. By default there is one tile per cluster. The energy of
+% each spike is summed first, and then the energies of all spikes. Each
+% sum adds pairs of halves, in an order set by the number of spikes alone.
+% So E is bitwise identical for any tile size, any number of workers, and
+% any number of computational threads, because the energy of each pair of
+% clusters is summed by one worker.
+% 
+% 
+% Coarser clusters
+% 
+% The second form of makenergymat returns the raw interface-energy matrix
+% of a coarser set of clusters, each of which joins one or more of the
+% clusters in E. a is a vector with one element per cluster in E, and the
+% ith cluster of E is joined into coarse cluster a( i ). The energies of
+% all joined pairs are summed, in the same way as makcmerge does after a
+% merger. This is used with the nested levels of bisection returned by
+% makspkclust, as in makenergymat (  E  ,  L( b ).a  ). Only one energy
+% matrix need be computed for the final clusters.
+% 
+% This is intended: coarse energies keep the scaling term d0 that E was
+% computed with, rather than L( b ).d0. Each pair of spikes adds
+% exp( - d / d0 ) to the energy, so a sum over spike pairs cannot be
+% rescaled to another d0 after the fact. Levels then differ only in how
+% final clusters are grouped, and so their connection strengths can be
+% compared. For the energies of level b with its own scaling term, call
+% makenergymat (  L( b ).n  ,  L( b ).c  ,  c  ,  L( b ).d0  ), which costs
+% as much as the final energy matrix.
+% 
 % 
 % References:
 % 
@@ -47,14 +98,24 @@ function  E = makenergymat (  n  ,  ca  ,  c  ,  d0  )
   
   %%% Preparation %%%
   
+  % Coarser clusters requested. Then n is the energy matrix and ca maps
+  % each of its clusters to a coarser one.
+  if  nargin  ==  2  ,  E = blocksum (  n  ,  ca  ) ;  return  ,  end
+  
   % The number of clusters
   cnum = numel (  n  ) ;
   
+  % No pruning by default
+  if  nargin  <  5  ,  tol = 0 ;  end
+  
   % Group spikes by cluster number , for distribution of data in parfor
   % loop
   C = arrayfun (  @( i ) c(  :  ,  ca  ==  i  )'  ,  ...
     1 : cnum  ,  'UniformOutput'  ,  false  ) ;
   
+  % Upper bound on the interface energy of each pair of clusters
+  emax = bound (  n  ,  C  ,  d0  ) ;
+  
   % Make vectors of cluster data in the order that they're needed to
   % compute energies
   npairs = ( cnum ^ 2 - cnum ) / 2  +  cnum ;
@@ -62,30 +123,65 @@ function  E = makenergymat (  n  ,  ca  ,  c  ,  d0  )
   C2 = cell (  npairs  ,  1  ) ;
   k = 0 ;
   
+  % Pairs that are computed , and sum of bounds for those that are skipped
+  keep = true (  npairs  ,  1  ) ;
+  emiss = 0 ;
+  
   % In this order, we fill in each row of the upper-triangular portion of
   % the energy matrix
   for  i = 1 : cnum
     for  j = i : cnum
       k = k + 1 ;
+      
+      % Different clusters that are too far apart to matter
+      if  i  ~=  j  &&  emax( i , j )  <  tol
+        keep( k ) = false ;
+        emiss = emiss  +  emax( i , j ) ;
+        continue
+      end
+      
       C1{ k } = C{ i } ;
       C2{ k } = C{ j } ;
     end
   end
   
+  % Discard skipped pairs
+  C1 = C1( keep ) ;
+  C2 = C2( keep ) ;
+  
   
   %%% Raw interface Energy %%%
   
-  parfor  k = 1 : npairs
+  % Spikes of cluster i per tile of distances , tuned for this computer
+  tune = maktune ;
+  tile = tune.energytile ;
+  
+  parfor  k = 1 : numel (  C1  )
     
-    % Pairwise distances between all spikes in cluster i with those in
-    % cluster j
-    d = pdist2 (  C1{ k }  ,  C2{ k }  ) ;
+    % Energy of each spike in cluster i
+    e = zeros (  size( C1{ k } , 1 )  ,  1  ) ;
     
-    % Compute interface energy
-    e( k ) = sum ( exp(  - double( d( : ) )  /  d0  ) ) ;
+    for  r = 1 : tile : size (  C1{ k }  ,  1  )
+      
+      % Pairwise distances between a tile of spikes in cluster i with all
+      % spikes in cluster j
+      i = r : min (  r + tile - 1  ,  numel( e )  ) ;
+      d = pdist2 (  C1{ k }( i , : )  ,  C2{ k }  ) ;
+      
+      % Compute interface energy
+      e( i ) = pairsum (  exp( - double( d ) / d0 )  ) ;
+      
+    end % tiles
+    
+    % Sum in the same order for any tile size
+    ek( k ) = pairsum (  e'  ) ;
     
   end
   
+  % Skipped pairs have zero energy
+  e = zeros (  npairs  ,  1  ) ;
+  e( keep ) = ek ;
+  
   % Reshape from a vector into a square matrix , first allocate a matrix
   E = zeros (  cnum  ) ;
   
@@ -112,3 +208,91 @@ function  E = makenergymat (  n  ,  ca  ,  c  ,  d0  )
   
 end % makenergymat
 
+
+%%% Sub-routines %%%
+
+% Sums x over columns by adding the odd columns to the even ones until one
+% is left. The order of additions depends only on the size of x , unlike
+% that of sum , which can change with the number of computational threads.
+function  x = pairsum (  x  )
+  
+  % No columns sum to zero
+  if  isempty (  x  )  ,  x = zeros (  size( x , 1 )  ,  1  ) ;  return  ,  end
+  
+  while  1  <  size (  x  ,  2  )
+    
+    % Odd number of columns , pad with zeros
+    if  mod (  size( x , 2 )  ,  2  )  ,  x( : , end + 1 ) = 0 ;  end
+    
+    x = x( : , 1 : 2 : end )  +  x( : , 2 : 2 : end ) ;
+    
+  end
+  
+end % pairsum
+
+
+% Upper bound on the interface energy between each pair of clusters , found
+% from the bounding sphere of each cluster. C{ i } has the spikes of
+% cluster i across rows.
+function  emax = bound (  n  ,  C  ,  d0  )
+  
+  % Number of clusters
+  cnum = numel (  C  ) ;
+  
+  % Centre and radius of each cluster's bounding sphere
+  cen = zeros (  cnum  ,  size( C{ 1 } , 2 )  ) ;
+  rad = zeros (  cnum  ,  1  ) ;
+  
+  for  i = 1 : cnum
+    
+    % Empty cluster has no energy with anything
+    if  isempty (  C{ i }  )  ,  continue  ,  end
+    
+    cen( i , : ) = mean (  double( C{ i } )  ,  1  ) ;
+    rad( i ) = max ( pdist2(  double( C{ i } )  ,  cen( i , : )  ) ) ;
+    
+  end % clusters
+  
+  % Lower bound on the distance between any two spikes of each pair
+  dmin = max (  pdist2( cen , cen )  -  bsxfun( @plus , rad , rad' )  ,  0 );
+  
+  % Number of spike pairs times the largest possible energy of each
+  n = double (  n( : )  ) ;
+  emax = ( n  *  n' )  .*  exp (  - dmin  /  d0  ) ;
+  
+end % bound
+
+
+% Sums blocks of raw interface-energy matrix E to find the energy matrix of
+% coarser clusters. Fine cluster i belongs to coarse cluster a( i ).
+function  E = blocksum (  E  ,  a  )
+  
+  % Full matrix of doubles
+  E = full (  double( E )  ) ;
+  
+  % Number of fine and coarse clusters
+  fnum = numel (  a  ) ;
+  cnum = double (  max( a )  ) ;
+  
+  % Membership matrix , fine clusters over rows and coarse over columns
+  A = full ( sparse(  1 : fnum  ,  double( a( : ) )  ,  1  ,  fnum  ,  ...
+    cnum  ) ) ;
+  
+  % Inter-cluster energies in both triangles , without the diagonal
+  F = triu (  E  ,  1  ) ;
+  F = F  +  F' ;
+  
+  % Sum energies between all fine cluster pairs for each coarse pair. Pairs
+  % inside the same coarse cluster are counted twice on the diagonal.
+  G = A'  *  F  *  A ;
+  
+  % New intra-cluster energy is the sum of the intra-cluster energies plus
+  % the inter-cluster energies of all joined clusters , just like makcmerge
+  d = A'  *  diag (  E  )  +  diag (  G  )  /  2 ;
+  
+  % Return upper-triangular matrix with intra-cluster energy on diagonal
+  E = triu (  G  ,  1  ) ;
+  E( 1 : cnum + 1 : end ) = d ;
+  
+end % blocksum
+
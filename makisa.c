@@ -0,0 +1,66 @@
+
+/*  makisa
+  
+  [ isa , cpu ] = makisa
+  
+  MET Analysis Kit. Reports the instruction set level that MEX kernels
+  built with makisa.h will run. isa is the name of the level that is used,
+  and cpu is the name of the highest level that the CPU supports. Levels
+  are 'base' , 'sse4.2' , 'avx2' , and 'avx512'. isa is lower than cpu when
+  environment variable MAK_ISA names a lower level.
+  
+  Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+
+*/
+
+
+/*-- Include block --*/
+
+#include     "mex.h"
+#include  "matrix.h"
+#include  "makisa.h"
+
+
+/*-- Define block --*/
+
+#define   NARGIN  0
+#define  NARGOUT  2
+#define   ISAOUT  0
+#define   CPUOUT  1
+
+
+/*** MEX gateway function ***/
+
+void  mexFunction (  int nlhs  ,        mxArray * plhs[ ] ,
+                     int nrhs  ,  const mxArray * prhs[ ]  )
+{
+  
+  
+  /*-- Input check --*/
+  
+  /* prhs is never read */
+  ( void ) prhs ;
+  
+  /* No input args */
+  if  ( nrhs  !=  NARGIN )
+    
+    mexErrMsgIdAndTxt (  "MAK:makisa:nargsin"  ,
+      "makisa: takes no input arguments"  ) ;
+  
+  /* Must be no more than 2 output args */
+  else if  ( NARGOUT  <  nlhs )
+    
+    mexErrMsgIdAndTxt (  "MAK:makisa:nargsout"  ,
+      "makisa: returns at most %d output arguments"  ,  NARGOUT  ) ;
+  
+  
+  /*-- Report --*/
+  
+  plhs[ ISAOUT ] = mxCreateString (  makisa_name[ makisa( ) ]  ) ;
+  
+  if  ( 1  <  nlhs )
+    plhs[ CPUOUT ] = mxCreateString (  makisa_name[ makisa_cpu( ) ]  ) ;
+
+
+} /* mexFunction */
+
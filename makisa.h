@@ -0,0 +1,130 @@
+
+/*  makisa.h
+  
+  MET Analysis Kit. Run-time instruction set dispatch for MEX functions.
+  A kernel is compiled several times , once for each instruction set
+  level. Then makisa ( ) chooses which version to run from the CPU that it
+  finds. The same MEX binary can therefore use AVX-512 on new CPUs and
+  still run on old ones.
+  
+  Levels are base , sse4.2 , avx2 , and avx512. The base version uses the
+  compiler's default instruction set. Environment variable MAK_ISA can
+  name a lower level than the CPU supports , for testing e.g.
+    
+    setenv ( 'MAK_ISA' , 'sse4.2' )
+  
+  but a level that the CPU does not support is ignored. The variable is
+  read on every call to makisa ( ) , so there is no need to clear MEX
+  functions after changing it. Other compilers and CPUs only use the base
+  level.
+  
+  A kernel is declared by a macro that takes the function name , any other
+  macro arguments , and a function attribute as the last argument. For
+  instance
+    
+    #define  KERNEL( NAME , TYPE , ATTR )  \
+      static ATTR void  NAME ( TYPE * x ) { ... }
+    
+    MAKISA_CLONES( KERNEL , kernel_d , double )
+    
+    static void  ( * const kernel_d[ ] ) ( double * ) =
+      MAKISA_TABLE( kernel_d ) ;
+    
+    kernel_d[ makisa( ) ] (  x  ) ;
+  
+  See makisa.m for the MEX function that reports the chosen level.
+  
+  Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+
+*/
+
+#ifndef  MAKISA_H
+#define  MAKISA_H
+
+
+/*-- Include block --*/
+
+#include  <stdlib.h>
+#include  <string.h>
+
+
+/*-- Define block --*/
+
+/* Instruction set levels , and their number */
+#define  MAKISA_BASE    0
+#define  MAKISA_SSE42   1
+#define  MAKISA_AVX2    2
+#define  MAKISA_AVX512  3
+#define  MAKISA_NUM     4
+
+/* Environment variable that caps the level */
+#define  MAKISA_ENV  "MAK_ISA"
+
+/* Function attributes of each level. Only GCC and Clang on x86 can
+   compile for other targets within one translation unit. */
+#if  defined( __GNUC__ )  &&  ( defined( __x86_64__ ) || defined( __i386__ ) )
+  #define  MAKISA_X86
+  #define  MAKISA_ATTR_SSE42   __attribute__(( target( "sse4.2" ) ))
+  #define  MAKISA_ATTR_AVX2    __attribute__(( target( "avx2,fma" ) ))
+  #define  MAKISA_ATTR_AVX512  \
+    __attribute__(( target( "avx512f,avx512dq,avx512vl,avx2,fma" ) ))
+#else
+  #define  MAKISA_ATTR_SSE42
+  #define  MAKISA_ATTR_AVX2
+  #define  MAKISA_ATTR_AVX512
+#endif
+
+/* Declare one version of a kernel per level , using macro M */
+#define  MAKISA_CLONES( M , NAME , ... )                     \
+  M( NAME ## _base   , __VA_ARGS__ ,                    )    \
+  M( NAME ## _sse42  , __VA_ARGS__ , MAKISA_ATTR_SSE42  )    \
+  M( NAME ## _avx2   , __VA_ARGS__ , MAKISA_ATTR_AVX2   )    \
+  M( NAME ## _avx512 , __VA_ARGS__ , MAKISA_ATTR_AVX512 )
+
+/* Initialiser of a function pointer array , indexed by level */
+#define  MAKISA_TABLE( NAME )  \
+  { NAME ## _base , NAME ## _sse42 , NAME ## _avx2 , NAME ## _avx512 }
+
+
+/*-- Subroutines --*/
+
+/* Name of each level , as used by MAK_ISA */
+static const char  * const makisa_name[ MAKISA_NUM ] =
+  {  "base"  ,  "sse4.2"  ,  "avx2"  ,  "avx512"  } ;
+
+/* Highest level that the CPU supports */
+static int  makisa_cpu ( void )
+{
+#ifdef  MAKISA_X86
+  __builtin_cpu_init ( ) ;
+  
+  if  ( __builtin_cpu_supports( "avx512f" )   &&
+        __builtin_cpu_supports( "avx512dq" )  &&
+        __builtin_cpu_supports( "avx512vl" ) )  return  MAKISA_AVX512 ;
+  
+  if  ( __builtin_cpu_supports( "avx2" )  &&
+        __builtin_cpu_supports( "fma" ) )  return  MAKISA_AVX2 ;
+  
+  if  ( __builtin_cpu_supports( "sse4.2" ) )  return  MAKISA_SSE42 ;
+#endif
+  
+  return  MAKISA_BASE ;
+}
+
+/* Level to run. This is the highest level that the CPU supports , unless
+   MAK_ISA names a lower one. */
+static int  makisa ( void )
+{
+  int  i , l = makisa_cpu ( ) ;
+  const char  * e = getenv (  MAKISA_ENV  ) ;
+  
+  if  ( e )
+    for  ( i = 0 ; i < l ; i++ )
+      if  ( !strcmp(  e  ,  makisa_name[ i ]  ) )  return  i ;
+  
+  return  l ;
+}
+
+
+#endif  /* MAKISA_H */
+
@@ -0,0 +1,29 @@
+
+% [ isa , cpu ] = makisa
+% 
+% MET Analysis Kit. Reports which instruction set level is used by MEX
+% functions that are compiled with several versions of their kernels, such
+% as makenergyadd. isa is the name of the level that is run, and cpu is the
+% name of the highest level that this computer's CPU supports. Levels are
+% 'base', 'sse4.2', 'avx2', and 'avx512'. The base level uses whatever
+% instruction set the compiler targets by default.
+% 
+% The level is chosen each time that a MEX function runs. Hence a MEX file
+% that is compiled on one computer will use AVX-512 on CPUs that have it,
+% and still run on older CPUs. For testing, environment variable MAK_ISA
+% can name a lower level than the CPU supports, e.g.
+% 
+%   setenv (  'MAK_ISA'  ,  'avx2'  )
+% 
+% A level that the CPU does not support is ignored. Use setenv( 'MAK_ISA'
+% , '' ) to return to the default. Only GCC and Clang on x86 CPUs build
+% multiple versions. Otherwise, isa and cpu are both 'base'.
+% 
+% Compile with e.g.
+% 
+%   mex makisa.c
+% 
+% The shared dispatch code is in makisa.h, which must be in the same
+% directory as any MEX source file that includes it.
+% 
+% Written by Jackson Smith - October 2026 - ESI (Fries Lab)
@@ -0,0 +1,539 @@
+
+/*  maklda
+  
+  [ a , p ] = maklda ( X , c , f , lambda )
+  
+  MET Analysis Kit. Cross-validated linear discriminant analysis ( LDA )
+  decoding of population responses in every time bin. Class sufficient
+  statistics and the Cholesky factor of the pooled within-class scatter
+  matrix are computed once per time bin from all trials. The factor for
+  each fold is then found by removing the held-out trials one at a time
+  with rank-1 Cholesky downdates , instead of refitting the covariance
+  matrix and its inverse for every fold.
+  
+  X is a T x N x B single or double matrix of responses from T trials , N
+  units , and B time bins. c is a T-element vector of class labels and f
+  is a T-element vector of fold labels ; both are uint8 , uint16 , uint32 ,
+  or double with integer values of 1 or more. Trials with fold label i are
+  held out and decoded by an LDA trained on all other trials. lambda is
+  optional , default 0 ; it is added to the diagonal of the within-class
+  scatter matrix , and must be positive if N is close to or more than the
+  number of training trials.
+  
+  a is a 1 x B double vector with the fraction of trials that were decoded
+  correctly in each time bin. p is a T x B double matrix of decoded class
+  labels. p is NaN for all trials of a fold whose scatter matrix is not
+  positive definite.
+  
+  Compile with OpenMP to divide time bins and folds between threads.
+  
+  Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+
+*/
+
+
+/*-- Include block --*/
+
+#include    <math.h>
+#include  <stdlib.h>
+#include  <string.h>
+#include     "mex.h"
+#include  "matrix.h"
+
+#ifdef  _OPENMP
+  #include  <omp.h>
+#endif
+
+
+/*-- Define block --*/
+
+#define  NARGINMIN  3
+#define  NARGINMAX  4
+#define    NARGOUT  2
+#define       XARG  0
+#define       CARG  1
+#define       FARG  2
+#define     LAMARG  3
+#define       AOUT  0
+#define       POUT  1
+
+
+/*-- Subroutines --*/
+
+/* Convert label vector u to 0-based labels in l. U returns the largest
+   label. Returns non-zero if any label is not an integer of 1 or more. */
+static int  getlabels ( const mxArray * u , mwSize * l , mwSize * U )
+{
+  mwSize  i , N = mxGetNumberOfElements (  u  ) ;
+  double  v ;
+  
+  for  ( *U = 0 , i = 0 ; i < N ; i++ )
+  {
+    switch  ( mxGetClassID(  u  ) )
+    {
+      case  mxUINT8_CLASS:
+        v = ( ( const unsigned char * ) mxGetData( u ) )[ i ] ;  break ;
+      case  mxUINT16_CLASS:
+        v = ( ( const unsigned short * ) mxGetData( u ) )[ i ] ;  break ;
+      case  mxUINT32_CLASS:
+        v = ( ( const unsigned int * ) mxGetData( u ) )[ i ] ;  break ;
+      default:
+        v = mxGetPr (  u  )[ i ] ;
+    }
+    
+    if  ( !( 1 <= v )  ||  v != ( double ) ( mwSize ) v )  return  1 ;
+    
+    l[ i ] = ( mwSize ) v  -  1 ;
+    if  ( *U  <  ( mwSize ) v )  *U = ( mwSize ) v ;
+  }
+  
+  return  0 ;
+}
+
+/* True if u is a valid label vector with n elements */
+static int  islabels ( const mxArray * u , mwSize n )
+{
+  return  ( mxIsDouble( u ) || mxIsUint8( u ) || mxIsUint16( u ) ||
+            mxIsUint32( u ) )  &&  !mxIsComplex( u )  &&
+          mxGetNumberOfElements( u ) == n ;
+}
+
+/* Response of trial t to all N units in time bin b of T x N x B matrix X ,
+   as a double vector */
+static void  getresp ( const mxArray * X , mwSize T , mwSize N , mwSize t ,
+  mwSize b , double * x )
+{
+  mwSize  j , i = t  +  b * T * N ;
+  
+  if  ( mxIsDouble(  X  ) )
+    for  ( j = 0 ; j < N ; j++ )
+      x[ j ] = mxGetPr (  X  )[ i + j * T ] ;
+  else
+    for  ( j = 0 ; j < N ; j++ )
+      x[ j ] = ( ( const float * ) mxGetData( X ) )[ i + j * T ] ;
+}
+
+/* Cholesky factorisation of the N x N matrix A , column-major , in place.
+   Only the lower triangle is used and returned. Non-zero if A is not
+   positive definite. */
+static int  cholesky ( double * A , mwSize N )
+{
+  mwSize  i , j , k ;
+  double  s ;
+  
+  for  ( j = 0 ; j < N ; j++ )
+  {
+    for  ( s = A[ j + j * N ] , k = 0 ; k < j ; k++ )
+      s -= A[ j + k * N ]  *  A[ j + k * N ] ;
+    
+    if  ( !( 0 < s ) )  return  1 ;
+    A[ j + j * N ] = s = sqrt (  s  ) ;
+    
+    for  ( i = j + 1 ; i < N ; i++ )
+    {
+      double  r = A[ i + j * N ] ;
+      for  ( k = 0 ; k < j ; k++ )  r -= A[ i + k * N ]  *  A[ j + k * N ] ;
+      A[ i + j * N ] = r  /  s ;
+    }
+  }
+  
+  return  0 ;
+}
+
+/* Rank-1 downdate of lower Cholesky factor L , so that L * L' becomes
+   L * L' - v * v'. v is overwritten. Non-zero if the result is not
+   positive definite. */
+static int  downdate ( double * L , double * v , mwSize N )
+{
+  mwSize  i , k ;
+  double  r , c , s , * l ;
+  
+  for  ( k = 0 ; k < N ; k++ )
+  {
+    l = L  +  k * N ;
+    r = ( l[ k ] - v[ k ] )  *  ( l[ k ] + v[ k ] ) ;
+    if  ( !( 0 < r ) )  return  1 ;
+    
+    r = sqrt (  r  ) ;
+    c = r  /  l[ k ] ;
+    s = v[ k ]  /  l[ k ] ;
+    l[ k ] = r ;
+    
+    for  ( i = k + 1 ; i < N ; i++ )
+    {
+      l[ i ] = ( l[ i ]  -  s * v[ i ] )  /  c ;
+      v[ i ] = c * v[ i ]  -  s * l[ i ] ;
+    }
+  }
+  
+  return  0 ;
+}
+
+/* Solve L * L' * w = y for w , given lower Cholesky factor L */
+static void  cholsolve ( const double * L , const double * y , double * w ,
+  mwSize N )
+{
+  mwSize  i , k ;
+  
+  for  ( i = 0 ; i < N ; i++ )
+  {
+    double  s = y[ i ] ;
+    for  ( k = 0 ; k < i ; k++ )  s -= L[ i + k * N ]  *  w[ k ] ;
+    w[ i ] = s  /  L[ i + i * N ] ;
+  }
+  
+  for  ( i = N ; i-- ; )
+  {
+    double  s = w[ i ] ;
+    for  ( k = i + 1 ; k < N ; k++ )  s -= L[ k + i * N ]  *  w[ k ] ;
+    w[ i ] = s  /  L[ i + i * N ] ;
+  }
+}
+
+/* Within-class scatter matrix of the given trials , plus lambda on the
+   diagonal , into lower triangle of W. m has the class means. */
+static void  scatter ( const mxArray * X , mwSize T , mwSize N , mwSize b ,
+  const mwSize * t , mwSize n , const mwSize * c , const double * m ,
+  double lambda , double * x , double * W )
+{
+  mwSize  i , j , k ;
+  
+  memset (  W  ,  0  ,  N * N * sizeof( double )  ) ;
+  
+  for  ( k = 0 ; k < n ; k++ )
+  {
+    getresp (  X  ,  T  ,  N  ,  t[ k ]  ,  b  ,  x  ) ;
+    for  ( i = 0 ; i < N ; i++ )  x[ i ] -= m[ c[ t[ k ] ] * N + i ] ;
+    
+    for  ( j = 0 ; j < N ; j++ )
+      for  ( i = j ; i < N ; i++ )
+        W[ i + j * N ] += x[ i ]  *  x[ j ] ;
+  }
+  
+  for  ( i = 0 ; i < N ; i++ )  W[ i + i * N ] += lambda ;
+}
+
+
+/*** MEX gateway function ***/
+
+void  mexFunction (  int nlhs  ,        mxArray * plhs[ ] ,
+                     int nrhs  ,  const mxArray * prhs[ ]  )
+{
+  
+  
+  /*-- Variables --*/
+  
+  /* Generic counters */
+  mwSize  i , j ;
+  
+  /* Number of trials , units , time bins , classes , and folds */
+  mwSize  T , N , B , K , F ;
+  
+  /* Class and fold label of each trial , trials grouped by fold with
+     offsets fo , all trials , and trials per class */
+  mwSize  * c , * f , * ft , * fo , * ta , * nk ;
+  
+  /* Ridge term */
+  double  lambda = 0 ;
+  
+  /* Class means and Cholesky factor of each time bin , and flags for
+     time bins whose factor does not exist */
+  double  * m , * L ;
+  char  * bad ;
+  
+  /* Output */
+  mxArray  * o[ NARGOUT ] ;
+  double  * a , * p , nan = mxGetNaN ( ) ;
+  
+  /* Out of memory in any thread */
+  int  err = 0 ;
+  
+  
+  /*-- Input check --*/
+  
+  /* Must be 3 or 4 input args */
+  if  ( nrhs < NARGINMIN  ||  NARGINMAX < nrhs )
+    
+    mexErrMsgIdAndTxt (  "MAK:maklda:nargsin"  ,
+      "maklda: requires %d or %d input arguments"  ,
+      NARGINMIN  ,  NARGINMAX  ) ;
+  
+  /* Must be no more than 2 output args */
+  else if  ( NARGOUT  <  nlhs )
+    
+    mexErrMsgIdAndTxt (  "MAK:maklda:nargsout"  ,
+      "maklda: returns at most %d output arguments"  ,  NARGOUT  ) ;
+  
+  /* X must be real single or double with at most 3 dimensions */
+  else if  (  !( mxIsDouble( prhs[ XARG ] ) || mxIsSingle( prhs[ XARG ] ) )
+              ||  mxIsComplex( prhs[ XARG ] )  ||  mxIsEmpty( prhs[ XARG ] )
+              ||  3 < mxGetNumberOfDimensions( prhs[ XARG ] )  )
+    
+    mexErrMsgIdAndTxt (  "MAK:maklda:X"  ,
+      "maklda: X must be a non-empty real single or double T x N x B "
+      "matrix"  ) ;
+  
+  T = mxGetDimensions (  prhs[ XARG ]  )[ 0 ] ;
+  N = mxGetDimensions (  prhs[ XARG ]  )[ 1 ] ;
+  B = mxGetNumberOfElements (  prhs[ XARG ]  )  /  T  /  N ;
+  
+  /* c and f must have one label per trial */
+  if  ( !islabels(  prhs[ CARG ]  ,  T  ) )
+    
+    mexErrMsgIdAndTxt (  "MAK:maklda:c"  ,
+      "maklda: c must be uint8 , uint16 , uint32 , or double with one "
+      "value per trial"  ) ;
+  
+  else if  ( !islabels(  prhs[ FARG ]  ,  T  ) )
+    
+    mexErrMsgIdAndTxt (  "MAK:maklda:f"  ,
+      "maklda: f must be uint8 , uint16 , uint32 , or double with one "
+      "value per trial"  ) ;
+  
+  /* Optional lambda must be a non-negative scalar */
+  if  ( nrhs  ==  NARGINMAX )
+  {
+    if  (  !mxIsDouble( prhs[ LAMARG ] )  ||  mxIsComplex( prhs[ LAMARG ] )
+           ||  mxGetNumberOfElements( prhs[ LAMARG ] ) != 1  ||
+           !( 0 <= mxGetScalar( prhs[ LAMARG ] ) )  ||
+           !isfinite( mxGetScalar( prhs[ LAMARG ] ) )  )
+      
+      mexErrMsgIdAndTxt (  "MAK:maklda:lambda"  ,
+        "maklda: lambda must be a finite non-negative scalar"  ) ;
+    
+    lambda = mxGetScalar (  prhs[ LAMARG ]  ) ;
+  }
+  
+  /* Labels */
+  c = mxMalloc (  T * sizeof( mwSize )  ) ;
+  f = mxMalloc (  T * sizeof( mwSize )  ) ;
+  
+  if  ( getlabels(  prhs[ CARG ]  ,  c  ,  &K  ) )
+    
+    mexErrMsgIdAndTxt (  "MAK:maklda:cval"  ,
+      "maklda: c values must be integers of 1 or more"  ) ;
+  
+  else if  ( getlabels(  prhs[ FARG ]  ,  f  ,  &F  ) )
+    
+    mexErrMsgIdAndTxt (  "MAK:maklda:fval"  ,
+      "maklda: f values must be integers of 1 or more"  ) ;
+  
+  
+  /*-- Preparation --*/
+  
+  /* Group trials by fold , counting sort */
+  fo = mxCalloc (  F + 1  ,  sizeof( mwSize )  ) ;
+  ft = mxMalloc (  T * sizeof( mwSize )  ) ;
+  ta = mxMalloc (  T * sizeof( mwSize )  ) ;
+  nk = mxCalloc (  K  ,  sizeof( mwSize )  ) ;
+  
+  for  ( i = 0 ; i < T ; i++ )  {  fo[ f[ i ] + 1 ] += 1 ;  nk[ c[ i ] ]++ ;  }
+  for  ( i = 0 ; i < F ; i++ )  fo[ i + 1 ] += fo[ i ] ;
+  for  ( i = 0 ; i < T ; i++ )  {  ft[ fo[ f[ i ] ]++ ] = i ;  ta[ i ] = i ;  }
+  for  ( i = F ; i ; i-- )  fo[ i ] = fo[ i - 1 ] ;
+  fo[ 0 ] = 0 ;
+  
+  /* Per time bin class means and Cholesky factors */
+  m = mxMalloc (  B * K * N * sizeof( double )  ) ;
+  L = mxMalloc (  B * N * N * sizeof( double )  ) ;
+  bad = mxCalloc (  B  ,  sizeof( char )  ) ;
+  
+  /* Outputs */
+  o[ AOUT ] = mxCreateDoubleMatrix (  1  ,  B  ,  mxREAL  ) ;
+  o[ POUT ] = mxCreateDoubleMatrix (  T  ,  B  ,  mxREAL  ) ;
+  a = mxGetPr (  o[ AOUT ]  ) ;
+  p = mxGetPr (  o[ POUT ]  ) ;
+  
+  
+  /*-- Decoding --*/
+  
+  #pragma omp parallel
+  {
+    
+    /* Task index , time bin , fold , class , and counters */
+    mwSignedIndex  q ;
+    mwSize  b , r , k , h , i ;
+    
+    /* Thread buffers. Response , downdate vector , fold means , class
+       counts , factor , discriminant weights , and offsets. */
+    double  * x = malloc (  N * sizeof( double )  ) ,
+            * v = malloc (  N * sizeof( double )  ) ,
+           * fm = malloc (  K * N * sizeof( double )  ) ,
+           * fL = malloc (  N * N * sizeof( double )  ) ,
+            * w = malloc (  K * N * sizeof( double )  ) ,
+           * be = malloc (  K * sizeof( double )  ) ;
+    mwSize  * fn = malloc (  K * sizeof( mwSize )  ) ,
+            * tr = malloc (  T * sizeof( mwSize )  ) ;
+    int  e = !x  ||  !v  ||  !fm  ||  !fL  ||  !w  ||  !be  ||  !fn  ||  !tr ;
+    
+    /* Sufficient statistics of all trials , once per time bin */
+    #pragma omp for schedule( dynamic )
+    for  ( q = 0 ; q < ( mwSignedIndex ) B ; q++ )
+    {
+      double  * mb = m  +  q * K * N ;
+      
+      if  ( e )  continue ;
+      
+      memset (  mb  ,  0  ,  K * N * sizeof( double )  ) ;
+      
+      for  ( r = 0 ; r < T ; r++ )
+      {
+        getresp (  prhs[ XARG ]  ,  T  ,  N  ,  r  ,  q  ,  x  ) ;
+        for  ( k = 0 ; k < N ; k++ )  mb[ c[ r ] * N + k ] += x[ k ] ;
+      }
+      
+      for  ( k = 0 ; k < K ; k++ )
+        for  ( r = 0 ; r < N ; r++ )
+          if  ( nk[ k ] )  mb[ k * N + r ] /= nk[ k ] ;
+      
+      scatter (  prhs[ XARG ] ,  T ,  N ,  q ,  ta ,  T ,  c ,  mb ,  lambda ,
+        x ,  L + q * N * N  ) ;
+      
+      bad[ q ] = ( char ) cholesky (  L + q * N * N  ,  N  ) ;
+    }
+    
+    /* Each fold of each time bin */
+    #pragma omp for schedule( dynamic )
+    for  ( q = 0 ; q < ( mwSignedIndex ) ( B * F ) ; q++ )
+    {
+      mwSize  nf , kf , nt = 0 ;
+      int  ok ;
+      double  s ;
+      
+      b = q  /  F ;
+      r = q  %  F ;
+      
+      /* Empty fold , or no buffers */
+      if  ( e  ||  fo[ r ]  ==  fo[ r + 1 ] )  continue ;
+      
+      memcpy (  fm  ,  m + b * K * N  ,  K * N * sizeof( double )  ) ;
+      memcpy (  fL  ,  L + b * N * N  ,  N * N * sizeof( double )  ) ;
+      for  ( k = 0 ; k < K ; k++ )  fn[ k ] = nk[ k ] ;
+      ok = !bad[ b ] ;
+      
+      /* Remove each held-out trial. With n trials of class k and mean mu ,
+         removing x takes n / ( n - 1 ) * ( x - mu ) * ( x - mu )' from the
+         scatter matrix. */
+      for  ( h = fo[ r ] ; h < fo[ r + 1 ] ; h++ )
+      {
+        double  * mu ;
+        
+        k = c[ ft[ h ] ] ;
+        mu = fm  +  k * N ;
+        getresp (  prhs[ XARG ]  ,  T  ,  N  ,  ft[ h ]  ,  b  ,  x  ) ;
+        
+        if  ( fn[ k ]  <  2 )  {  fn[ k ] = 0 ;  continue ;  }
+        
+        s = sqrt (  fn[ k ]  /  ( fn[ k ] - 1.0 )  ) ;
+        for  ( i = 0 ; i < N ; i++ )
+        {
+          v[ i ] = s  *  ( x[ i ] - mu[ i ] ) ;
+          mu[ i ] = ( fn[ k ] * mu[ i ]  -  x[ i ] )  /  ( fn[ k ] - 1 ) ;
+        }
+        
+        fn[ k ]-- ;
+        if  ( ok )  ok = !downdate (  fL  ,  v  ,  N  ) ;
+      }
+      
+      /* Training trials and classes */
+      for  ( nf = kf = k = 0 ; k < K ; k++ )
+        if  ( fn[ k ] )  {  nf += fn[ k ] ;  kf++ ;  }
+      
+      /* Downdates failed , factorise the fold's own scatter matrix */
+      if  ( !ok  &&  kf < nf )
+      {
+        for  ( i = 0 ; i < T ; i++ )
+          if  ( f[ i ] != r  &&  fn[ c[ i ] ] )  tr[ nt++ ] = i ;
+        
+        scatter (  prhs[ XARG ] ,  T ,  N ,  b ,  tr ,  nt ,  c ,  fm ,
+          lambda ,  x ,  fL  ) ;
+        ok = !cholesky (  fL  ,  N  ) ;
+      }
+      
+      /* No decoder */
+      if  ( !ok  ||  nf <= kf )
+      {
+        for  ( h = fo[ r ] ; h < fo[ r + 1 ] ; h++ )
+          p[ ft[ h ] + b * T ] = nan ;
+        continue ;
+      }
+      
+      /* Pooled covariance is scatter / ( nf - kf ). Discriminant of class
+         k is s * w' * x + be , for w = inv( scatter ) * mu. */
+      s = ( double ) ( nf - kf ) ;
+      
+      for  ( k = 0 ; k < K ; k++ )
+      {
+        if  ( !fn[ k ] )  continue ;
+        
+        cholsolve (  fL  ,  fm + k * N  ,  w + k * N  ,  N  ) ;
+        
+        for  ( be[ k ] = 0 , i = 0 ; i < N ; i++ )
+          be[ k ] += w[ k * N + i ]  *  fm[ k * N + i ] ;
+        
+        be[ k ] = - s * be[ k ] / 2  +  log (  ( double ) fn[ k ] / nf  ) ;
+      }
+      
+      /* Decode held-out trials */
+      for  ( h = fo[ r ] ; h < fo[ r + 1 ] ; h++ )
+      {
+        double  y , ymax = -HUGE_VAL ;
+        mwSize  kmax = 0 ;
+        
+        getresp (  prhs[ XARG ]  ,  T  ,  N  ,  ft[ h ]  ,  b  ,  x  ) ;
+        
+        for  ( k = 0 ; k < K ; k++ )
+        {
+          if  ( !fn[ k ] )  continue ;
+          
+          for  ( y = 0 , i = 0 ; i < N ; i++ )
+            y += w[ k * N + i ]  *  x[ i ] ;
+          y = s * y  +  be[ k ] ;
+          
+          if  ( ymax  <  y )  {  ymax = y ;  kmax = k ;  }
+        }
+        
+        p[ ft[ h ] + b * T ] = ( double ) ( kmax + 1 ) ;
+      }
+    }
+    
+    #pragma omp critical
+    err |= e ;
+    
+    free (  x  ) ;  free (  v  ) ;  free (  fm  ) ;  free (  fL  ) ;
+    free (  w  ) ;  free (  be  ) ;  free (  fn  ) ;  free (  tr  ) ;
+  
+  } /* parallel */
+  
+  if  ( err )
+    mexErrMsgIdAndTxt (  "MAK:maklda:mem"  ,  "maklda: out of memory"  ) ;
+  
+  /* Fraction correct per time bin , over decoded trials */
+  for  ( j = 0 ; j < B ; j++ )
+  {
+    mwSize  n = 0 , y = 0 ;
+    
+    for  ( i = 0 ; i < T ; i++ )
+      if  ( !mxIsNaN( p[ i + j * T ] ) )
+      {
+        n++ ;
+        y += p[ i + j * T ]  ==  c[ i ] + 1 ;
+      }
+    
+    a[ j ] = n  ?  ( double ) y / n  :  nan ;
+  }
+  
+  mxFree (  c  ) ;  mxFree (  f  ) ;  mxFree (  fo  ) ;  mxFree (  ft  ) ;
+  mxFree (  ta  ) ;  mxFree (  nk  ) ;  mxFree (  m  ) ;  mxFree (  L  ) ;
+  mxFree (  bad  ) ;
+  
+  /* Return requested outputs */
+  for  ( i = 0 ; i < NARGOUT ; i++ )
+    if  ( i  <  ( mwSize ) ( nlhs < 1 ? 1 : nlhs ) )
+      plhs[ i ] = o[ i ] ;
+    else
+      mxDestroyArray (  o[ i ]  ) ;
+
+
+} /* mexFunction */
+
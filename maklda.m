@@ -0,0 +1,52 @@
+
+% [ a , p ] = maklda ( X , c , f , lambda )
+% 
+% MET Analysis Kit. Cross-validated linear discriminant analysis ( LDA )
+% decoding of population responses, in every time bin. This is intended
+% for the same kind of population responses that are given to maklinfin,
+% but it returns decoding accuracy rather than linear Fisher information.
+% 
+% X is a T x N x B single or double matrix of responses, for T trials, N
+% units e.g. neurones, and B time bins. c is a T-element vector of class
+% labels, e.g. the stimulus on each trial. f is a T-element vector of fold
+% labels. Both c and f must be uint8, uint16, uint32, or double, with
+% integer values of 1 or more. Each fold is held out in turn, and its
+% trials are decoded by an LDA that is trained on all other trials.
+% 
+% lambda is optional, default 0. It is added to the diagonal of the
+% within-class scatter matrix, i.e. the pooled covariance matrix times the
+% number of training trials minus the number of classes. A positive lambda
+% is needed when the number of units is close to, or more than, the number
+% of training trials.
+% 
+% a is a 1 x B double vector with the fraction of trials that were decoded
+% correctly in each time bin. p is a T x B double matrix with the decoded
+% class label of each trial in each time bin. Class priors are the
+% proportion of training trials in each class. p is NaN for all trials in
+% a fold when the scatter matrix of the fold's training trials is not
+% positive definite, and those trials are left out of a.
+% 
+% 
+% Algorithm:
+% 
+% Class means and the Cholesky factor of the within-class scatter matrix
+% are computed once per time bin from all trials. With n trials from class
+% k and mean mu, removing trial x changes the scatter matrix by
+% 
+%   - n / ( n - 1 ) * ( x - mu ) * ( x - mu )'
+% 
+% which is a rank-1 downdate of the Cholesky factor that costs O( N ^ 2 ).
+% The mean of class k is updated at the same time. Hence the decoder of
+% each fold costs O( h * N ^ 2 ) for h held-out trials, rather than the
+% O( T * N ^ 2 + N ^ 3 ) of refitting the covariance matrix and its
+% inverse. If a downdate fails due to rounding error then the fold's
+% scatter matrix is factorised from scratch.
+% 
+% If MEX is compiled with OpenMP then time bins and folds are divided
+% between threads, e.g.
+% 
+%   mex CFLAGS='$CFLAGS -fopenmp' LDFLAGS='$LDFLAGS -fopenmp' maklda.c
+% 
+% Otherwise, it runs on a single thread.
+% 
+% Written by Jackson Smith - October 2026 - ESI (Fries Lab)
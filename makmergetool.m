@@ -55,6 +55,11 @@ classdef  makmergetool  <  handle
 % cluster's spikes are added to the low-numbered cluster. If clustering is
 % aborted by the user then the output arguments are all empty matrices.
 % 
+% When merge returns 'cutoff', the calling function can apply the new
+% cutoff with makcreplay if it kept the dendrogram returned by makcmerge
+% with an empty cutoff. Automated merging then need not be repeated for
+% each new cutoff value that is tried.
+% 
 % Written by Jackson Smith - February 2018 - DPAG , University of Oxford
 % 
   
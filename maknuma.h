@@ -0,0 +1,178 @@
+
+/*  maknuma.h
+  
+  MET Analysis Kit. First-touch placement of large MEX output arrays on
+  multi-socket computers. Linux places each page of memory on the socket
+  of the thread that first writes to it. If one thread zeros a large
+  output array then all of its pages sit on one socket , and threads on
+  the other socket must read and write remote memory.
+  
+  maknuma_create ( ) returns an uninitialised array and zeros it in
+  parallel. The last dimension of the array is cut into chunks of slices ,
+  and chunk i is zeroed by thread i modulo the number of threads. This is
+  OpenMP's schedule( static , chunk ). A compute loop over the same slices
+  then uses schedule( runtime ) after a call to maknuma_sched ( ) , so that
+  each slice is computed by the thread that zeroed it. The schedule is a
+  setting of the whole MATLAB process , so maknuma_unsched ( ) puts back
+  the one that maknuma_sched ( ) replaced. Arrays smaller than
+  MAKNUMA_MIN bytes are not worth the bother. They are created by
+  mxCreateNumericArray and the compute loop is given schedule( dynamic ).
+  
+  Threads must be bound to cores for this to help , e.g. by setting
+  environment variables OMP_PROC_BIND=spread and OMP_PLACES=cores before
+  MATLAB starts. If environment variable MAK_THP is set then Linux is also
+  advised to back the array with transparent huge pages.
+  
+  For example
+    
+    chunk = maknuma_chunk (  W * M * sizeof( float )  ,  Nt  ) ;
+    plhs[ 0 ] = maknuma_create (  3  ,  dims  ,  mxSINGLE_CLASS  ,  chunk  );
+    old = maknuma_sched (  chunk  ) ;
+    
+    #pragma omp parallel for schedule( runtime )
+    for  ( t = 0 ; t < Nt ; t++ )  ...
+    
+    maknuma_unsched (  old  ) ;
+  
+  Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+
+*/
+
+#ifndef  MAKNUMA_H
+#define  MAKNUMA_H
+
+
+/*-- Include block --*/
+
+#include  <stdint.h>
+#include  <stdlib.h>
+#include  <string.h>
+#include     "mex.h"
+#include  "matrix.h"
+
+#ifdef  __linux__
+  #include  <sys/mman.h>
+#endif
+
+#ifdef  _OPENMP
+  #include  <omp.h>
+#endif
+
+
+/*-- Define block --*/
+
+/* Smallest array , in bytes , that is placed by first touch */
+#define  MAKNUMA_MIN  ( ( size_t ) 1 << 24 )
+
+/* Page size , and transparent huge page size , in bytes */
+#define  MAKNUMA_PAGE  ( ( size_t ) 1 << 12 )
+#define  MAKNUMA_HUGE  ( ( size_t ) 1 << 21 )
+
+/* Environment variable that asks for transparent huge pages */
+#define  MAKNUMA_THP  "MAK_THP"
+
+
+/*-- Data types --*/
+
+/* Schedule of loops with schedule( runtime ) , kind and chunk size */
+typedef struct
+{
+  
+  int  kind , chunk ;
+
+} maknuma_sched_t ;
+
+
+/*-- Subroutines --*/
+
+/* Number of slices per chunk , for n slices of s bytes each. A chunk
+   covers at least one page. MATLAB does not align array data to pages ,
+   so the page at each end of a chunk may still be shared with the
+   neighbouring chunk , but every other page is touched by one thread.
+   Returns 0 if the array is too small to place by first touch. */
+static mwSize  maknuma_chunk ( size_t s , mwSize n )
+{
+  size_t  p = getenv( MAKNUMA_THP )  ?  MAKNUMA_HUGE  :  MAKNUMA_PAGE ;
+  
+  if  ( !s  ||  s * n  <  MAKNUMA_MIN )  return  0 ;
+  
+  return  ( mwSize ) ( ( p + s - 1 )  /  s ) ;
+}
+
+/* Zeroed numeric array with nd dimensions dims and class c. If chunk is
+   non-zero then it is zeroed by all threads , chunk slices of the last
+   dimension at a time. */
+static mxArray *  maknuma_create ( mwSize nd , const mwSize * dims ,
+  mxClassID c , mwSize chunk )
+{
+  mxArray  * a ;
+  char  * p ;
+  size_t  s , n ;
+  mwSignedIndex  i ;
+  
+  if  ( !chunk )  return  mxCreateNumericArray (  nd ,  dims ,  c ,  mxREAL );
+  
+  a = mxCreateUninitNumericArray (  nd  ,  dims  ,  c  ,  mxREAL  ) ;
+  p = ( char * ) mxGetData (  a  ) ;
+  
+  /* Number of slices in the last dimension , and bytes per slice */
+  n = dims[ nd - 1 ] ;
+  s = n  ?  mxGetNumberOfElements( a ) / n * mxGetElementSize( a )  :  0 ;
+
+#if  defined( __linux__ )  &&  defined( MADV_HUGEPAGE )
+  if  ( getenv(  MAKNUMA_THP  ) )
+  {
+    /* Whole huge pages within the array */
+    uintptr_t  b = ( ( uintptr_t ) p + MAKNUMA_HUGE - 1 )  &
+      ~ ( uintptr_t ) ( MAKNUMA_HUGE - 1 ) ;
+    uintptr_t  e = ( ( uintptr_t ) p + s * n )  &
+      ~ ( uintptr_t ) ( MAKNUMA_HUGE - 1 ) ;
+    
+    if  ( b  <  e )  madvise (  ( void * ) b  ,  e - b  ,  MADV_HUGEPAGE  ) ;
+  }
+#endif
+  
+  #pragma omp parallel for schedule( static , chunk )
+  for  ( i = 0 ; i < ( mwSignedIndex ) n ; i++ )
+    memset (  p + i * s  ,  0  ,  s  ) ;
+  
+  return  a ;
+}
+
+/* Sets the schedule of loops with schedule( runtime ) to match the
+   placement of an array from maknuma_create ( ) with the same chunk.
+   Returns the schedule that was replaced. */
+static maknuma_sched_t  maknuma_sched ( mwSize chunk )
+{
+  maknuma_sched_t  s = {  0  ,  0  } ;
+  
+#ifdef  _OPENMP
+  omp_sched_t  k ;
+  
+  omp_get_schedule (  &k  ,  &s.chunk  ) ;
+  s.kind = ( int ) k ;
+  
+  if  ( chunk )
+    omp_set_schedule (  omp_sched_static  ,  ( int ) chunk  ) ;
+  else
+    omp_set_schedule (  omp_sched_dynamic  ,  1  ) ;
+#else
+  ( void ) chunk ;
+#endif
+  
+  return  s ;
+}
+
+/* Puts back schedule s , as returned by maknuma_sched ( ) */
+static void  maknuma_unsched ( maknuma_sched_t s )
+{
+#ifdef  _OPENMP
+  omp_set_schedule (  ( omp_sched_t ) s.kind  ,  s.chunk  ) ;
+#else
+  ( void ) s ;
+#endif
+}
+
+
+#endif  /* MAKNUMA_H */
+
@@ -0,0 +1,538 @@
+
+/*  maknwbread
+  
+  [ P , id ] = maknwbread ( file )
+  [ P , id ] = maknwbread ( file , u )
+  x = maknwbread ( file , es , ch , r )
+  w = maknwbread ( file , es , ch , s , win )
+  
+  MET Analysis Kit. Reads spike trains and raw samples straight from a
+  Neurodata Without Borders ( NWB ) file , through the HDF5 library ,
+  without loading whole datasets or writing an intermediate .mat file.
+  
+  Given only the file name , the spike trains of the units table are
+  read. u is an optional vector of row indices , counting from 1 , of the
+  units that are read. P is a struct of packed spike trains , as returned
+  by makspkpack , with one train per unit and P.size equal to [ 1 , U ] ,
+  ready for makspkcount , maksttc , or makrccg. P.valid is true if every
+  train has finite spike times in chronological order. id is a 1 x U
+  double vector with the id of each unit. Spike times of units that are
+  next to each other in the file are read at once.
+  
+  es is the path of an ElectricalSeries , or of its data , such as
+  '/acquisition/ElectricalSeries'. Its data must be integers , with one
+  row of samples per frame and one column per channel , as NWB stores
+  them. Samples are converted to int16. The other arguments , and outputs
+  x and w , are as for makrawread , with C set by the data. Reads of data
+  are aligned to the chunks of the HDF5 dataset , so that each chunk is
+  read once , see makraw.h. Samples are raw , multiply by the conversion
+  attribute of the data to get volts.
+  
+  HDF5 calls are made on one thread. Compile with the include path and
+  library of an HDF5 build that is no newer than the one that came with
+  MATLAB , e.g.
+    
+    mex -I/usr/include/hdf5/serial -lhdf5_serial maknwbread.c
+  
+  Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+
+*/
+
+
+/*-- Include block --*/
+
+#include  <string.h>
+#include     "mex.h"
+#include  "matrix.h"
+#include    "hdf5.h"
+#include  "makspk.h"
+#include  "makraw.h"
+
+
+/*-- Define block --*/
+
+#define  NARGINMIN  1
+#define  NARGINMAX  5
+#define    NARGOUT  2
+#define    FILEARG  0
+#define       UARG  1
+#define      ESARG  1
+#define      CHARG  2
+#define       RARG  3
+#define       SARG  3
+#define     WINARG  4
+#define       POUT  0
+#define      IDOUT  1
+#define       XOUT  0
+
+/* Datasets of the units table */
+#define  SPKTIM  "/units/spike_times"
+#define  SPKIND  "/units/spike_times_index"
+#define  UNITID  "/units/id"
+
+/* Hash slots of the chunk cache , a prime as HDF5 advises , and its
+   smallest size in bytes */
+#define  NSLOTS  12421
+#define   CACHE  ( 1 << 20 )
+
+
+/*-- Data types --*/
+
+/* Open HDF5 objects , closed on error. Negative if not open. */
+typedef struct
+{
+  
+  hid_t  f , d[ 3 ] ;
+
+} nwb_t ;
+
+/* An integer dataset of F x C samples */
+typedef struct
+{
+  
+  hid_t  d ;
+  mwSize  C ;
+
+} h5src_t ;
+
+
+/*-- Subroutines --*/
+
+/* Closes all objects of h */
+static void  nwbclose ( nwb_t * h )
+{
+  int  i ;
+  
+  for  ( i = 0 ; i < 3 ; i++ )
+    if  ( 0 <= h->d[ i ] )  {  H5Dclose (  h->d[ i ]  ) ;  h->d[ i ] = -1 ;  }
+  
+  if  ( 0 <= h->f )  {  H5Fclose (  h->f  ) ;  h->f = -1 ;  }
+}
+
+/* Closes all objects of h and then raises an error */
+static void  nwberr ( nwb_t * h , const char * id , const char * msg )
+{
+  nwbclose (  h  ) ;
+  mexErrMsgIdAndTxt (  id  ,  "maknwbread: %s"  ,  msg  ) ;
+}
+
+/* Opens dataset name at loc. Chunked datasets get a chunk cache that
+   holds two rows of chunks , across all columns , so that a read that
+   runs into the next row of chunks does not decompress it again. */
+static hid_t  opendset ( hid_t loc , const char * name )
+{
+  hid_t  d = H5Dopen2 (  loc  ,  name  ,  H5P_DEFAULT  ) , p , s , t ;
+  hsize_t  c[ H5S_MAX_RANK ] , n[ H5S_MAX_RANK ] ;
+  size_t  b ;
+  int  i , k ;
+  
+  if  ( d  <  0 )  return  d ;
+  
+  p = H5Dget_create_plist (  d  ) ;
+  k = H5Pget_layout( p ) == H5D_CHUNKED  ?
+    H5Pget_chunk( p , H5S_MAX_RANK , c )  :  0 ;
+  H5Pclose (  p  ) ;
+  
+  if  ( k  <=  0 )  return  d ;
+  
+  /* Bytes of two rows of chunks */
+  s = H5Dget_space (  d  ) ;
+  t = H5Dget_type (  d  ) ;
+  H5Sget_simple_extent_dims (  s  ,  n  ,  NULL  ) ;
+  
+  for  ( b = 2 * H5Tget_size( t ) * c[ 0 ] , i = 1 ; i < k ; i++ )
+    b *= ( n[ i ] + c[ i ] - 1 )  /  c[ i ]  *  c[ i ] ;
+  
+  H5Tclose (  t  ) ;
+  H5Sclose (  s  ) ;
+  
+  /* Re-open with the cache , no smaller than the default of 1MiB. Fully
+     read chunks are dropped first. */
+  p = H5Pcreate (  H5P_DATASET_ACCESS  ) ;
+  H5Pset_chunk_cache (  p  ,  NSLOTS  ,  b < CACHE ? CACHE : b  ,  1.0  ) ;
+  H5Dclose (  d  ) ;
+  d = H5Dopen2 (  loc  ,  name  ,  p  ) ;
+  H5Pclose (  p  ) ;
+  
+  return  d ;
+}
+
+/* Reads n frames from frame a of h5src_t h into x */
+static int  readh5 ( void * h , int16_t * x , mwSize a , mwSize n )
+{
+  const h5src_t  * r = h ;
+  hsize_t  o[ 2 ] = {  a  ,  0  } , c[ 2 ] = {  n  ,  r->C  } ;
+  hid_t  f = H5Dget_space (  r->d  ) ;
+  hid_t  m = H5Screate_simple (  H5Sget_simple_extent_ndims( f )  ,  c  ,
+    NULL  ) ;
+  herr_t  e = H5Sselect_hyperslab (  f  ,  H5S_SELECT_SET  ,  o  ,  NULL  ,
+    c  ,  NULL  ) ;
+  
+  if  ( 0 <= e )
+    e = H5Dread (  r->d  ,  H5T_NATIVE_INT16  ,  m  ,  f  ,  H5P_DEFAULT  ,
+      x  ) ;
+  
+  H5Sclose (  m  ) ;
+  H5Sclose (  f  ) ;
+  
+  return  e  <  0 ;
+}
+
+/* Reads n doubles from element a of 1-D dataset d into x */
+static int  readvec ( hid_t d , double * x , hsize_t a , hsize_t n )
+{
+  hid_t  f , m ;
+  herr_t  e ;
+  
+  if  ( !n )  return  0 ;
+  
+  f = H5Dget_space (  d  ) ;
+  m = H5Screate_simple (  1  ,  &n  ,  NULL  ) ;
+  e = H5Sselect_hyperslab (  f  ,  H5S_SELECT_SET  ,  &a  ,  NULL  ,  &n  ,
+    NULL  ) ;
+  
+  if  ( 0 <= e )
+    e = H5Dread (  d  ,  H5T_NATIVE_DOUBLE  ,  m  ,  f  ,  H5P_DEFAULT  ,  x );
+  
+  H5Sclose (  m  ) ;
+  H5Sclose (  f  ) ;
+  
+  return  e  <  0 ;
+}
+
+/* Reads the spike trains of units u , or of all units if u is NULL , into
+   packed spike trains plhs[ POUT ] , and their ids into plhs[ IDOUT ] */
+static void  units ( nwb_t * h , const mxArray * u , int nlhs ,
+  mxArray * plhs[ ] )
+{
+  /* Field names of packed spike trains */
+  const char  * fld[ MAKSPK_NFLD ] =
+    {  MAKSPK_T  ,  MAKSPK_OFF  ,  MAKSPK_SIZE  ,  MAKSPK_VALID  } ;
+  
+  /* Units of the table and that are read , and counters */
+  mwSize  U = 0 , V , i , j , k , * ui ;
+  
+  /* Spikes of the table , and the end of each unit's spikes */
+  hsize_t  N ;
+  unsigned long long  * ind ;
+  
+  /* Offsets , spike times , and ids */
+  double  * off , * t , * id ;
+  
+  mxArray  * a ;
+  hid_t  s ;
+  
+  
+  /* Spike times and their index , both vectors */
+  h->d[ 0 ] = opendset (  h->f  ,  SPKIND  ) ;
+  h->d[ 1 ] = opendset (  h->f  ,  SPKTIM  ) ;
+  
+  if  ( h->d[ 0 ] < 0  ||  h->d[ 1 ] < 0 )
+    nwberr (  h  ,  "MAK:maknwbread:units"  ,
+      "can't open " SPKTIM " and " SPKIND  ) ;
+  
+  for  ( i = 0 ; i < 2 ; i++ )
+  {
+    s = H5Dget_space (  h->d[ i ]  ) ;
+    k = H5Sget_simple_extent_ndims( s ) == 1 ;
+    if  ( k )  H5Sget_simple_extent_dims (  s  ,  &N  ,  NULL  ) ;
+    H5Sclose (  s  ) ;
+    
+    if  ( !k )
+      nwberr (  h  ,  "MAK:maknwbread:units"  ,
+        SPKTIM " and " SPKIND " must be vectors"  ) ;
+    
+    if  ( !i )  U = ( mwSize ) N ;
+  }
+  
+  /* Index , with a leading zero. Spikes of unit i are ind[ i ] to
+     ind[ i + 1 ] - 1. */
+  ind = mxMalloc (  ( U + 1 ) * sizeof( unsigned long long )  ) ;
+  ind[ 0 ] = 0 ;
+  
+  if  ( U  &&  H5Dread( h->d[ 0 ] , H5T_NATIVE_ULLONG , H5S_ALL , H5S_ALL ,
+                        H5P_DEFAULT , ind + 1 ) < 0 )
+    nwberr (  h  ,  "MAK:maknwbread:read"  ,  "failed to read " SPKIND  ) ;
+  
+  for  ( i = 0 ; i < U ; i++ )
+    if  ( ind[ i + 1 ] < ind[ i ]  ||  N < ind[ i + 1 ] )
+      nwberr (  h  ,  "MAK:maknwbread:units"  ,
+        SPKIND " must not decrease , nor pass the end of " SPKTIM  ) ;
+  
+  /* Units that are read */
+  V = u  ?  mxGetNumberOfElements( u )  :  U ;
+  ui = mxMalloc (  ( V + 1 ) * sizeof( mwSize )  ) ;
+  
+  if  ( u  &&  makraw_index(  u  ,  U  ,  ui  ) )
+    nwberr (  h  ,  "MAK:maknwbread:u"  ,
+      "u must have integers from 1 to the number of units"  ) ;
+  
+  if  ( !u )
+    for  ( i = 0 ; i < V ; i++ )  ui[ i ] = i ;
+  
+  
+  /*-- Packed spike trains --*/
+  
+  plhs[ POUT ] = mxCreateStructMatrix (  1  ,  1  ,  MAKSPK_NFLD  ,  fld  ) ;
+  
+  a = mxCreateDoubleMatrix (  V + 1  ,  1  ,  mxREAL  ) ;
+  off = mxGetPr (  a  ) ;
+  mxSetField (  plhs[ POUT ]  ,  0  ,  MAKSPK_OFF  ,  a  ) ;
+  
+  for  ( k = 0 ; k < V ; k++ )
+    off[ k + 1 ] = off[ k ]  +
+      ( double ) ( ind[ ui[ k ] + 1 ]  -  ind[ ui[ k ] ] ) ;
+  
+  a = mxCreateDoubleMatrix (  ( mwSize ) off[ V ]  ,  1  ,  mxREAL  ) ;
+  t = mxGetPr (  a  ) ;
+  mxSetField (  plhs[ POUT ]  ,  0  ,  MAKSPK_T  ,  a  ) ;
+  
+  /* Units that follow one another in the file are read at once */
+  for  ( k = 0 ; k < V ; k = j )
+  {
+    for  ( j = k + 1 ; j < V  &&  ui[ j ] == ui[ j - 1 ] + 1 ; j++ )  ;
+    
+    if  ( readvec(  h->d[ 1 ]  ,  t + ( mwSize ) off[ k ]  ,  ind[ ui[ k ] ] ,
+                    ind[ ui[ j - 1 ] + 1 ]  -  ind[ ui[ k ] ]  ) )
+      nwberr (  h  ,  "MAK:maknwbread:read"  ,  "failed to read " SPKTIM  ) ;
+  }
+  
+  a = mxCreateDoubleMatrix (  1  ,  2  ,  mxREAL  ) ;
+  mxGetPr (  a  )[ 0 ] = 1 ;
+  mxGetPr (  a  )[ 1 ] = ( double ) V ;
+  mxSetField (  plhs[ POUT ]  ,  0  ,  MAKSPK_SIZE  ,  a  ) ;
+  
+  /* NWB does not promise that spike times are in order */
+  mxSetField (  plhs[ POUT ]  ,  0  ,  MAKSPK_VALID  ,
+    mxCreateLogicalScalar( !makspk_packed( plhs[ POUT ] , 1 , &i ) )  ) ;
+  
+  
+  /*-- Unit ids --*/
+  
+  if  ( IDOUT  <  nlhs )
+  {
+    h->d[ 2 ] = opendset (  h->f  ,  UNITID  ) ;
+    id = mxMalloc (  ( U + 1 ) * sizeof( double )  ) ;
+    
+    if  ( h->d[ 2 ]  <  0  ||  readvec(  h->d[ 2 ]  ,  id  ,  0  ,  U  ) )
+      nwberr (  h  ,  "MAK:maknwbread:read"  ,  "failed to read " UNITID  ) ;
+    
+    plhs[ IDOUT ] = mxCreateDoubleMatrix (  1  ,  V  ,  mxREAL  ) ;
+    
+    for  ( k = 0 ; k < V ; k++ )
+      mxGetPr (  plhs[ IDOUT ]  )[ k ] = id[ ui[ k ] ] ;
+    
+    mxFree (  id  ) ;
+  }
+  
+  mxFree (  ind  ) ;
+  mxFree (  ui  ) ;
+}
+
+/* Reads samples of ElectricalSeries es into plhs[ XOUT ] , a range of
+   frames if nrhs is 4 , or windows around spikes if it is 5 */
+static void  series ( nwb_t * h , int nrhs , const mxArray * prhs[ ] ,
+  mxArray * plhs[ ] )
+{
+  /* Channels that are read , first frame of each window , size of w */
+  mwSize  * ch , * s , dims[ 3 ] ;
+  
+  /* Number of channels read , spikes , first frame , frames , counter */
+  mwSize  K , N , a = 0 , n = 0 , i ;
+  
+  /* Size and chunk size of the data */
+  hsize_t  d[ 2 ] = {  0  ,  1  } , c[ 2 ] ;
+  
+  /* Source of frames */
+  h5src_t  src ;
+  makraw_t  r ;
+  
+  /* Path of the series , the object there , and the data property list */
+  char  * es ;
+  hid_t  o , p ;
+  
+  /* Error code */
+  int  e ;
+  
+  
+  /*-- The data --*/
+  
+  if  ( !mxIsChar(  prhs[ ESARG ]  ) )
+    nwberr (  h  ,  "MAK:maknwbread:es"  ,  "es must be a string"  ) ;
+  
+  /* es can be the series group , or its data */
+  es = mxArrayToString (  prhs[ ESARG ]  ) ;
+  o = H5Oopen (  h->f  ,  es  ,  H5P_DEFAULT  ) ;
+  
+  if  ( 0  <=  o )
+  {
+    h->d[ 0 ] = H5Iget_type( o ) == H5I_GROUP  ?  opendset( o , "data" )  :
+                                                  opendset( h->f , es ) ;
+    H5Oclose (  o  ) ;
+  }
+  
+  mxFree (  es  ) ;
+  
+  if  ( h->d[ 0 ]  <  0 )
+    nwberr (  h  ,  "MAK:maknwbread:es"  ,  "can't open data of es"  ) ;
+  
+  /* Integer samples , frames over rows and channels over columns */
+  o = H5Dget_type (  h->d[ 0 ]  ) ;
+  e = H5Tget_class( o ) != H5T_INTEGER ;
+  H5Tclose (  o  ) ;
+  
+  o = H5Dget_space (  h->d[ 0 ]  ) ;
+  e = e  ||  H5Sget_simple_extent_ndims( o ) < 1  ||
+             H5Sget_simple_extent_ndims( o ) > 2 ;
+  
+  if  ( !e )  H5Sget_simple_extent_dims (  o  ,  d  ,  NULL  ) ;
+  
+  H5Sclose (  o  ) ;
+  
+  if  ( e  ||  !d[ 1 ] )
+    nwberr (  h  ,  "MAK:maknwbread:es"  ,
+      "data of es must be an integer vector or matrix"  ) ;
+  
+  /* Frames per chunk , a whole number of rows of dataset chunks */
+  p = H5Dget_create_plist (  h->d[ 0 ]  ) ;
+  
+  if  ( H5Pget_layout(  p  )  !=  H5D_CHUNKED )  c[ 0 ] = 1 ;
+  else  H5Pget_chunk (  p  ,  2  ,  c  ) ;
+  
+  H5Pclose (  p  ) ;
+  
+  src.d = h->d[ 0 ] ;
+  src.C = ( mwSize ) d[ 1 ] ;
+  
+  r.src  = &src ;
+  r.read = readh5 ;
+  r.C    = src.C ;
+  r.F    = ( mwSize ) d[ 0 ] ;
+  r.B    = MAKRAW_BYTES  /  ( r.C * sizeof( int16_t ) * c[ 0 ] ) ;
+  r.B    = ( r.B  ?  r.B  :  1 )  *  c[ 0 ] ;
+  r.par  = 0 ;
+  
+  
+  /*-- Channels --*/
+  
+  K = mxGetNumberOfElements (  prhs[ CHARG ]  ) ;
+  K = K  ?  K  :  r.C ;
+  ch = mxMalloc (  K * sizeof( mwSize )  ) ;
+  
+  if  ( makraw_index(  prhs[ CHARG ]  ,  r.C  ,  ch  ) )
+    nwberr (  h  ,  "MAK:maknwbread:ch"  ,
+      "ch must have integers from 1 to the number of channels"  ) ;
+  
+  if  ( mxIsEmpty(  prhs[ CHARG ]  ) )
+    for  ( i = 0 ; i < K ; i++ )  ch[ i ] = i ;
+  
+  
+  /*-- Range of frames --*/
+  
+  if  ( nrhs  ==  RARG + 1 )
+  {
+    if  ( makraw_range(  prhs[ RARG ]  ,  r.F  ,  &a  ,  &n  ) )
+      nwberr (  h  ,  "MAK:maknwbread:r"  ,
+        "r must be [ s0 , s1 ] , frames within the data"  ) ;
+    
+    plhs[ XOUT ] = mxCreateNumericMatrix (  K  ,  n  ,  mxINT16_CLASS  ,
+      mxREAL  ) ;
+    
+    e = makraw_slab (  &r  ,  ch  ,  K  ,  a  ,  n  ,
+      mxGetData( plhs[ XOUT ] )  ) ;
+  }
+  
+  
+  /*-- Window around each spike --*/
+  
+  else
+  {
+    N = mxGetNumberOfElements (  prhs[ SARG ]  ) ;
+    s = mxMalloc (  ( N + 1 ) * sizeof( mwSize )  ) ;
+    
+    if  ( makraw_window(  prhs[ WINARG ]  ,  prhs[ SARG ]  ,  r.F  ,  s  ,
+                          &dims[ 0 ]  ) )
+      nwberr (  h  ,  "MAK:maknwbread:s"  ,
+        "win must be [ pre , post ] , integers of 0 or more , and s frames "
+        "from pre + 1 to the number of frames - post"  ) ;
+    
+    dims[ 1 ] = N ;
+    dims[ 2 ] = K ;
+    
+    plhs[ XOUT ] = mxCreateNumericArray (  3  ,  dims  ,  mxINT16_CLASS  ,
+      mxREAL  ) ;
+    
+    e = makraw_wave (  &r  ,  ch  ,  K  ,  s  ,  N  ,  dims[ 0 ]  ,
+      mxGetData( plhs[ XOUT ] )  ) ;
+    
+    mxFree (  s  ) ;
+  }
+  
+  mxFree (  ch  ) ;
+  
+  if  ( e )  nwberr (  h  ,  "MAK:maknwbread:read"  ,  makraw_msg[ e ]  ) ;
+}
+
+
+/*** MEX gateway function ***/
+
+void  mexFunction (  int nlhs  ,        mxArray * plhs[ ] ,
+                     int nrhs  ,  const mxArray * prhs[ ]  )
+{
+  
+  
+  /*-- Variables --*/
+  
+  /* Open HDF5 objects */
+  nwb_t  h = {  -1  ,  {  -1  ,  -1  ,  -1  }  } ;
+  
+  /* File name */
+  char  * file ;
+  
+  
+  /*-- Input check --*/
+  
+  /* Must be 1 , 2 , 4 , or 5 input args */
+  if  ( nrhs < NARGINMIN  ||  NARGINMAX < nrhs  ||  nrhs == RARG )
+    
+    mexErrMsgIdAndTxt (  "MAK:maknwbread:nargsin"  ,
+      "maknwbread: takes 1 , 2 , 4 , or 5 input arguments"  ) ;
+  
+  /* Spike trains give 2 output args , samples give 1 */
+  else if  ( ( nrhs <= UARG + 1  ?  NARGOUT  :  XOUT + 1 )  <  nlhs )
+    
+    mexErrMsgIdAndTxt (  "MAK:maknwbread:nargsout"  ,
+      "maknwbread: too many output arguments"  ) ;
+  
+  /* file must be a string */
+  else if  ( !mxIsChar(  prhs[ FILEARG ]  ) )
+    
+    mexErrMsgIdAndTxt (  "MAK:maknwbread:file"  ,
+      "maknwbread: file must be a string"  ) ;
+  
+  
+  /*-- Open file --*/
+  
+  /* Failures are raised as MEX errors , rather than printed by HDF5 */
+  H5Eset_auto2 (  H5E_DEFAULT  ,  NULL  ,  NULL  ) ;
+  
+  file = mxArrayToString (  prhs[ FILEARG ]  ) ;
+  h.f = H5Fopen (  file  ,  H5F_ACC_RDONLY  ,  H5P_DEFAULT  ) ;
+  mxFree (  file  ) ;
+  
+  if  ( h.f  <  0 )
+    nwberr (  &h  ,  "MAK:maknwbread:file"  ,  "can't open file"  ) ;
+  
+  
+  /*-- Read --*/
+  
+  if  ( nrhs  <=  UARG + 1 )
+    units (  &h  ,  UARG < nrhs  ?  prhs[ UARG ]  :  NULL  ,  nlhs  ,  plhs  );
+  else
+    series (  &h  ,  nrhs  ,  prhs  ,  plhs  ) ;
+  
+  nwbclose (  &h  ) ;
+
+
+} /* mexFunction */
+
@@ -0,0 +1,46 @@
+
+% [ P , id ] = maknwbread ( file )
+% [ P , id ] = maknwbread ( file , u )
+% x = maknwbread ( file , es , ch , r )
+% w = maknwbread ( file , es , ch , s , win )
+% 
+% MET Analysis Kit. Reads spike trains and raw samples straight from a
+% Neurodata Without Borders ( NWB ) file through the HDF5 library. Only
+% the parts of each dataset that are asked for are read, and they go
+% directly into the arrays that MAK functions take, with no intermediate
+% .mat file.
+% 
+% Given file alone, the spike trains of all units in the units table are
+% read. u is an optional vector of row indices of the table, counting from
+% 1, for the units that are read. P is a struct of packed spike trains, as
+% returned by makspkpack, with one train per unit and P.size equal to
+% [ 1 , U ]. It can go to makspkcount, or be unpacked by makspkpack for
+% maksttc or makrccg. P.valid is true if every train has finite spike times
+% in chronological order. id is a 1 x U double vector with the id of each
+% unit. Units that are next to each other in the table have their spike
+% times read in a single read.
+% 
+% es is the path of an ElectricalSeries in the file, or of its data, e.g.
+% '/acquisition/ElectricalSeries'. The data must be integers, with one row
+% per frame and one column per channel, as NWB stores them. Samples are
+% converted to int16, but are not scaled. Multiply by the conversion
+% attribute of the data to get volts. Arguments ch, r, s, and win, and
+% outputs x and w, are as for makrawread, with the number of channels
+% taken from the data. For example
+% 
+%   w = maknwbread (  'rec.nwb'  ,  '/acquisition/ElectricalSeries'  ,  ...
+%     c  ,  s  ,  [ 10 , 21 ]  ) ;
+% 
+% Reads of the data begin on the chunk boundaries of the HDF5 dataset, and
+% each read covers whole chunks, so that every compressed chunk is
+% decompressed once. See makraw.h, which must be in the same directory as
+% maknwbread.c.
+% 
+% HDF5 calls are made on one thread. Compile MEX with the header files and
+% library of an HDF5 release no newer than the one that came with MATLAB,
+% e.g.
+% 
+%   mex -I/usr/include/hdf5/serial -lhdf5_serial maknwbread.c
+% 
+% Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+% 
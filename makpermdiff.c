@@ -0,0 +1,691 @@
+
+/*  makpermdiff
+  
+  [ p , d ] = makpermdiff ( Y , g , nperm , seed )
+  [ p , d ] = makpermdiff ( P , X , g , nperm , seed , maxtau )
+  
+  MET Analysis Kit. Permutation test for a difference in spike train
+  correlation between two conditions. Per-trial terms are computed once by
+  maksttc or makrccg. On each permutation, the condition labels are
+  shuffled and the per-trial terms are only summed again by group.
+  
+  The first form takes per-trial STTC values Y from maksttc, with trials
+  indexed over the last dimension. g is a logical vector with one element
+  per trial that is true for trials in condition A and false for those in
+  condition B. The statistic is the mean of condition A minus the mean of
+  condition B, ignoring NaN values. p and d have the size of Y without its
+  last dimension.
+  
+  The second form takes P and X, the per-trial PSTHs and auto- and cross-
+  correlations returned by makrccg. The statistic is the r_CCG of
+  condition A minus that of condition B, at integration widths of 0 to
+  maxtau milliseconds. p and d are ( maxtau + 1 ) x S x S for S spike
+  clusters.
+  
+  p is the two-sided permutation p-value of each statistic, and d is the
+  observed difference. seed is the random number seed, default 0. The same
+  seed gives the same p for any number of threads.
+  
+  Compile with OpenMP to divide permutations between threads.
+  
+  Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+
+*/
+
+
+/*-- Include block --*/
+
+#include    <math.h>
+#include  <stdint.h>
+#include  <stdlib.h>
+#include  <string.h>
+#include     "mex.h"
+#include  "matrix.h"
+
+#ifdef  _OPENMP
+  #include  <omp.h>
+#endif
+
+
+/*-- Define block --*/
+
+/* Number of input and output arguments */
+#define  NARGIN1MIN  3
+#define  NARGIN1MAX  4
+#define  NARGIN2MIN  4
+#define  NARGIN2MAX  6
+#define     NARGOUT  2
+#define        POUT  0
+#define        DOUT  1
+
+/* Relative tolerance of a permuted statistic that is as extreme as the
+   observed one. They are summed in different orders of trials , so a
+   labelling with the same groups can differ by a few ulp. */
+#define  TOL  1e-12
+
+
+/*-- Data types --*/
+
+/* Everything that a permutation needs to know about the data */
+typedef struct
+{
+  
+  /* STTC form when non-zero , otherwise r_CCG form */
+  int  sttc ;
+  
+  /* Number of trials , and number in condition A */
+  mwSize  Nt , nA ;
+  
+  /* Number of statistics */
+  mwSize  K ;
+  
+  /* STTC form. Per-trial values are doubles if Ydbl is non-zero. Sum and
+     count of non-NaN values over all trials for each statistic. */
+  const void  * Y ;
+  int  Ydbl ;
+  double  * Ysum ;
+  double  * Ycnt ;
+  
+  /* r_CCG form. Q bins , S clusters , U = S( S + 1 ) / 2 cluster pairs
+     including autos , and T + 1 integration widths. P is the Nt x Q x S
+     per-trial PSTH array , and XI is the Nt x ( T + 1 ) x U per-trial
+     integrated correlation array. Psum and XIsum sum these over trials. */
+  mwSize  Q , S , U , T ;
+  const double  * P ;
+  double  * XI ;
+  double  * Psum ;
+  double  * XIsum ;
+
+} data_t ;
+
+
+/*-- Random numbers --*/
+
+/* SplitMix64 generator , returns next 64-bit value from state s */
+static uint64_t  splitmix64 ( uint64_t * s )
+{
+  uint64_t  z = ( *s += 0x9E3779B97F4A7C15ULL ) ;
+  z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ULL ;
+  z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBULL ;
+  return  z ^ ( z >> 31 ) ;
+} /* splitmix64 */
+
+
+/* Choose the nA trials that are labelled condition A on permutation i.
+   The generator is seeded by the permutation number, so each permutation
+   is the same no matter which thread runs it. Indices are returned in
+   the first nA elements of idx. */
+static void  shuffle ( uint64_t seed , mwSize i , mwSize Nt , mwSize nA ,
+                       mwIndex * idx )
+{
+  mwSize  j , k ;
+  mwIndex  t ;
+  uint64_t  s = seed  ^  ( 0xD1B54A32D192ED03ULL * ( uint64_t ) ( i + 1 ) );
+  
+  for  ( j = 0 ; j < Nt ; j++ )  idx[ j ] = j ;
+  
+  /* Partial Fisher-Yates shuffle */
+  for  ( j = 0 ; j < nA ; j++ )
+  {
+    k = j  +  ( mwSize ) ( splitmix64( &s ) % ( uint64_t ) ( Nt - j ) ) ;
+    t = idx[ j ] ;  idx[ j ] = idx[ k ] ;  idx[ k ] = t ;
+  }
+} /* shuffle */
+
+
+/*-- STTC form --*/
+
+/* Sum and count of non-NaN values over the Na trials listed in A */
+static void  sttcsum ( const data_t * D , const mwIndex * A , mwSize Na ,
+                       double * s , double * n )
+{
+  mwSize  i , k ;
+  double  v ;
+  const double  * yd = ( const double * ) D->Y ;
+  const float   * ys = ( const float  * ) D->Y ;
+  
+  memset (  s  ,  0  ,  D->K * sizeof( double )  ) ;
+  memset (  n  ,  0  ,  D->K * sizeof( double )  ) ;
+  
+  for  ( i = 0 ; i < Na ; i++ )
+    
+    if  ( D->Ydbl )
+      
+      for  ( k = 0 ; k < D->K ; k++ )
+      {
+        v = yd[ k  +  A[ i ] * D->K ] ;
+        if  ( !isnan( v ) )  {  s[ k ] += v ;  n[ k ] += 1 ;  }
+      }
+    
+    else
+      
+      for  ( k = 0 ; k < D->K ; k++ )
+      {
+        v = ys[ k  +  A[ i ] * D->K ] ;
+        if  ( !isnan( v ) )  {  s[ k ] += v ;  n[ k ] += 1 ;  }
+      }
+
+} /* sttcsum */
+
+
+/* Difference of condition means , ignoring NaN. Trials in condition A are
+   listed in A. Work buffers s and n have K elements each. */
+static void  sttcstat ( const data_t * D , const mwIndex * A , double * s ,
+                        double * n , double * stat )
+{
+  mwSize  k ;
+  
+  /* Sum condition A */
+  sttcsum (  D ,  A ,  D->nA ,  s ,  n  ) ;
+  
+  /* Condition B is the rest. NaN results if either has no values. */
+  for  ( k = 0 ; k < D->K ; k++ )
+    
+    stat[ k ] = s[ k ] / n[ k ]  -
+      ( D->Ysum[ k ] - s[ k ] ) / ( D->Ycnt[ k ] - n[ k ] ) ;
+
+} /* sttcstat */
+
+
+/*-- r_CCG form --*/
+
+/* Integrate the shift-corrected correlation of clusters a and b to each
+   integration width , for one condition. p is the Q x S condition-average
+   PSTH and x is the ( T + 1 ) x U condition-average integrated
+   correlation. The shift predictor is subtracted at each lag m , just as
+   makrccg does with xcorr of the average PSTH. */
+static void  integrate ( const data_t * D , const double * p ,
+                         const double * x , mwSize a , mwSize b ,
+                         mwSize u , double * r )
+{
+  mwSize  n , m , tau ;
+  double  sp ;
+  const double  * pa = p  +  a * D->Q ;
+  const double  * pb = p  +  b * D->Q ;
+  
+  for  ( tau = 0 ; tau <= D->T ; tau++ )
+  {
+    /* Shift predictor at lag +tau and -tau */
+    for  ( sp = 0 , n = 0 ; n + tau < D->Q ; n++ )
+      sp += pa[ n + tau ]  *  pb[ n ] ;
+    
+    if  ( tau )
+      for  ( m = 0 ; m + tau < D->Q ; m++ )
+        sp += pa[ m ]  *  pb[ m + tau ] ;
+    
+    /* Accumulate over integration widths */
+    r[ tau ] = ( tau  ?  r[ tau - 1 ]  :  0 )  -  sp ;
+  }
+  
+  /* Add the integrated correlation */
+  for  ( tau = 0 ; tau <= D->T ; tau++ )
+    r[ tau ] += x[ tau  +  u * ( D->T + 1 ) ] ;
+
+} /* integrate */
+
+
+/* r_CCG of one condition at each integration width for all pairs a < b.
+   Result r is ( T + 1 ) x S x S with the integrated auto-correlations
+   on the diagonal. */
+static void  rccg ( const data_t * D , const double * p , const double * x ,
+                    double * r )
+{
+  mwSize  a , b , u , tau ;
+  const mwSize  W = D->T + 1 ;
+  
+  /* Integrated shift-corrected correlations of all pairs a <= b */
+  for  ( u = 0 , a = 0 ; a < D->S ; a++ )
+    for  ( b = a ; b < D->S ; b++ , u++ )
+      integrate (  D ,  p ,  x ,  a ,  b ,  u ,  r + W * ( a + b * D->S )  ) ;
+  
+  /* Normalise cross-correlations by the auto-correlations */
+  for  ( a = 0 ; a < D->S ; a++ )
+    for  ( b = a + 1 ; b < D->S ; b++ )
+      for  ( tau = 0 ; tau < W ; tau++ )
+        r[ tau + W * ( a + b * D->S ) ] /=
+          sqrt (  r[ tau + W * ( a + a * D->S ) ]  *
+                  r[ tau + W * ( b + b * D->S ) ]  ) ;
+
+} /* rccg */
+
+
+/* Difference of condition r_CCG. Trials in condition A are listed in A.
+   Work buffer w has room for two sets of PSTHs , correlations , and
+   r_CCG arrays. */
+static void  rccgstat ( const data_t * D , const mwIndex * A , double * w ,
+                        double * stat )
+{
+  mwSize  i , j , a , b , tau ;
+  const mwSize  Np = D->Q * D->S ;
+  const mwSize  Nx = ( D->T + 1 ) * D->U ;
+  const mwSize  Nr = ( D->T + 1 ) * D->S * D->S ;
+  const double  nA = ( double ) D->nA ;
+  const double  nB = ( double ) ( D->Nt - D->nA ) ;
+  double  * pA = w ,  * pB = pA + Np ,  * xA = pB + Np ,  * xB = xA + Nx ;
+  double  * rA = xB + Nx ,  * rB = rA + Nr ;
+  
+  /* Sum condition A */
+  for  ( j = 0 ; j < Np ; j++ )
+    for  ( pA[ j ] = 0 , i = 0 ; i < D->nA ; i++ )
+      pA[ j ] += D->P[ A[ i ]  +  j * D->Nt ] ;
+  
+  for  ( j = 0 ; j < Nx ; j++ )
+    for  ( xA[ j ] = 0 , i = 0 ; i < D->nA ; i++ )
+      xA[ j ] += D->XI[ A[ i ]  +  j * D->Nt ] ;
+  
+  /* Condition B is the rest , and then take averages */
+  for  ( j = 0 ; j < Np ; j++ )
+  {
+    pB[ j ] = ( D->Psum[ j ] - pA[ j ] ) / nB ;
+    pA[ j ] /= nA ;
+  }
+  
+  for  ( j = 0 ; j < Nx ; j++ )
+  {
+    xB[ j ] = ( D->XIsum[ j ] - xA[ j ] ) / nB ;
+    xA[ j ] /= nA ;
+  }
+  
+  /* r_CCG of each condition */
+  rccg (  D ,  pA ,  xA ,  rA  ) ;
+  rccg (  D ,  pB ,  xB ,  rB  ) ;
+  
+  /* Difference for each pair , symmetric , undefined on diagonal */
+  for  ( a = 0 ; a < D->S ; a++ )
+    for  ( b = 0 ; b < D->S ; b++ )
+      for  ( tau = 0 ; tau <= D->T ; tau++ )
+      {
+        j = a < b  ?  a + b * D->S  :  b + a * D->S ;
+        stat[ tau  +  ( D->T + 1 ) * ( a + b * D->S ) ] =  a == b  ?
+          mxGetNaN ( )  :
+          rA[ tau + ( D->T + 1 ) * j ]  -  rB[ tau + ( D->T + 1 ) * j ] ;
+      }
+
+} /* rccgstat */
+
+
+/*-- Permutations --*/
+
+/* Size of per-thread work buffer */
+static mwSize  worksize ( const data_t * D )
+{
+  if  ( D->sttc )  return  2 * D->K ;
+  return  2 * ( D->Q * D->S  +  ( D->T + 1 ) * D->U  +
+                ( D->T + 1 ) * D->S * D->S ) ;
+} /* worksize */
+
+
+/* Compute statistic for one labelling of the trials */
+static void  statistic ( const data_t * D , const mwIndex * A , double * w ,
+                         double * stat )
+{
+  if  ( D->sttc )
+    sttcstat (  D ,  A ,  w ,  w + D->K ,  stat  ) ;
+  else
+    rccgstat (  D ,  A ,  w ,  stat  ) ;
+} /* statistic */
+
+
+/* Run permutations. Observed statistic is in d. Returns two-sided p-values
+   in p , counting only permutations with a defined statistic. */
+static void  permtest ( const data_t * D , mwSize nperm , uint64_t seed ,
+                        const double * d , double * p )
+{
+  mwSize  k ;
+  
+  /* Out of memory in any thread */
+  int  err = 0 ;
+  
+  /* Number of permutations with a defined statistic , and the number at
+     least as extreme as the observed value */
+  unsigned int  * nv = mxCalloc (  D->K  ,  sizeof( unsigned int )  ) ;
+  unsigned int  * ge = mxCalloc (  D->K  ,  sizeof( unsigned int )  ) ;
+  
+  #pragma omp parallel
+  {
+    
+    /* Thread buffers */
+    mwIndex  * idx = malloc (  D->Nt * sizeof( mwIndex )  ) ;
+    double   * w = malloc (  worksize( D ) * sizeof( double )  ) ;
+    double   * s = malloc (  D->K * sizeof( double )  ) ;
+    unsigned int  * tnv = calloc (  D->K  ,  sizeof( unsigned int )  ) ;
+    unsigned int  * tge = calloc (  D->K  ,  sizeof( unsigned int )  ) ;
+    mwSignedIndex  i ;
+    mwSize  j ;
+    int  e = !idx  ||  !w  ||  !s  ||  !tnv  ||  !tge ;
+    
+    #pragma omp for schedule( static )
+    for  ( i = 0 ; i < ( mwSignedIndex ) nperm ; i++ )
+    {
+      if  ( e )  continue ;
+      
+      shuffle (  seed ,  i ,  D->Nt ,  D->nA ,  idx  ) ;
+      statistic (  D ,  idx ,  w ,  s  ) ;
+      
+      for  ( j = 0 ; j < D->K ; j++ )
+        if  ( !isnan( s[ j ] ) )
+        {
+          tnv[ j ]++ ;
+          if  ( fabs( s[ j ] )  >=  fabs( d[ j ] ) * ( 1 - TOL ) )
+            tge[ j ]++ ;
+        }
+    }
+    
+    /* Counts are integers , so the order of summation does not matter */
+    #pragma omp critical
+    {
+      for  ( j = 0 ; !e  &&  j < D->K ; j++ )
+      {
+        nv[ j ] += tnv[ j ] ;
+        ge[ j ] += tge[ j ] ;
+      }
+      err |= e ;
+    }
+    
+    free (  idx  ) ;  free (  w  ) ;  free (  s  ) ;
+    free (  tnv  ) ;  free (  tge  ) ;
+  
+  } /* parallel */
+  
+  if  ( err )
+    mexErrMsgIdAndTxt (  "MAK:makpermdiff:mem"  ,
+      "makpermdiff: out of memory"  ) ;
+  
+  /* p-values , including the observed labelling */
+  for  ( k = 0 ; k < D->K ; k++ )
+    p[ k ] = isnan( d[ k ] )  ?  mxGetNaN ( )  :
+      ( 1.0 + ge[ k ] )  /  ( 1.0 + nv[ k ] ) ;
+  
+  mxFree (  nv  ) ;  mxFree (  ge  ) ;
+
+} /* permtest */
+
+
+/*** MEX gateway function ***/
+
+void  mexFunction (  int nlhs  ,        mxArray * plhs[ ] ,
+                     int nrhs  ,  const mxArray * prhs[ ]  )
+{
+  
+  
+  /*-- Variables --*/
+  
+  /* Generic counters */
+  mwSize  i , j , a , b , u , t , tau ;
+  
+  /* Data shared by all permutations */
+  data_t  D ;
+  
+  /* Argument index of g , number of permutations , and seed */
+  int  garg ;
+  mwSize  nperm ;
+  uint64_t  seed = 0 ;
+  
+  /* Condition labels , and list of condition A trials */
+  const mxLogical  * g ;
+  mwIndex  * A ;
+  
+  /* Output dimensions */
+  mwSize  nd , dims[ 3 ] ;
+  const mwSize  * ydims ;
+  
+  /* Observed statistic , work buffer , and input arrays */
+  double  * d , * w ;
+  const double  * X ;
+  
+  
+  /*-- Input check --*/
+  
+  memset (  &D  ,  0  ,  sizeof( data_t )  ) ;
+  
+  /* Must be no more than 2 output args */
+  if  ( NARGOUT  <  nlhs )
+    
+    mexErrMsgIdAndTxt (  "MAK:makpermdiff:nargsout"  ,
+      "makpermdiff: returns at most %d output arguments"  ,  NARGOUT  ) ;
+  
+  /* Need at least Y and g */
+  else if  ( nrhs  <  NARGIN1MIN )
+    
+    mexErrMsgIdAndTxt (  "MAK:makpermdiff:nargsin"  ,
+      "makpermdiff: requires at least %d input arguments"  ,  NARGIN1MIN  );
+  
+  /* STTC form when second argument is logical */
+  D.sttc = mxIsLogical (  prhs[ 1 ]  ) ;
+  garg = D.sttc  ?  1  :  2 ;
+  
+  /* Number of input args for each form */
+  if  (  D.sttc  &&  NARGIN1MAX < nrhs  )
+    
+    mexErrMsgIdAndTxt (  "MAK:makpermdiff:nargsin"  ,
+      "makpermdiff: STTC form takes %d to %d input arguments"  ,
+      NARGIN1MIN  ,  NARGIN1MAX  ) ;
+  
+  else if  (  !D.sttc  &&  ( nrhs < NARGIN2MIN  ||  NARGIN2MAX < nrhs )  )
+    
+    mexErrMsgIdAndTxt (  "MAK:makpermdiff:nargsin"  ,
+      "makpermdiff: r_CCG form takes %d to %d input arguments"  ,
+      NARGIN2MIN  ,  NARGIN2MAX  ) ;
+  
+  /* g must be logical */
+  else if  (  !mxIsLogical( prhs[ garg ] )  )
+    
+    mexErrMsgIdAndTxt (  "MAK:makpermdiff:g"  ,
+      "makpermdiff: g must be logical"  ) ;
+  
+  /* nperm must be a positive scalar */
+  else if  (  !mxIsScalar( prhs[ garg + 1 ] )  ||
+              !mxIsNumeric( prhs[ garg + 1 ] )  ||
+              mxGetScalar( prhs[ garg + 1 ] )  <  1  )
+    
+    mexErrMsgIdAndTxt (  "MAK:makpermdiff:nperm"  ,
+      "makpermdiff: nperm must be a scalar of 1 or more"  ) ;
+  
+  /* Number of permutations */
+  nperm = ( mwSize ) mxGetScalar (  prhs[ garg + 1 ]  ) ;
+  
+  /* Optional seed */
+  if  ( garg + 2  <  nrhs )
+  {
+    if  (  !mxIsScalar( prhs[ garg + 2 ] )  ||
+           !mxIsNumeric( prhs[ garg + 2 ] )  ||
+           mxGetScalar( prhs[ garg + 2 ] )  <  0  )
+      
+      mexErrMsgIdAndTxt (  "MAK:makpermdiff:seed"  ,
+        "makpermdiff: seed must be a non-negative scalar"  ) ;
+    
+    seed = ( uint64_t ) mxGetScalar (  prhs[ garg + 2 ]  ) ;
+  }
+  
+  
+  /*-- STTC form --*/
+  
+  if  ( D.sttc )
+  {
+    
+    /* Y must be real single or double */
+    if  (  !( mxIsDouble( prhs[ 0 ] ) || mxIsSingle( prhs[ 0 ] ) )  ||
+           mxIsComplex( prhs[ 0 ] )  ||  mxIsSparse( prhs[ 0 ] )  )
+      
+      mexErrMsgIdAndTxt (  "MAK:makpermdiff:Y"  ,
+        "makpermdiff: Y must be a full, real single or double array"  ) ;
+    
+    /* Trials are the last dimension */
+    nd = mxGetNumberOfDimensions (  prhs[ 0 ]  ) ;
+    ydims = mxGetDimensions (  prhs[ 0 ]  ) ;
+    
+    /* Y( : , i ) is the set of statistics on trial i , unless Y is a row
+       vector with one statistic per trial */
+    if  ( nd == 2  &&  ydims[ 0 ] == 1 )
+    {
+      D.Nt = ydims[ 1 ] ;  D.K = 1 ;  nd = 2 ;  dims[ 0 ] = dims[ 1 ] = 1 ;
+    }
+    else
+    {
+      D.Nt = ydims[ nd - 1 ] ;
+      D.K = mxGetNumberOfElements (  prhs[ 0 ]  )  /  ( D.Nt ? D.Nt : 1 ) ;
+      nd = nd - 1 < 2  ?  2  :  nd - 1 ;
+      dims[ 1 ] = 1 ;
+      for  ( i = 0 ; i < nd ; i++ )
+        if  ( i < mxGetNumberOfDimensions( prhs[ 0 ] ) - 1 )
+          dims[ i ] = ydims[ i ] ;
+    }
+    
+    D.Y = mxGetData (  prhs[ 0 ]  ) ;
+    D.Ydbl = mxIsDouble (  prhs[ 0 ]  ) ;
+  
+  }
+  
+  
+  /*-- r_CCG form --*/
+  
+  else
+  {
+    
+    /* P and X must be real double 3D arrays from makrccg */
+    if  (  !mxIsDouble( prhs[ 0 ] )  ||  !mxIsDouble( prhs[ 1 ] )  ||
+           mxIsComplex( prhs[ 0 ] )  ||  mxIsComplex( prhs[ 1 ] )  ||
+           mxIsSparse( prhs[ 0 ] )  ||  mxIsSparse( prhs[ 1 ] )  )
+      
+      mexErrMsgIdAndTxt (  "MAK:makpermdiff:PX"  ,
+        "makpermdiff: P and X must be full, real double arrays"  ) ;
+    
+    /* Sizes */
+    ydims = mxGetDimensions (  prhs[ 0 ]  ) ;
+    D.Nt = ydims[ 0 ] ;
+    D.Q  = mxGetNumberOfDimensions( prhs[ 0 ] ) < 2  ?  1  :  ydims[ 1 ] ;
+    D.S  = mxGetNumberOfDimensions( prhs[ 0 ] ) < 3  ?  1  :  ydims[ 2 ] ;
+    D.U  = D.S * ( D.S + 1 ) / 2 ;
+    D.T  = D.Q - 1 ;
+    
+    /* X must be Nt x ( 2Q - 1 ) x S ^ 2 */
+    if  (  mxGetM( prhs[ 1 ] ) != D.Nt  ||
+           mxGetNumberOfElements( prhs[ 1 ] ) !=
+             D.Nt * ( 2 * D.Q - 1 ) * D.S * D.S  ||  D.S < 2  )
+      
+      mexErrMsgIdAndTxt (  "MAK:makpermdiff:Xsize"  ,
+        "makpermdiff: P and X must be returned by makrccg for 2 or more "
+        "spike clusters"  ) ;
+    
+    /* Optional maximum integration width */
+    if  ( garg + 3  <  nrhs )
+    {
+      if  (  !mxIsScalar( prhs[ garg + 3 ] )  ||
+             !mxIsNumeric( prhs[ garg + 3 ] )  ||
+             mxGetScalar( prhs[ garg + 3 ] ) < 0  ||
+             ( double ) D.T < mxGetScalar( prhs[ garg + 3 ] )  )
+        
+        mexErrMsgIdAndTxt (  "MAK:makpermdiff:maxtau"  ,
+          "makpermdiff: maxtau must be a scalar from 0 to %d"  ,
+          ( int ) D.T  ) ;
+      
+      D.T = ( mwSize ) mxGetScalar (  prhs[ garg + 3 ]  ) ;
+    }
+    
+    D.K = ( D.T + 1 ) * D.S * D.S ;
+    D.P = mxGetPr (  prhs[ 0 ]  ) ;
+    X = mxGetPr (  prhs[ 1 ]  ) ;
+    
+    /* Output dimensions */
+    nd = 3 ;
+    dims[ 0 ] = D.T + 1 ;  dims[ 1 ] = dims[ 2 ] = D.S ;
+    
+    /* Integrate each trial's correlations once , for pairs a <= b. X has
+       lags -( Q - 1 ) to Q - 1 along dim 2 and column a * S + b along dim
+       3. The sum over lags +/-m is the same for either column order. */
+    D.XI = mxMalloc (  D.Nt * ( D.T + 1 ) * D.U * sizeof( double )  ) ;
+    
+    for  ( u = 0 , a = 0 ; a < D.S ; a++ )
+      for  ( b = a ; b < D.S ; b++ , u++ )
+        for  ( t = 0 ; t < D.Nt ; t++ )
+        {
+          const double  * x = X  +  t  +
+            D.Nt * ( 2 * D.Q - 1 ) * ( a * D.S + b ) ;
+          double  * xi = D.XI  +  t  +  D.Nt * ( D.T + 1 ) * u ;
+          
+          for  ( tau = 0 ; tau <= D.T ; tau++ )
+            xi[ D.Nt * tau ] = ( tau ? xi[ D.Nt * ( tau - 1 ) ] : 0 )  +
+              ( tau  ?  x[ D.Nt * ( D.Q - 1 - tau ) ]  +
+                        x[ D.Nt * ( D.Q - 1 + tau ) ]
+                     :  x[ D.Nt * ( D.Q - 1 ) ] ) ;
+        }
+    
+    /* Sums over all trials */
+    D.Psum  = mxCalloc (  D.Q * D.S  ,  sizeof( double )  ) ;
+    D.XIsum = mxCalloc (  ( D.T + 1 ) * D.U  ,  sizeof( double )  ) ;
+    
+    for  ( j = 0 ; j < D.Q * D.S ; j++ )
+      for  ( t = 0 ; t < D.Nt ; t++ )
+        D.Psum[ j ] += D.P[ t  +  j * D.Nt ] ;
+    
+    for  ( j = 0 ; j < ( D.T + 1 ) * D.U ; j++ )
+      for  ( t = 0 ; t < D.Nt ; t++ )
+        D.XIsum[ j ] += D.XI[ t  +  j * D.Nt ] ;
+  
+  }
+  
+  
+  /*-- Condition labels --*/
+  
+  /* One label per trial */
+  if  ( mxGetNumberOfElements( prhs[ garg ] )  !=  D.Nt )
+    
+    mexErrMsgIdAndTxt (  "MAK:makpermdiff:gnumel"  ,
+      "makpermdiff: g must have one element per trial"  ) ;
+  
+  /* List condition A trials */
+  g = mxGetLogicals (  prhs[ garg ]  ) ;
+  A = mxMalloc (  ( D.Nt ? D.Nt : 1 ) * sizeof( mwIndex )  ) ;
+  
+  for  ( D.nA = 0 , t = 0 ; t < D.Nt ; t++ )
+    if  ( g[ t ] )  A[ D.nA++ ] = t ;
+  
+  /* Both conditions need trials */
+  if  ( D.nA == 0  ||  D.nA == D.Nt )
+    
+    mexErrMsgIdAndTxt (  "MAK:makpermdiff:gcond"  ,
+      "makpermdiff: g must have both true and false values"  ) ;
+  
+  
+  /*-- Observed statistic --*/
+  
+  /* Sums over all trials for STTC form */
+  if  ( D.sttc )
+  {
+    mwIndex  * all = mxMalloc (  D.Nt * sizeof( mwIndex )  ) ;
+    for  ( t = 0 ; t < D.Nt ; t++ )  all[ t ] = t ;
+    D.Ysum = mxMalloc (  D.K * sizeof( double )  ) ;
+    D.Ycnt = mxMalloc (  D.K * sizeof( double )  ) ;
+    sttcsum (  &D ,  all ,  D.Nt ,  D.Ysum ,  D.Ycnt  ) ;
+    mxFree (  all  ) ;
+  }
+  
+  /* Observed labelling */
+  d = mxMalloc (  D.K * sizeof( double )  ) ;
+  w = mxMalloc (  worksize( &D ) * sizeof( double )  ) ;
+  statistic (  &D ,  A ,  w ,  d  ) ;
+  
+  
+  /*-- Permutations --*/
+  
+  plhs[ POUT ] = mxCreateNumericArray (  nd  ,  dims  ,  mxDOUBLE_CLASS  ,
+    mxREAL  ) ;
+  permtest (  &D ,  nperm ,  seed ,  d ,  mxGetPr( plhs[ POUT ] )  ) ;
+  
+  /* Return observed difference */
+  if  ( 1  <  nlhs )
+  {
+    plhs[ DOUT ] = mxCreateNumericArray (  nd  ,  dims  ,  mxDOUBLE_CLASS  ,
+      mxREAL  ) ;
+    memcpy (  mxGetPr( plhs[ DOUT ] )  ,  d  ,  D.K * sizeof( double )  ) ;
+  }
+  
+  /* Free memory */
+  mxFree (  A  ) ;  mxFree (  d  ) ;  mxFree (  w  ) ;
+  if  ( D.sttc )  {  mxFree (  D.Ysum  ) ;  mxFree (  D.Ycnt  ) ;  }
+  else  {  mxFree (  D.XI  ) ;  mxFree (  D.Psum  ) ;
+           mxFree (  D.XIsum  ) ;  }
+
+
+} /* mexFunction */
+
@@ -0,0 +1,52 @@
+
+% [ p , d ] = makpermdiff ( Y , g , nperm , seed )
+% [ p , d ] = makpermdiff ( P , X , g , nperm , seed , maxtau )
+% 
+% MET Analysis Kit, general analysis. Permutation test for a difference in
+% spike train correlation between two conditions. Per-trial terms are
+% computed once by maksttc or makrccg. On each permutation, the condition
+% labels are shuffled and the per-trial terms are only summed again by
+% group. Nothing is computed again from the spike times.
+% 
+% The first form takes per-trial STTC values Y from maksttc, with trials
+% indexed over the last dimension ; for example, the W x Np x Nt output of
+% maksttc for W time windows and Np pairs of spike trains. Y may be single
+% or double. g is a logical vector with one element per trial that is true
+% for trials in condition A and false for those in condition B. The
+% statistic is the mean of condition A minus the mean of condition B,
+% ignoring NaN values. p and d have the size of Y without its last
+% dimension.
+% 
+% The second form takes P and X, the per-trial PSTHs and auto- and cross-
+% correlations returned by makrccg when it is given a window. These must
+% be double. The statistic is the r_CCG of condition A minus that of
+% condition B, at integration widths of 0 to maxtau milliseconds. The
+% shift predictor is computed from the average PSTHs of each group, so
+% that part is done again for each permutation. Default maxtau is the
+% longest lag available in X ; a smaller value makes the test faster. p
+% and d are ( maxtau + 1 ) x S x S for S spike clusters, with NaN on the
+% diagonal.
+% 
+% nperm is the number of permutations. p is the two-sided permutation
+% p-value of each statistic, that is the fraction of permutations with an
+% absolute difference that is at least as large as the observed one,
+% counting the observed labels as one permutation. A relative tolerance of
+% 1e-12 allows for the order in which trials are summed. d is the observed
+% difference. p is NaN where d is NaN. seed is a non-negative integer that
+% seeds the random number generator, default 0. The same seed gives the
+% same p for any number of threads.
+% 
+% If MEX is compiled with OpenMP then permutations are divided between
+% threads, e.g.
+% 
+%   mex CFLAGS='$CFLAGS -fopenmp' LDFLAGS='$LDFLAGS -fopenmp' makpermdiff.c
+% 
+% Otherwise, it runs on a single thread.
+% 
+% References:
+% 
+% Bair W, Zohary E, Newsome WT. J Neurosci. 2001 Mar 1;21(5):1676-97.
+% Cutts CS, Eglen SJ. J Neurosci. 2014 Oct 22;34(43):14288-303.
+% Maris E, Oostenveld R. J Neurosci Methods. 2007 Aug 15;164(1):177-90.
+% 
+% Written by Jackson Smith - October 2026 - ESI (Fries Lab)
@@ -0,0 +1,729 @@
+
+function  varargout = makplan (  varargin  )
+% 
+% plan = makplan (  cap  ,  fun  ,  ...  )
+% makplan (  cap  ,  fun  ,  ...  )
+% [ y , ... ] = makplan (  plan  )
+% 
+% MET Analysis Kit. Predicts the peak memory and the run time of a call to
+% one of the heavier MAK functions, before it is made. If the call will not
+% fit within a memory cap, then makplan chooses another way of making it
+% that will.
+% 
+% cap is the memory cap in bytes. fun is the name of the function to plan
+% for, and the remaining inputs are the same inputs that will be given to
+% fun. For example, makplan (  8e9  ,  'maksttc'  ,  w  ,  maxdt  ,  C  ).
+% Spike trains and signals are only used to count spikes and array sizes.
+% Spike trains may be packed by makspkpack, when fun accepts that.
+% Without an output argument, makplan prints the plan in the command window
+% and does nothing else ; this is a dry run. Otherwise, the plan struct is
+% returned. makplan (  plan  ) carries out the plan and returns the same
+% outputs as fun.
+% 
+% 
+% Cost models
+% 
+% Peak memory counts the arrays that fun allocates, but not its inputs.
+% Parallel workers each hold their own copy of broadcast and reduction
+% variables, so the number of workers matters. This is the size of the
+% current parallel pool, or the number of cores if there is none. MEX
+% functions use one thread per core. Run time is the predicted number of
+% operations divided by the number of operations per second of one core,
+% from maktune, and by the number of workers or threads. Run maktune (
+% 'run'  ) first, so that times are calibrated to this computer. The
+% predictions are rough, to within a factor of about two.
+% 
+%   maksttc - Output W x Np x T single for W delta-t values, Np pairs of
+%     clusters and T trials, plus the W x M x T table of tiled proportions
+%     for M clusters. The table is broadcast to every worker, twice. Only
+%     the forms that return sttc and dt from w and maxdt are planned. The
+%     Tab, Fi, N forms are refused, with 5 inputs or with 3 outputs.
+% 
+%   makpopsttc - Output W x M x T single.
+% 
+%   makspkdist - Output P x Np x T double for P parameter values.
+% 
+%   makrccg2 - Each worker sums the L x N x N cross-correlations of its
+%     trials in two parts, for L = 2M - 1 lags and N neurones, and holds
+%     both parts of one more trial. Three more arrays of about this size
+%     are used at the end.
+% 
+%   makenergymat - Each worker holds the distances between a tile of
+%     spikes from one cluster and all spikes from another, twice in double
+%     precision. Pruning is ignored, so this is an upper bound.
+% 
+% 
+% Plans
+% 
+% If the direct call fits within cap then that is the plan. Otherwise, one
+% of these is chosen:
+% 
+%   chunk - maksttc, makpopsttc, or makspkdist is called on chunks of
+%     consecutive trials, as many at a time as will fit.
+% 
+%   reduce - makrccg2 is run with fewer parallel workers, so that fewer
+%     copies of its sum are kept.
+% 
+%   block - makrccg2 is called on each pair of blocks of neurones, with no
+%     parallel workers. The r_CCG of two neurones does not depend on any
+%     other neurone, so the result is the same.
+% 
+%   tile - makenergymat is run with fewer spikes per tile of distances than
+%     in this computer's maktune profile.
+% 
+% If the output of fun is too big to fit within cap then chunk and block
+% plans write it to a MAT file, out-of-core. makplan (  plan  ) then
+% returns a matfile object, and the output is its variable y. If no plan
+% fits then the one with the smallest peak is returned.
+% 
+% 
+% Plan struct
+% 
+% plan is a struct with fields:
+% 
+%   .fun - Name of the function.
+% 
+%   .args - Cell array of its inputs.
+% 
+%   .cap - Memory cap, in bytes.
+% 
+%   .mem - Predicted peak memory of the direct call, in bytes.
+% 
+%   .time - Predicted run time of the direct call, in seconds.
+% 
+%   .mode - The plan, one of 'direct', 'chunk', 'reduce', 'block', or
+%     'tile'.
+% 
+%   .peak - Predicted peak memory of the plan, in bytes.
+% 
+%   .ptime - Predicted run time of the plan, in seconds.
+% 
+%   .fits - True if .peak is no more than .cap.
+% 
+%   .chunk - Cell array with the trial indices of each chunk, or the
+%     neurone indices of each block. Empty for other plans.
+% 
+%   .workers - Number of parallel workers or threads.
+% 
+%   .tile - Number of spikes per tile, for makenergymat.
+% 
+%   .size - Size of the output.
+% 
+%   .class - Class of the output.
+% 
+%   .file - Name of the MAT file that takes the output, or empty if it is
+%     kept in memory. A temporary file name is chosen, and it can be
+%     changed before the plan is carried out.
+% 
+% Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+% 
+  
+  
+  %%% Global constants %%%
+  
+  % Functions that have a cost model
+  FUNS = { 'maksttc' , 'makpopsttc' , 'makspkdist' , 'makrccg2' , ...
+    'makenergymat' } ;
+  
+  
+  %%% Carry out a plan %%%
+  
+  if  nargin  ==  1  &&  isstruct (  varargin{ 1 }  )
+    
+    varargout = cell (  1  ,  max( nargout , 1 )  ) ;
+    [ varargout{ : } ] = runplan (  varargin{ 1 }  ) ;
+    return
+  
+  end
+  
+  
+  %%% Check input %%%
+   
+   narginchk (  3  ,  Inf  )
+  nargoutchk (  0  ,  1  )
+  
+  % Name inputs
+  [ cap , fun ] = varargin{ 1 : 2 } ;
+  args = varargin( 3 : end ) ;
+  
+  % cap must be a positive real scalar
+  if  ~ isscalar (  cap  )  ||  ~ isnumeric (  cap  )  ||  ...
+      ~ isreal (  cap  )  ||  cap  <=  0
+    
+    error (  'MAK:makplan:cap'  ,  ...
+      'makplan: cap must be a positive real scalar'  )
+  
+  % fun must name a function with a cost model
+  elseif  ~ ischar (  fun  )  ||  ~ any (  strcmp(  fun  ,  FUNS  )  )
+    
+    error (  'MAK:makplan:fun'  ,  'makplan: fun must be one of: %s'  ,  ...
+      strjoin (  FUNS  ,  ', '  )  )
+  
+  % The ( Tab , Fi , N , A , B ) form of maksttc has no cost model
+  elseif  strcmp (  fun  ,  'maksttc'  )  &&  numel (  args  )  ==  5
+    
+    error (  'MAK:makplan:form'  ,  ...
+      'makplan: cannot plan maksttc (  Tab  ,  Fi  ,  N  ,  A  ,  B  )'  )
+  
+  end % check input
+  
+  
+  %%% Preparation %%%
+  
+  % Number of cores , for MEX threads
+  nc = feature (  'numcores'  ) ;
+  
+  % Number of parallel workers
+  pool = gcp (  'nocreate'  ) ;
+  
+  if  isempty (  pool  )
+    nw = nc ;
+  else
+    nw = pool.NumWorkers ;
+  end
+  
+  % Operations per second of one core
+  tune = maktune ;
+  ops1 = tune.opsrate ;
+  
+  % Plan of the direct call
+  plan = struct (  'fun'  ,  fun  ,  'args'  ,  { args }  ,  ...
+    'cap'  ,  cap  ,  'mem'  ,  0  ,  'time'  ,  0  ,  ...
+    'mode'  ,  'direct'  ,  'peak'  ,  0  ,  'ptime'  ,  0  ,  ...
+    'fits'  ,  true  ,  'chunk'  ,  { {} }  ,  'workers'  ,  nw  ,  ...
+    'tile'  ,  tune.energytile  ,  'size'  ,  [ ]  ,  'class'  ,  ''  ,  ...
+    'file'  ,  ''  ) ;
+  
+  
+  %%% Cost models %%%
+  
+  switch  fun
+    
+    % Functions over trials of spike trains
+    case  { 'maksttc' , 'makpopsttc' , 'makspkdist' }
+      
+      % Spike trains , trials over rows and clusters over columns
+      [ C , ab ] = spktrains (  fun  ,  args  ) ;
+      
+      if  isstruct (  C  )
+        T = C.size( 1 ) ;
+        M = C.size( 2 ) ;
+      else
+        [ T , M ] = size (  C  ) ;
+      end
+      
+      % Spike counts , and the total of each trial
+      n = spkcount (  C  ) ;
+      S = sum (  n  ,  2  ) ;
+      
+      % Number of pairs of clusters
+      Np = ( M ^ 2  -  M )  /  2 ;
+      
+      % Bytes of output per trial o , and of other arrays per trial b
+      switch  fun
+        
+        case  'maksttc'
+          
+          W = ndt (  args{ 1 : 2 }  ) ;
+          o = 4 * W * Np ;
+          b = 4 * W * M  *  ( 1  +  2 * nw ) ;
+          ops = W * Np * T  +  ( M - 1 ) * sum (  S  ) ;
+          plan.class = 'single' ;
+          plan.size = W ;
+        
+        case  'makpopsttc'
+          
+          W = ndt (  args{ 1 : 2 }  ) ;
+          o = 4 * W * M ;
+          b = 0 ;
+          ops = W * M * T  +  sum (  S  )  *  log2 (  M  ) ;
+          plan.workers = nc ;
+          plan.class = 'single' ;
+          plan.size = W ;
+        
+        case  'makspkdist'
+          
+          P = numel (  args{ 2 }  ) ;
+          o = 8 * P * Np ;
+          b = 0 ;
+          plan.workers = nc ;
+          plan.class = 'double' ;
+          plan.size = P ;
+          
+          % Victor-Purpura visits every pair of spikes from two trains ,
+          % van Rossum visits every spike once per pair
+          if  strcmp (  args{ 1 }  ,  'vp'  )
+            ops = P  *  sum (  ( S .^ 2  -  sum( n .^ 2 , 2 ) )  /  2  ) ;
+          else
+            ops = P  *  ( M - 1 )  *  sum (  S  ) ;
+          end
+      
+      end % bytes
+      
+      % Output size , with a P x T or W x T output for A and B
+      if  ab
+        plan.size = [  plan.size  ,  T  ] ;
+      elseif  strcmp (  fun  ,  'makpopsttc'  )
+        plan.size = [  plan.size  ,  M  ,  T  ] ;
+      else
+        plan.size = [  plan.size  ,  Np  ,  T  ] ;
+      end
+      
+      % Run time is the same for every chunk
+      plan.time = ops  /  ( ops1 * plan.workers ) ;
+      plan.ptime = plan.time ;
+      
+      % Plan chunks of trials
+      plan = trialchunks (  plan  ,  T  ,  o  ,  b  ) ;
+    
+    % Cross-correlations , summed over trials
+    case  'makrccg2'
+      
+      % Signals , and bytes per element
+      X = args{ 1 } ;
+      [ M , N , T ] = size (  X  ) ;
+      e = nbytes (  X  ) ;
+      plan.class = class (  X  ) ;
+      plan.size = [  M  ,  N  ,  N  ] ;
+      
+      % Number of lags , and of FFT points
+      L = 2 * M  -  1 ;
+      L2 = 2  ^  ceil (  log2( L )  ) ;
+      
+      % Bytes of one L x N x N array
+      a = e * L * N ^ 2 ;
+      
+      % FFT of each neurone , and inverse FFT of each pair , in each trial
+      % and in the average
+      ops = rccgops (  T  ,  L2  ,  N  ) ;
+      
+      % Direct call
+      plan.mem = a  *  ( 4 * nw  +  3 ) ;
+      plan.time = ops  /  ( ops1 * nw ) ;
+      plan.peak = plan.mem ;
+      plan.ptime = plan.time ;
+      
+      % Does not fit , try fewer workers
+      w = floor (  ( cap / a  -  3 )  /  4  ) ;
+      
+      if  plan.mem  <=  cap
+        
+        % Direct call fits
+      
+      elseif  w  >=  1
+        
+        plan.mode = 'reduce' ;
+        plan.workers = w ;
+        plan.peak = a  *  ( 4 * w  +  3 ) ;
+        plan.ptime = ops  /  ( ops1 * w ) ;
+      
+      % Blocks of neurones , each pair of blocks called on the client
+      else
+        
+        plan.mode = 'block' ;
+        plan.workers = 0 ;
+        
+        % Output is kept in memory , if there is room
+        o = e * M * N ^ 2 ;
+        
+        if  o  >=  cap
+          o = 0 ;
+          plan.file = [  tempname  ,  '.mat'  ] ;
+        end
+        
+        % Largest block for which a call on two blocks fits
+        B = max (  1  ,  floor( sqrt(  ( cap - o ) / ( 7 * e * L )  ) / 2 )  );
+        B = min (  B  ,  N  ) ;
+        plan.chunk = arrayfun (  @( i ) i : min( i + B - 1 , N )  ,  ...
+          1 : B : N  ,  'UniformOutput'  ,  false  ) ;
+        
+        % Number of blocks , and pairs of blocks
+        K = numel (  plan.chunk  ) ;
+        K = ( K ^ 2  +  K )  /  2 ;
+        
+        plan.peak = o  +  7 * e * L * ( 2 * B ) ^ 2 ;
+        plan.ptime = K * rccgops (  T  ,  L2  ,  2 * B  )  /  ops1 ;
+      
+      end % plans
+    
+    % Interface energy of all pairs of clusters
+    case  'makenergymat'
+      
+      % Cluster sizes , largest first , and spike components
+      n = sort (  double( args{ 1 }( : ) )  ,  'descend'  ) ;
+      c = args{ 3 } ;
+      e = nbytes (  c  ) ;
+      plan.class = 'double' ;
+      plan.size = [  numel( n )  ,  numel( n )  ] ;
+      
+      % Bytes per worker , per spike in a tile , against the biggest
+      % cluster
+      r = n( 1 )  *  ( e  +  16 ) ;
+      
+      % Spikes are grouped by cluster , a copy of c
+      base = e  *  numel (  c  ) ;
+      
+      % Pairwise distances of all pairs of clusters , each with one
+      % subtraction and multiply-add per component , and one exp( )
+      ops = ( sum( n ) ^ 2  +  sum( n .^ 2 ) )  /  2  *  ...
+        ( 3 * size( c , 1 )  +  1 ) ;
+      
+      % Direct call
+      plan.mem = base  +  nw * min( tune.energytile , n( 1 ) ) * r ;
+      plan.time = ops  /  ( ops1 * nw ) ;
+      plan.peak = plan.mem ;
+      plan.ptime = plan.time ;
+      
+      % Does not fit , fewer spikes per tile
+      if  plan.mem  >  cap
+        
+        plan.mode = 'tile' ;
+        plan.tile = max (  1  ,  floor( ( cap - base ) / ( nw * r ) )  ) ;
+        plan.peak = base  +  nw * plan.tile * r ;
+      
+      end
+  
+  end % cost models
+  
+  % Plan fits within the cap
+  plan.fits = plan.peak  <=  cap ;
+  
+  
+  %%% Output %%%
+  
+  % Dry run
+  if  nargout  ==  0
+    printplan (  plan  )
+  else
+    varargout{ 1 } = plan ;
+  end
+  
+  
+end % makplan
+  
+  
+%%% Sub-routines %%%
+  
+% Spike trains of maksttc , makpopsttc , or makspkdist , trials over rows
+% and clusters over columns. ab is true for the A and B form.
+function  [ C , ab ] = spktrains (  fun  ,  args  )
+  
+  % Number of inputs of the A and B form
+  switch  fun
+    case  'maksttc'     ,  ab = numel (  args  )  ==  4 ;
+    case  'makspkdist'  ,  ab = numel (  args  )  ==  5 ;
+    otherwise           ,  ab = false ;
+  end
+  
+  % Spike trains
+  if  ab
+    C = [  args{ end - 1 }( : )  ,  args{ end }( : )  ] ;
+  else
+    C = args{ end } ;
+  end
+  
+end % spktrains
+  
+  
+% Number of spikes in each spike train of C , a cell array or packed spike
+% trains from makspkpack
+function  n = spkcount (  C  )
+  
+  if  isstruct (  C  )
+    n = reshape (  diff( C.off )  ,  C.size  ) ;
+  else
+    n = cellfun (  @numel  ,  C  ) ;
+  end
+  
+end % spkcount
+  
+  
+% Number of delta-t values , as in maksttc
+function  W = ndt (  w  ,  maxdt  )
+  
+  W = ceil (  round( diff( w ) , 6 )  *  1000  ) ;
+  if  ~ isempty (  maxdt  )  ,  W = min (  maxdt  ,  W  ) ;  end
+  W = W  +  1 ;
+  
+end % ndt
+  
+  
+% Bytes per element of numeric array x
+function  e = nbytes (  x  )
+  
+  e = numel ( typecast(  zeros( 1 , class( x ) )  ,  'uint8'  ) ) ;
+  
+end % nbytes
+  
+  
+% Operations of makrccg2 on T trials of N neurones with L2 FFT points
+function  ops = rccgops (  T  ,  L2  ,  N  )
+  
+  ops = ( T + 1 ) * L2 * log2( L2 ) * ( N  +  ( N ^ 2  +  N ) / 2 ) ;
+  
+end % rccgops
+  
+  
+% Chunks of consecutive trials. T trials , each with o bytes of output and
+% b bytes of other arrays.
+function  plan = trialchunks (  plan  ,  T  ,  o  ,  b  )
+  
+  % Direct call
+  plan.mem = T  *  ( o + b ) ;
+  plan.peak = plan.mem ;
+  
+  if  plan.mem  <=  plan.cap  ,  return  ,  end
+  
+  % Output is kept in memory , with chunks in the rest
+  out = T * o ;
+  n = floor (  ( plan.cap - out )  /  ( o + b )  ) ;
+  
+  % No room , write output to file and give all of cap to chunks
+  if  n  <  1
+    out = 0 ;
+    n = max (  1  ,  floor( plan.cap / ( o + b ) )  ) ;
+    plan.file = [  tempname  ,  '.mat'  ] ;
+  end
+  
+  plan.mode = 'chunk' ;
+  plan.chunk = arrayfun (  @( i ) i : min( i + n - 1 , T )  ,  ...
+    1 : n : T  ,  'UniformOutput'  ,  false  ) ;
+  plan.peak = out  +  n * ( o + b ) ;
+  
+end % trialchunks
+  
+  
+% Carries out a plan
+function  varargout = runplan (  plan  )
+  
+  % Function and its inputs
+  fun = str2func (  plan.fun  ) ;
+  args = plan.args ;
+  
+  % Number of outputs
+  nout = max (  nargout  ,  1  ) ;
+  varargout = cell (  1  ,  nout  ) ;
+  
+  % Tab , Fi , and N are not sttc , and were not planned
+  if  strcmp (  plan.fun  ,  'maksttc'  )  &&  nout  ==  3
+    
+    error (  'MAK:makplan:form'  ,  ...
+      'makplan: cannot carry out [ Tab , Fi , N ] = maksttc (  ...  )'  )
+    
+  end
+  
+  switch  plan.mode
+    
+    case  'direct'
+      
+      [ varargout{ : } ] = fun (  args{ : }  ) ;
+    
+    % Fewer workers for makrccg2
+    case  'reduce'
+      
+      if  numel (  args  )  <  2  ,  args{ 2 } = true ;  end
+      args{ 3 } = plan.workers ;
+      [ varargout{ : } ] = fun (  args{ : }  ) ;
+    
+    % Smaller tiles for makenergymat , profile restored afterwards
+    case  'tile'
+      
+      p = maktune ;
+      q = p ;
+      q.energytile = plan.tile ;
+      maktune (  q  ) ;
+      
+      c = onCleanup (  @( ) maktune( p )  ) ;
+      [ varargout{ : } ] = fun (  args{ : }  ) ;
+    
+    % Output is built in parts
+    case  { 'chunk' , 'block' }
+      
+      % In memory
+      if  isempty (  plan.file  )
+        
+        y = zeros (  plan.size  ,  plan.class  ) ;
+      
+      % Out-of-core , set the size of y first
+      else
+        
+        y = matfile (  plan.file  ,  'Writable'  ,  true  ) ;
+        s = num2cell (  plan.size  ) ;
+        y.y( s{ : } ) = zeros (  1  ,  plan.class  ) ;
+      
+      end
+      
+      if  strcmp (  plan.mode  ,  'chunk'  )
+        y = runchunks (  plan  ,  fun  ,  args  ,  y  ,  nout  ) ;
+      else
+        y = runblocks (  plan  ,  fun  ,  args  ,  y  ) ;
+      end
+      
+      varargout( 1 : numel( y ) ) = y ;
+  
+  end % plan
+  
+end % runplan
+  
+  
+% Calls fun on each chunk of trials. y is the output , or a matfile
+% object. Returns a cell array with y and the other outputs of the first
+% chunk.
+function  y = runchunks (  plan  ,  fun  ,  args  ,  y  ,  nout  )
+  
+  % Spike trains are the last input , or the last two for A and B
+  [ ~ , ab ] = spktrains (  plan.fun  ,  args  ) ;
+  k = numel (  args  )  -  ab  :  numel (  args  ) ;
+  
+  % Packed spike trains are unpacked once , to index trials. fun would
+  % unpack them anyway.
+  for  j = k
+    if  isstruct (  args{ j }  )
+      args{ j } = makspkpack (  args{ j }  ) ;
+    end
+  end
+  
+  % Outputs of one chunk
+  r = cell (  1  ,  nout  ) ;
+  
+  for  i = 1 : numel (  plan.chunk  )
+    
+    % Trials of this chunk
+    t = plan.chunk{ i } ;
+    a = args ;
+    
+    for  j = k
+      if  ab
+        a{ j } = a{ j }( t ) ;
+      else
+        a{ j } = a{ j }( t , : ) ;
+      end
+    end
+    
+    [ r{ : } ] = fun (  a{ : }  ) ;
+    
+    % Assign trials , trials are the last dimension
+    if  isnumeric (  y  )  &&  ab
+      y( : , t ) = r{ 1 } ;
+    elseif  isnumeric (  y  )
+      y( : , : , t ) = r{ 1 } ;
+    elseif  ab
+      y.y( : , t ) = r{ 1 } ;
+    else
+      y.y( : , : , t ) = r{ 1 } ;
+    end
+    
+    % Other outputs are the same for all chunks
+    if  i  ==  1  ,  o = r( 2 : end ) ;  end
+  
+  end % chunks
+  
+  y = [  { y }  ,  o  ] ;
+  
+end % runchunks
+  
+  
+% Calls makrccg2 on each pair of blocks of neurones. y is the output , or a
+% matfile object. Returns a cell array with y.
+function  y = runblocks (  plan  ,  fun  ,  args  ,  y  )
+  
+  % No workers
+  if  numel (  args  )  <  2  ,  args{ 2 } = true ;  end
+  args{ 3 } = plan.workers ;
+  
+  % Signals
+  X = args{ 1 } ;
+  B = plan.chunk ;
+  
+  for  i = 1 : numel (  B  )
+    for  j = i : numel (  B  )
+      
+      % Neurones of both blocks , and their columns of r
+      if  i  ==  j
+        n = B{ i } ;
+        I = 1 : numel (  n  ) ;
+        J = I ;
+      else
+        n = [  B{ i }  ,  B{ j }  ] ;
+        I = 1 : numel (  B{ i }  ) ;
+        J = numel (  B{ i }  )  +  ( 1 : numel( B{ j } ) ) ;
+      end
+      
+      args{ 1 } = X(  :  ,  n  ,  :  ) ;
+      r = fun (  args{ : }  ) ;
+      
+      % Assign both halves of the symmetric matrix
+      if  isnumeric (  y  )
+        y( : , B{ i } , B{ j } ) = r( : , I , J ) ;
+        y( : , B{ j } , B{ i } ) = r( : , J , I ) ;
+      else
+        y.y( : , B{ i } , B{ j } ) = r( : , I , J ) ;
+        y.y( : , B{ j } , B{ i } ) = r( : , J , I ) ;
+      end
+    
+    end % block j
+  end % block i
+  
+  y = { y } ;
+  
+end % runblocks
+  
+  
+% Prints the plan
+function  printplan (  p  )
+  
+  % Bytes per gigabyte
+  GB = 2 ^ 30 ;
+  
+  % Describe the plan
+  switch  p.mode
+    
+    case  'direct'  ,  s = 'direct call' ;
+    
+    case  'chunk'
+      s = sprintf (  '%d chunks of up to %d trials'  ,  ...
+        numel( p.chunk )  ,  numel( p.chunk{ 1 } )  ) ;
+    
+    case  'reduce'
+      s = sprintf (  '%d parallel workers'  ,  p.workers  ) ;
+    
+    case  'block'
+      s = sprintf (  '%d blocks of up to %d neurones, no workers'  ,  ...
+        numel( p.chunk )  ,  numel( p.chunk{ 1 } )  ) ;
+    
+    case  'tile'
+      s = sprintf (  '%d spikes per tile'  ,  p.tile  ) ;
+  
+  end % describe
+  
+  fprintf (  '%s plan , memory cap %.2f GB\n'  ,  p.fun  ,  p.cap / GB  )
+  fprintf (  '  direct call : peak %.2f GB , about %s\n'  ,  ...
+    p.mem / GB  ,  tstr( p.time )  )
+  fprintf (  '  plan        : %s\n'  ,  s  )
+  fprintf (  '  planned     : peak %.2f GB , about %s\n'  ,  ...
+    p.peak / GB  ,  tstr( p.ptime )  )
+  
+  if  ~ isempty (  p.file  )
+    fprintf (  '  out-of-core : %s\n'  ,  p.file  )
+  end
+  
+  if  ~ p.fits
+    fprintf (  '  no plan fits within the memory cap\n'  )
+  end
+  
+end % printplan
+  
+  
+% Run time as a string
+function  s = tstr (  t  )
+  
+  if  t  <  120
+    s = sprintf (  '%.1f s'  ,  t  ) ;
+  elseif  t  <  7200
+    s = sprintf (  '%.1f min'  ,  t / 60  ) ;
+  else
+    s = sprintf (  '%.1f h'  ,  t / 3600  ) ;
+  end
+  
+end % tstr
+
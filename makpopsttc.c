@@ -0,0 +1,696 @@
+
+/*  makpopsttc
+  
+  [ sttc , dt ] = makpopsttc ( w , maxdt , C )
+  [ sttc , dt ] = makpopsttc ( w , maxdt , C , cls )
+  
+  MET Analysis Kit. Population coupling measured with the spike time tiling
+  coefficient ( STTC ) of Cutts and Eglen ( 2014 ). For each neurone/spike-
+  cluster , STTC is computed between its spike train and the pooled spike
+  train of all other neurones/spike-clusters on the same trial. This is
+  the same as giving maksttc a merged rest-of-population train for each
+  cluster in turn , but all spike trains of a trial are merged only once.
+  
+  w , maxdt , and C are the same as for maksttc ( w , maxdt , C ). C must
+  have at least 2 columns. sttc is a W x M x T single matrix of STTC values
+  for W delta-t values , M clusters , and T trials. sttc( : , a , i ) is
+  the coupling of cluster a to the population on trial i. It is NaN if
+  either cluster a or the rest of the population has no spikes in the
+  analysis window. dt returns the delta-t values in milliseconds.
+  
+  cls is optional , either 'single' ( default ) or 'int16'. If 'int16'
+  then sttc is an int16 matrix of fixed-point STTC values , as from
+  makq16 , using half the memory. Each thread encodes its trials as soon as
+  they are done , so a single matrix of all trials is never made. Decode
+  with makq16 ( sttc ) , where -32768 becomes NaN.
+  
+  Compile with OpenMP to divide trials between threads.
+  
+  Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+
+*/
+
+
+/*-- Include block --*/
+
+#include    <math.h>
+#include  <stdlib.h>
+#include  <string.h>
+#include     "mex.h"
+#include  "matrix.h"
+#include  "maknuma.h"
+#include   "makq16.h"
+
+#ifdef  _OPENMP
+  #include  <omp.h>
+#endif
+
+
+/*-- Define block --*/
+
+#define  NARGINMIN  3
+#define  NARGINMAX  4
+#define    NARGOUT  2
+#define       WARG  0
+#define   MAXDTARG  1
+#define       CARG  2
+#define     CLSARG  3
+#define    STTCOUT  0
+#define      DTOUT  1
+
+/* Minimum time step in seconds , one millisecond */
+#define  MINSTP  0.001
+
+/* Longest class name */
+#define  CLSLEN  6
+
+
+/*-- Data types --*/
+
+/* One spike train , the part of it inside the analysis window */
+typedef struct
+{
+  
+  /* Spike times , double if dbl is non-zero and single otherwise */
+  const void  * s ;
+  int  dbl ;
+  
+  /* Index of first spike in window , and number of spikes in window */
+  mwSize  f , n ;
+
+} train_t ;
+
+/* Buffers that one thread needs to compute one trial */
+typedef struct
+{
+  
+  /* Merged spike times , cluster labels , and delta-t index of the
+     nearest spike from another cluster */
+  double  * t ;
+  mwSize  * l , * dn ;
+  
+  /* Positions in the merged train of each cluster's spikes , grouped by
+     cluster. Cluster a starts at off[ a ]. */
+  mwSize  * pos , * off ;
+  
+  /* Heap of clusters for merging , each cluster's next spike , and its
+     time */
+  mwSize  * heap , * next ;
+  double  * ht ;
+  
+  /* ISI counts and sums for the merged train , and working copies */
+  double  * Kall , * Sall , * K , * S ;
+  
+  /* Spikes of each cluster within delta-t of the population , and spikes
+     of the population within delta-t of one cluster */
+  double  * Pu , * Pr ;
+  
+  /* Proportion of time covered by one cluster and by the rest */
+  float  * Ta , * Tr ;
+  
+  /* STTC of one trial , before it is encoded as int16 */
+  float  * y ;
+  
+  /* Returned when STTC is undefined */
+  float  nan ;
+
+} buf_t ;
+
+
+/*-- Subroutines --*/
+
+/* Spike time i of train x , in double precision */
+static double  spktime ( const train_t * x , mwSize i )
+{
+  return  x->dbl  ?  ( ( const double * ) x->s )[ i ]  :
+    ( double ) ( ( const float * ) x->s )[ i ] ;
+}
+
+/* Index of delta-t that separates earlier time y from later time x. Adds
+   W when this is beyond the last delta-t. */
+static mwSize  F ( double x , double y , mwSize W )
+{
+  double  d = ceil (  ( x  -  y )  *  1000  ) ;
+  return  d  <  ( double ) W  ?  ( mwSize ) d  :  W ;
+}
+
+/* Adds sgn times one inter-spike-interval of isi milliseconds to the count
+   and sum of ISIs that are surpassed at each delta-t */
+static void  addisi ( double * K , double * S , mwSize W , double isi ,
+  double sgn )
+{
+  double  d = ceil (  isi  /  2  ) ;
+  
+  if  ( d  <  ( double ) W )
+  {
+    K[ ( mwSize ) d ] += sgn ;
+    S[ ( mwSize ) d ] += sgn  *  isi ;
+  }
+}
+
+/* Proportion of time within each delta-t of N spikes , from the ISI
+   counts K and sums S , and the time Ts from window start to first spike
+   and Te from last spike to window end. Follows getT of maksttc. */
+static void  getT ( float * T , const double * K , const double * S ,
+  mwSize W , double N , double Ts , double Te , double dur )
+{
+  mwSize  i ;
+  double  cK , cS , dt , s , e ;
+  
+  for  ( cK = cS = 0 , i = 0 ; i < W ; i++ )
+  {
+    cK += K[ i ] ;
+    cS += S[ i ] ;
+    dt = ( double ) i ;
+     s = Ts < dt ;
+     e = Te < dt ;
+    T[ i ] = ( float ) ( (  ( 2 * ( N - cK ) - s - e ) * dt  +
+      s * Ts  +  e * Te  +  cS  )  /  dur ) ;
+  }
+}
+
+/* Restores the heap property below heap element i , comparing the next
+   spike time of each cluster. Ties go to the lower cluster index. */
+static void  siftdown ( mwSize * heap , mwSize h , mwSize i ,
+  const double * ht )
+{
+  mwSize  c , x = heap[ i ] ;
+  
+  while  ( ( c = 2 * i + 1 )  <  h )
+  {
+    if  ( c + 1 < h  &&  ( ht[ heap[ c + 1 ] ] < ht[ heap[ c ] ]  ||
+          ( ht[ heap[ c + 1 ] ] == ht[ heap[ c ] ]  &&
+            heap[ c + 1 ] < heap[ c ] ) ) )  c++ ;
+    
+    if  ( ht[ x ] < ht[ heap[ c ] ]  ||
+          ( ht[ x ] == ht[ heap[ c ] ]  &&  x < heap[ c ] ) )  break ;
+    
+    heap[ i ] = heap[ c ] ;
+    i = c ;
+  }
+  
+  heap[ i ] = x ;
+}
+
+/* Coupling STTC of every cluster on one trial , written to the W x M
+   column-major matrix y */
+static void  trialsttc ( float * y , const train_t * x , mwSize M ,
+  mwSize W , double w1 , double w2 , buf_t * b )
+{
+  
+  /* Counters , cluster , merged train size , run of one cluster's spikes ,
+     and first and last population spikes */
+  mwSize  a , i , j , k , n , q , r , p0 , p1 , fr , lr ;
+  
+  /* Delta-t index pair , flags for spikes seen by a sweep , and spike
+     times */
+  mwSize  d1 , d2 , h0 , h1 ;
+  double  t0 , t1 , Ts , Te ;
+  
+  /* Window duration in milliseconds , number of spikes in cluster and
+     population , and proportions */
+  double  dur = ( w2  -  w1 )  *  1000 , na , nr ;
+  float  Pa , Pr ;
+  
+  /* Next spike time of each cluster , for the heap */
+  double  * ht = b->ht ;
+  
+  
+  /*-- Merge all clusters into one labelled train --*/
+  
+  for  ( n = 0 , k = 0 , a = 0 ; a < M ; a++ )
+  {
+    n += x[ a ].n ;
+    b->off[ a ] = n  -  x[ a ].n ;
+    b->next[ a ] = 0 ;
+    if  ( x[ a ].n )
+    {
+      ht[ a ] = spktime (  x + a ,  x[ a ].f  ) ;
+      b->heap[ k++ ] = a ;
+    }
+  }
+  b->off[ M ] = n ;
+  
+  for  ( i = k / 2 ; i-- ; )  siftdown (  b->heap ,  k ,  i ,  ht  ) ;
+  
+  for  ( q = 0 ; q < n ; q++ )
+  {
+    a = b->heap[ 0 ] ;
+    b->t[ q ] = ht[ a ] ;
+    b->l[ q ] = a ;
+    b->pos[ b->off[ a ] + b->next[ a ] ] = q ;
+    
+    /* Cluster has more spikes , or leaves the heap */
+    if  ( ++b->next[ a ]  <  x[ a ].n )
+      ht[ a ] = spktime (  x + a ,  x[ a ].f + b->next[ a ]  ) ;
+    else
+      b->heap[ 0 ] = b->heap[ --k ] ;
+    
+    if  ( k )  siftdown (  b->heap ,  k ,  0 ,  ht  ) ;
+  }
+  
+  
+  /*-- Terms shared by all clusters --*/
+  
+  /* ISIs of the merged train */
+  memset (  b->Kall  ,  0  ,  W * sizeof( double )  ) ;
+  memset (  b->Sall  ,  0  ,  W * sizeof( double )  ) ;
+  for  ( q = 1 ; q < n ; q++ )
+    addisi (  b->Kall ,  b->Sall ,  W ,
+      ( b->t[ q ] - b->t[ q - 1 ] ) * 1000 ,  1  ) ;
+  
+  /* Nearest spike from another cluster. The forward sweep keeps the
+     latest spike , t1 from cluster r , and the latest spike from any other
+     cluster than r , t0. The backward sweep does the same in reverse. */
+  for  ( t0 = t1 = 0 , h0 = h1 = 0 , r = 0 , q = 0 ; q < n ; q++ )
+  {
+    if  ( h1  &&  b->l[ q ] != r )
+      b->dn[ q ] = F (  b->t[ q ] ,  t1 ,  W  ) ;
+    else
+      b->dn[ q ] = h0  ?  F( b->t[ q ] , t0 , W )  :  W ;
+    
+    if  ( h1  &&  b->l[ q ] != r )  {  t0 = t1 ;  h0 = 1 ;  }
+    t1 = b->t[ q ] ;  r = b->l[ q ] ;  h1 = 1 ;
+  }
+  
+  for  ( t0 = t1 = 0 , h0 = h1 = 0 , r = 0 , q = n ; q-- ; )
+  {
+    if  ( h1  &&  b->l[ q ] != r )
+      d1 = F (  t1 ,  b->t[ q ] ,  W  ) ;
+    else
+      d1 = h0  ?  F( t0 , b->t[ q ] , W )  :  W ;
+    
+    if  ( d1  <  b->dn[ q ] )  b->dn[ q ] = d1 ;
+    
+    if  ( h1  &&  b->l[ q ] != r )  {  t0 = t1 ;  h0 = 1 ;  }
+    t1 = b->t[ q ] ;  r = b->l[ q ] ;  h1 = 1 ;
+  }
+  
+  /* Count each cluster's spikes by delta-t to the population */
+  memset (  b->Pu  ,  0  ,  W * M * sizeof( double )  ) ;
+  for  ( q = 0 ; q < n ; q++ )
+    if  ( b->dn[ q ]  <  W )  b->Pu[ b->l[ q ] * W + b->dn[ q ] ] += 1 ;
+  
+  
+  /*-- Clusters --*/
+  
+  for  ( a = 0 ; a < M ; a++ , y += W )
+  {
+    
+    /* Spikes in cluster and rest of population */
+    na = ( double ) x[ a ].n ;
+    nr = ( double ) ( n  -  x[ a ].n ) ;
+    
+    /* STTC is undefined */
+    if  ( !na  ||  !nr )
+    {
+      for  ( i = 0 ; i < W ; i++ )  y[ i ] = b->nan ;
+      continue ;
+    }
+    
+    /* Positions of this cluster's spikes */
+    p0 = b->off[ a ] ;
+    p1 = b->off[ a + 1 ] ;
+    
+    /* Time covered by the cluster */
+    memset (  b->K  ,  0  ,  W * sizeof( double )  ) ;
+    memset (  b->S  ,  0  ,  W * sizeof( double )  ) ;
+    for  ( k = p0 + 1 ; k < p1 ; k++ )
+      addisi (  b->K ,  b->S ,  W ,
+        ( b->t[ b->pos[ k ] ] - b->t[ b->pos[ k - 1 ] ] ) * 1000 ,  1  ) ;
+    
+    Ts = ( b->t[ b->pos[ p0 ] ]  -  w1 )  *  1000 ;
+    Te = ( w2  -  b->t[ b->pos[ p1 - 1 ] ] )  *  1000 ;
+    getT (  b->Ta ,  b->K ,  b->S ,  W ,  na ,  Ts ,  Te ,  dur  ) ;
+    
+    /* Time covered by the rest of the population. Each run of consecutive
+       spikes from this cluster in the merged train removes the ISIs on
+       either side and within the run , and joins the population spikes on
+       either side by a single ISI. */
+    memcpy (  b->K  ,  b->Kall  ,  W * sizeof( double )  ) ;
+    memcpy (  b->S  ,  b->Sall  ,  W * sizeof( double )  ) ;
+    fr = 0 ;  lr = n - 1 ;
+    
+    for  ( k = p0 ; k < p1 ; k = j )
+    {
+      
+      /* Run of spikes from merged positions i to r */
+      i = b->pos[ k ] ;
+      for  ( j = k + 1 ; j < p1  &&  b->pos[ j ] == b->pos[ j - 1 ] + 1 ;
+             j++ ) ;
+      r = b->pos[ j - 1 ] ;
+      
+      for  ( q = i ? i : 1 ; q <= r + 1  &&  q < n ; q++ )
+        addisi (  b->K ,  b->S ,  W ,
+          ( b->t[ q ] - b->t[ q - 1 ] ) * 1000 ,  -1  ) ;
+      
+      if  ( i  &&  r + 1 < n )
+        addisi (  b->K ,  b->S ,  W ,
+          ( b->t[ r + 1 ] - b->t[ i - 1 ] ) * 1000 ,  1  ) ;
+      
+      /* Run at either end of the merged train */
+      if  ( i == 0 )  fr = r + 1 ;
+      if  ( r + 1 == n )  lr = i - 1 ;
+    
+    } /* runs */
+    
+    Ts = ( b->t[ fr ]  -  w1 )  *  1000 ;
+    Te = ( w2  -  b->t[ lr ] )  *  1000 ;
+    getT (  b->Tr ,  b->K ,  b->S ,  W ,  nr ,  Ts ,  Te ,  dur  ) ;
+    
+    /* Population spikes by delta-t to this cluster. Only the population
+       spikes in each gap between this cluster's spikes that are within
+       maxdt of either end are visited. */
+    memset (  b->Pr  ,  0  ,  W * sizeof( double )  ) ;
+    
+    /* Leading spikes */
+    for  ( t1 = b->t[ b->pos[ p0 ] ] , q = b->pos[ p0 ] ; q-- ; )
+    {
+      if  ( ( d2 = F( t1 , b->t[ q ] , W ) )  ==  W )  break ;
+      b->Pr[ d2 ] += 1 ;
+    }
+    
+    /* Gaps between consecutive spikes , the earlier end takes ties */
+    for  ( k = p0 + 1 ; k < p1 ; k++ )
+    {
+      i = b->pos[ k - 1 ] ;
+      r = b->pos[ k ] ;
+      t0 = b->t[ i ] ;
+      t1 = b->t[ r ] ;
+      
+      for  ( q = i + 1 ; q < r ; q++ )
+      {
+        d1 = F (  b->t[ q ] ,  t0 ,  W  ) ;
+        if  ( d1 == W  ||  F( t1 , b->t[ q ] , W ) < d1 )  break ;
+        b->Pr[ d1 ] += 1 ;
+      }
+      
+      for  ( j = r ; q < j-- ; )
+      {
+        if  ( ( d2 = F( t1 , b->t[ j ] , W ) )  ==  W )  break ;
+        b->Pr[ d2 ] += 1 ;
+      }
+    }
+    
+    /* Trailing spikes */
+    for  ( t0 = b->t[ b->pos[ p1 - 1 ] ] , q = b->pos[ p1 - 1 ] + 1 ;
+           q < n ; q++ )
+    {
+      if  ( ( d1 = F( b->t[ q ] , t0 , W ) )  ==  W )  break ;
+      b->Pr[ d1 ] += 1 ;
+    }
+    
+    /* Cumulative sums give spikes within each delta-t. Normalise into
+       proportions and compute STTC. The min function removes NaN values
+       that occur when P and T are both 1 at large delta-t. */
+    for  ( i = 0 ; i < W ; i++ )
+    {
+      if  ( i )
+      {
+        b->Pu[ a * W + i ] += b->Pu[ a * W + i - 1 ] ;
+        b->Pr[ i ] += b->Pr[ i - 1 ] ;
+      }
+      Pa = ( float ) ( b->Pu[ a * W + i ]  /  na ) ;
+      Pr = ( float ) ( b->Pr[ i ]  /  nr ) ;
+      y[ i ] = 0.5f  *  (
+        fminf (  ( Pa - b->Tr[ i ] ) / ( 1 - Pa * b->Tr[ i ] ) ,  1  )  +
+        fminf (  ( Pr - b->Ta[ i ] ) / ( 1 - Pr * b->Ta[ i ] ) ,  1  )  ) ;
+    }
+  
+  } /* clusters */
+
+} /* trialsttc */
+
+
+/*** MEX gateway function ***/
+
+void  mexFunction (  int nlhs  ,        mxArray * plhs[ ] ,
+                     int nrhs  ,  const mxArray * prhs[ ]  )
+{
+  
+  
+  /*-- Variables --*/
+  
+  /* Generic counters */
+  mwSize  i , j ;
+  
+  /* Number of trials , clusters , delta-t values , and most spikes in any
+     trial */
+  mwSize  Nt , M , W , nmax ;
+  
+  /* Analysis window , its duration , and NaN */
+  double  w1 , w2 , dur ;
+  float  nan = ( float ) mxGetNaN ( ) ;
+  
+  /* Spike trains */
+  const mxArray  * c ;
+  train_t  * x ;
+  
+  /* Output , trials per chunk of output , and the replaced schedule */
+  mwSize  dims[ 3 ] , chunk ;
+  maknuma_sched_t  old ;
+  float  * y ;
+  int16_t  * q ;
+  
+  /* int16 output , instruction set level , and class name */
+  int  i16 = 0 , isa = makisa ( ) ;
+  char  cls[ CLSLEN + 1 ] ;
+  
+  /* Out of memory in any thread */
+  int  err = 0 ;
+  
+  
+  /*-- Input check --*/
+  
+  /* Must be 3 or 4 input args */
+  if  ( nrhs < NARGINMIN  ||  NARGINMAX < nrhs )
+    
+    mexErrMsgIdAndTxt (  "MAK:makpopsttc:nargsin"  ,
+      "makpopsttc: requires %d or %d input arguments"  ,
+      NARGINMIN  ,  NARGINMAX  ) ;
+  
+  /* Must be no more than 2 output args */
+  else if  ( NARGOUT  <  nlhs )
+    
+    mexErrMsgIdAndTxt (  "MAK:makpopsttc:nargsout"  ,
+      "makpopsttc: returns at most %d output arguments"  ,  NARGOUT  ) ;
+  
+  /* w must be a real 2-element single or double vector */
+  else if  (  !( mxIsDouble( prhs[ WARG ] ) || mxIsSingle( prhs[ WARG ] ) )
+              ||  mxIsComplex( prhs[ WARG ] )  ||
+              mxGetNumberOfElements( prhs[ WARG ] ) != 2  )
+    
+    mexErrMsgIdAndTxt (  "MAK:makpopsttc:w"  ,
+      "makpopsttc: w must be 2-element real value vector where "
+      "w( 1 ) < w( 2 ) and %f <= w( 2 ) - w( 1 )"  ,  MINSTP  ) ;
+  
+  /* Window and its duration rounded to the nearest microsecond */
+  if  ( mxIsDouble(  prhs[ WARG ]  ) )
+  {
+    w1 = mxGetPr (  prhs[ WARG ]  )[ 0 ] ;
+    w2 = mxGetPr (  prhs[ WARG ]  )[ 1 ] ;
+  }
+  else
+  {
+    w1 = ( ( const float * ) mxGetData( prhs[ WARG ] ) )[ 0 ] ;
+    w2 = ( ( const float * ) mxGetData( prhs[ WARG ] ) )[ 1 ] ;
+  }
+  dur = round (  ( w2  -  w1 )  *  1e6  )  /  1e6 ;
+  
+  /* The window must increase and span at least the minimum step */
+  if  ( !( w1 < w2 )  ||  dur < MINSTP )
+    
+    mexErrMsgIdAndTxt (  "MAK:makpopsttc:w"  ,
+      "makpopsttc: w must be 2-element real value vector where "
+      "w( 1 ) < w( 2 ) and %f <= w( 2 ) - w( 1 )"  ,  MINSTP  ) ;
+  
+  /* Milliseconds spanned by w */
+  W = ( mwSize ) ceil (  dur  *  1000  ) ;
+  
+  /* maxdt is ignored if empty , otherwise it is a real scalar */
+  if  ( !mxIsEmpty(  prhs[ MAXDTARG ]  ) )
+  {
+    if  (  !mxIsScalar( prhs[ MAXDTARG ] )  ||
+           !mxIsNumeric( prhs[ MAXDTARG ] )  ||
+           mxIsComplex( prhs[ MAXDTARG ] )  ||
+           mxGetScalar( prhs[ MAXDTARG ] ) < 1e3 * MINSTP  ||
+           ( double ) W < mxGetScalar( prhs[ MAXDTARG ] )  )
+      
+      mexErrMsgIdAndTxt (  "MAK:makpopsttc:maxdt"  ,
+        "makpopsttc: maxdt must be a scalar real number in the range of "
+        "%d to %d"  ,  ( int ) ( 1e3 * MINSTP )  ,  ( int ) W  ) ;
+    
+    W = ( mwSize ) mxGetScalar (  prhs[ MAXDTARG ]  ) ;
+  }
+  
+  /* Include delta-t of zero */
+  W = W  +  1 ;
+  
+  /* C must be a 2D cell array with at least 2 columns */
+  c = prhs[ CARG ] ;
+  
+  if  (  !mxIsCell( c )  ||  mxIsEmpty( c )  ||
+         mxGetNumberOfDimensions( c ) != 2  )
+    
+    mexErrMsgIdAndTxt (  "MAK:makpopsttc:Ccell"  ,
+      "makpopsttc: C must be a non-empty 2D cell array"  ) ;
+  
+  else if  ( mxGetN(  c  )  <  2 )
+    
+    mexErrMsgIdAndTxt (  "MAK:makpopsttc:Cncols"  ,
+      "makpopsttc: C must not have fewer than 2 columns"  ) ;
+  
+  Nt = mxGetM (  c  ) ;
+   M = mxGetN (  c  ) ;
+  
+  /* cls must be 'single' or 'int16' */
+  if  ( CLSARG  <  nrhs )
+  {
+    if  (  !mxIsChar( prhs[ CLSARG ] )  ||
+           CLSLEN < mxGetNumberOfElements( prhs[ CLSARG ] )  ||
+           mxGetString( prhs[ CLSARG ] , cls , CLSLEN + 1 )  ||
+           ( strcmp( cls , "single" )  &&  strcmp( cls , "int16" ) )  )
+      
+      mexErrMsgIdAndTxt (  "MAK:makpopsttc:cls"  ,
+        "makpopsttc: cls must be 'single' or 'int16'"  ) ;
+    
+    i16 = !strcmp (  cls  ,  "int16"  ) ;
+  }
+  
+  
+  /*-- Preparation --*/
+  
+  /* Locate the spikes of each trial and cluster inside the window. Trials
+     are indexed over rows of C , but clusters of one trial are kept
+     together in x. */
+  x = mxMalloc (  Nt * M * sizeof( train_t )  ) ;
+  nmax = 0 ;
+  
+  for  ( i = 0 ; i < Nt ; i++ )
+  {
+    mwSize  n = 0 ;
+    
+    for  ( j = 0 ; j < M ; j++ )
+    {
+      const mxArray  * s = mxGetCell (  c  ,  i + j * Nt  ) ;
+      train_t  * t = x  +  i * M  +  j ;
+      
+      t->s = NULL ;  t->dbl = 1 ;  t->f = t->n = 0 ;
+      
+      /* Empty place holder */
+      if  ( !s  ||  mxIsEmpty( s ) )  continue ;
+      
+      if  (  !( mxIsDouble( s ) || mxIsSingle( s ) )  ||
+             mxIsComplex( s )  ||  mxIsSparse( s )  ||
+             mxGetNumberOfDimensions( s ) != 2  ||
+             ( mxGetM( s ) != 1  &&  mxGetN( s ) != 1 )  )
+        
+        mexErrMsgIdAndTxt (  "MAK:makpopsttc:spktrains"  ,
+          "makpopsttc: all spike trains must be real-numbered vectors of "
+          "type single or double , or empty"  ) ;
+      
+      t->s = mxGetData (  s  ) ;
+      t->dbl = mxIsDouble (  s  ) ;
+      
+      /* Spikes are in chronological order */
+      while  ( t->f < mxGetNumberOfElements( s )  &&
+               spktime( t , t->f ) < w1 )  t->f++ ;
+      while  ( t->f + t->n < mxGetNumberOfElements( s )  &&
+               spktime( t , t->f + t->n ) <= w2 )  t->n++ ;
+      
+      n += t->n ;
+    }
+    
+    if  ( nmax  <  n )  nmax = n ;
+  }
+  
+  /* Allocate output , placing large ones by first touch of each trial */
+  dims[ 0 ] = W ;  dims[ 1 ] = M ;  dims[ 2 ] = Nt ;
+  chunk = maknuma_chunk (  W * M * ( i16 ? sizeof( int16_t ) :
+    sizeof( float ) )  ,  Nt  ) ;
+  plhs[ STTCOUT ] = maknuma_create (  3  ,  dims  ,
+    i16  ?  mxINT16_CLASS  :  mxSINGLE_CLASS  ,  chunk  ) ;
+  old = maknuma_sched (  chunk  ) ;
+  y = ( float * ) mxGetData (  plhs[ STTCOUT ]  ) ;
+  q = ( int16_t * ) mxGetData (  plhs[ STTCOUT ]  ) ;
+  
+  
+  /*-- Compute STTC --*/
+  
+  #pragma omp parallel
+  {
+    
+    /* Thread's buffers */
+    buf_t  b ;
+    mwSignedIndex  t ;
+    int  e ;
+    
+    b.t    = malloc (  ( nmax + 1 ) * sizeof( double )  ) ;
+    b.l    = malloc (  ( nmax + 1 ) * sizeof( mwSize )  ) ;
+    b.dn   = malloc (  ( nmax + 1 ) * sizeof( mwSize )  ) ;
+    b.pos  = malloc (  ( nmax + 1 ) * sizeof( mwSize )  ) ;
+    b.off  = malloc (  ( M + 1 ) * sizeof( mwSize )  ) ;
+    b.heap = malloc (  M * sizeof( mwSize )  ) ;
+    b.next = malloc (  M * sizeof( mwSize )  ) ;
+    b.Kall = malloc (  W * sizeof( double )  ) ;
+    b.Sall = malloc (  W * sizeof( double )  ) ;
+    b.K    = malloc (  W * sizeof( double )  ) ;
+    b.S    = malloc (  W * sizeof( double )  ) ;
+    b.Pu   = malloc (  W * M * sizeof( double )  ) ;
+    b.ht   = malloc (  M * sizeof( double )  ) ;
+    b.Pr   = malloc (  W * sizeof( double )  ) ;
+    b.Ta   = malloc (  W * sizeof( float )  ) ;
+    b.Tr   = malloc (  W * sizeof( float )  ) ;
+    b.y    = i16  ?  malloc( W * M * sizeof( float ) )  :  NULL ;
+    b.nan  = nan ;
+    
+    e = !b.t  ||  !b.l  ||  !b.dn  ||  !b.pos  ||  !b.off  ||  !b.heap  ||
+        !b.next  ||  !b.Kall  ||  !b.Sall  ||  !b.K  ||  !b.S  ||  !b.Pu  ||
+        !b.ht  ||  !b.Pr  ||  !b.Ta  ||  !b.Tr  ||  ( i16  &&  !b.y ) ;
+    
+    /* Trials , on the thread that placed their output. int16 output is
+       encoded straight from the thread's buffer. */
+    #pragma omp for schedule( runtime )
+    for  ( t = 0 ; t < ( mwSignedIndex ) Nt ; t++ )
+      if  ( e )
+        continue ;
+      else if  ( i16 )
+      {
+        trialsttc (  b.y ,  x + t * M ,  M ,  W ,  w1 ,  w2 ,  &b  ) ;
+        makq16_enc_s[ isa ] (  q + t * W * M ,  b.y ,  W * M  ) ;
+      }
+      else
+        trialsttc (  y + t * W * M ,  x + t * M ,  M ,  W ,  w1 ,  w2 ,  &b );
+    
+    #pragma omp critical
+    err |= e ;
+    
+    free (  b.t  ) ;  free (  b.l  ) ;  free (  b.dn  ) ;
+    free (  b.pos  ) ;  free (  b.off  ) ;  free (  b.heap  ) ;
+    free (  b.next  ) ;  free (  b.ht  ) ;  free (  b.Kall  ) ;
+    free (  b.Sall  ) ;  free (  b.K  ) ;  free (  b.S  ) ;  free (  b.Pu  ) ;
+    free (  b.Pr  ) ;  free (  b.Ta  ) ;  free (  b.Tr  ) ;  free (  b.y  ) ;
+  
+  } /* parallel */
+  
+  maknuma_unsched (  old  ) ;
+  mxFree (  x  ) ;
+  
+  if  ( err )
+    mexErrMsgIdAndTxt (  "MAK:makpopsttc:mem"  ,
+      "makpopsttc: out of memory"  ) ;
+  
+  
+  /*-- Delta-t values --*/
+  
+  if  ( nlhs  <=  1 )
+    return ;
+  
+  plhs[ DTOUT ] = mxCreateNumericMatrix (  W  ,  1  ,  mxSINGLE_CLASS  ,
+    mxREAL  ) ;
+  y = ( float * ) mxGetData (  plhs[ DTOUT ]  ) ;
+  for  ( i = 0 ; i < W ; i++ )  y[ i ] = ( float ) i ;
+
+
+} /* mexFunction */
+
@@ -0,0 +1,74 @@
+
+% [ sttc , dt ] = makpopsttc ( w , maxdt , C )
+% [ sttc , dt ] = makpopsttc ( w , maxdt , C , cls )
+% 
+% MET Analysis Kit. Population coupling measured with the spike time tiling
+% coefficient ( STTC ) of Cutts and Eglen ( 2014 ). For each neurone/spike-
+% cluster, STTC is computed between its spike train and the pooled spike
+% train of all other neurones/spike-clusters on the same trial. The result
+% is the same as giving maksttc a merged rest-of-population spike train for
+% each cluster in turn. But here, the spike trains of each trial are merged
+% only once into a single train that labels each spike with its cluster.
+% 
+% w, maxdt, and C are the same as for maksttc (  w  ,  maxdt  ,  C  ). C is
+% a cell array with trials indexed over rows and neurones/spike-clusters
+% indexed over columns, and it must have at least 2 columns. Each element
+% contains a vector of single or double spike times in chronological
+% order, or is empty.
+% 
+% sttc is a W x M x T single matrix of STTC values for W delta-t values, M
+% clusters, and T trials. sttc( : , a , i ) is the coupling of cluster a to
+% the rest of the population on trial i. It is NaN if either cluster a or
+% the rest of the population has no spikes within the analysis window. dt
+% returns all delta-t values in register with the rows of sttc.
+% 
+% cls is optional, either 'single' ( default ) or 'int16'. If 'int16' then
+% sttc is an int16 matrix of fixed-point STTC values, as from makq16, and
+% takes half the memory. Each thread encodes its trials as soon as they
+% are done, so a single precision matrix of all trials is never made.
+% Values are rounded to the nearest 1 / 32767 and NaN is kept as -32768.
+% Decode with makq16 (  sttc  ).
+% 
+% 
+% Algorithm:
+% 
+% For each trial, all spike trains are merged by a heap into one labelled
+% train. A forward and a backward sweep of the merged train find the
+% nearest spike from any other cluster before and after each spike. This
+% gives the proportion of each cluster's spikes within delta-t of the
+% population, for all clusters at once.
+% 
+% The proportion of time within delta-t of the population is computed as
+% in maksttc, from the inter-spike-intervals ( ISI ) of the merged train.
+% To remove cluster a, each run of consecutive spikes from a in the merged
+% train takes away the ISIs on either side of and within the run, and adds
+% back the one ISI that joins the population spikes on either side.
+% 
+% The proportion of population spikes within delta-t of cluster a only
+% visits the population spikes in each gap between consecutive spikes of
+% a that are within maxdt of either end of the gap. Hence, the cost for
+% each trial is O( n log M  +  M W ) for n spikes, plus the number of
+% population spikes that are within maxdt of a spike from each cluster. A
+% small maxdt is much faster than the rest-of-population trains given to
+% maksttc, which cost O( n M ).
+% 
+% If MEX is compiled with OpenMP then trials are divided between threads,
+% e.g.
+% 
+%   mex CFLAGS='$CFLAGS -fopenmp' LDFLAGS='$LDFLAGS -fopenmp' makpopsttc.c
+% 
+% Otherwise, it runs on a single thread. Large outputs are zeroed in
+% parallel, so that on multi-socket computers each trial's output is held
+% by the socket of the thread that computes it ; see maknuma.h.
+% 
+% 
+% Reference:
+% 
+% Cutts CS, Eglen SJ. 2014. Detecting Pairwise Correlations in Spike
+%   Trains: An Objective Comparison of Methods and Application to the Study
+%   of Retinal Waves. J Neurosc, 34(43):14288-14303.
+% 
+% Okun M, et al. 2015. Diverse coupling of neurons to populations in
+%   sensory cortex. Nature, 521(7553):511-515.
+% 
+% Written by Jackson Smith - October 2026 - ESI (Fries Lab)
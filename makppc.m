@@ -0,0 +1,248 @@
+
+function  [ ppc , n ] = makppc (  x  ,  fs  ,  t0  ,  band  ,  S  ,  est  )
+% 
+% [ ppc , n ] = makppc (  x  ,  fs  ,  t0  ,  band  ,  S  )
+% [ ppc , n ] = makppc (  ...  ,  est  )
+% 
+% MET Analysis Kit. Computes the spike-LFP pairwise phase consistency
+% ( PPC ) of Vinck et al. ( 2010 , 2012 ) between every unit and every LFP
+% channel. Each LFP channel is band-pass filtered and transformed to its
+% analytic signal once per trial, the phase is sampled at all spike times,
+% and PPC is computed from resultant vectors rather than a loop over all
+% pairs of spikes.
+% 
+% x is the LFP, a real numeric matrix with time samples indexed over rows,
+% channels over columns, and trials over the 3rd dimension i.e. M x C x T.
+% fs is the sampling rate in Hertz, and t0 is the time of the first sample
+% in seconds. Sample i is at time t0 + ( i - 1 ) / fs on every trial. band
+% is an F x 2 matrix of frequency bands in Hertz, where band( f , 1 ) is
+% the lower and band( f , 2 ) is the upper edge of band f.
+% 
+% S is a T x U cell array of spike times, in seconds, with trials indexed
+% over rows and units indexed over columns, as for C in maksttc. Each
+% spike takes the phase of the nearest LFP sample. Spikes more than half a
+% sample outside of the LFP are ignored.
+% 
+% est is optional and names the estimator. It can be 'ppc0' ( default )
+% to use all pairs of spikes, or 'ppc1' to use only the pairs of spikes
+% that come from different trials. The latter removes the dependence of
+% spikes on the same trial, e.g. from bursts.
+% 
+% ppc is a U x C x F double matrix, so that ppc( u , c , f ) is PPC of
+% unit u to channel c in band f. It is NaN when there are too few spikes,
+% or spikes from too few trials for 'ppc1'. n is a U x 1 vector with the
+% number of spikes used from each unit.
+% 
+% 
+% Algorithm:
+% 
+% For unit-length phase vectors z( i ) of n spikes, the sum over all pairs
+% of spikes of cos( phase difference ) is ( | sum( z ) | ^ 2 - n ) / 2.
+% Hence,
+% 
+%   ppc0 = ( | R | ^ 2  -  n )  /  ( n * ( n - 1 ) )
+% 
+% where R is the resultant vector sum( z ). If Rm and nm are the resultant
+% vector and number of spikes on trial m, then removing the pairs from the
+% same trial gives
+% 
+%   ppc1 = ( | R | ^ 2  -  sum( | Rm | ^ 2 ) )  /  ( n ^ 2  -  sum( nm ^ 2 ) )
+% 
+% Thus the cost is O( n ) per unit, channel, and band rather than O( n^2 ).
+% 
+% On each trial, a single FFT is applied to all channels. Band-pass
+% filtering and the Hilbert transform are then done together, by keeping
+% only the positive frequencies within each band and doubling them before
+% the inverse FFT. This is a zero-phase filter with a rectangular response.
+% The analytic values at all spike times of all units are normalised to
+% unit length and summed per unit by one sparse matrix product. Trials are
+% divided between workers with a parfor loop.
+% 
+% 
+% References:
+% 
+%   Vinck M, van Wingerden M, Womelsdorf T, Fries P, Pennartz CMA. 2010.
+%     The pairwise phase consistency: A bias-free measure of rhythmic
+%     neuronal synchronization. NeuroImage, 51(1):112-122.
+% 
+%   Vinck M, Battaglia FP, Womelsdorf T, Pennartz C. 2012. Improved
+%     measures of phase-coupling between spikes and the Local Field
+%     Potential. J Comput Neurosci, 33(1):53-75.
+% 
+% 
+% Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+% 
+  
+  
+  %%% Check input %%%
+  
+  % Number of input and output args
+  narginchk  (  5  ,  6  )
+  nargoutchk (  0  ,  2  )
+  
+  % Default estimator
+  if  nargin  <  6  ,  est = 'ppc0' ;  end
+  
+  % x must be real numeric
+  if  ~ isnumeric (  x  )  ||  ~ isreal (  x  )  ||  isempty (  x  )  ||  ...
+      ndims (  x  )  >  3
+    
+    error (  'MAK:makppc:x'  ,  ...
+      'makppc: x must be a non-empty real numeric M x C x T array'  )
+  
+  % fs must be a positive scalar
+  elseif  ~ isscalar (  fs  )  ||  ~ isnumeric (  fs  )  ||  ...
+      ~ isreal (  fs  )  ||  ~ ( 0  <  fs  &&  fs  <  Inf )
+    
+    error (  'MAK:makppc:fs'  ,  ...
+      'makppc: fs must be a finite positive scalar'  )
+  
+  % t0 must be a real scalar
+  elseif  ~ isscalar (  t0  )  ||  ~ isnumeric (  t0  )  ||  ...
+      ~ isreal (  t0  )  ||  ~ isfinite (  t0  )
+    
+    error (  'MAK:makppc:t0'  ,  'makppc: t0 must be a finite scalar'  )
+  
+  % band must be F x 2 with 0 <= lower < upper <= Nyquist
+  elseif  ~ isnumeric (  band  )  ||  ~ isreal (  band  )  ||  ...
+      ~ ismatrix (  band  )  ||  size (  band  ,  2  )  ~=  2  ||  ...
+      isempty (  band  )  ||  any (  band( : , 1 )  <  0  )  ||  ...
+      any (  band( : , 1 )  >=  band( : , 2 )  )  ||  ...
+      any (  band( : , 2 )  >  fs / 2  )
+    
+    error (  'MAK:makppc:band'  ,  [ 'makppc: band must be F x 2 ' , ...
+      'with 0 <= band( : , 1 ) < band( : , 2 ) <= fs / 2' ]  )
+  
+  % S must be a T x U cell array
+  elseif  ~ iscell (  S  )  ||  ~ ismatrix (  S  )  ||  ...
+      size (  S  ,  1  )  ~=  size (  x  ,  3  )
+    
+    error (  'MAK:makppc:S'  ,  ...
+      'makppc: S must be a T x U cell array for T trials in x'  )
+  
+  % Spike times must be real numeric vectors , or empty
+  elseif  ~ all (  cellfun( @( v ) isempty( v ) || ( isvector( v ) && ...
+      isnumeric( v ) && isreal( v ) ) , S( : ) )  )
+    
+    error (  'MAK:makppc:spktimes'  ,  ...
+      'makppc: spike times must be real numeric vectors , or empty'  )
+  
+  % est must be 'ppc0' or 'ppc1'
+  elseif  ~ ischar (  est  )  ||  ...
+      ~ any (  strcmp( est , { 'ppc0' , 'ppc1' } )  )
+    
+    error (  'MAK:makppc:est'  ,  'makppc: est must be ''ppc0'' or ''ppc1'''  )
+  
+  end % check input
+  
+  
+  %%% Preparation %%%
+  
+  % Samples , channels , trials , units , and bands
+  [ M , C , T ] = size (  x  ) ;
+  U = size (  S  ,  2  ) ;
+  F = size (  band  ,  1  ) ;
+  
+  % FFT length , and frequency of each FFT bin up to Nyquist
+  nf = 2  ^  ceil( log2(  M  ) ) ;
+  f = ( 0 : floor( nf / 2 ) )'  *  fs  /  nf ;
+  
+  % Analytic band-pass gain of each band , over FFT bins. Positive
+  % frequencies within the band are doubled. DC and Nyquist bins are not
+  % doubled , as they have no negative counterpart.
+  H = zeros (  nf  ,  F  ) ;
+  
+  for  i = 1 : F
+    
+    % Bins within band
+    j = find (  band( i , 1 )  <=  f  &  f  <=  band( i , 2 )  ) ;
+    
+    % Analytic gain
+    H( j , i ) = 2 ;
+    H( j( j == 1  |  j == nf / 2 + 1 ) , i ) = 1 ;
+  
+  end % bands
+  
+  % Ensure floating point FFT
+  if  ~ isfloat (  x  )  ,  x = double (  x  ) ;  end
+  
+  
+  %%% Resultant vectors %%%
+  
+  % Sum over trials of resultant vectors , squared length of trial
+  % resultants , spike counts , and squared spike counts. The first two
+  % are U x C * F , the rest are U x 1.
+  R = zeros (  U  ,  C * F  ) ;
+  Q = zeros (  U  ,  C * F  ) ;
+  n = zeros (  U  ,  1  ) ;
+  n2 = zeros (  U  ,  1  ) ;
+  
+  parfor  m = 1 : T
+    
+    % Spike times of all units , with unit index of each spike
+    s = cellfun (  @( v ) double( v( : ) )  ,  S( m , : )  ,  ...
+      'UniformOutput'  ,  false  ) ;
+    u = repelem (  ( 1 : U )'  ,  cellfun( @numel , s )'  ) ;
+    s = cat (  1  ,  s{ : }  ,  zeros( 0 , 1 )  ) ;
+    
+    % Nearest sample of each spike , discarding spikes outside the LFP
+    s = round (  ( s - t0 ) * fs  )  +  1 ;
+    k = 1 <= s  &  s <= M ;
+    s = s( k ) ;
+    u = u( k ) ;
+    
+    % No spikes on this trial
+    if  isempty (  s  )  ,  continue  ,  end
+    
+    % FFT of all channels , once
+    X = fft (  x( : , : , m )  ,  nf  ,  1  ) ;
+    
+    % Unit-length analytic values at spike times , for each band
+    Z = zeros (  numel( s )  ,  C * F  ) ;
+    
+    for  i = 1 : F
+      
+      % Analytic signal in band i
+      A = ifft (  X .* H( : , i )  ,  [ ]  ,  1  ) ;
+      A = A( s , : ) ;
+      
+      % Phase vectors , zero if there is no amplitude
+      A = A  ./  abs (  A  ) ;
+      A( ~ isfinite(  A  ) ) = 0 ;
+      
+      Z( : , ( i - 1 ) * C + 1 : i * C ) = A ;
+    
+    end % bands
+    
+    % Sum phase vectors of each unit
+    G = sparse (  u  ,  1 : numel( u )  ,  1  ,  U  ,  numel( u )  ) ;
+    Rm = G  *  Z ;
+    nm = full (  sum( G , 2 )  ) ;
+    
+    % Accumulate over trials
+    R = R  +  Rm ;
+    Q = Q  +  abs (  Rm  )  .^  2 ;
+    n = n  +  nm ;
+    n2 = n2  +  nm  .^  2 ;
+  
+  end % trials
+  
+  
+  %%% Pairwise phase consistency %%%
+  
+  % Number of spike pairs , and the sum of same-trial terms to remove
+  switch  est
+    case  'ppc0'  ,  d = n .* ( n - 1 ) ;  Q = n ;
+    case  'ppc1'  ,  d = n .^ 2  -  n2 ;
+  end
+  
+  % Too few pairs to define PPC
+  d( d  ==  0 ) = NaN ;
+  
+  % Pairwise phase consistency , U x C x F
+  ppc = ( abs (  R  )  .^  2  -  Q )  ./  d ;
+  ppc = reshape (  ppc  ,  U  ,  C  ,  F  ) ;
+  
+  
+end % makppc
+
@@ -0,0 +1,167 @@
+
+function  c = makpspfilt (  x  ,  par  )
+% 
+% c = makpspfilt (  x  )
+% c = makpspfilt (  x  ,  par  )
+% 
+% MET Analysis Kit. Causal smoothing of binned signals with the
+% postsynaptic potential kernel of makpspkern, using recursive filters.
+% The result is the same as
+% 
+%   c = makconv (  x  ,  makpspkern( par )  ,  'c'  )
+% 
+% up to floating point rounding. Convolution is done over the rows of x,
+% which can have any number of dimensions, so that each column is a
+% separate channel or trial. c has the same size as x. If x is single then
+% so is c, otherwise c is double.
+% 
+% par is the same parameter struct as for makpspkern, and the default
+% parameters are used if par is not given or is empty. In addition,
+% par.length can be Inf, in which case the kernel is never truncated and
+% is normalised so that its infinite sum is 1.
+% 
+% 
+% Algorithm:
+% 
+% Let a = exp( -1 / ( fsample * Tdecay ) ) and b = exp( -( 1 / Tgrowth +
+% 1 / Tdecay ) / fsample ). Then makpspkern's kernel is k( n ) = ( a ^ n -
+% b ^ n ) / S at samples n = 0 to N, where N = ceil( length * fsample )
+% and S is the sum of the kernel before normalisation. Each exponential is
+% a first-order recursive filter, for instance
+% 
+%   y( i ) = x( i )  +  a * y( i - 1 )
+% 
+% has the untruncated kernel a ^ n. Truncation after N samples is achieved
+% by subtracting a ^ ( N + 1 ) * x( i - N - 1 ) from the input of the
+% recursion. The cost is therefore O( 1 ) per sample regardless of the
+% kernel length, rather than the O( log( M + N ) ) per sample of makconv's
+% FFTs for M rows of x. The filters are run by filter( ), which works on
+% all columns of x at once.
+% 
+% Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+% 
+  
+  
+  %%% Check input %%%
+  
+  % Number of input and output args
+  narginchk  (  1  ,  2  )
+  nargoutchk (  0  ,  1  )
+  
+  % Default parameters
+  if  nargin  <  2  ||  isempty (  par  )
+    par = makpspkern (  'default'  ) ;
+  end
+  
+  % x must be real numeric
+  if  ~ isnumeric (  x  )  ||  ~ isreal (  x  )
+    
+    error (  'MAK:makpspfilt:x'  ,  'makpspfilt: x must be real numeric'  )
+  
+  % Invalid parameter struct
+  elseif  validpar (  par  )
+    
+    error (  'MAK:makpspfilt:par'  ,  [ 'makpspfilt: par must be a ' , ...
+      'valid makpspkern parameter struct, see help makpspfilt' ]  )
+  
+  end % check input
+  
+  % filter( ) requires floating point input
+  if  ~ isfloat (  x  )  ,  x = double (  x  ) ;  end
+  
+  
+  %%% Kernel terms %%%
+  
+  % Decay factor per sample of each exponential
+  a = exp (  - 1  /  par.fsample  /  par.Tdecay  ) ;
+  b = exp (  - ( 1 / par.Tgrowth  +  1 / par.Tdecay )  /  par.fsample  ) ;
+  
+  % Number of samples after time zero , as in makpspkern
+  N = ceil (  par.length  *  par.fsample  ) ;
+  
+  % Sum of the kernel over samples 0 to N , so that it can be normalised
+  S = ( 1  -  a ^ ( N + 1 ) ) / ( 1  -  a )  -  ...
+      ( 1  -  b ^ ( N + 1 ) ) / ( 1  -  b ) ;
+  
+  
+  %%% Filter %%%
+  
+  % Remember the size of x , then work on columns
+  siz = size (  x  ) ;
+  x = reshape (  x  ,  siz( 1 )  ,  [ ]  ) ;
+  
+  % Input to each recursion
+  u = x ;
+  v = x ;
+  
+  % Truncate kernels after N samples
+  if  isfinite (  N  )  &&  N + 1  <  siz( 1 )
+    
+    % Rows that are N + 1 samples after an earlier row
+    i = N + 2 : siz( 1 ) ;
+    
+    % Remove the tail of the exponential from each earlier sample
+    u( i , : ) = u( i , : )  -  a ^ ( N + 1 ) * x( 1 : end - N - 1 , : ) ;
+    v( i , : ) = v( i , : )  -  b ^ ( N + 1 ) * x( 1 : end - N - 1 , : ) ;
+  
+  end % truncate
+  
+  % Difference of exponentials , normalised
+  c = ( filter( 1 , [ 1 , - a ] , u , [ ] , 1 )  -  ...
+        filter( 1 , [ 1 , - b ] , v , [ ] , 1 ) )  /  S ;
+  
+  % Original size
+  c = reshape (  c  ,  siz  ) ;
+  
+  
+end % makpspfilt
+  
+  
+%%% Sub-routines %%%
+  
+% Validate parameter struct , returns 0 if parameter struct is valid. Same
+% as makpspkern , except that .length may be Inf.
+function  val = validpar ( par )
+  
+  % Fail by default
+  val = true ;
+  
+  % Field names of default parameter struct
+  fdef = fieldnames (  makpspkern( 'default' )  ) ;
+  
+  % Must be a scalar struct with correct field names
+  if  ~ isstruct (  par  )  ||  ~ isscalar (  par  )  ,  return  ,  end
+  
+  % Get field names
+  fpar = fieldnames (  par  ) ;
+  
+  % Check field names
+  if  numel (  fdef  )  ~=  numel (  fpar  )  ||  ...
+      ~ all (  ismember( fpar , fdef )  )
+    
+    return
+  
+  end % field names
+  
+  % All values must be scalar numeric real and greater than zero
+  for  F = fpar'  ,  f = F{ 1 } ;
+    
+    % Value
+    x = par.( f ) ;
+    
+    % Validate value , only .length may be infinite
+    if  ~ isscalar (  x  )  ||  ~ isnumeric (  x  )  ||  ...
+        ~ isreal (  x  )  ||  x  <=  0  ||  ...
+        ( ~ isfinite(  x  )  &&  ~ strcmp(  f  ,  'length'  ) )
+      
+      return
+    
+    end % validate value
+  
+  end % value check
+  
+  % Parameter struct is valid
+  val = false ;
+  
+end % validpar
+
@@ -0,0 +1,166 @@
+
+/*  makq16
+  
+  q = makq16 ( x )
+  y = makq16 ( q )
+  y = makq16 ( q , cls )
+  
+  MET Analysis Kit. Encodes values in the range -1 to +1 , such as STTC
+  from maksttc or makpopsttc and r_CCG from makrccg , as int16 fixed-point
+  numbers , or decodes them again. See makq16.h.
+  
+  x is a real single or double array. q is an int16 array of the same size
+  with round( x * 32767 ) , where NaN becomes -32768. Values of x outside
+  -1 to +1 saturate at the nearest bound.
+  
+  Given int16 q , returns y with q / 32767 , where -32768 becomes NaN. cls
+  is optional , either 'single' ( default ) or 'double'.
+  
+  Compile with OpenMP to divide values between threads.
+  
+  Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+
+*/
+
+
+/*-- Include block --*/
+
+#include  <string.h>
+#include     "mex.h"
+#include  "matrix.h"
+#include  "makq16.h"
+
+
+/*-- Define block --*/
+
+#define  NARGINMIN  1
+#define  NARGINMAX  2
+#define    NARGOUT  1
+#define       XARG  0
+#define     CLSARG  1
+#define       YOUT  0
+
+/* Longest class name */
+#define  CLSLEN  6
+
+/* Values per block of work */
+#define  BLK  65536
+
+
+/*** MEX gateway function ***/
+
+void  mexFunction (  int nlhs  ,        mxArray * plhs[ ] ,
+                     int nrhs  ,  const mxArray * prhs[ ]  )
+{
+  
+  
+  /*-- Variables --*/
+  
+  /* Block counter */
+  mwSignedIndex  j ;
+  
+  /* Number of values and blocks */
+  mwSize  n , B ;
+  
+  /* Instruction set level , single or double input , and decode to
+     double */
+  int  isa = makisa ( ) , sgl , enc , dbl = 0 ;
+  
+  /* Input */
+  const mxArray  * x = prhs[ XARG ] ;
+  
+  /* Decoded sentinel */
+  double  nan = mxGetNaN ( ) ;
+  
+  /* Input and output values */
+  const void  * v ;
+  void  * y ;
+  
+  /* Class name */
+  char  cls[ CLSLEN + 1 ] ;
+  
+  
+  /*-- Input check --*/
+  
+  /* Must be 1 or 2 input args */
+  if  ( nrhs < NARGINMIN  ||  NARGINMAX < nrhs )
+    
+    mexErrMsgIdAndTxt (  "MAK:makq16:nargsin"  ,
+      "makq16: takes %d or %d input arguments"  ,  NARGINMIN  ,  NARGINMAX );
+  
+  /* Must be no more than 1 output arg */
+  else if  ( NARGOUT  <  nlhs )
+    
+    mexErrMsgIdAndTxt (  "MAK:makq16:nargsout"  ,
+      "makq16: returns at most %d output argument"  ,  NARGOUT  ) ;
+  
+  /* Must be a real , full single , double , or int16 array */
+  else if  (  !( mxIsDouble( x ) || mxIsSingle( x ) || mxIsInt16( x ) )  ||
+              mxIsComplex( x )  ||  mxIsSparse( x )  )
+    
+    mexErrMsgIdAndTxt (  "MAK:makq16:x"  ,
+      "makq16: input must be a real single , double , or int16 array"  ) ;
+  
+  /* cls is only given with int16 values */
+  if  ( CLSARG  <  nrhs )
+  {
+    if  ( !mxIsInt16(  x  ) )
+      
+      mexErrMsgIdAndTxt (  "MAK:makq16:nargsin"  ,
+        "makq16: cls is only given with int16 input"  ) ;
+    
+    else if  (  !mxIsChar( prhs[ CLSARG ] )  ||
+                CLSLEN < mxGetNumberOfElements( prhs[ CLSARG ] )  ||
+                mxGetString( prhs[ CLSARG ] , cls , CLSLEN + 1 )  ||
+                ( strcmp( cls , "double" )  &&  strcmp( cls , "single" ) )  )
+      
+      mexErrMsgIdAndTxt (  "MAK:makq16:cls"  ,
+        "makq16: cls must be 'single' or 'double'"  ) ;
+    
+    dbl = !strcmp (  cls  ,  "double"  ) ;
+  }
+  
+  
+  /*-- Output --*/
+  
+  n = mxGetNumberOfElements (  x  ) ;
+  B = ( n  +  BLK  -  1 )  /  BLK ;
+  sgl = mxIsSingle (  x  ) ;
+  enc = !mxIsInt16 (  x  ) ;
+  
+  plhs[ YOUT ] = mxCreateNumericArray (  mxGetNumberOfDimensions( x )  ,
+    mxGetDimensions( x )  ,  enc  ?  mxINT16_CLASS  :
+    ( dbl  ?  mxDOUBLE_CLASS  :  mxSINGLE_CLASS )  ,  mxREAL  ) ;
+  
+  v = mxGetData (  x  ) ;
+  y = mxGetData (  plhs[ YOUT ]  ) ;
+  
+  
+  /*-- Encode or decode , block by block --*/
+  
+  #pragma omp parallel for schedule( static )
+  for  ( j = 0 ; j < ( mwSignedIndex ) B ; j++ )
+  {
+    mwSize  i = ( mwSize ) j  *  BLK ;
+    mwSize  m = n - i  <  BLK  ?  n - i  :  BLK ;
+    
+    if  ( enc  &&  sgl )
+      makq16_enc_s[ isa ] (  ( int16_t * ) y + i  ,
+        ( const float * ) v + i  ,  m  ) ;
+    
+    else if  ( enc )
+      makq16_enc_d[ isa ] (  ( int16_t * ) y + i  ,
+        ( const double * ) v + i  ,  m  ) ;
+    
+    else if  ( dbl )
+      makq16_dec_d[ isa ] (  ( double * ) y + i  ,
+        ( const int16_t * ) v + i  ,  m  ,  nan  ) ;
+    
+    else
+      makq16_dec_s[ isa ] (  ( float * ) y + i  ,
+        ( const int16_t * ) v + i  ,  m  ,  ( float ) nan  ) ;
+  }
+
+
+} /* mexFunction */
+
@@ -0,0 +1,122 @@
+
+/*  makq16.h
+  
+  MET Analysis Kit. Compact int16 fixed-point storage of values that are
+  bounded in the range -1 to +1 , such as STTC and r_CCG. Value v is kept
+  as round( v * 32767 ) , giving a step of about 3.05e-5 , and NaN is kept
+  as -32768 , the one value that no finite v can take. Values outside of
+  -1 to +1 saturate at the nearest bound. Hence 2 bytes are used per value
+  rather than 4 for single or 8 for double.
+  
+  Encoding and decoding kernels are compiled for each instruction set
+  level of makisa.h , and each one is a single loop with no branches that
+  the compiler turns into SIMD instructions. Kernels do not start threads
+  of their own , so that they can be called by each thread on its share of
+  the data. For example
+    
+    int  isa = makisa ( ) ;
+    makq16_enc_s[ isa ] (  q  ,  x  ,  n  ) ;
+    makq16_dec_d[ isa ] (  y  ,  q  ,  n  ,  mxGetNaN( )  ) ;
+  
+  encodes n floats x into int16 values q , and decodes q into doubles y
+  with NaN in place of the sentinel. See makq16 for the MEX function.
+  
+  Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+
+*/
+
+#ifndef  MAKQ16_H
+#define  MAKQ16_H
+
+
+/*-- Include block --*/
+
+#include  <stdint.h>
+#include     "mex.h"
+#include  "matrix.h"
+#include  "makisa.h"
+
+
+/*-- Define block --*/
+
+/* Fixed-point value of +1 , and the NaN sentinel */
+#define  MAKQ16_ONE  32767
+#define  MAKQ16_NAN  ( -32768 )
+
+/* GCC will not turn a floating point select into a SIMD blend if it
+   assumes that comparisons may trap , as it does by default. No value that
+   these kernels compare raises a trap that anyone handles. */
+#if  defined( __GNUC__ )  &&  !defined( __clang__ )
+  #define  MAKQ16_ATTR  __attribute__(( optimize( "no-trapping-math" ) ))
+#else
+  #define  MAKQ16_ATTR
+#endif
+
+
+/*-- Kernels --*/
+
+/* Declares a function that encodes n values x of type TYPE into q. NaN
+   is set to zero before clamping , so that every conversion is defined ,
+   and the sentinel is chosen last. Rounding is half away from zero. Every
+   step is computed for every value and then selected , leaving no branch
+   in the loop. */
+#define  MAKQ16_ENC( NAME , TYPE , ATTR )                                  \
+static ATTR MAKQ16_ATTR void  NAME ( int16_t * q , const TYPE * x ,       \
+  mwSize n )                                                               \
+{                                                                          \
+  mwSize  i ;                                                              \
+  double  v ;                                                              \
+  int  k , m ;                                                             \
+                                                                           \
+  _Pragma( "omp simd private( v , k , m )" )                               \
+  for  ( i = 0 ; i < n ; i++ )                                             \
+  {                                                                        \
+    v = ( double ) x[ i ]  *  MAKQ16_ONE ;                                 \
+    m = v  !=  v ;                                                         \
+    v = m  ?  0  :  v ;                                                    \
+    v = v  <  -MAKQ16_ONE  ?  -MAKQ16_ONE  :  v ;                          \
+    v = MAKQ16_ONE  <  v  ?  MAKQ16_ONE  :  v ;                            \
+    k = ( int ) ( v  +  ( v < 0  ?  -0.5  :  0.5 ) ) ;                     \
+    q[ i ] = ( int16_t ) ( m  ?  MAKQ16_NAN  :  k ) ;                      \
+  }                                                                        \
+}
+
+/* Declares a function that decodes n values q into y of type TYPE */
+#define  MAKQ16_DEC( NAME , TYPE , ATTR )                                  \
+static ATTR MAKQ16_ATTR void  NAME ( TYPE * y , const int16_t * q ,       \
+  mwSize n , TYPE nan )                                                    \
+{                                                                          \
+  mwSize  i ;                                                              \
+  TYPE  v ;                                                                \
+                                                                           \
+  _Pragma( "omp simd private( v )" )                                       \
+  for  ( i = 0 ; i < n ; i++ )                                             \
+  {                                                                        \
+    v = ( TYPE ) q[ i ]  /  ( TYPE ) MAKQ16_ONE ;                          \
+    y[ i ] = q[ i ]  ==  MAKQ16_NAN  ?  nan  :  v ;                        \
+  }                                                                        \
+}
+
+MAKISA_CLONES( MAKQ16_ENC , makq16_enc_s , float  )
+MAKISA_CLONES( MAKQ16_ENC , makq16_enc_d , double )
+MAKISA_CLONES( MAKQ16_DEC , makq16_dec_s , float  )
+MAKISA_CLONES( MAKQ16_DEC , makq16_dec_d , double )
+
+
+/*-- Dispatch tables , indexed by makisa ( ) --*/
+
+static void  ( * const makq16_enc_s[ ] ) ( int16_t * , const float * ,
+  mwSize ) = MAKISA_TABLE( makq16_enc_s ) ;
+
+static void  ( * const makq16_enc_d[ ] ) ( int16_t * , const double * ,
+  mwSize ) = MAKISA_TABLE( makq16_enc_d ) ;
+
+static void  ( * const makq16_dec_s[ ] ) ( float * , const int16_t * ,
+  mwSize , float ) = MAKISA_TABLE( makq16_dec_s ) ;
+
+static void  ( * const makq16_dec_d[ ] ) ( double * , const int16_t * ,
+  mwSize , double ) = MAKISA_TABLE( makq16_dec_d ) ;
+
+
+#endif  /* MAKQ16_H */
+
@@ -0,0 +1,41 @@
+
+% q = makq16 ( x )
+% y = makq16 ( q )
+% y = makq16 ( q , cls )
+% 
+% MET Analysis Kit. Compact storage of values that are bounded in the range
+% -1 to +1, such as STTC from maksttc or makpopsttc, or the normalised
+% cross-correlations of makrccg. These are kept as int16 fixed-point
+% numbers that take 2 bytes each, rather than 4 bytes for single or 8 for
+% double. Large all-pairs outputs can then be kept in memory and saved to
+% disk at a half or a quarter of their size.
+% 
+% x is a real single or double array. q is an int16 array of the same size
+% with round( x * 32767 ), so that the step between values is about 3e-5.
+% NaN becomes -32768, a value that no number can take. Values of x that are
+% outside the range -1 to +1 saturate at the nearest bound. Hence, the
+% auto-correlations on the diagonal of makrccg's output are not kept,
+% because they are not normalised.
+% 
+% Given int16 q, returns y with q / 32767, where -32768 becomes NaN. cls is
+% optional, either 'single' ( default ) or 'double'. Encoding and decoding
+% again gives y within 1 / 65534 of x.
+% 
+% For example
+% 
+%   q = makq16 (  maksttc( w , maxdt , C )  ) ;
+%   save (  'sttc.mat'  ,  'q'  )
+%   sttc = makq16 (  q  ) ;
+% 
+% makpopsttc can write int16 output directly. The encoding and decoding
+% loops are compiled for several instruction sets, and the best one for the
+% CPU is chosen at run time ; see makisa. Shared code is in makq16.h, which
+% must be in the same directory as makq16.c. If MEX is compiled with OpenMP
+% then values are divided between threads, e.g.
+% 
+%   mex CFLAGS='$CFLAGS -fopenmp' LDFLAGS='$LDFLAGS -fopenmp' makq16.c
+% 
+% Otherwise, it runs on a single thread.
+% 
+% Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+% 
@@ -12,7 +12,9 @@ function  [ varargout ] = makrastplot (  T  ,  varargin  )
 % optionally returned. By default, each time stamp is represented by a
 % black dot '.' marker. Optional Name/Value pairs can be given to specify
 % additional properties of the line object. The raster is added to the
-% current axes, or a new figure and axes is created if none exist.
+% current axes, or a new figure and axes is created if none exist. Each
+% element of T must be empty, or a real numeric vector with no Inf or
+% NaN ; T is checked by makspkchk, after integer types are cast to double.
 % 
 % Written by Jackson Smith - April 2018 - DPAG , University of Oxford
 % 
@@ -30,6 +32,17 @@ function  [ varargout ] = makrastplot (  T  ,  varargin  )
   narginchk (  1  ,  Inf  )
   nargoutchk (  0  ,  1  )
   
+  % Integer time stamps , such as sample stamps , are plotted as doubles
+  if  iscell (  T  )
+    
+    c = cellfun (  @( t ) isnumeric( t ) && ~ isfloat( t )  ,  T  ) ;
+    
+    if  any (  c( : )  )
+      T( c ) = cellfun (  @double  ,  T( c )  ,  'UniformOutput'  ,  false  );
+    end
+    
+  end
+  
   % Check that T is a cell array
   if  ~ iscell (  T  )
     
@@ -37,8 +50,8 @@ function  [ varargout ] = makrastplot (  T  ,  varargin  )
       'makrastplot: T must be a cell array'  )
     
   % All elements must be real-valued, numeric vectors with no Inf or NaN,
-  % or empties
-  elseif  ~ all ( cellfun(  @val  ,  T  ) )
+  % or empties. Spike times need not be in order.
+  elseif  ~ makspkchk (  T  ,  false  )
     
     error (  'MAK:makrastplot:Tvalvect'  ,  [ 'makrastplot: ' , ...
       'All elements of T must be numeric, real-valued vectors with ' , ...
@@ -101,20 +114,6 @@ end % makrastplot
 
 %%% Subroutines  %%%
 
-% Checks if t is valid i.e. a numeric, real-numbered vector that contains
-% no Inf or Nan values
-function  x = val (  t  )
-  
-  % Valid vector
-  vect = isnumeric (  t  )  &&  isreal (  t  )  &&  isvector (  t  )  &&...
-    all ( isfinite(  t  ) ) ;
-  
-  % t is a valid vector or it is empty
-  x = vect  ||  isempty (  t  ) ;
-  
-end % ists
-
-
 % Checks that s is a char row vector
 function  x = isstring (  s  )
   
@@ -0,0 +1,330 @@
+
+/*  makraw.h
+  
+  MET Analysis Kit. Chunked reading of raw int16 recordings , straight into
+  the arrays that MAK functions take , without an intermediate .mat file.
+  A recording is a sequence of F frames , each with one int16 sample from
+  every one of C channels , one frame after another. That is , channels are
+  interleaved. Flat binary files are laid out this way ( see makrawread ) ,
+  and so is the data of an NWB ElectricalSeries ( see maknwbread ).
+  
+  A source of frames is described by a makraw_t , with a function that
+  reads n frames from frame a into a buffer. The source is divided into
+  chunks of B frames , such as the chunks of an HDF5 dataset , or a few
+  MiB of a file. No read begins before the start of a chunk or runs past
+  the end of the next one. Hence , each chunk of the source is read once ,
+  apart from the few frames that a window runs into the following chunk.
+  
+  makraw_slab ( ) reads a contiguous range of frames from a sub-set of
+  channels , and makraw_wave ( ) cuts a window of frames around each spike
+  from a sub-set of channels , such as spike waveforms for makalignspks.
+  Only the chunks that hold a spike are read. If the read function can be
+  called by many threads at once then chunks are divided between threads.
+  Both return one of MAKRAW_OK , MAKRAW_READ , or MAKRAW_MEM. For example
+    
+    makraw_t  r = {  src  ,  rd  ,  C  ,  F  ,  B  ,  1  } ;
+    int  e = makraw_wave (  &r  ,  ch  ,  K  ,  s  ,  N  ,  L  ,  w  ) ;
+    
+    if  ( e )
+      mexErrMsgIdAndTxt (  "MAK:fun:read"  ,  "fun: %s"  ,
+        makraw_msg[ e ]  ) ;
+  
+  Channels and frames are zero-based here. makraw_index ( ) ,
+  makraw_range ( ) , and makraw_window ( ) turn MATLAB's one-based
+  channels and frames into zero-based ones , and return non-zero if any is
+  not within the source.
+  
+  Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+
+*/
+
+#ifndef  MAKRAW_H
+#define  MAKRAW_H
+
+
+/*-- Include block --*/
+
+#include    <math.h>
+#include  <stdint.h>
+#include  <stdlib.h>
+#include  <string.h>
+#include     "mex.h"
+#include  "matrix.h"
+
+
+/*-- Define block --*/
+
+/* Return codes */
+#define  MAKRAW_OK    0
+#define  MAKRAW_READ  1
+#define  MAKRAW_MEM   2
+
+/* Bytes per chunk of a source that has no chunks of its own */
+#define  MAKRAW_BYTES  ( 1 << 22 )
+
+
+/*-- Data types --*/
+
+/* Reads n frames from frame a of src into x , C * n values. Returns
+   non-zero on failure. */
+typedef int  ( * makraw_fn ) ( void * src , int16_t * x , mwSize a ,
+  mwSize n ) ;
+
+/* A source of frames */
+typedef struct
+{
+  
+  /* Source , and its read function */
+  void  * src ;
+  makraw_fn  read ;
+  
+  /* Channels , frames , and frames per chunk */
+  mwSize  C , F , B ;
+  
+  /* Non-zero if read can be called by many threads at once */
+  int  par ;
+
+} makraw_t ;
+
+
+/*-- Messages , indexed by return code --*/
+
+static const char  * const makraw_msg[ ] =
+{
+  "no error"  ,
+  "failed to read from the source"  ,
+  "not enough memory for a read buffer"
+} ;
+
+
+/*-- Subroutines --*/
+
+/* Writes the numbers of a to x as zero-based indices. Returns non-zero
+   unless a is a real double array of integers from 1 to n , or empty. */
+static int  makraw_index ( const mxArray * a , mwSize n , mwSize * x )
+{
+  mwSize  i , N = mxGetNumberOfElements (  a  ) ;
+  const double  * v ;
+  
+  if  ( !mxIsDouble( a )  ||  mxIsComplex( a )  ||  mxIsSparse( a ) )
+    return  1 ;
+  
+  for  ( v = mxGetPr( a ) , i = 0 ; i < N ; i++ )
+  {
+    if  ( !( 1 <= v[ i ]  &&  v[ i ] <= ( double ) n )  ||
+          v[ i ] != floor( v[ i ] ) )
+      return  1 ;
+    
+    x[ i ] = ( mwSize ) v[ i ]  -  1 ;
+  }
+  
+  return  0 ;
+}
+
+/* Reads [ s0 , s1 ] in a , the first and last of F frames counting from
+   1 , as zero-based first frame f and number of frames n. s1 is s0 - 1
+   for no frames. Returns non-zero if a is not such a range. */
+static int  makraw_range ( const mxArray * a , mwSize F , mwSize * f ,
+  mwSize * n )
+{
+  const double  * v = mxIsDouble( a )  &&  !mxIsComplex( a )  &&
+    mxGetNumberOfElements( a ) == 2  ?  mxGetPr( a )  :  NULL ;
+  
+  if  (  !v  ||  !( 1 <= v[ 0 ] )  ||  v[ 0 ] != floor( v[ 0 ] )  ||
+         v[ 1 ] != floor( v[ 1 ] )  ||  !( v[ 0 ] - 1 <= v[ 1 ] )  ||
+         !( v[ 1 ] <= ( double ) F )  )
+    return  1 ;
+  
+  *f = ( mwSize ) v[ 0 ]  -  1 ;
+  *n = ( mwSize ) v[ 1 ]  -  *f ;
+  
+  return  0 ;
+}
+
+/* Reads window [ pre , post ] from a , and frames s from b , counting
+   from 1 , into zero-based first frames f of windows of L = pre + post + 1
+   frames. Returns non-zero if a window is not integers of 0 or more , or
+   if any window is not within F frames. */
+static int  makraw_window ( const mxArray * a , const mxArray * b ,
+  mwSize F , mwSize * f , mwSize * L )
+{
+  const double  * v = mxIsDouble( a )  &&  !mxIsComplex( a )  &&
+    mxGetNumberOfElements( a ) == 2  ?  mxGetPr( a )  :  NULL ;
+  mwSize  i , N = mxGetNumberOfElements (  b  ) , pre ;
+  
+  if  (  !v  ||  !( 0 <= v[ 0 ] )  ||  !( 0 <= v[ 1 ] )  ||
+         v[ 0 ] != floor( v[ 0 ] )  ||  v[ 1 ] != floor( v[ 1 ] )  ||
+         !( v[ 0 ] + v[ 1 ] < ( double ) F )  )
+    return  1 ;
+  
+  pre = ( mwSize ) v[ 0 ] ;
+  *L = pre  +  ( mwSize ) v[ 1 ]  +  1 ;
+  
+  if  ( makraw_index(  b  ,  F - ( mwSize ) v[ 1 ]  ,  f  ) )  return  1 ;
+  
+  for  ( i = 0 ; i < N ; i++ )
+  {
+    if  ( f[ i ]  <  pre )  return  1 ;
+    f[ i ] -= pre ;
+  }
+  
+  return  0 ;
+}
+
+/* Copies channels ch of n frames in buffer b , with C channels per frame ,
+   to x , with K values per frame */
+static void  makraw_gather ( int16_t * x , const int16_t * b , mwSize n ,
+  mwSize C , const mwSize * ch , mwSize K )
+{
+  mwSize  i , k ;
+  
+  for  ( i = 0 ; i < n ; i++ , x += K , b += C )
+    for  ( k = 0 ; k < K ; k++ )
+      x[ k ] = b[ ch[ k ] ] ;
+}
+
+/* Reads frames a to a + n - 1 from channels ch , K of them , into x , a
+   K x n array. If ch is NULL then all channels are read , in order. */
+static int  makraw_slab ( const makraw_t * r , const mwSize * ch ,
+  mwSize K , mwSize a , mwSize n , int16_t * x )
+{
+  mwSignedIndex  j , j0 , j1 ;
+  mwSize  k ;
+  int  all = ch == NULL , e = MAKRAW_OK ;
+  
+  if  ( !n )  return  MAKRAW_OK ;
+  
+  /* Channels are read straight into x if they are all there , in order */
+  for  ( k = 0 ; all == 0  &&  k < K ; k++ )
+    if  ( ch[ k ]  !=  k )  break ;
+  
+  all = all  ||  ( K == r->C  &&  k == K ) ;
+  
+  j0 = ( mwSignedIndex ) ( a  /  r->B ) ;
+  j1 = ( mwSignedIndex ) ( ( a + n - 1 )  /  r->B ) ;
+  
+  #pragma omp parallel if( r->par )
+  {
+    /* Buffer of the thread , and its error */
+    int16_t  * b = all  ?  NULL  :
+      malloc (  r->B * r->C * sizeof( int16_t )  ) ;
+    int  d = !all  &&  !b  ?  MAKRAW_MEM  :  MAKRAW_OK ;
+    
+    #pragma omp for schedule( dynamic , 1 )
+    for  ( j = j0 ; j <= j1 ; j++ )
+    {
+      /* Frames of chunk j that are in the range */
+      mwSize  i = ( mwSize ) j * r->B  <  a  ?  a  :  ( mwSize ) j * r->B ;
+      mwSize  m = ( mwSize ) ( j + 1 ) * r->B  <  a + n  ?
+                  ( mwSize ) ( j + 1 ) * r->B - i  :  a + n - i ;
+      
+      if  ( d )  continue ;
+      
+      if  ( all )
+      {
+        if  ( r->read(  r->src  ,  x + ( i - a ) * K  ,  i  ,  m  ) )
+          d = MAKRAW_READ ;
+      }
+      else if  ( r->read(  r->src  ,  b  ,  i  ,  m  ) )
+        d = MAKRAW_READ ;
+      else
+        makraw_gather (  x + ( i - a ) * K  ,  b  ,  m  ,  r->C  ,  ch  ,
+          K  ) ;
+    }
+    
+    free (  b  ) ;
+    
+    /* Worst error of any thread */
+    #pragma omp critical
+    e = e < d  ?  d  :  e ;
+  }
+  
+  return  e ;
+}
+
+/* Reads L frames from frame s[ i ] of channels ch , K of them , for each
+   of N spikes , into w , an L x N x K array. Spikes can be in any order.
+   Each chunk that holds a first frame is read along with the L - 1 frames
+   that follow it. */
+static int  makraw_wave ( const makraw_t * r , const mwSize * ch ,
+  mwSize K , const mwSize * s , mwSize N , mwSize L , int16_t * w )
+{
+  mwSignedIndex  j ;
+  mwSize  i , J , nj , * cnt , * o , * q ;
+  int  e = MAKRAW_OK ;
+  
+  if  ( !N  ||  !L )  return  MAKRAW_OK ;
+  
+  /* Counting sort of spikes by chunk. Spikes of chunk j are o[ cnt[ j ] ]
+     to o[ cnt[ j + 1 ] - 1 ]. q lists the nj chunks with spikes. */
+  J = ( r->F  +  r->B  -  1 )  /  r->B ;
+  cnt = calloc (  J + 1  ,  sizeof( mwSize )  ) ;
+  o = malloc (  N * sizeof( mwSize )  ) ;
+  q = malloc (  ( N < J ? N : J ) * sizeof( mwSize )  +  1  ) ;
+  
+  if  ( !cnt  ||  !o  ||  !q )
+  {
+    free (  cnt  ) ;  free (  o  ) ;  free (  q  ) ;
+    return  MAKRAW_MEM ;
+  }
+  
+  for  ( i = 0 ; i < N ; i++ )  cnt[ s[ i ] / r->B + 1 ]++ ;
+  
+  for  ( nj = 0 , i = 0 ; i < J ; i++ )
+  {
+    if  ( cnt[ i + 1 ] )  q[ nj++ ] = i ;
+    cnt[ i + 1 ] += cnt[ i ] ;
+  }
+  
+  for  ( i = 0 ; i < N ; i++ )  o[ cnt[ s[ i ] / r->B ]++ ] = i ;
+  
+  /* cnt[ j ] now ends chunk j , shift it back to its start */
+  memmove (  cnt + 1  ,  cnt  ,  J * sizeof( mwSize )  ) ;
+  cnt[ 0 ] = 0 ;
+  
+  #pragma omp parallel if( r->par )
+  {
+    /* Buffer of the thread , and its error */
+    int16_t  * b = malloc (  ( r->B + L - 1 ) * r->C * sizeof( int16_t )  ) ;
+    int  d = b  ?  MAKRAW_OK  :  MAKRAW_MEM ;
+    
+    #pragma omp for schedule( dynamic , 1 )
+    for  ( j = 0 ; j < ( mwSignedIndex ) nj ; j++ )
+    {
+      mwSize  a = q[ j ]  *  r->B , m , n , k , t ;
+      const int16_t  * f ;
+      
+      if  ( d )  continue ;
+      
+      /* Frames of the chunk and those that follow it */
+      m = r->B + L - 1  <  r->F - a  ?  r->B + L - 1  :  r->F - a ;
+      
+      if  ( r->read(  r->src  ,  b  ,  a  ,  m  ) )
+      {
+        d = MAKRAW_READ ;
+        continue ;
+      }
+      
+      /* Window of each spike , channel by channel */
+      for  ( n = cnt[ q[ j ] ] ; n < cnt[ q[ j ] + 1 ] ; n++ )
+        for  ( f = b + ( s[ o[ n ] ] - a ) * r->C , k = 0 ; k < K ; k++ )
+          for  ( t = 0 ; t < L ; t++ )
+            w[ t  +  L * ( o[ n ]  +  N * k ) ] = f[ t * r->C  +  ch[ k ] ] ;
+    }
+    
+    free (  b  ) ;
+    
+    /* Worst error of any thread */
+    #pragma omp critical
+    e = e < d  ?  d  :  e ;
+  }
+  
+  free (  cnt  ) ;
+  free (  o  ) ;
+  free (  q  ) ;
+  
+  return  e ;
+}
+
+
+#endif  /* MAKRAW_H */
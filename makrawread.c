@@ -0,0 +1,272 @@
+
+/*  makrawread
+  
+  x = makrawread ( file , C , ch , r )
+  w = makrawread ( file , C , ch , s , win )
+  
+  MET Analysis Kit. Reads int16 samples straight from a flat binary
+  recording , such as the .dat or .bin file of an acquisition system ,
+  without loading it all or writing an intermediate .mat file. The file
+  holds one int16 sample from every one of C channels per frame , one frame
+  after another , with channels interleaved and no header. Frames are read
+  in chunks of about 4MiB , see makraw.h.
+  
+  file is the name of the file. C is the number of channels. ch is a
+  vector of channel indices , from 1 to C , that are read. If ch is empty
+  then all channels are read , in order.
+  
+  r is [ s0 , s1 ] , the first and last frame that are read , counting
+  from 1. x is then a K x n int16 matrix , with one row for each of the K
+  channels of ch , and a column for each frame from s0 to s1.
+  
+  Given s and win , a window of frames is read around each of N spikes.
+  s is a vector of frame indices , counting from 1 , such as the threshold
+  crossing of each spike , in any order. win is [ pre , post ] , the number
+  of frames before and after s( i ) that are read. w is then an
+  L x N x K int16 array with L = pre + post + 1 , frames over rows , spikes
+  over columns , and channels over the third dimension. For one channel ,
+  w is the S x N matrix of waveforms that makalignspks takes , with
+  p.prethr equal to pre. Only the chunks of the file that hold a spike are
+  read.
+  
+  Compile with OpenMP to read chunks of the file on many threads at once.
+  
+  Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+
+*/
+
+
+/*-- Include block --*/
+
+/* Files larger than 2GiB need 64-bit offsets , and pread is POSIX */
+#define  _FILE_OFFSET_BITS  64
+#define  _XOPEN_SOURCE  700
+
+#include     <fcntl.h>
+#include    <unistd.h>
+#include  <sys/stat.h>
+#include     "mex.h"
+#include  "matrix.h"
+#include  "makraw.h"
+
+
+/*-- Define block --*/
+
+#define  NARGINMIN  4
+#define  NARGINMAX  5
+#define    NARGOUT  1
+#define    FILEARG  0
+#define       CARG  1
+#define      CHARG  2
+#define       RARG  3
+#define       SARG  3
+#define     WINARG  4
+#define       XOUT  0
+
+
+/*-- Data types --*/
+
+/* An open file , with C channels per frame */
+typedef struct
+{
+  
+  int  fd ;
+  mwSize  C ;
+
+} rawfile_t ;
+
+
+/*-- Subroutines --*/
+
+/* Reads n frames from frame a of rawfile_t f into x. pread ( ) does not
+   move the file position , and so threads can read at the same time. */
+static int  readraw ( void * f , int16_t * x , mwSize a , mwSize n )
+{
+  const rawfile_t  * r = f ;
+  size_t  b = n  *  r->C  *  sizeof( int16_t ) ;
+  off_t  o = ( off_t ) ( a * r->C * sizeof( int16_t ) ) ;
+  ssize_t  m ;
+  
+  /* pread can return fewer bytes than asked for */
+  while  ( b )
+  {
+    m = pread (  r->fd  ,  x  ,  b  ,  o  ) ;
+    
+    if  ( m  <=  0 )  return  1 ;
+    
+    x = ( int16_t * ) ( ( char * ) x  +  m ) ;
+    b -= ( size_t ) m ;
+    o += m ;
+  }
+  
+  return  0 ;
+}
+
+
+/*** MEX gateway function ***/
+
+void  mexFunction (  int nlhs  ,        mxArray * plhs[ ] ,
+                     int nrhs  ,  const mxArray * prhs[ ]  )
+{
+  
+  
+  /*-- Variables --*/
+  
+  /* Channels that are read , and first frame of each window */
+  mwSize  * ch , * s ;
+  
+  /* Number of channels read , spikes , frames , and size of w */
+  mwSize  K , N , n = 0 , dims[ 3 ] ;
+  
+  /* First frame , and counter */
+  mwSize  a = 0 , i ;
+  
+  /* Number of channels */
+  double  c ;
+  
+  /* Source of frames */
+  makraw_t  r ;
+  
+  /* The file */
+  rawfile_t  f ;
+  struct stat  st ;
+  char  * file ;
+  
+  /* Error code */
+  int  e ;
+  
+  
+  /*-- Input check --*/
+  
+  /* Must be 4 or 5 input args */
+  if  ( nrhs < NARGINMIN  ||  NARGINMAX < nrhs )
+    
+    mexErrMsgIdAndTxt (  "MAK:makrawread:nargsin"  ,
+      "makrawread: takes %d or %d input arguments"  ,
+      NARGINMIN  ,  NARGINMAX  ) ;
+  
+  /* Must be no more than 1 output arg */
+  else if  ( NARGOUT  <  nlhs )
+    
+    mexErrMsgIdAndTxt (  "MAK:makrawread:nargsout"  ,
+      "makrawread: returns at most %d output argument"  ,  NARGOUT  ) ;
+  
+  /* file must be a string */
+  else if  ( !mxIsChar(  prhs[ FILEARG ]  ) )
+    
+    mexErrMsgIdAndTxt (  "MAK:makrawread:file"  ,
+      "makrawread: file must be a string"  ) ;
+  
+  /* C must be a positive integer */
+  c = mxIsDouble( prhs[ CARG ] )  &&  !mxIsComplex( prhs[ CARG ] )  &&
+      mxIsScalar( prhs[ CARG ] )  ?  mxGetScalar( prhs[ CARG ] )  :  0 ;
+  
+  if  ( !( 1 <= c )  ||  c != floor( c ) )
+    
+    mexErrMsgIdAndTxt (  "MAK:makrawread:C"  ,
+      "makrawread: C must be a positive integer"  ) ;
+  
+  f.C = ( mwSize ) c ;
+  
+  /* Channels , all of them if ch is empty */
+  K = mxGetNumberOfElements (  prhs[ CHARG ]  ) ;
+  K = K  ?  K  :  f.C ;
+  ch = mxMalloc (  K * sizeof( mwSize )  ) ;
+  
+  if  ( makraw_index(  prhs[ CHARG ]  ,  f.C  ,  ch  ) )
+    
+    mexErrMsgIdAndTxt (  "MAK:makrawread:ch"  ,
+      "makrawread: ch must have integers from 1 to C"  ) ;
+  
+  if  ( mxIsEmpty(  prhs[ CHARG ]  ) )
+    for  ( i = 0 ; i < K ; i++ )  ch[ i ] = i ;
+  
+  /* Open the file and count whole frames */
+  file = mxArrayToString (  prhs[ FILEARG ]  ) ;
+  f.fd = open (  file  ,  O_RDONLY  ) ;
+  mxFree (  file  ) ;
+  
+  if  ( f.fd  ==  -1 )
+    
+    mexErrMsgIdAndTxt (  "MAK:makrawread:file"  ,
+      "makrawread: can't open file"  ) ;
+  
+  else if  ( fstat(  f.fd  ,  &st  ) )
+  {
+    close (  f.fd  ) ;
+    mexErrMsgIdAndTxt (  "MAK:makrawread:file"  ,
+      "makrawread: can't get size of file"  ) ;
+  }
+  
+  r.src  = &f ;
+  r.read = readraw ;
+  r.C    = f.C ;
+  r.F    = ( mwSize ) st.st_size  /  ( f.C * sizeof( int16_t ) ) ;
+  r.B    = MAKRAW_BYTES  /  ( f.C * sizeof( int16_t ) ) ;
+  r.B    = r.B  ?  r.B  :  1 ;
+  r.par  = 1 ;
+  
+  
+  /*-- Range of frames --*/
+  
+  if  ( nrhs  ==  NARGINMIN )
+  {
+    if  ( makraw_range(  prhs[ RARG ]  ,  r.F  ,  &a  ,  &n  ) )
+    {
+      close (  f.fd  ) ;
+      mexErrMsgIdAndTxt (  "MAK:makrawread:r"  ,
+        "makrawread: r must be [ s0 , s1 ] , frames from 1 to %.0f"  ,
+        ( double ) r.F  ) ;
+    }
+    
+    plhs[ XOUT ] = mxCreateNumericMatrix (  K  ,  n  ,  mxINT16_CLASS  ,
+      mxREAL  ) ;
+    
+    e = makraw_slab (  &r  ,  ch  ,  K  ,  a  ,  n  ,
+      mxGetData( plhs[ XOUT ] )  ) ;
+  }
+  
+  
+  /*-- Window around each spike --*/
+  
+  else
+  {
+    N = mxGetNumberOfElements (  prhs[ SARG ]  ) ;
+    s = mxMalloc (  ( N + 1 ) * sizeof( mwSize )  ) ;
+    
+    /* Each window must be within the file */
+    if  ( makraw_window(  prhs[ WINARG ]  ,  prhs[ SARG ]  ,  r.F  ,  s  ,
+                          &dims[ 0 ]  ) )
+    {
+      close (  f.fd  ) ;
+      mexErrMsgIdAndTxt (  "MAK:makrawread:s"  ,
+        "makrawread: win must be [ pre , post ] , integers of 0 or more , "
+        "and s frames from pre + 1 to %.0f - post"  ,  ( double ) r.F  ) ;
+    }
+    
+    dims[ 1 ] = N ;
+    dims[ 2 ] = K ;
+    
+    plhs[ XOUT ] = mxCreateNumericArray (  3  ,  dims  ,  mxINT16_CLASS  ,
+      mxREAL  ) ;
+    
+    e = makraw_wave (  &r  ,  ch  ,  K  ,  s  ,  N  ,  dims[ 0 ]  ,
+      mxGetData( plhs[ XOUT ] )  ) ;
+    
+    mxFree (  s  ) ;
+  }
+  
+  
+  /*-- Done --*/
+  
+  close (  f.fd  ) ;
+  mxFree (  ch  ) ;
+  
+  if  ( e )
+    
+    mexErrMsgIdAndTxt (  "MAK:makrawread:read"  ,
+      "makrawread: %s"  ,  makraw_msg[ e ]  ) ;
+
+
+} /* mexFunction */
+
@@ -0,0 +1,47 @@
+
+% x = makrawread ( file , C , ch , r )
+% w = makrawread ( file , C , ch , s , win )
+% 
+% MET Analysis Kit. Reads int16 samples straight from a flat binary
+% recording, such as the .dat or .bin file that many acquisition systems
+% write. Only the frames that are asked for are read, so that spike
+% waveforms or a stretch of raw data can be passed to MAK functions without
+% loading a multi-GB recording, or writing a copy of it to a .mat file.
+% 
+% file is the name of the file. It holds one int16 sample from every one of
+% C channels per frame, one frame after another. That is, channels are
+% interleaved and there is no header. ch is a vector of indices from 1 to
+% C of the channels that are read, or empty for all channels in order.
+% 
+% r is [ s0 , s1 ], the first and last frame that are read, counting from
+% 1. x is then a K x n int16 matrix with one row for each of the K channels
+% in ch, and one column for each frame from s0 to s1.
+% 
+% Given s and win, a window of frames is read around each of N spikes. s is
+% a vector of frame indices, counting from 1, such as the threshold
+% crossing of each spike. Spikes can be in any order. win is
+% [ pre , post ], the number of frames before and after s( i ) that are
+% read. w is then an L x N x K int16 array with L = pre + post + 1 frames
+% over rows, spikes over columns, and channels over the third dimension.
+% For one channel, w is the S x N matrix of waveforms that makalignspks
+% takes, with p.prethr equal to pre. For example
+% 
+%   p.prethr = 10 ;
+%   w = makrawread (  'rec.dat'  ,  384  ,  c  ,  s  ,  [ 10 , 21 ]  ) ;
+%   a = makalignspks (  p  ,  t( c )  ,  w  ) ;
+% 
+% The file is read in chunks of about 4MiB that begin on whole multiples of
+% the chunk size. Windows are read chunk by chunk, so each chunk that holds
+% a spike is read once, and chunks without spikes are not read at all. See
+% makraw.h, which must be in the same directory as makrawread.c. maknwbread
+% reads the same things from an NWB file.
+% 
+% If MEX is compiled with OpenMP then chunks are read by many threads at
+% once, e.g.
+% 
+%   mex CFLAGS='$CFLAGS -fopenmp' LDFLAGS='$LDFLAGS -fopenmp' makrawread.c
+% 
+% Otherwise, it runs on a single thread.
+% 
+% Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+% 
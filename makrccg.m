@@ -32,7 +32,10 @@ function  [ rccg , varargout ] = makrccg (  varargin  )
 %   the limit, it is the auto-covariance and can be used to recover the
 %   cross-covariance from any two units at any given integration lag. lags
 %   is an L x 1 vector of milliseconds of lag, in register with the rows of
-%   rccg.
+%   rccg. C may also be a struct of packed spike trains from makspkpack,
+%   or a makbincache session cache. Then binned counts are taken from the
+%   cache, and other analyses of the same session can share them. They
+%   are the same counts that histcounts gives.
 % 
 % [ rccg , lags , nscx ] = makrccg (  w  ,  ...  ) - For any previous form
 %   of makrccg, an optional third output argument can be returned. This
@@ -77,6 +80,11 @@ function  [ rccg , varargout ] = makrccg (  varargin  )
 %   the 95% BCA bootstrap confidence intervals around the r_ccg for every
 %   spike cluster pair.
 % 
+% rccg can be kept as int16 fixed-point values in a quarter of the memory
+%   by makq16 (  rccg  ), and decoded again by makq16 (  q  ,  'double'  ).
+%   But the un-normalised auto-correlations in rccg( : , i , i ) saturate
+%   at +/-1, and must be kept separately if they are needed.
+% 
 % 
 % Reference:
 % 
@@ -101,6 +109,9 @@ function  [ rccg , varargout ] = makrccg (  varargin  )
   % UniformOutput false input argument
   UF = {  'UniformOutput'  ,  false  } ;
   
+  % No cache of binned counts , by default
+  bc = [ ] ;
+  
   
   %%% Check input %%%
   
@@ -141,12 +152,32 @@ function  [ rccg , varargout ] = makrccg (  varargin  )
     % Number of lags in milliseconds
     Nlags = ceil (  Nlags  /  0.001  )  -  1 ;
     
+    % Spike trains are checked , unless they were packed and checked already
+    chk = true ;
+    
     % Get spike cluster trains from C
     if  nargin  ==  2
       
       % Assign name
       C = varargin{ 2 } ;
       
+      % Session cache of binned counts from makbincache. Its spike trains
+      % were checked when it was made , so C only holds place.
+      if  isa (  C  ,  'makbincache'  )
+        
+        bc = C ;
+        C = cell (  bc.T  ,  bc.U  ) ;
+      
+      % Packed spike trains from makspkpack , unpacked into row vectors. If
+      % C.valid is true then their spike times were checked when they were
+      % packed , and makspkpack only checks the offsets.
+      elseif  isstruct (  C  )
+        
+        chk = ~ ( isfield( C , 'valid' )  &&  isequal( C.valid , true ) ) ;
+        C = makspkpack (  C  ) ;
+      
+      end
+      
       % Must have no more than 2 dimensions with at least 2 columns
       if  ~ iscell (  C  )  ||  isempty (  C  )
 
@@ -193,14 +224,45 @@ function  [ rccg , varargout ] = makrccg (  varargin  )
       
     end % spk clust trains
     
-    % Check that all spike trains are numeric row vectors or empty
-    c = cellfun (  ...
-      @( c ) isnumeric( c ) && ( isrow( c ) || isempty( c ) )  ,  C  ) ;
+    % Check that all spike trains are numeric vectors , or empty. They need
+    % not be in order.
+    if  chk
+      
+      % Integer spike times , such as sample stamps , are binned as doubles
+      c = cellfun (  @( c ) isnumeric( c ) && ~ isfloat( c )  ,  C  ) ;
+      if  any (  c( : )  )
+        C( c ) = cellfun (  @double  ,  C( c )  ,  UF{ : }  ) ;
+      end
+      
+      [ ok , k , why ] = makspkchk (  C  ,  false  ) ;
+      
+      % histcounts ignores NaN and Inf , so they are dropped before another
+      % check
+      if  ~ ok  &&  k  &&  isfloat (  C{ k }  )  &&  ...
+          ~ all (  isfinite(  C{ k }  )  )
+        
+        c = cellfun (  @isfloat  ,  C  ) ;
+        C( c ) = cellfun (  @( c ) c( isfinite( c ) )  ,  C( c )  ,  UF{ : } );
+        [ ok , k , why ] = makspkchk (  C  ,  false  ) ;
+        
+      end
+      
+      if  ~ ok
+        
+        error (  'MAK:makrccg:spktrains'  ,  ...
+          'makrccg: spike train %d %s'  ,  k  ,  why  )
+        
+      end
+      
+    end
+    
+    % Spike trains are binned into rows
+    c = cellfun (  @( c ) isrow( c ) || isempty( c )  ,  C  ) ;
     
     if  ~ all (  c( : )  )
       
       error (  'MAK:makrccg:spkrowvect'  ,  ...
-        'makrccg: all spike trains must numeric row vectors or empties'  )
+        'makrccg: all spike trains must be row vectors or empties'  )
       
     end
     
@@ -274,27 +336,45 @@ function  [ rccg , varargout ] = makrccg (  varargin  )
     if  1  <  nargout  ,  varargout{ 1 } = ( 0 : Nlags )' ;  end
     
     % We need to build P by binning spike times using millisecond-width
-    % time bins
-    edges = ( 0 : Nlags + 1 ) / 1e3  +  w( 1 ) ;
+    % time bins. makbincache finds its edges from the same grid in the same
+    % way , so that both agree to the last bit.
+    edges = w( 1 )  +  ( 0 : Nlags + 1 )  *  1e-3 ;
+    
+    % Get binned counts from the cache , trials x bins x clusters
+    if  ~ isempty (  bc  )
+      Pc = bc.get (  'count'  ,  [ w( 1 ) , 1e-3 , Nlags + 1 ]  ) ;
+    end
     
     % At P and X are requested as output , compute P and X for each trial
     % and use up lots of memory
     if  RETNSCX  <  nargout
 
-      % Bin all spikes , P is Nclusts x Ntrials and contains column vects
-      P = cellfun (  @( c ) histcounts( c , edges )'  ,  C  , UF{ : }  )' ;
+      % Binned counts from the cache , as time bins x clusters x trials
+      if  ~ isempty (  bc  )
 
-      % Reshape cell array so that clusters span columns and trials span
-      % layers
-      P = reshape (  P  ,  1  ,  Nclusts  ,  Ntrials  ) ;
+        P = permute (  Pc  ,  [ 2 , 3 , 1 ]  ) ;
 
-      % And collapse into a single matrix of time bins x clusters x trials
-      P = cell2mat (  P  ) ;
+      else
+        
+        % Bin all spikes , P is Nclusts x Ntrials and contains column vects
+        P = cellfun (  @( c ) histcounts( c , edges )'  ,  C  , UF{ : }  )' ;
+        
+        % Reshape cell array so that clusters span columns and trials span
+        % layers
+        P = reshape (  P  ,  1  ,  Nclusts  ,  Ntrials  ) ;
+        
+        % And collapse into a single matrix of time bins x clusters x
+        % trials
+        P = cell2mat (  P  ) ;
+      
+      end % bin spikes
 
-      % Now we need to compute auto and cross correlations for each trial
+      % Now we need to compute auto and cross correlations for each trial.
+      % Spike counts are integers , so are their correlations. Rounding
+      % removes the error of the FFT that xcorr uses.
       parfor  i = 1 : Ntrials
 
-        X( : , : , i ) = xcorr (  P( : , : , i )  ) ;
+        X( : , : , i ) = round (  xcorr (  P( : , : , i )  )  ) ;
 
       end % trials
 
@@ -319,23 +399,43 @@ function  [ rccg , varargout ] = makrccg (  varargin  )
       P = zeros (  numel( edges ) - 1  ,  Nclusts  ) ;
       X = zeros (  2 * ( Nlags + 1 ) - 1  ,  Nclusts ^ 2  ) ;
       
+      % Binned counts of each trial from the cache , as time bins x
+      % clusters matrices
+      Pt = cell (  Ntrials  ,  1  ) ;
+      
+      if  ~ isempty (  bc  )
+        Pt = squeeze ( num2cell(  permute( Pc , [ 2 , 3 , 1 ] )  ,  ...
+          [ 1 , 2 ]  ) ) ;
+      end
+      
       % Trials
       parfor  i = 1 : Ntrials
         
-        % Bin all spikes on this trial , p is 1 x Nclusts cell array column
-        % vectors
-        p = cellfun (  @( c ) histcounts( c , edges )'  ,  C( i , : )  ,...
-          'UniformOutput'  ,  false  ) ;
+        % Binned by the cache
+        if  ~ isempty (  Pt{ i }  )
+        
+          p = Pt{ i } ;
+        
+        else
+          
+          % Bin all spikes on this trial , p is 1 x Nclusts cell array
+          % column vectors
+          p = cellfun (  @( c ) histcounts( c , edges )'  ,  C( i , : ) ,...
+            'UniformOutput'  ,  false  ) ;
+          
+          % Collapse p into a number of bins x spike clusters matrix of
+          % spikes binned from this trial
+          p = cell2mat (  p  ) ;
         
-        % Collapse p into a number of bins x spike clusters matrix of
-        % spikes binned from this trial
-        p = cell2mat (  p  ) ;
+        end % bin spikes
         
         % Accumulate spike count in each bin
         P = P  +  p ;
         
-        % Accumulate cross-/auto-correlations
-        X = X  +  xcorr (  p  ) ;
+        % Accumulate cross-/auto-correlations. These are integers , once
+        % the error of the FFT is rounded away. So the sum is exact , and
+        % does not depend on the order in which workers add trials.
+        X = X  +  round (  xcorr (  p  )  ) ;
         
       end % trials
       
@@ -441,14 +541,28 @@ function  [ rccg , varargout ] = makrccg (  varargin  )
   if  nargout  ==  RETNSCX
     
     % First , compute the average firing rate of all cells within the given
-    % time window
-    parfor  i = 1 : Nclusts
+    % time window , including both ends. The cache only holds C's place , so
+    % its packed spike trains are counted directly. The spikes of each
+    % train in the window are the difference of a cumulative sum at its
+    % offsets.
+    if  ~ isempty (  bc  )
       
-      G( 1 , i ) = mean (  ...
-        cellfun (  @( c )  sum (  w( 1 ) <= c  &  c <= w( 2 )  )  ,  ...
-          C( : , i )  )  )  /  diff (  w  ) ; %#ok
+      bp = bc.P ;
+      bn = [ 0 ; cumsum( w( 1 ) <= bp.t( : )  &  bp.t( : ) <= w( 2 ) ) ] ;
+      bn = bn( bp.off( 2 : end ) + 1 )  -  bn( bp.off( 1 : end - 1 ) + 1 ) ;
+      G = mean (  reshape( bn , bc.T , bc.U )  ,  1  )  /  diff (  w  ) ;
       
-    end % average rate
+    else
+      
+      parfor  i = 1 : Nclusts
+        
+        G( 1 , i ) = mean (  ...
+          cellfun (  @( c )  sum (  w( 1 ) <= c  &  c <= w( 2 )  )  ,  ...
+            C( : , i )  )  )  /  diff (  w  ) ; %#ok
+      
+      end % average rate
+    
+    end % cache
     
     % Now compute the geometric mean firing rate of each pair ,
     % transposition puts linear indexing of geo rate in register with
@@ -1,8 +1,9 @@
 
-function  rccg = makrccg2( X , keepnan )
+function  rccg = makrccg2( X , keepnan , maxw )
 % 
 % rccg = makrccg2( X )
 % rccg = makrccg2( X , keepnan )
+% rccg = makrccg2( X , keepnan , maxw )
 % 
 % MET Analysis Kit. A different implementation of r_CCG that allows for
 % more flexible manipulation of the neural signals. X is the M x N x T
@@ -42,7 +43,26 @@ function  rccg = makrccg2( X , keepnan )
 % provide the optional second input keepnan as true or false (scalar
 % logical).
 % 
-% Uses parallel computing toolbox.
+% Uses parallel computing toolbox. Each worker sums the cross-correlations
+% of its own trials, in two arrays of ( 2M - 1 ) x N x N values. Optional
+% third input maxw is the maximum number of workers to use, default Inf.
+% Fewer workers need less memory, and maxw of 0 runs on the client alone.
+% See makplan.
+% 
+% The sum over trials is made exact, so that rccg is bitwise identical for
+% any number of workers, and in any order that they finish. Each trial's
+% cross-correlations of neurones a and b are split into two parts, and
+% each part is summed over trials in its own array. The first part is
+% rounded to a multiple of a power of two q, chosen so that the sum has at
+% most as many significant bits as the floating point type. The sum over
+% trials of the product of the norms of a and b bounds the sum. Alone,
+% this would make an error of up to 2 T eps times the average product of
+% the norms, where eps is that of the class of X; about T times the error
+% of the FFT. So the remainder of each trial is summed in the second
+% array, rounded to a grid that is about T eps times finer than q. The
+% sum of both arrays then has an error of up to 4 ( T eps ) ^ 2 times the
+% average product of the norms, which is less than that of the FFT for any
+% practical number of trials.
 % 
 % Reference:
 % 
@@ -57,12 +77,15 @@ function  rccg = makrccg2( X , keepnan )
   %%% Quick check of input %%%
   
   % Number of arguments
-   narginchk( 1 , 2 )
+   narginchk( 1 , 3 )
   nargoutchk( 0 , 1 )
   
   % keepnan not provided, set default value
   if  nargin < 2  ,  keepnan = true ;  end
   
+  % maxw not provided, use all workers
+  if  nargin < 3  ,  maxw = Inf ;  end
+  
   % Size of neural signal array
   [ M , N , T ] = size( X ) ;
   
@@ -89,6 +112,14 @@ function  rccg = makrccg2( X , keepnan )
     error( 'MAK:makrccg2:keepnan' , ...
       'makrccg2: keepnan must be a scalar logical' )
     
+  % maxw must be a scalar non-negative integer or Inf
+  elseif  ~ isscalar( maxw )  ||  ~ isnumeric( maxw )  ||  ...
+      ~ isreal( maxw )  ||  maxw < 0  ||  ...
+      ( ~ isinf( maxw )  &&  mod( maxw , 1 ) )
+    
+    error( 'MAK:makrccg2:maxw' , ...
+      'makrccg2: maxw must be a scalar non-negative integer or Inf' )
+    
   end % input check
   
   
@@ -113,21 +144,39 @@ function  rccg = makrccg2( X , keepnan )
   lix = [ L2 - L0 + 1 : L2 , 1 : L0 + 1 ] ;
   
   % Auto- and cross-correlation of the PSTH
-  S = OrangeCountyLumberTruck( mean( X , 3 ) , N , L , L2 , lix ) ;
+  S = OrangeCountyLumberTruck( mean( X , 3 ) , N , L , L2 , lix , [] ) ;
+  
+  % Norm of each neurone's signal on each trial
+  Q = zeros( N , T , 'like' , X ) ;
+  for  i = 1 : T , Q( : , i ) = sqrt( sum( X( : , : , i ) .^ 2 , 1 ) ) ; end
   
-  % Allocate auto- & cross-correlation accumulator
+  % Grid of each pair of neurones. Sums of multiples of Q( a , b ) are exact
+  % up to twice the bound on the sum.
+  Q = 2 .^ ( nextpow2( double( Q ) * double( Q' ) ) + 1 ) * ...
+    eps( class( X ) ) ;
+  
+  % Grid of the remainders. Each is no more than half of Q( a , b ), so T
+  % of them sum to no more than T * Q( a , b ) / 2.
+  R = 2 .^ ( nextpow2( T * Q / 2 ) + 1 ) * eps( class( X ) ) ;
+  
+  % Allocate auto- & cross-correlation accumulators, for the parts on grid
+  % Q and the remainders on grid R
   C = zeros( L , N , N , 'like' , X ) ;
+  D = zeros( L , N , N , 'like' , X ) ;
   
   % Trials
-  parfor  i = 1 : T
+  parfor  ( i = 1 : T , maxw )
     
-    % Compute all auto- and cross-correlations, and accumulate sum
-    C = C  +  OrangeCountyLumberTruck( X( : , : , i ) , N , L , L2 , lix );
+    % Compute all auto- and cross-correlations, and accumulate sums
+    [ c , d ] = OrangeCountyLumberTruck( X( : , : , i ) , N , L , L2 , ...
+      lix , Q , R ) ;
+    C = C  +  c ;
+    D = D  +  d ;
     
   end % trials
   
   % Average correlation
-  C = C  ./  T ;
+  C = ( C  +  D )  ./  T ;
   
   % Subtract away correlations expected by fluctuations in the average
   % firing rate
@@ -176,11 +225,14 @@ end % makrccg2
 
 % Local implementation of xcorr. This will only compute results for the
 % upper-triangular portion of the correlation matrix. Then it will
-% transpose the flipped result into the lower-portion.
-function  C = OrangeCountyLumberTruck( X , N , L , L2 , lix )
+% transpose the flipped result into the lower-portion. Results are rounded
+% to the grid of each pair in Q, unless Q is empty. Then D returns the
+% remainders, rounded to the grid of each pair in R.
+function  [ C , D ] = OrangeCountyLumberTruck( X , N , L , L2 , lix , Q , R )
   
-  % Allocate cross-correlation matrix
+  % Allocate cross-correlation matrices
   C = zeros( L , N , N , 'like' , X ) ;
+  D = zeros( L , N , N , 'like' , X ) ;
   
   % Fourier transform of neural signals
   F = fft( X , L2 ) ;
@@ -206,15 +258,31 @@ function  C = OrangeCountyLumberTruck( X , N , L , L2 , lix )
     % Re-order lags and discard zero-padding
     y = y( lix , : ) ;
     
+    % Round to the grid of each pair. The remainder is exact, as it is the
+    % difference of two numbers of the same sign within a factor of two.
+    if  ~ isempty( Q )
+      h = bsxfun( @times , round( bsxfun( @rdivide , y , Q( i , j ) ) ) ,...
+        Q( i , j ) ) ;
+      r = y  -  h ;
+      r = bsxfun( @times , round( bsxfun( @rdivide , r , R( i , j ) ) ) ,...
+        R( i , j ) ) ;
+      y = h ;
+    end
+    
     % Save row of data
     C( : , i , j ) = permute( y , [ 1 , 3 , 2 ] ) ;
     
     % Flip order of lags and discard auto-correlation
     y = flip( y( : , 2 : end ) , 1 ) ;
-    j = j( 2 : end ) ;
+    k = j( 2 : end ) ;
     
     % Transpose data and copy to lower-triangular half
-    C( : , j , i ) = y ;
+    C( : , k , i ) = y ;
+    
+    % Same for the remainders
+    if  isempty( Q )  ,  continue  ,  end
+    D( : , i , j ) = permute( r , [ 1 , 3 , 2 ] ) ;
+    D( : , k , i ) = flip( r( : , 2 : end ) , 1 ) ;
     
   end % row
   
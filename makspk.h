@@ -0,0 +1,358 @@
+
+/*  makspk.h
+  
+  MET Analysis Kit. Validation of spike trains , and the packed spike train
+  format. A spike train is valid if it is empty , or if it is a real ,
+  non-sparse vector of type single or double that holds finite spike
+  times in chronological order. Empty trains are place holders for
+  missing data.
+  
+  makspk_cell ( ) checks every train of a cell array in one pass. The
+  class and size of each train are checked on one thread , and then the
+  spike times of all trains are divided between threads. It returns the
+  first invalid train , by linear index , and the reason why it failed ,
+  one of MAKSPK_TYPE , MAKSPK_FINITE , or MAKSPK_ORDER. makspk_packed ( )
+  does the same for packed spike trains , and can also return MAKSPK_PACK
+  if the struct itself is malformed. makspk_offsets ( ) checks only the
+  struct and its offsets , and is used when .valid is true. For example
+    
+    mwSize  k ;
+    int  e = makspk_cell (  prhs[ 0 ]  ,  1  ,  &k  ,  NULL  ) ;
+    
+    if  ( e )
+      mexErrMsgIdAndTxt (  "MAK:fun:spktrains"  ,
+        "fun: spike train %d %s"  ,  ( int ) k + 1  ,  makspk_msg[ e ]  ) ;
+  
+  A packed set of spike trains is a struct with fields
+    
+    .t - N x 1 double , the spike times of all trains , one after another
+    .off - ( T * M + 1 ) x 1 double offsets , train i is
+      t( off( i ) + 1 : off( i + 1 ) )
+    .size - [ T , M ] , the size of the cell array that was packed
+    .valid - scalar logical , true if every train is valid
+  
+  Trains are packed in the same order as the elements of a cell array ,
+  trials over rows and clusters over columns. See makspkpack and makspkchk.
+  
+  Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+
+*/
+
+#ifndef  MAKSPK_H
+#define  MAKSPK_H
+
+
+/*-- Include block --*/
+
+#include    <math.h>
+#include  <stdlib.h>
+#include     "mex.h"
+#include  "matrix.h"
+
+#ifdef  _OPENMP
+  #include  <omp.h>
+#endif
+
+
+/*-- Define block --*/
+
+/* Reasons for failure */
+#define  MAKSPK_OK      0
+#define  MAKSPK_TYPE    1
+#define  MAKSPK_FINITE  2
+#define  MAKSPK_ORDER   3
+#define  MAKSPK_PACK    4
+
+/* Field names of packed spike trains , and their number */
+#define  MAKSPK_T      "t"
+#define  MAKSPK_OFF    "off"
+#define  MAKSPK_SIZE   "size"
+#define  MAKSPK_VALID  "valid"
+#define  MAKSPK_NFLD   4
+
+
+/*-- Data types --*/
+
+/* Spike times of one train , double if dbl is non-zero and single
+   otherwise , and the number of spikes */
+typedef struct
+{
+  
+  const void  * s ;
+  int  dbl ;
+  mwSize  n ;
+
+} makspk_t ;
+
+
+/*-- Subroutines --*/
+
+/* Reason for failure , as text */
+static const char  * const makspk_msg[ ] =
+  {  "is valid"  ,
+     "is not a real vector of type single or double , or empty"  ,
+     "has Inf or NaN spike times"  ,
+     "is not in chronological order"  ,
+     "packed spike trains have a bad field or offset"  } ;
+
+/* Checks the class and size of spike train a , and returns its spike
+   times in s. a may be NULL , an empty cell. */
+static int  makspk_type ( const mxArray * a , makspk_t * s )
+{
+  s->s = NULL ;  s->dbl = 1 ;  s->n = 0 ;
+  
+  if  ( !a  ||  mxIsEmpty( a ) )  return  MAKSPK_OK ;
+  
+  if  (  !( mxIsDouble( a ) || mxIsSingle( a ) )  ||  mxIsComplex( a )  ||
+         mxIsSparse( a )  ||  mxGetNumberOfDimensions( a ) != 2  ||
+         ( mxGetM( a ) != 1  &&  mxGetN( a ) != 1 )  )
+    return  MAKSPK_TYPE ;
+  
+  s->s = mxGetData (  a  ) ;
+  s->dbl = mxIsDouble (  a  ) ;
+  s->n = mxGetNumberOfElements (  a  ) ;
+  
+  return  MAKSPK_OK ;
+}
+
+/* Checks that spike times are finite , and in chronological order if ord
+   is non-zero. One pass. */
+static int  makspk_times ( const makspk_t * s , int ord )
+{
+  mwSize  i ;
+  
+  if  ( s->dbl )
+  {
+    const double  * x = ( const double * ) s->s ;
+    
+    for  ( i = 0 ; i < s->n ; i++ )
+    {
+      if  ( !isfinite( x[ i ] ) )  return  MAKSPK_FINITE ;
+      if  ( ord  &&  i  &&  x[ i ] < x[ i - 1 ] )  return  MAKSPK_ORDER ;
+    }
+  }
+  else
+  {
+    const float  * x = ( const float * ) s->s ;
+    
+    for  ( i = 0 ; i < s->n ; i++ )
+    {
+      if  ( !isfinite( x[ i ] ) )  return  MAKSPK_FINITE ;
+      if  ( ord  &&  i  &&  x[ i ] < x[ i - 1 ] )  return  MAKSPK_ORDER ;
+    }
+  }
+  
+  return  MAKSPK_OK ;
+}
+
+/* Checks one spike train a */
+static int  makspk_check ( const mxArray * a , int ord )
+{
+  makspk_t  s ;
+  int  e = makspk_type (  a  ,  &s  ) ;
+  
+  return  e  ?  e  :  makspk_times (  &s  ,  ord  ) ;
+}
+
+/* Checks all spike trains in cell array C , and returns the reason that
+   the first invalid train failed , or MAKSPK_OK. Its linear index is
+   returned in k. If s is not NULL then it must have one element per cell ,
+   and it returns the spike times of each train. */
+static int  makspk_cell ( const mxArray * C , int ord , mwSize * k ,
+  makspk_t * s )
+{
+  int  e = MAKSPK_OK ;
+  mwSize  i , m , n = mxGetNumberOfElements (  C  ) , f ;
+  mwSignedIndex  j ;
+  makspk_t  * x = s  ?  s  :  mxMalloc (  ( n + 1 ) * sizeof( makspk_t )  );
+  
+  /* Class and size , stop at the first failure */
+  for  ( f = n , i = 0 ; i < n ; i++ )
+    if  ( makspk_type(  mxGetCell( C , i )  ,  x + i  ) )
+    {
+      f = i ;
+      break ;
+    }
+  
+  /* Spike times of trains before that */
+  m = f ;
+  
+  #pragma omp parallel for schedule( dynamic , 64 ) reduction( min : f )
+  for  ( j = 0 ; j < ( mwSignedIndex ) m ; j++ )
+    if  ( ( mwSize ) j < f  &&  makspk_times(  x + j  ,  ord  ) )
+      f = ( mwSize ) j ;
+  
+  /* First invalid train */
+  if  ( f  <  n )  e = makspk_check (  mxGetCell( C , f )  ,  ord  ) ;
+  
+  *k = f ;
+  if  ( !s )  mxFree (  x  ) ;
+  
+  return  e ;
+}
+
+/* Checks the fields and offsets of packed spike trains P , but not their
+   spike times. This is O( trains ) , and is done even if .valid is true ,
+   so that a bad offset cannot index outside of .t. Offsets must be
+   integers that run from zero to the number of spikes , in order. A field
+   that is missing or of the wrong type , or a bad offset , is reported as
+   MAKSPK_PACK. n returns the number of trains. */
+static int  makspk_offsets ( const mxArray * P , mwSize * n )
+{
+  const mxArray  * t = mxIsStruct( P ) && mxIsScalar( P )  ?
+    mxGetField( P , 0 , MAKSPK_T ) : NULL ;
+  const mxArray  * o = t  ?  mxGetField( P , 0 , MAKSPK_OFF )  :  NULL ;
+  const double  * off ;
+  mwSize  i ;
+  
+  *n = 0 ;
+  
+  /* Fields */
+  if  (  !t  ||  !o  ||  !mxIsDouble( t )  ||  !mxIsDouble( o )  ||
+         mxIsComplex( t )  ||  mxIsComplex( o )  ||
+         mxIsSparse( t )  ||  mxIsSparse( o )  ||  mxIsEmpty( o )  )
+    return  MAKSPK_PACK ;
+  
+  off = mxGetPr (  o  ) ;
+  *n = mxGetNumberOfElements (  o  )  -  1 ;
+  
+  /* Offsets */
+  if  ( off[ 0 ] != 0  ||
+        off[ *n ] != ( double ) mxGetNumberOfElements( t ) )
+    return  MAKSPK_PACK ;
+  
+  for  ( i = 0 ; i < *n ; i++ )
+    if  ( !( off[ i ] <= off[ i + 1 ] )  ||  off[ i ] != floor( off[ i ] ) )
+      return  MAKSPK_PACK ;
+  
+  return  MAKSPK_OK ;
+}
+
+/* Checks packed spike trains P , first with makspk_offsets ( ) and then
+   the spike times of every train. */
+static int  makspk_packed ( const mxArray * P , int ord , mwSize * k )
+{
+  const double  * x , * off ;
+  mwSize  n , f ;
+  mwSignedIndex  j ;
+  
+  *k = 0 ;
+  
+  /* Fields and offsets */
+  if  ( makspk_offsets(  P  ,  &n  ) )  return  MAKSPK_PACK ;
+  
+  x = mxGetPr (  mxGetField( P , 0 , MAKSPK_T )  ) ;
+  off = mxGetPr (  mxGetField( P , 0 , MAKSPK_OFF )  ) ;
+  *k = n ;
+  
+  /* Spike times of each train */
+  f = n ;
+  
+  #pragma omp parallel for schedule( dynamic , 64 ) reduction( min : f )
+  for  ( j = 0 ; j < ( mwSignedIndex ) n ; j++ )
+  {
+    makspk_t  s ;
+    s.s = x  +  ( mwSize ) off[ j ] ;
+    s.dbl = 1 ;
+    s.n = ( mwSize ) ( off[ j + 1 ]  -  off[ j ] ) ;
+    if  ( ( mwSize ) j < f  &&  makspk_times(  &s  ,  ord  ) )
+      f = ( mwSize ) j ;
+  }
+  
+  *k = f ;
+  
+  if  ( f  <  n )
+  {
+    makspk_t  s ;
+    s.s = x  +  ( mwSize ) off[ f ] ;
+    s.dbl = 1 ;
+    s.n = ( mwSize ) ( off[ f + 1 ]  -  off[ f ] ) ;
+    return  makspk_times (  &s  ,  ord  ) ;
+  }
+  
+  return  MAKSPK_OK ;
+}
+
+/* Checks spike trains C , a cell array or packed spike trains , and
+   returns the spike times of each train in s , which must be freed with
+   mxFree. m and n return the number of rows and columns of trains , for
+   trials and units. The spike times of packed trains are not checked
+   again if .valid is true , but their fields and offsets are. Returns the
+   same as makspk_cell ( ) or makspk_packed ( ) ; s is NULL unless all
+   trains are valid. */
+static inline int  makspk_load ( const mxArray * C , int ord , mwSize * k ,
+  makspk_t ** s , mwSize * m , mwSize * n )
+{
+  const mxArray  * v , * z ;
+  const double  * x , * off , * sz ;
+  mwSize  i , N ;
+  int  e = MAKSPK_OK ;
+  
+  *s = NULL ;
+  *k = 0 ;
+  
+  /* Cell array , of any number of dimensions over columns */
+  if  ( mxIsCell(  C  ) )
+  {
+    N = mxGetNumberOfElements (  C  ) ;
+    *m = mxGetM (  C  ) ;
+    *n = *m  ?  N / *m  :  0 ;
+    *s = mxMalloc (  ( N + 1 ) * sizeof( makspk_t )  ) ;
+    e = makspk_cell (  C  ,  ord  ,  k  ,  *s  ) ;
+    
+    if  ( e )  {  mxFree (  *s  ) ;  *s = NULL ;  }
+    return  e ;
+  }
+  
+  /* Packed , spike times checked unless that was done already */
+  if  ( !mxIsStruct( C )  ||  !mxIsScalar( C ) )  return  MAKSPK_PACK ;
+  
+  v = mxGetField (  C  ,  0  ,  MAKSPK_VALID  ) ;
+  
+  if  ( !v  ||  !mxIsLogicalScalarTrue( v ) )
+    e = makspk_packed (  C  ,  ord  ,  k  ) ;
+  else
+    e = makspk_offsets (  C  ,  &N  ) ;
+  
+  if  ( e )  return  e ;
+  
+  x = mxGetPr (  mxGetField( C , 0 , MAKSPK_T )  ) ;
+  z = mxGetField (  C  ,  0  ,  MAKSPK_OFF  ) ;
+  off = mxGetPr (  z  ) ;
+  N = mxGetNumberOfElements (  z  )  -  1 ;
+  
+  /* Rows of trains , and the product of all other sizes */
+  z = mxGetField (  C  ,  0  ,  MAKSPK_SIZE  ) ;
+  
+  if  ( !z  ||  !mxIsDouble( z )  ||  mxGetNumberOfElements( z ) < 2 )
+    return  MAKSPK_PACK ;
+  
+  sz = mxGetPr (  z  ) ;
+  
+  for  ( i = 0 ; i < mxGetNumberOfElements( z ) ; i++ )
+    if  ( !( sz[ i ] >= 0 )  ||  sz[ i ] != floor( sz[ i ] ) )
+      return  MAKSPK_PACK ;
+  
+  *m = ( mwSize ) sz[ 0 ] ;
+  
+  for  ( *n = 1 , i = 1 ; i < mxGetNumberOfElements( z ) ; i++ )
+    *n *= ( mwSize ) sz[ i ] ;
+  
+  if  ( *m * *n  !=  N )  return  MAKSPK_PACK ;
+  
+  /* Spike times of each train */
+  *s = mxMalloc (  ( N + 1 ) * sizeof( makspk_t )  ) ;
+  
+  for  ( i = 0 ; i < N ; i++ )
+  {
+    ( *s )[ i ].s = x  +  ( mwSize ) off[ i ] ;
+    ( *s )[ i ].dbl = 1 ;
+    ( *s )[ i ].n = ( mwSize ) ( off[ i + 1 ]  -  off[ i ] ) ;
+  }
+  
+  return  MAKSPK_OK ;
+}
+
+
+#endif  /* MAKSPK_H */
+
@@ -0,0 +1,137 @@
+
+/*  makspkchk
+  
+  [ ok , k , why ] = makspkchk ( C )
+  [ ok , k , why ] = makspkchk ( C , ord )
+  
+  MET Analysis Kit. Checks a set of spike trains in one pass. C is a cell
+  array of spike trains , or a struct of packed spike trains from
+  makspkpack. Each train must be empty , or a real vector of type single
+  or double with finite spike times in chronological order. Optional ord
+  is a scalar logical , default true. If it is false then the order of
+  spike times is not checked.
+  
+  ok is true if all spike trains are valid. Otherwise , k is the linear
+  index of the first invalid train and why is a string that says why ; k
+  is zero if all trains are valid , or if packed C is malformed. If C is
+  packed and its .valid field is true then its spike times are not checked
+  again , but its fields and offsets are.
+  
+  Compile with OpenMP to divide spike trains between threads.
+  
+  Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+
+*/
+
+
+/*-- Include block --*/
+
+#include     "mex.h"
+#include  "matrix.h"
+#include  "makspk.h"
+
+
+/*-- Define block --*/
+
+#define  NARGINMIN  1
+#define  NARGINMAX  2
+#define    NARGOUT  3
+#define       CARG  0
+#define     ORDARG  1
+#define      OKOUT  0
+#define       KOUT  1
+#define     WHYOUT  2
+
+
+/*** MEX gateway function ***/
+
+void  mexFunction (  int nlhs  ,        mxArray * plhs[ ] ,
+                     int nrhs  ,  const mxArray * prhs[ ]  )
+{
+  
+  
+  /*-- Variables --*/
+  
+  /* Generic counter */
+  int  i ;
+  
+  /* Check spike times are in order , and reason for failure */
+  int  ord = 1 , e = MAKSPK_OK ;
+  
+  /* Index of first invalid train */
+  mwSize  k = 0 ;
+  
+  /* Valid flag of packed spike trains */
+  const mxArray  * v ;
+  
+  /* Output arguments */
+  mxArray  * o[ NARGOUT ] ;
+  
+  
+  /*-- Input check --*/
+  
+  /* Number of input args */
+  if  ( nrhs  <  NARGINMIN  ||  NARGINMAX  <  nrhs )
+    
+    mexErrMsgIdAndTxt (  "MAK:makspkchk:nargsin"  ,
+      "makspkchk: takes %d or %d input arguments"  ,
+      NARGINMIN  ,  NARGINMAX  ) ;
+  
+  /* Number of output args */
+  else if  ( NARGOUT  <  nlhs )
+    
+    mexErrMsgIdAndTxt (  "MAK:makspkchk:nargsout"  ,
+      "makspkchk: returns at most %d output arguments"  ,  NARGOUT  ) ;
+  
+  /* C must be a cell array or a struct */
+  else if  ( !mxIsCell( prhs[ CARG ] )  &&  !mxIsStruct( prhs[ CARG ] ) )
+    
+    mexErrMsgIdAndTxt (  "MAK:makspkchk:C"  ,
+      "makspkchk: C must be a cell array or packed spike trains"  ) ;
+  
+  /* ord must be a scalar logical */
+  else if  ( nrhs  ==  NARGINMAX  &&  !mxIsLogicalScalar( prhs[ ORDARG ] ) )
+    
+    mexErrMsgIdAndTxt (  "MAK:makspkchk:ord"  ,
+      "makspkchk: ord must be a scalar logical"  ) ;
+  
+  if  ( nrhs  ==  NARGINMAX )
+    ord = mxIsLogicalScalarTrue (  prhs[ ORDARG ]  ) ;
+  
+  
+  /*-- Check spike trains --*/
+  
+  /* Cell array */
+  if  ( mxIsCell(  prhs[ CARG ]  ) )
+    
+    e = makspk_cell (  prhs[ CARG ]  ,  ord  ,  &k  ,  NULL  ) ;
+  
+  /* Packed , spike times unless already validated */
+  else
+  {
+    v = mxIsScalar( prhs[ CARG ] )  ?
+      mxGetField( prhs[ CARG ] , 0 , MAKSPK_VALID )  :  NULL ;
+    
+    if  ( !v  ||  !mxIsLogicalScalarTrue( v ) )
+      e = makspk_packed (  prhs[ CARG ]  ,  ord  ,  &k  ) ;
+    else
+      e = makspk_offsets (  prhs[ CARG ]  ,  &k  ) ;
+  }
+  
+  
+  /*-- Output --*/
+  
+  o[ OKOUT  ] = mxCreateLogicalScalar (  e  ==  MAKSPK_OK  ) ;
+  o[ KOUT   ] = mxCreateDoubleScalar (
+    e  &&  e != MAKSPK_PACK  ?  ( double ) k + 1  :  0  ) ;
+  o[ WHYOUT ] = mxCreateString (  makspk_msg[ e ]  ) ;
+  
+  for  ( i = 0 ; i < NARGOUT ; i++ )
+    if  ( i  <  ( nlhs > 1 ? nlhs : 1 ) )
+      plhs[ i ] = o[ i ] ;
+    else
+      mxDestroyArray (  o[ i ]  ) ;
+
+
+} /* mexFunction */
+
@@ -0,0 +1,34 @@
+
+% [ ok , k , why ] = makspkchk ( C )
+% [ ok , k , why ] = makspkchk ( C , ord )
+% 
+% MET Analysis Kit. Checks a set of spike trains in one pass over their
+% spike times. C is a cell array of spike trains, as used by maksttc and
+% makrccg, or a struct of packed spike trains from makspkpack. Each train
+% must be empty, or a real vector of type single or double with finite
+% spike times in chronological order. Empty trains are place holders for
+% missing data. Optional ord is a scalar logical, default true. If it is
+% false then the order of spike times is not checked, as for raster plots.
+% 
+% ok is a scalar logical, true if all spike trains are valid. Otherwise, k
+% is the linear index of the first invalid train and why is a string that
+% says what is wrong with it, for example
+% 
+%   [ ok , k , why ] = makspkchk (  C  ) ;
+%   if  ~ ok  ,  error (  'spike train %d %s'  ,  k  ,  why  ) ,  end
+% 
+% k is zero if all trains are valid, or if packed C is malformed. If C is
+% packed and C.valid is true then its spike times are not checked again,
+% but its fields and offsets are.
+% 
+% This replaces a cellfun or parfor loop over spike trains that needs
+% several passes over the data and many calls to MATLAB functions. If MEX
+% is compiled with OpenMP then spike trains are divided between threads,
+% e.g.
+% 
+%   mex CFLAGS='$CFLAGS -fopenmp' LDFLAGS='$LDFLAGS -fopenmp' makspkchk.c
+% 
+% Otherwise, it runs on a single thread. See makspkpack.
+% 
+% Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+% 
@@ -1,7 +1,8 @@
 
-function  [ n , c , d0 ] = makspkclust (  par  ,  S  )
+function  [ n , c , d0 , L ] = makspkclust (  par  ,  S  )
 % 
 % [ n , id , d0 ] = makspkclust (  par  ,  S  )
+% [ n , id , d0 , L ] = makspkclust (  par  ,  S  )
 % 
 % MAK Analysis Kit, pre-processing. Performs initial spike clustering on
 % spike components in S. Returns vector n where n( i ) is the number of
@@ -26,6 +27,17 @@ function  [ n , c , d0 ] = makspkclust (  par  ,  S  )
 %   5) Repeat steps 1 to 4 until the desired number of bisections have
 %   been performed.
 % 
+% Optional output L returns a coarser clustering for every number of
+% bisections from 1 to par.bisecs, so that par.bisecs can be chosen
+% without clustering the spikes again. Spikes change clusters during each
+% round of assignments. So the clusters found after b bisections are not
+% always unions of the final clusters. Instead, the clusters at level b
+% are made by joining all final clusters that descend from the same
+% cluster centre after b bisections. Levels are thus nested, and the
+% interface energy matrix of any level is found by summing blocks of the
+% final energy matrix ; see makenergymat (  E  ,  a  ). Energies found
+% that way use the final d0, not L( b ).d0, on purpose ; see makenergymat.
+% 
 % It is advise to shuffle the random number generator's seed prior to
 % calling this function for the first time.
 % 
@@ -56,6 +68,13 @@ function  [ n , c , d0 ] = makspkclust (  par  ,  S  )
 % d0 - Scaling term for interface energy computation , single precision
 %   floating point scalar value
 % 
+% L - par.bisecs element struct vector with one element per level of
+%   bisection. L( b ) has fields .n , .c , and .d0 , which are equivalent
+%   to n , c , and d0 for the clusters at level b. Field .a is a C element
+%   uint8 row vector mapping the final clusters to level b ; a( i ) is the
+%   level b cluster that contains final cluster i. L( par.bisecs ) holds
+%   the same values as n , c , and d0 , with a = 1 : C.
+% 
 % 
 % References:
 % 
@@ -111,6 +130,10 @@ function  [ n , c , d0 ] = makspkclust (  par  ,  S  )
   % Cluster centres
   cen = zeros (  ncmp  ,  cmax  ,  'single'  ) ;
   
+  % Cluster lineage. lin( i , b ) is the number of the cluster following
+  % bisection b that cluster i descends from.
+  lin = zeros (  cmax  ,  par.bisecs  ,  'uint8'  ) ;
+  
   % Initialise first cluster
   cnum = 1 ;
   n( 1 ) = nspk ;
@@ -137,6 +160,11 @@ function  [ n , c , d0 ] = makspkclust (  par  ,  S  )
     % Duplicate existing cluster centres
     cen( : , 1 : cnum ) = repmat (  cen( : , ci )  ,  1  ,  2  ) ;
     
+    % Both copies inherit the lineage of the original , and each is
+    % numbered for this bisection
+    lin( 1 : cnum , : ) = repmat (  lin( ci , : )  ,  2  ,  1  ) ;
+    lin( 1 : cnum , bisecs ) = 1 : cnum ;
+    
     % New cluster index
     ci = 1 : cnum ;
     
@@ -226,6 +254,7 @@ function  [ n , c , d0 ] = makspkclust (  par  ,  S  )
   % Discard empty clusters
   n = n( ci ) ;
   cen = cen( : , ci ) ;
+  lin = lin( ci , : ) ;
   
   % If there were empty clusters ...
   if  numel (  ci  )  <  cnum
@@ -243,10 +272,11 @@ function  [ n , c , d0 ] = makspkclust (  par  ,  S  )
     
   end % zero-spike clusters
   
-  % Scaling term used by UltraMegaSort2000 , line one is W = T - B , line
-  % two acts on W
-  d0 = cov( S' ) - cov( cen( : , c )' ) ;
-  d0 = sqrt ( sum( diag(  d0  ) ) )  /  10 ;
+  % Scaling term for interface energy
+  d0 = getd0 (  S  ,  cen  ,  c  ) ;
+  
+  % Return clusters at each level of bisection
+  if  3  <  nargout  ,  L = levels (  S  ,  n  ,  c  ,  d0  ,  lin  ) ;  end
   
   
 end % makspkclust
@@ -254,6 +284,62 @@ end % makspkclust
 
 %%% Sub-routines %%%
 
+% Scaling term used by UltraMegaSort2000 , line one is W = T - B , line
+% two acts on W
+function  d0 = getd0 (  S  ,  cen  ,  c  )
+  
+  d0 = cov( S' ) - cov( cen( : , c )' ) ;
+  d0 = sqrt ( sum( diag(  d0  ) ) )  /  10 ;
+  
+end % getd0
+
+
+% Join final clusters that descend from the same cluster at each level of
+% bisection. Final clusters are in column lin( : , end ).
+function  L = levels (  S  ,  n  ,  c  ,  d0  ,  lin  )
+  
+  % Number of levels
+  B = size (  lin  ,  2  ) ;
+  
+  % No bisections , no levels
+  if  ~ B  ,  L = struct (  'n' , {} , 'c' , {} , 'd0' , {} , 'a' , {}  ) ;
+    return  ,  end
+  
+  % Allocate output
+  L = struct (  'n'  ,  cell( 1 , B )  ,  'c'  ,  []  ,  'd0'  ,  [] ,...
+    'a'  ,  []  ) ;
+  
+  % Final level is the returned clustering
+  L( B ).n = n ;  L( B ).c = c ;  L( B ).d0 = d0 ;
+  L( B ).a = uint8 (  1 : numel( n )  ) ;
+  
+  % Coarser levels
+  for  b = 1 : B - 1
+    
+    % Renumber the level b ancestors of all final clusters from 1
+    [ ~ , ~ , a ] = unique (  lin( : , b )  ) ;
+    a = uint8 (  a'  ) ;
+    
+    % Spike assignments and number of spikes per level b cluster
+    L( b ).a = a ;
+    L( b ).c = a (  c  ) ;
+    L( b ).n = uint32 (  accumarray(  double( a' )  ,  double( n' )  )'  );
+    
+    % Level b cluster centres
+    cen = zeros (  size( S , 1 )  ,  numel( L( b ).n )  ,  'single'  ) ;
+    
+    for  i = 1 : numel (  L( b ).n  )
+      cen( : , i ) = mean (  S( : , L( b ).c == i )  ,  2  ) ;
+    end
+    
+    % Scaling term
+    L( b ).d0 = getd0 (  S  ,  cen  ,  L( b ).c  ) ;
+    
+  end % levels
+  
+end % levels
+
+
 % Estimate the mean distance between pairs of spikes by sampling n pairs
 % of different spikes from S
 function  mdist = estdist (  n  ,  S  )
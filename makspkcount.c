@@ -0,0 +1,268 @@
+
+/*  makspkcount
+  
+  N = makspkcount ( C , w )
+  N = makspkcount ( C , w , cls )
+  N = makspkcount ( C , w , cls , rate )
+  N = makspkcount ( C , w , cls , rate , closed )
+  
+  MET Analysis Kit. Counts the spikes of each trial and unit within one or
+  more windows , ready for makroc , makmi , makddi , makbalancedz , or
+  maklinfin. Spike trains are in chronological order , so each count is
+  found by two binary searches for the first spike at or after the start
+  of the window and the first spike at or after its end. This takes
+  O( log n ) time for n spikes , rather than a logical mask over every
+  spike of the train.
+  
+  C is a T x U cell array of spike trains , with trials over rows and units
+  over columns , or packed spike trains from makspkpack or makspktrains.
+  Trains are checked with makspkchk. Only the offsets of packed trains are
+  checked if they are already valid. If C has one row then each unit's
+  train is shared by all trials , such as a whole recording from
+  makspktrains , and the windows of each trial pick out its spikes.
+  
+  w is a K x 2 or K x 2 x B double array of B windows. Window b of trial k
+  counts spikes from time w( k , 1 , b ) up to , but not including ,
+  w( k , 2 , b ). If K is 1 then the same windows are used on every trial.
+  Otherwise , K must equal T , unless C has one row and then T is K. Bins
+  of a peri-stimulus time histogram are given as B windows.
+  
+  cls is optional , either 'double' ( default ) or 'single'. If optional
+  rate is true then counts are divided by the duration of each window ,
+  giving firing rates in spikes per second , default false. A window of
+  zero duration then gives NaN. If optional closed is true then the last
+  window of each trial also counts spikes at its end , as histcounts does
+  with its last bin , default false.
+  
+  N is a T x U x B array of class cls , with trials over rows , units over
+  columns , and windows over the third dimension.
+  
+  Compile with OpenMP to divide units between threads.
+  
+  Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+
+*/
+
+
+/*-- Include block --*/
+
+#include  <string.h>
+#include     "mex.h"
+#include  "matrix.h"
+#include  "makspk.h"
+
+
+/*-- Define block --*/
+
+#define  NARGINMIN  2
+#define  NARGINMAX  5
+#define    NARGOUT  1
+#define       CARG  0
+#define       WARG  1
+#define     CLSARG  2
+#define    RATEARG  3
+#define  CLOSEDARG  4
+#define       NOUT  0
+
+/* Longest class name */
+#define  CLSLEN  7
+
+
+/*-- Subroutines --*/
+
+/* Index of the first spike of train s that is not before time v , or
+   that is after v if le is non-zero */
+static mwSize  lowerbound ( const makspk_t * s , double v , int le )
+{
+  mwSize  a = 0 , m , n = s->n ;
+  double  x ;
+  
+  while  ( n )
+  {
+    m = n  /  2 ;
+    x = s->dbl  ?  ( ( const double * ) s->s )[ a + m ]  :
+                   ( ( const float  * ) s->s )[ a + m ] ;
+    
+    if  ( x < v  ||  ( le  &&  x == v ) )
+    {
+      a += m + 1 ;
+      n -= m + 1 ;
+    }
+    else
+      n = m ;
+  }
+  
+  return  a ;
+}
+
+
+/*** MEX gateway function ***/
+
+void  mexFunction (  int nlhs  ,        mxArray * plhs[ ] ,
+                     int nrhs  ,  const mxArray * prhs[ ]  )
+{
+  
+  
+  /*-- Variables --*/
+  
+  /* Generic counter */
+  mwSignedIndex  j ;
+  
+  /* Rows and columns of trains , trials , windows per trial , and
+     windows */
+  mwSize  m , U , T , K , B ;
+  
+  /* Size of N , and first invalid train */
+  mwSize  dims[ 3 ] , k ;
+  
+  /* Windows */
+  const double  * w ;
+  
+  /* Spike times of each train */
+  makspk_t  * s ;
+  
+  /* Single output , rates , closed last window , and reason that a train
+     is invalid */
+  int  sgl = 0 , rate = 0 , closed = 0 , e ;
+  
+  /* Class name */
+  char  cls[ CLSLEN + 1 ] ;
+  
+  
+  /*-- Input check --*/
+  
+  /* Must be 2 to 5 input args */
+  if  ( nrhs < NARGINMIN  ||  NARGINMAX < nrhs )
+    
+    mexErrMsgIdAndTxt (  "MAK:makspkcount:nargsin"  ,
+      "makspkcount: requires %d to %d input arguments"  ,
+      NARGINMIN  ,  NARGINMAX  ) ;
+  
+  /* Must be no more than 1 output arg */
+  else if  ( NARGOUT  <  nlhs )
+    
+    mexErrMsgIdAndTxt (  "MAK:makspkcount:nargsout"  ,
+      "makspkcount: returns at most %d output argument"  ,  NARGOUT  ) ;
+  
+  /* w must be a real double array of K x 2 x B */
+  else if  (  !mxIsDouble( prhs[ WARG ] )  ||  mxIsComplex( prhs[ WARG ] )
+              ||  mxIsSparse( prhs[ WARG ] )  ||  mxIsEmpty( prhs[ WARG ] )
+              ||  3 < mxGetNumberOfDimensions( prhs[ WARG ] )
+              ||  mxGetDimensions( prhs[ WARG ] )[ 1 ] != 2  )
+    
+    mexErrMsgIdAndTxt (  "MAK:makspkcount:w"  ,
+      "makspkcount: w must be a real double array of K x 2 x B"  ) ;
+  
+  /* cls must be 'double' or 'single' */
+  if  ( CLSARG  <  nrhs )
+  {
+    if  (  !mxIsChar( prhs[ CLSARG ] )  ||
+           CLSLEN < mxGetNumberOfElements( prhs[ CLSARG ] )  ||
+           mxGetString( prhs[ CLSARG ] , cls , CLSLEN + 1 )  ||
+           ( strcmp( cls , "double" )  &&  strcmp( cls , "single" ) )  )
+      
+      mexErrMsgIdAndTxt (  "MAK:makspkcount:cls"  ,
+        "makspkcount: cls must be 'double' or 'single'"  ) ;
+    
+    sgl = !strcmp (  cls  ,  "single"  ) ;
+  }
+  
+  /* rate must be a scalar logical */
+  if  ( RATEARG  <  nrhs )
+  {
+    if  ( !mxIsLogicalScalar(  prhs[ RATEARG ]  ) )
+      
+      mexErrMsgIdAndTxt (  "MAK:makspkcount:rate"  ,
+        "makspkcount: rate must be a scalar logical"  ) ;
+    
+    rate = mxIsLogicalScalarTrue (  prhs[ RATEARG ]  ) ;
+  }
+  
+  /* closed must be a scalar logical */
+  if  ( CLOSEDARG  <  nrhs )
+  {
+    if  ( !mxIsLogicalScalar(  prhs[ CLOSEDARG ]  ) )
+      
+      mexErrMsgIdAndTxt (  "MAK:makspkcount:closed"  ,
+        "makspkcount: closed must be a scalar logical"  ) ;
+    
+    closed = mxIsLogicalScalarTrue (  prhs[ CLOSEDARG ]  ) ;
+  }
+  
+  /* Spike trains , in one pass */
+  e = makspk_load (  prhs[ CARG ]  ,  1  ,  &k  ,  &s  ,  &m  ,  &U  ) ;
+  
+  if  ( e  ==  MAKSPK_PACK )
+    
+    mexErrMsgIdAndTxt (  "MAK:makspkcount:C"  ,
+      "makspkcount: C must be a cell array or packed spike trains"  ) ;
+  
+  else if  ( e )
+    
+    mexErrMsgIdAndTxt (  "MAK:makspkcount:spktrains"  ,
+      "makspkcount: spike train %d %s"  ,  ( int ) k + 1  ,  makspk_msg[ e ]);
+  
+  
+  /*-- Preparation --*/
+  
+  w = mxGetPr (  prhs[ WARG ]  ) ;
+  K = mxGetM (  prhs[ WARG ]  ) ;
+  B = mxGetNumberOfElements (  prhs[ WARG ]  )  /  ( 2 * K ) ;
+  
+  /* Number of trials */
+  T = m  ==  1  ?  K  :  m ;
+  
+  if  ( K != 1  &&  K != T )
+    
+    mexErrMsgIdAndTxt (  "MAK:makspkcount:K"  ,
+      "makspkcount: w must have 1 row or one row per trial"  ) ;
+  
+  for  ( k = 0 ; k < K * B ; k++ )
+    if  ( !( w[ k % K  +  2 * K * ( k / K ) ]  <=
+             w[ k % K  +  2 * K * ( k / K )  +  K ] ) )
+      
+      mexErrMsgIdAndTxt (  "MAK:makspkcount:wval"  ,
+        "makspkcount: no window of w may end before it starts"  ) ;
+  
+  dims[ 0 ] = T ;  dims[ 1 ] = U ;  dims[ 2 ] = B ;
+  
+  plhs[ NOUT ] = mxCreateNumericArray (  3  ,  dims  ,
+    sgl  ?  mxSINGLE_CLASS  :  mxDOUBLE_CLASS  ,  mxREAL  ) ;
+  
+  
+  /*-- Count spikes --*/
+  
+  #pragma omp parallel for schedule( dynamic , 1 )
+  for  ( j = 0 ; j < ( mwSignedIndex ) U ; j++ )
+  {
+    double  * nd = ( double * ) mxGetData (  plhs[ NOUT ]  ) ;
+    float  * ns = ( float * ) mxGetData (  plhs[ NOUT ]  ) ;
+    const double  * a , * z ;
+    mwSize  b , i , x ;
+    double  c ;
+    
+    for  ( b = 0 ; b < B ; b++ )
+      for  ( i = 0 ; i < T ; i++ )
+      {
+        /* Window of this trial , and its spike train */
+        a = w  +  2 * K * b  +  ( K  ==  1  ?  0  :  i ) ;
+        z = a  +  K ;
+        x = ( m  ==  1  ?  0  :  i )  +  m * j ;
+        
+        c = ( double ) ( lowerbound( s + x , *z , closed && b == B - 1 )  -
+                         lowerbound( s + x , *a , 0 ) ) ;
+        
+        if  ( rate )  c /= *z  -  *a ;
+        
+        x = i  +  T * ( j  +  U * b ) ;
+        
+        if  ( sgl )  ns[ x ] = ( float ) c ;
+        else         nd[ x ] = c ;
+      }
+  }
+  
+  mxFree (  s  ) ;
+
+
+} /* mexFunction */
+
@@ -0,0 +1,50 @@
+
+% N = makspkcount ( C , w )
+% N = makspkcount ( C , w , cls )
+% N = makspkcount ( C , w , cls , rate )
+% N = makspkcount ( C , w , cls , rate , closed )
+% 
+% MET Analysis Kit. Counts the spikes of each trial and unit within one or
+% more windows, ready for makroc, makmi, makddi, makbalancedz, or
+% maklinfin. Spike trains are in chronological order, so each count is
+% found by two binary searches, for the first spike at or after the start
+% of the window and the first spike at or after its end. This takes
+% O( log n ) time for n spikes, rather than a logical mask over every spike
+% of the train.
+% 
+% C is a T x U cell array of spike trains, with trials over rows and units
+% over columns, or packed spike trains from makspkpack or makspktrains.
+% Trains are checked as by makspkchk. Only the offsets of packed trains
+% are checked if they are already valid. If C has one row then each unit's
+% train is shared by all trials, such as a whole recording from
+% makspktrains, and the windows of each trial pick out its spikes.
+% 
+% w is a K x 2 or K x 2 x B double array of B windows. Window b of trial k
+% counts spikes from time w( k , 1 , b ) up to, but not including,
+% w( k , 2 , b ). If K is 1 then the same windows are used on every trial.
+% Otherwise, K must equal T, unless C has one row and then T is K. Bins of
+% a peri-stimulus time histogram are given as B windows, for example
+% 
+%   e = 0 : 0.05 : 0.5 ;
+%   w = permute (  [ e( 1 : end - 1 ) ; e( 2 : end ) ]  ,  [ 3 , 1 , 2 ]  ) ;
+%   N = makspkcount (  C  ,  w  ) ;
+% 
+% cls is optional, either 'double' ( default ) or 'single'. If optional
+% rate is true then counts are divided by the duration of each window,
+% giving firing rates in spikes per second, default false. A window of
+% zero duration then gives NaN. If optional closed is true then the last
+% window of each trial also counts spikes at its end, as histcounts does
+% with its last bin, default false.
+% 
+% N is a T x U x B array of class cls, with trials over rows, units over
+% columns, and windows over the third dimension.
+% 
+% If MEX is compiled with OpenMP then units are divided between threads,
+% e.g.
+% 
+%   mex CFLAGS='$CFLAGS -fopenmp' LDFLAGS='$LDFLAGS -fopenmp' makspkcount.c
+% 
+% Otherwise, it runs on a single thread.
+% 
+% Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+% 
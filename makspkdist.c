@@ -0,0 +1,473 @@
+
+/*  makspkdist
+  
+  d = makspkdist ( m , p , w , C )
+  d = makspkdist ( m , p , w , A , B )
+  
+  MET Analysis Kit. Computes the van Rossum or the Victor-Purpura distance
+  between all pairs of spike trains on each trial. m is 'vr' for van
+  Rossum or 'vp' for Victor-Purpura. p is a vector of P parameter values ;
+  these are time constants in seconds for 'vr' , and costs per second of
+  spike shift for 'vp'. w is the analysis window [ start , end ] in
+  seconds , only spikes from w( 1 ) to w( 2 ) are used ; if w is empty
+  then all spikes are used. A , B , and C are the same as for maksttc.
+  
+  With C , d is a P x Np x Nt double matrix for Np pairs and Nt trials ,
+  with pairs in the same order as maksttc. With A and B , d is P x Nt.
+  An empty [ ] place holder means that there is no data , so d is NaN.
+  
+  Van Rossum distances use an exponential kernel and take O( na + nb )
+  time per pair. Victor-Purpura distances use a banded dynamic programme
+  that only visits spike pairs closer than 2 / q seconds.
+  
+  Compile with OpenMP to divide pairs and trials between threads.
+  
+  Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+
+*/
+
+
+/*-- Include block --*/
+
+#include    <math.h>
+#include  <stdlib.h>
+#include  <string.h>
+#include     "mex.h"
+#include  "matrix.h"
+#include  "maknuma.h"
+
+#ifdef  _OPENMP
+  #include  <omp.h>
+#endif
+
+
+/*-- Define block --*/
+
+#define  NARGINC  4
+#define  NARGAB   5
+#define  NARGOUT  1
+#define     MARG  0
+#define     PARG  1
+#define     WARG  2
+#define     DOUT  0
+
+
+/*-- Data types --*/
+
+/* One spike train , the part of it inside the analysis window */
+typedef struct
+{
+  
+  /* Spike times , double if dbl is non-zero and single otherwise. s is
+     NULL for an empty place holder. */
+  const void  * s ;
+  int  dbl ;
+  
+  /* Index of first spike in window , and number of spikes in window */
+  mwSize  f , n ;
+
+} train_t ;
+
+
+/*-- Subroutines --*/
+
+/* Spike time i of the window of train x , in double precision */
+static double  spktime ( const train_t * x , mwSize i )
+{
+  i += x->f ;
+  return  x->dbl  ?  ( ( const double * ) x->s )[ i ]  :
+    ( double ) ( ( const float * ) x->s )[ i ] ;
+}
+
+/* Sum over spike pairs i > j of exp( - ( x( i ) - x( j ) ) / tau ) ,
+   using the recursion m( i ) = exp( - ( x( i ) - x( i - 1 ) ) / tau ) *
+   ( m( i - 1 ) + 1 ) */
+static double  vrself ( const train_t * x , double tau )
+{
+  mwSize  i ;
+  double  m = 0 , s = 0 ;
+  
+  for  ( i = 1 ; i < x->n ; i++ )
+  {
+    m = exp (  - ( spktime( x , i ) - spktime( x , i - 1 ) )  /  tau  )  *
+      ( m  +  1 ) ;
+    s += m ;
+  }
+  
+  return  s ;
+}
+
+/* Sum over all spike pairs of exp( - | a( i ) - b( j ) | / tau ). The
+   merged trains are swept once. Each spike adds the decayed sum of the
+   other train's earlier spikes. Ties go to a first , so they count once. */
+static double  vrcross ( const train_t * a , const train_t * b ,
+  double tau )
+{
+  mwSize  i = 0 , j = 0 ;
+  double  ma = 0 , mb = 0 , s = 0 , t , tl = 0 , f ;
+  
+  while  ( i < a->n  ||  j < b->n )
+  {
+    int  isa = j == b->n  ||
+               ( i < a->n  &&  spktime( a , i ) <= spktime( b , j ) ) ;
+    
+    t = isa  ?  spktime (  a  ,  i  )  :  spktime (  b  ,  j  ) ;
+    f = exp (  - ( t - tl )  /  tau  ) ;
+    ma *= f ;
+    mb *= f ;
+    tl = t ;
+    
+    if  ( isa )  {  s += mb ;  ma += 1 ;  i++ ;  }
+    else         {  s += ma ;  mb += 1 ;  j++ ;  }
+  }
+  
+  return  s ;
+}
+
+/* Victor-Purpura distance with cost q per second of shift. With benefit
+   H( i , j ) = i + j - G( i , j ) , for G the usual cost of aligning the
+   first i spikes of a with the first j of b ,
+     
+     H( i , j ) = max( H( i - 1 , j ) , H( i , j - 1 ) ,
+                       H( i - 1 , j - 1 ) + 2 - q | a( i ) - b( j ) | )
+   
+   where the last term is only used when | a( i ) - b( j ) | < 2 / q. This
+   band of columns , lo to hi , only moves forward from row to row. Any
+   column left of the band keeps its value from the row above. Any column
+   right of the band takes the largest value so far at the right end of a
+   band , r. Hence , only columns within the band of each row are visited ,
+   and h holds H( i , j ) for the latest row that visited column j. */
+static double  vpdist ( const train_t * a , const train_t * b , double q ,
+  double * h )
+{
+  mwSize  i , j , lo = 1 , hi = 0 , hmax = 0 ;
+  double  r = 0 , x , dg , up , s ;
+  
+  /* Shifts cost nothing , so only the difference in counts remains */
+  if  ( q == 0 )
+    return  a->n < b->n  ?  ( double ) ( b->n - a->n )  :
+      ( double ) ( a->n - b->n ) ;
+  
+  h[ 0 ] = 0 ;
+  
+  for  ( i = 1 ; i <= a->n ; i++ )
+  {
+    x = spktime (  a  ,  i - 1  ) ;
+    
+    /* Band of row i , columns j with | a( i ) - b( j ) | < 2 / q */
+    while  ( lo <= b->n  &&  2  <=  q * ( x - spktime( b , lo - 1 ) ) )
+      lo++ ;
+    if  ( hi  <  lo - 1 )  hi = lo  -  1 ;
+    while  ( hi < b->n  &&  q * ( spktime( b , hi ) - x )  <  2 )  hi++ ;
+    
+    /* Empty band */
+    if  ( hi  <  lo )  continue ;
+    
+    /* Columns that enter a band for the first time hold r from the row
+       above */
+    for  ( j = hmax + 1 ; j <= hi ; j++ )  h[ j ] = r ;
+    if  ( hmax  <  hi )  hmax = hi ;
+    
+    /* Diagonal and left neighbours from column lo - 1 , which does not
+       change in this row */
+    dg = h[ lo - 1 ] ;
+    s = dg ;
+    
+    for  ( j = lo ; j <= hi ; j++ )
+    {
+      up = h[ j ] ;
+      x = spktime (  a  ,  i - 1  )  -  spktime (  b  ,  j - 1  ) ;
+      s = s < up  ?  up  :  s ;
+      x = dg  +  2  -  q * fabs( x ) ;
+      if  ( s  <  x )  s = x ;
+      dg = up ;
+      h[ j ] = s ;
+    }
+    
+    if  ( r  <  h[ hi ] )  r = h[ hi ] ;
+  }
+  
+  /* The last column has its final value if it was ever visited */
+  s = b->n <= hmax  &&  r < h[ b->n ]  ?  h[ b->n ]  :  r ;
+  
+  return  ( double ) ( a->n + b->n )  -  s ;
+}
+
+
+/*** MEX gateway function ***/
+
+void  mexFunction (  int nlhs  ,        mxArray * plhs[ ] ,
+                     int nrhs  ,  const mxArray * prhs[ ]  )
+{
+  
+  
+  /*-- Variables --*/
+  
+  /* Generic counters */
+  mwSize  i , j ;
+  
+  /* Distance measure string , van Rossum if vr is non-zero , otherwise
+     Victor-Purpura */
+  char  m[ 3 ] ;
+  int  vr ;
+  
+  /* Number of parameters , trials , spike trains per trial , and pairs ,
+     and most spikes in any train */
+  mwSize  P , Nt , Ns , Np , nmax ;
+  
+  /* Parameters , and window */
+  const double  * p ;
+  double  w1 = -HUGE_VAL , w2 = HUGE_VAL ;
+  
+  /* Spike trains , indexed by train then trial , and the van Rossum self
+     term of each one */
+  train_t  * x ;
+  double  * vs ;
+  
+  /* Pair indices , slices per chunk of output , the replaced schedule , and
+     output */
+  mwSize  * pa , * pb , chunk ;
+  maknuma_sched_t  old ;
+  double  * d , nan = mxGetNaN ( ) ;
+  
+  /* Out of memory in any thread */
+  int  err = 0 ;
+  
+  
+  /*-- Input check --*/
+  
+  /* Must be 4 or 5 input args */
+  if  ( nrhs != NARGINC  &&  nrhs != NARGAB )
+    
+    mexErrMsgIdAndTxt (  "MAK:makspkdist:nargsin"  ,
+      "makspkdist: requires %d or %d input arguments"  ,
+      NARGINC  ,  NARGAB  ) ;
+  
+  /* Must be no more than 1 output arg */
+  else if  ( NARGOUT  <  nlhs )
+    
+    mexErrMsgIdAndTxt (  "MAK:makspkdist:nargsout"  ,
+      "makspkdist: returns at most %d output argument"  ,  NARGOUT  ) ;
+  
+  /* m must be 'vr' or 'vp' */
+  else if  (  !mxIsChar( prhs[ MARG ] )  ||
+              mxGetNumberOfElements( prhs[ MARG ] ) != 2  ||
+              mxGetString( prhs[ MARG ] , m , 3 )  ||
+              ( strcmp( m , "vr" )  &&  strcmp( m , "vp" ) )  )
+    
+    mexErrMsgIdAndTxt (  "MAK:makspkdist:m"  ,
+      "makspkdist: m must be 'vr' or 'vp'"  ) ;
+  
+  vr = !strcmp (  m  ,  "vr"  ) ;
+  
+  /* p must be a real double vector */
+  if  (  !mxIsDouble( prhs[ PARG ] )  ||  mxIsComplex( prhs[ PARG ] )  ||
+         mxIsEmpty( prhs[ PARG ] )  )
+    
+    mexErrMsgIdAndTxt (  "MAK:makspkdist:p"  ,
+      "makspkdist: p must be a non-empty real double vector"  ) ;
+  
+  P = mxGetNumberOfElements (  prhs[ PARG ]  ) ;
+  p = mxGetPr (  prhs[ PARG ]  ) ;
+  
+  /* Time constants must be positive , costs must not be negative */
+  for  ( i = 0 ; i < P ; i++ )
+    if  ( vr  ?  !( 0 < p[ i ] )  :  !( 0 <= p[ i ]  &&  isfinite( p[ i ] ) ) )
+      
+      mexErrMsgIdAndTxt (  "MAK:makspkdist:pval"  ,
+        "makspkdist: p must be positive for 'vr' , and finite and "
+        "non-negative for 'vp'"  ) ;
+  
+  /* w must be empty , or a real double 2-element vector */
+  if  ( !mxIsEmpty(  prhs[ WARG ]  ) )
+  {
+    if  (  !mxIsDouble( prhs[ WARG ] )  ||  mxIsComplex( prhs[ WARG ] )  ||
+           mxGetNumberOfElements( prhs[ WARG ] ) != 2  ||
+           !( mxGetPr( prhs[ WARG ] )[ 0 ] < mxGetPr( prhs[ WARG ] )[ 1 ] ) )
+      
+      mexErrMsgIdAndTxt (  "MAK:makspkdist:w"  ,
+        "makspkdist: w must be empty or a 2-element real double vector "
+        "where w( 1 ) < w( 2 )"  ) ;
+    
+    w1 = mxGetPr (  prhs[ WARG ]  )[ 0 ] ;
+    w2 = mxGetPr (  prhs[ WARG ]  )[ 1 ] ;
+  }
+  
+  /* A and B form , cell array vectors of the same length */
+  if  ( nrhs  ==  NARGAB )
+  {
+    if  (  !mxIsCell( prhs[ 3 ] )  ||  !mxIsCell( prhs[ 4 ] )  ||
+           mxGetNumberOfElements( prhs[ 3 ] ) !=
+           mxGetNumberOfElements( prhs[ 4 ] )  )
+      
+      mexErrMsgIdAndTxt (  "MAK:makspkdist:AB"  ,
+        "makspkdist: A and B must be cell arrays with the same number of "
+        "elements"  ) ;
+    
+    Nt = mxGetNumberOfElements (  prhs[ 3 ]  ) ;
+    Ns = 2 ;
+  }
+  
+  /* C form , trials over rows and spike trains over columns */
+  else
+  {
+    if  (  !mxIsCell( prhs[ 3 ] )  ||  mxIsEmpty( prhs[ 3 ] )  ||
+           mxGetNumberOfDimensions( prhs[ 3 ] ) != 2  ||
+           mxGetN( prhs[ 3 ] ) < 2  )
+      
+      mexErrMsgIdAndTxt (  "MAK:makspkdist:C"  ,
+        "makspkdist: C must be a 2D cell array with at least 2 columns"  ) ;
+    
+    Nt = mxGetM (  prhs[ 3 ]  ) ;
+    Ns = mxGetN (  prhs[ 3 ]  ) ;
+  }
+  
+  
+  /*-- Preparation --*/
+  
+  /* Locate the spikes of each train inside the window */
+  x = mxMalloc (  Ns * Nt * sizeof( train_t )  ) ;
+  nmax = 0 ;
+  
+  for  ( j = 0 ; j < Ns ; j++ )
+    for  ( i = 0 ; i < Nt ; i++ )
+    {
+      const mxArray  * s = nrhs == NARGAB  ?
+        mxGetCell (  prhs[ 3 + j ]  ,  i  )  :
+        mxGetCell (  prhs[ 3 ]  ,  i + j * Nt  ) ;
+      train_t  * t = x  +  j  +  i * Ns ;
+      mwSize  n ;
+      
+      t->s = NULL ;  t->dbl = 1 ;  t->f = t->n = 0 ;
+      
+      /* Empty place holder */
+      if  ( !s  ||  mxIsEmpty( s ) )  continue ;
+      
+      if  (  !( mxIsDouble( s ) || mxIsSingle( s ) )  ||
+             mxIsComplex( s )  ||  mxIsSparse( s )  ||
+             mxGetNumberOfDimensions( s ) != 2  ||
+             ( mxGetM( s ) != 1  &&  mxGetN( s ) != 1 )  )
+        
+        mexErrMsgIdAndTxt (  "MAK:makspkdist:spktrains"  ,
+          "makspkdist: all spike trains must be real-numbered vectors of "
+          "type single or double , or empty"  ) ;
+      
+      t->s = mxGetData (  s  ) ;
+      t->dbl = mxIsDouble (  s  ) ;
+      n = mxGetNumberOfElements (  s  ) ;
+      
+      /* Spikes are in chronological order */
+      while  ( t->f < n  &&  spktime( t , 0 ) < w1 )  t->f++ ;
+      while  ( t->f + t->n < n  &&  spktime( t , t->n ) <= w2 )  t->n++ ;
+      
+      if  ( nmax  <  t->n )  nmax = t->n ;
+    }
+  
+  /* Pairs in the order of maksttc , the lower triangle of an Ns x Ns
+     matrix taken column by column */
+  Np = Ns * ( Ns - 1 )  /  2 ;
+  pa = mxMalloc (  Np * sizeof( mwSize )  ) ;
+  pb = mxMalloc (  Np * sizeof( mwSize )  ) ;
+  
+  for  ( j = 0 , i = 0 ; i < Ns ; i++ )
+  {
+    mwSize  k ;
+    for  ( k = i + 1 ; k < Ns ; k++ , j++ )  {  pa[ j ] = i ;  pb[ j ] = k ;  }
+  }
+  
+  /* Van Rossum self terms , n + 2 * sum over i > j */
+  vs = mxMalloc (  ( vr ? P * Ns * Nt : 1 ) * sizeof( double )  ) ;
+  
+  if  ( vr )
+  {
+    mwSignedIndex  c ;
+    
+    #pragma omp parallel for schedule( dynamic ) private( i )
+    for  ( c = 0 ; c < ( mwSignedIndex ) ( Ns * Nt ) ; c++ )
+      for  ( i = 0 ; i < P ; i++ )
+        vs[ c * P + i ] = x[ c ].n  +  2 * vrself (  x + c  ,  p[ i ]  ) ;
+  }
+  
+  /* Allocate output , placing large ones by first touch of each trial.
+     Pairs and trials are computed in chunks of whole trials to match. */
+  chunk = maknuma_chunk (  P * Np * sizeof( double )  ,  Nt  ) ;
+  
+  if  ( nrhs  ==  NARGAB )
+  {
+    mwSize  dims[ 2 ] = {  P  ,  Nt  } ;
+    plhs[ DOUT ] = maknuma_create (  2  ,  dims  ,  mxDOUBLE_CLASS  ,  chunk );
+  }
+  else
+  {
+    mwSize  dims[ 3 ] = {  P  ,  Np  ,  Nt  } ;
+    plhs[ DOUT ] = maknuma_create (  3  ,  dims  ,  mxDOUBLE_CLASS  ,  chunk );
+  }
+  
+  d = mxGetPr (  plhs[ DOUT ]  ) ;
+  old = maknuma_sched (  chunk * Np  ) ;
+  
+  
+  /*-- Distances --*/
+  
+  #pragma omp parallel
+  {
+    
+    /* Victor-Purpura row buffer */
+    double  * h = vr  ?  NULL  :  malloc (  ( nmax + 1 ) * sizeof( double ) );
+    
+    /* Pair and trial , as one index */
+    mwSignedIndex  c ;
+    mwSize  k , t , q ;
+    const train_t  * a , * b ;
+    double  * y ;
+    int  e = !vr  &&  !h ;
+    
+    #pragma omp for schedule( runtime )
+    for  ( c = 0 ; c < ( mwSignedIndex ) ( Np * Nt ) ; c++ )
+    {
+      if  ( e )  continue ;
+      
+      q = c % Np ;
+      t = c / Np ;
+      a = x  +  pa[ q ]  +  t * Ns ;
+      b = x  +  pb[ q ]  +  t * Ns ;
+      y = d  +  c * P ;
+      
+      /* No data */
+      if  ( !a->s  ||  !b->s )
+      {
+        for  ( k = 0 ; k < P ; k++ )  y[ k ] = nan ;
+        continue ;
+      }
+      
+      for  ( k = 0 ; k < P ; k++ )
+        if  ( vr )
+        {
+          y[ k ] = ( vs[ ( a - x ) * P + k ]  +  vs[ ( b - x ) * P + k ]  -
+            2 * vrcross( a , b , p[ k ] ) )  /  2 ;
+          y[ k ] = 0 < y[ k ]  ?  sqrt( y[ k ] )  :  0 ;
+        }
+        else
+          y[ k ] = vpdist (  a ,  b ,  p[ k ] ,  h  ) ;
+    }
+    
+    #pragma omp critical
+    err |= e ;
+    
+    free (  h  ) ;
+  
+  } /* parallel */
+  
+  maknuma_unsched (  old  ) ;
+  mxFree (  x  ) ;
+  mxFree (  pa  ) ;
+  mxFree (  pb  ) ;
+  mxFree (  vs  ) ;
+  
+  if  ( err )
+    mexErrMsgIdAndTxt (  "MAK:makspkdist:mem"  ,
+      "makspkdist: out of memory"  ) ;
+
+
+} /* mexFunction */
+
@@ -0,0 +1,80 @@
+
+% d = makspkdist ( m , p , w , C )
+% d = makspkdist ( m , p , w , A , B )
+% 
+% MET Analysis Kit. Computes the distance between all pairs of spike trains
+% on each trial, using either the van Rossum ( 2001 ) or the Victor and
+% Purpura ( 1996 ) spike train metric. m is the string 'vr' for van Rossum
+% or 'vp' for Victor-Purpura. p is a vector of P parameter values. For 'vr'
+% these are the time constants of the exponential kernel, in seconds, and
+% must be positive. For 'vp' these are the costs of shifting a spike by one
+% second, and must be finite and non-negative. A cost of zero returns the
+% difference in spike counts.
+% 
+% w is a two-element vector defining the analysis window. Only spikes from
+% w( 1 ) to w( 2 ) seconds are used. If w is empty then all spikes are
+% used. A, B, and C are the same as for maksttc. Empty [ ] place holders
+% mean that there is no data, so the distance is NaN. But a spike train
+% with no spikes inside the analysis window is a valid, empty train.
+% 
+% If A and B are given then d is a P x T double matrix, indexing parameter
+% values over rows and trials over columns. If C is given then d is a
+% P x ( M ^ 2 - M ) / 2 x T matrix for M clusters, with cluster pairs in
+% the same order as maksttc, so d( : , p , : ) is the distance between
+% clusters a and b where
+% 
+%   p = 0 ;
+%   for  a = 1 : M - 1
+%     for  b = a + 1 : M
+%       p = p + 1 ;
+%     end
+%   end
+% 
+% 
+% Algorithm:
+% 
+% The van Rossum distance D for time constant tau is defined by
+% 
+%   D ^ 2 = 1 / tau * integral( ( fa( t ) - fb( t ) ) ^ 2 )
+% 
+% where fa and fb are the spike trains convolved with exp( -t / tau ) for
+% t >= 0. This equals half the sum of exp( -| x - y | / tau ) over all
+% pairs of spikes x and y from the same train, minus the same over pairs
+% with one spike from each train. Sums over spike pairs are found in one
+% sweep of the spike times, using the recursion
+% 
+%   m( i ) = exp( -( x( i ) - x( i - 1 ) ) / tau ) * ( m( i - 1 ) + 1 )
+% 
+% where m( i ) is the summed kernel of all spikes before x( i ). The terms
+% for each spike train are computed once, and the cross term of each pair
+% sweeps the two merged trains. Hence, the cost is O( na + nb ) per pair
+% and parameter value, for na and nb spikes.
+% 
+% The Victor-Purpura distance is the least total cost to turn one spike
+% train into the other, where deleting or inserting a spike costs 1 and
+% shifting a spike by dt costs q * | dt |. The usual dynamic programme
+% visits all na * nb pairs of spikes. But a shift of 2 / q or more never
+% costs less than deleting and inserting the spike. So only the band of
+% spike pairs closer than 2 / q is visited, and values outside of the band
+% are carried forward from the band's edges. The cost is O( na + nb ) plus
+% the number of spike pairs within 2 / q of each other.
+% 
+% If MEX is compiled with OpenMP then pairs and trials are divided between
+% threads, e.g.
+% 
+%   mex CFLAGS='$CFLAGS -fopenmp' LDFLAGS='$LDFLAGS -fopenmp' makspkdist.c
+% 
+% Otherwise, it runs on a single thread. Large outputs are zeroed in
+% parallel, so that on multi-socket computers each trial's output is held
+% by the socket of the thread that computes it ; see maknuma.h.
+% 
+% 
+% Reference:
+% 
+% van Rossum MCW. 2001. A novel spike distance. Neural Comput,
+%   13(4):751-763.
+% 
+% Victor JD, Purpura KP. 1996. Nature and precision of temporal coding in
+%   visual cortex: a metric-space analysis. J Neurophysiol, 76(2):1310-1326.
+% 
+% Written by Jackson Smith - October 2026 - ESI (Fries Lab)
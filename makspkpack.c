@@ -0,0 +1,221 @@
+
+/*  makspkpack
+  
+  P = makspkpack ( C )
+  C = makspkpack ( P )
+  
+  MET Analysis Kit. Packs a cell array of spike trains into one struct , or
+  unpacks it again. C is a cell array of spike trains , as used by maksttc
+  and makrccg. Each train must be empty , or a real vector of type single
+  or double with finite spike times in chronological order. The trains are
+  checked and copied in one pass , and an error is raised if any of them
+  is invalid.
+  
+  P is a struct with fields:
+    
+    .t - N x 1 double , the spike times of all N spikes , train by train
+    .off - ( numel( C ) + 1 ) x 1 double offsets. Spike train i is
+      P.t( P.off( i ) + 1 : P.off( i + 1 ) ) , in the linear order of C.
+    .size - size( C )
+    .valid - true , so that makspkchk and functions that use it need not
+      check P again.
+  
+  Given P , makspkpack returns cell array C with the size of P.size. Each
+  non-empty train is a row vector of doubles , and each empty train is [ ].
+  P is checked first. If P.valid is true then only its fields and offsets
+  are checked , and not its spike times.
+  
+  Compile with OpenMP to divide spike trains between threads. See makspk.h.
+  
+  Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+
+*/
+
+
+/*-- Include block --*/
+
+#include  <string.h>
+#include     "mex.h"
+#include  "matrix.h"
+#include  "makspk.h"
+
+
+/*-- Define block --*/
+
+#define   NARGIN  1
+#define  NARGOUT  1
+#define     CARG  0
+#define     POUT  0
+
+
+/*-- Subroutines --*/
+
+/* Packs the spike trains of cell array C */
+static mxArray *  pack ( const mxArray * C )
+{
+  const char  * fld[ MAKSPK_NFLD ] =
+    {  MAKSPK_T  ,  MAKSPK_OFF  ,  MAKSPK_SIZE  ,  MAKSPK_VALID  } ;
+  mwSize  i , k , n = mxGetNumberOfElements (  C  ) ;
+  mwSize  nd = mxGetNumberOfDimensions (  C  ) ;
+  const mwSize  * dims = mxGetDimensions (  C  ) ;
+  mwSignedIndex  j ;
+  double  * t , * off , * sz ;
+  makspk_t  * s ;
+  mxArray  * P , * a ;
+  int  e ;
+  
+  /* Check all trains , and get their spike times */
+  s = mxMalloc (  ( n + 1 ) * sizeof( makspk_t )  ) ;
+  e = makspk_cell (  C  ,  1  ,  &k  ,  s  ) ;
+  
+  if  ( e )
+    mexErrMsgIdAndTxt (  "MAK:makspkpack:spktrains"  ,
+      "makspkpack: spike train %d %s"  ,  ( int ) k + 1  ,  makspk_msg[ e ] );
+  
+  /* Offsets */
+  a = mxCreateDoubleMatrix (  n + 1  ,  1  ,  mxREAL  ) ;
+  off = mxGetPr (  a  ) ;
+  
+  for  ( i = 0 ; i < n ; i++ )  off[ i + 1 ] = off[ i ]  +  s[ i ].n ;
+  
+  P = mxCreateStructMatrix (  1  ,  1  ,  MAKSPK_NFLD  ,  fld  ) ;
+  mxSetField (  P  ,  0  ,  MAKSPK_OFF  ,  a  ) ;
+  
+  /* Spike times , copied by all threads */
+  a = mxCreateDoubleMatrix (  ( mwSize ) off[ n ]  ,  1  ,  mxREAL  ) ;
+  t = mxGetPr (  a  ) ;
+  mxSetField (  P  ,  0  ,  MAKSPK_T  ,  a  ) ;
+  
+  #pragma omp parallel for schedule( dynamic , 64 ) private( i )
+  for  ( j = 0 ; j < ( mwSignedIndex ) n ; j++ )
+  {
+    double  * x = t  +  ( mwSize ) off[ j ] ;
+    
+    if  ( s[ j ].dbl )
+      memcpy (  x  ,  s[ j ].s  ,  s[ j ].n * sizeof( double )  ) ;
+    else
+      for  ( i = 0 ; i < s[ j ].n ; i++ )
+        x[ i ] = ( ( const float * ) s[ j ].s )[ i ] ;
+  }
+  
+  /* Size of C */
+  a = mxCreateDoubleMatrix (  1  ,  nd  ,  mxREAL  ) ;
+  sz = mxGetPr (  a  ) ;
+  for  ( i = 0 ; i < nd ; i++ )  sz[ i ] = ( double ) dims[ i ] ;
+  mxSetField (  P  ,  0  ,  MAKSPK_SIZE  ,  a  ) ;
+  
+  /* Checked */
+  mxSetField (  P  ,  0  ,  MAKSPK_VALID  ,  mxCreateLogicalScalar( 1 )  ) ;
+  
+  mxFree (  s  ) ;
+  return  P ;
+}
+
+/* Unpacks packed spike trains P into a cell array */
+static mxArray *  unpack ( const mxArray * P )
+{
+  const mxArray  * v = mxGetField (  P  ,  0  ,  MAKSPK_VALID  ) ;
+  const mxArray  * z ;
+  const double  * t , * off , * sz ;
+  mwSize  i , k , n , nd , * dims ;
+  mxArray  * C , * a ;
+  int  e = MAKSPK_OK ;
+  
+  /* Check P. Spike times are not checked again if that was done already ,
+     but fields and offsets always are. */
+  if  ( !v  ||  !mxIsLogicalScalarTrue( v ) )
+    e = makspk_packed (  P  ,  1  ,  &k  ) ;
+  else
+    e = makspk_offsets (  P  ,  &k  ) ;
+  
+  if  ( e  ==  MAKSPK_PACK )
+    mexErrMsgIdAndTxt (  "MAK:makspkpack:P"  ,
+      "makspkpack: P has a bad field or offset"  ) ;
+  else if  ( e )
+    mexErrMsgIdAndTxt (  "MAK:makspkpack:spktrains"  ,
+      "makspkpack: spike train %d %s"  ,  ( int ) k + 1  ,  makspk_msg[ e ] );
+  
+  t = mxGetPr (  mxGetField( P , 0 , MAKSPK_T )  ) ;
+  off = mxGetPr (  mxGetField( P , 0 , MAKSPK_OFF )  ) ;
+  n = mxGetNumberOfElements (  mxGetField( P , 0 , MAKSPK_OFF )  )  -  1 ;
+  
+  /* Size of C must match the number of trains */
+  z = mxGetField (  P  ,  0  ,  MAKSPK_SIZE  ) ;
+  
+  if  ( !z  ||  !mxIsDouble( z )  ||  mxGetNumberOfElements( z ) < 2 )
+    mexErrMsgIdAndTxt (  "MAK:makspkpack:P"  ,
+      "makspkpack: P.size must be a double vector of 2 or more sizes"  ) ;
+  
+  sz = mxGetPr (  z  ) ;
+  nd = mxGetNumberOfElements (  z  ) ;
+  dims = mxMalloc (  nd * sizeof( mwSize )  ) ;
+  
+  for  ( k = 1 , i = 0 ; i < nd ; i++ )
+  {
+    if  ( sz[ i ] < 0  ||  sz[ i ] != floor( sz[ i ] ) )  k = 0 ;
+    dims[ i ] = ( mwSize ) sz[ i ] ;
+    k *= dims[ i ] ;
+  }
+  
+  if  ( k  !=  n )
+    mexErrMsgIdAndTxt (  "MAK:makspkpack:P"  ,
+      "makspkpack: P.size does not match the number of spike trains"  ) ;
+  
+  /* Rows of spike times , empty place holders are left as [ ] */
+  C = mxCreateCellArray (  nd  ,  dims  ) ;
+  
+  for  ( i = 0 ; i < n ; i++ )
+  {
+    k = ( mwSize ) ( off[ i + 1 ]  -  off[ i ] ) ;
+    if  ( !k )  continue ;
+    
+    a = mxCreateDoubleMatrix (  1  ,  k  ,  mxREAL  ) ;
+    memcpy (  mxGetPr( a )  ,  t + ( mwSize ) off[ i ]  ,
+      k * sizeof( double )  ) ;
+    mxSetCell (  C  ,  i  ,  a  ) ;
+  }
+  
+  mxFree (  dims  ) ;
+  return  C ;
+}
+
+
+/*** MEX gateway function ***/
+
+void  mexFunction (  int nlhs  ,        mxArray * plhs[ ] ,
+                     int nrhs  ,  const mxArray * prhs[ ]  )
+{
+  
+  
+  /*-- Input check --*/
+  
+  /* Must be exactly 1 input arg */
+  if  ( nrhs  !=  NARGIN )
+    
+    mexErrMsgIdAndTxt (  "MAK:makspkpack:nargsin"  ,
+      "makspkpack: requires %d input argument"  ,  NARGIN  ) ;
+  
+  /* Must be no more than 1 output arg */
+  else if  ( NARGOUT  <  nlhs )
+    
+    mexErrMsgIdAndTxt (  "MAK:makspkpack:nargsout"  ,
+      "makspkpack: returns at most %d output argument"  ,  NARGOUT  ) ;
+  
+  /* Must be a cell array or a scalar struct */
+  else if  ( !mxIsCell( prhs[ CARG ] )  &&
+             !( mxIsStruct( prhs[ CARG ] ) && mxIsScalar( prhs[ CARG ] ) ) )
+    
+    mexErrMsgIdAndTxt (  "MAK:makspkpack:C"  ,
+      "makspkpack: input must be a cell array or packed spike trains"  ) ;
+  
+  
+  /*-- Pack or unpack --*/
+  
+  if  ( mxIsCell(  prhs[ CARG ]  ) )
+    plhs[ POUT ] = pack (  prhs[ CARG ]  ) ;
+  else
+    plhs[ POUT ] = unpack (  prhs[ CARG ]  ) ;
+
+
+} /* mexFunction */
+
@@ -0,0 +1,39 @@
+
+% P = makspkpack ( C )
+% C = makspkpack ( P )
+% 
+% MET Analysis Kit. Packs a cell array of spike trains into one struct, or
+% unpacks it again. C is a cell array of spike trains, as used by maksttc
+% and makrccg, with trials over rows and clusters over columns. Each train
+% must be empty, or a real vector of type single or double with finite
+% spike times in chronological order. All trains are checked and copied
+% in one pass, and an error is raised if any of them is invalid.
+% 
+% P is a scalar struct with fields:
+% 
+%   .t - N x 1 double, the spike times of all N spikes, train by train
+%   .off - ( numel( C ) + 1 ) x 1 double offsets. Spike train i is
+%     P.t( P.off( i ) + 1 : P.off( i + 1 ) ), in the linear order of C.
+%   .size - size( C )
+%   .valid - true, so that functions that use makspkchk need not check P
+%     again.
+% 
+% Packed spike trains use one block of memory, instead of one MATLAB array
+% per train. They are quicker to check, to save, and to send to parallel
+% workers. maksttc and makrccg accept P in place of C.
+% 
+% Given P, makspkpack returns cell array C with the size of P.size. Each
+% non-empty train is a row vector of doubles, and each empty train is [ ].
+% P is checked first. If P.valid is true then only its fields and offsets
+% are checked, and not its spike times. Set P.valid to false after
+% changing P by hand.
+% 
+% If MEX is compiled with OpenMP then spike trains are divided between
+% threads, e.g.
+% 
+%   mex CFLAGS='$CFLAGS -fopenmp' LDFLAGS='$LDFLAGS -fopenmp' makspkpack.c
+% 
+% Otherwise, it runs on a single thread. See makspkchk.
+% 
+% Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+% 
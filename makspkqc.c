@@ -0,0 +1,305 @@
+
+/*  makspkqc
+  
+  [ isi , acg , rv , n ] = makspkqc ( t , c , x , y , ref )
+  
+  MET Analysis Kit. Spike sorting quality control for all clusters at
+  once. Spikes are grouped by cluster with a single counting sort. Then ,
+  in one pass over each cluster , its inter-spike-interval ( ISI )
+  histogram , its autocorrelogram ( ACG ) for short positive lags , and its
+  number of refractory period violations are computed.
+  
+  t is a vector of spike times in seconds , single or double , that are in
+  chronological order within each cluster. c is a vector of the same
+  length with the cluster index of each spike ; it is uint8 , uint16 ,
+  uint32 , or double with values from 1 to K. x is a vector of ascending
+  ISI histogram bin edges , in seconds , and y is a vector of ascending ACG
+  bin edges , in seconds. ref is the refractory period in seconds.
+  
+  isi is a ( numel( x ) - 1 ) x K matrix of ISI counts , and acg is a
+  ( numel( y ) - 1 ) x K matrix of counts of spike pairs from the same
+  cluster that are separated by each lag. rv is a 1 x K vector that counts
+  the ISIs less than ref. n is a 1 x K vector with the number of spikes in
+  each cluster. Bins include their left edge , and the last bin includes
+  both edges , as for Matlab's histogram ( ).
+  
+  Compile with OpenMP to divide clusters between threads.
+  
+  Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+
+*/
+
+
+/*-- Include block --*/
+
+#include  <stdlib.h>
+#include  <string.h>
+#include     "mex.h"
+#include  "matrix.h"
+
+#ifdef  _OPENMP
+  #include  <omp.h>
+#endif
+
+
+/*-- Define block --*/
+
+#define    NARGIN  5
+#define   NARGOUT  4
+#define      TARG  0
+#define      CARG  1
+#define      XARG  2
+#define      YARG  3
+#define    REFARG  4
+#define    ISIOUT  0
+#define    ACGOUT  1
+#define     RVOUT  2
+#define      NOUT  3
+
+
+/*-- Subroutines --*/
+
+/* Bin of value v given B + 1 ascending edges e. Returns B if v is outside
+   of the edges. Bins include their left edge , the last bin includes its
+   right edge too. */
+static mwSize  getbin ( double v , const double * e , mwSize B )
+{
+  mwSize  lo = 0 , hi = B , m ;
+  
+  if  ( v < e[ 0 ]  ||  e[ B ] < v  ||  v != v )  return  B ;
+  if  ( v == e[ B ] )  return  B  -  1 ;
+  
+  /* Last edge that is not greater than v */
+  while  ( lo + 1  <  hi )
+  {
+    m = ( lo  +  hi )  /  2 ;
+    if  ( e[ m ] <= v )  lo = m ;  else  hi = m ;
+  }
+  
+  return  lo ;
+}
+
+/* Writes the 0-based cluster labels of c to l and the largest label to K.
+   Returns non-zero if any label is not an integer of 1 or more. */
+static int  getlabels ( const mxArray * c , mwSize * l , mwSize * K )
+{
+  mwSize  i , N = mxGetNumberOfElements (  c  ) ;
+  double  v ;
+  
+  for  ( *K = 0 , i = 0 ; i < N ; i++ )
+  {
+    switch  ( mxGetClassID(  c  ) )
+    {
+      case  mxUINT8_CLASS:
+        v = ( ( const unsigned char * ) mxGetData( c ) )[ i ] ;  break ;
+      case  mxUINT16_CLASS:
+        v = ( ( const unsigned short * ) mxGetData( c ) )[ i ] ;  break ;
+      case  mxUINT32_CLASS:
+        v = ( ( const unsigned int * ) mxGetData( c ) )[ i ] ;  break ;
+      default:
+        v = mxGetPr (  c  )[ i ] ;
+    }
+    
+    if  ( !( 1 <= v )  ||  v != ( double ) ( mwSize ) v )  return  1 ;
+    
+    l[ i ] = ( mwSize ) v  -  1 ;
+    if  ( *K  <  ( mwSize ) v )  *K = ( mwSize ) v ;
+  }
+  
+  return  0 ;
+}
+
+
+/*** MEX gateway function ***/
+
+void  mexFunction (  int nlhs  ,        mxArray * plhs[ ] ,
+                     int nrhs  ,  const mxArray * prhs[ ]  )
+{
+  
+  
+  /*-- Variables --*/
+  
+  /* Generic counters */
+  mwSize  i ;
+  
+  /* Number of spikes , clusters , ISI bins , and ACG bins */
+  mwSize  N , K , Bx , By ;
+  
+  /* Refractory period */
+  double  ref ;
+  
+  /* Bin edges */
+  const double  * x , * y ;
+  
+  /* Cluster labels , start of each cluster in the sorted spikes , and
+     sorted spike times */
+  mwSize  * l , * off ;
+  double  * t ;
+  
+  /* Outputs */
+  mxArray  * o[ NARGOUT ] ;
+  double  * isi , * acg , * rv , * n ;
+  
+  
+  /*-- Input check --*/
+  
+  /* Must be exactly 5 input args */
+  if  ( nrhs  !=  NARGIN )
+    
+    mexErrMsgIdAndTxt (  "MAK:makspkqc:nargsin"  ,
+      "makspkqc: requires %d input arguments"  ,  NARGIN  ) ;
+  
+  /* Must be no more than 4 output args */
+  else if  ( NARGOUT  <  nlhs )
+    
+    mexErrMsgIdAndTxt (  "MAK:makspkqc:nargsout"  ,
+      "makspkqc: returns at most %d output arguments"  ,  NARGOUT  ) ;
+  
+  /* t must be real single or double */
+  else if  (  !( mxIsDouble( prhs[ TARG ] ) || mxIsSingle( prhs[ TARG ] ) )
+              ||  mxIsComplex( prhs[ TARG ] )  )
+    
+    mexErrMsgIdAndTxt (  "MAK:makspkqc:t"  ,
+      "makspkqc: t must be a real single or double vector"  ) ;
+  
+  /* c must have one label per spike */
+  else if  (  !( mxIsUint8( prhs[ CARG ] )  ||  mxIsUint16( prhs[ CARG ] )
+                 ||  mxIsUint32( prhs[ CARG ] )  ||
+                 ( mxIsDouble( prhs[ CARG ] ) && !mxIsComplex( prhs[ CARG ] )
+                   && !mxIsSparse( prhs[ CARG ] ) ) )  ||
+              mxGetNumberOfElements( prhs[ CARG ] ) !=
+              mxGetNumberOfElements( prhs[ TARG ] )  )
+    
+    mexErrMsgIdAndTxt (  "MAK:makspkqc:c"  ,
+      "makspkqc: c must be uint8 , uint16 , uint32 , or double with one "
+      "value per spike"  ) ;
+  
+  /* Bin edges must be ascending double vectors with at least 2 edges */
+  for  ( i = XARG ; i <= YARG ; i++ )
+  {
+    mwSize  j , B = mxGetNumberOfElements (  prhs[ i ]  ) ;
+    int  bad = !mxIsDouble( prhs[ i ] )  ||  mxIsComplex( prhs[ i ] )  ||
+               mxIsSparse( prhs[ i ] )  ||  B < 2 ;
+    
+    for  ( j = 1 ; !bad  &&  j < B ; j++ )
+      bad = !( mxGetPr( prhs[ i ] )[ j - 1 ]  <  mxGetPr( prhs[ i ] )[ j ] ) ;
+    
+    if  ( bad )
+      mexErrMsgIdAndTxt (  "MAK:makspkqc:edges"  ,
+        "makspkqc: %s must be a double vector of 2 or more ascending bin "
+        "edges"  ,  i == XARG  ?  "x"  :  "y"  ) ;
+  }
+  
+  /* ref must be a real scalar */
+  if  (  !mxIsScalar( prhs[ REFARG ] )  ||  !mxIsNumeric( prhs[ REFARG ] )
+         ||  mxIsComplex( prhs[ REFARG ] )  )
+    
+    mexErrMsgIdAndTxt (  "MAK:makspkqc:ref"  ,
+      "makspkqc: ref must be a real scalar"  ) ;
+  
+  
+  /*-- Preparation --*/
+  
+  N = mxGetNumberOfElements (  prhs[ TARG ]  ) ;
+  Bx = mxGetNumberOfElements (  prhs[ XARG ]  )  -  1 ;
+  By = mxGetNumberOfElements (  prhs[ YARG ]  )  -  1 ;
+  x = mxGetPr (  prhs[ XARG ]  ) ;
+  y = mxGetPr (  prhs[ YARG ]  ) ;
+  ref = mxGetScalar (  prhs[ REFARG ]  ) ;
+  
+  /* Cluster labels */
+  l = mxMalloc (  ( N + 1 ) * sizeof( mwSize )  ) ;
+  
+  if  ( getlabels(  prhs[ CARG ]  ,  l  ,  &K  ) )
+    
+    mexErrMsgIdAndTxt (  "MAK:makspkqc:cval"  ,
+      "makspkqc: c values must be integers of 1 or more"  ) ;
+  
+  /* Counting sort of spike times by cluster. This is stable , so each
+     cluster keeps its chronological order. */
+  off = mxCalloc (  K + 1  ,  sizeof( mwSize )  ) ;
+    t = mxMalloc (  ( N + 1 ) * sizeof( double )  ) ;
+  
+  for  ( i = 0 ; i < N ; i++ )  off[ l[ i ] + 1 ]++ ;
+  for  ( i = 1 ; i <= K ; i++ )  off[ i ] += off[ i - 1 ] ;
+  
+  if  ( mxIsDouble(  prhs[ TARG ]  ) )
+    for  ( i = 0 ; i < N ; i++ )
+      t[ off[ l[ i ] ]++ ] = mxGetPr (  prhs[ TARG ]  )[ i ] ;
+  else
+    for  ( i = 0 ; i < N ; i++ )
+      t[ off[ l[ i ] ]++ ] =
+        ( ( const float * ) mxGetData( prhs[ TARG ] ) )[ i ] ;
+  
+  /* Placement moved each start to the next cluster's start */
+  for  ( i = K ; i ; i-- )  off[ i ] = off[ i - 1 ] ;
+  off[ 0 ] = 0 ;
+  
+  /* Allocate outputs */
+  o[ ISIOUT ] = mxCreateDoubleMatrix (  Bx  ,  K  ,  mxREAL  ) ;
+  o[ ACGOUT ] = mxCreateDoubleMatrix (  By  ,  K  ,  mxREAL  ) ;
+  o[  RVOUT ] = mxCreateDoubleMatrix (   1  ,  K  ,  mxREAL  ) ;
+  o[   NOUT ] = mxCreateDoubleMatrix (   1  ,  K  ,  mxREAL  ) ;
+  isi = mxGetPr (  o[ ISIOUT ]  ) ;
+  acg = mxGetPr (  o[ ACGOUT ]  ) ;
+   rv = mxGetPr (  o[  RVOUT ]  ) ;
+    n = mxGetPr (  o[   NOUT ]  ) ;
+  
+  
+  /*-- Clusters --*/
+  
+  #pragma omp parallel
+  {
+    
+    /* Cluster , spike counters , the lag sweep's far end , and bin */
+    mwSignedIndex  a ;
+    mwSize  i , j , e , b ;
+    double  d ;
+    
+    /* Large clusters take longer */
+    #pragma omp for schedule( dynamic )
+    for  ( a = 0 ; a < ( mwSignedIndex ) K ; a++ )
+    {
+      
+      /* Spikes in cluster */
+      n[ a ] = ( double ) ( off[ a + 1 ]  -  off[ a ] ) ;
+      
+      /* ISIs and refractory violations */
+      for  ( i = off[ a ] + 1 ; i < off[ a + 1 ] ; i++ )
+      {
+        d = t[ i ]  -  t[ i - 1 ] ;
+        if  ( d  <  ref )  rv[ a ] += 1 ;
+        if  ( ( b = getbin( d , x , Bx ) )  <  Bx )  isi[ a * Bx + b ] += 1 ;
+      }
+      
+      /* ACG. The far end e of the sweep only moves forward , it marks the
+         first spike beyond the largest lag from spike i. Every spike
+         from i + 1 up to e is binned. */
+      for  ( e = off[ a ] , i = off[ a ] ; i < off[ a + 1 ] ; i++ )
+      {
+        if  ( e  <=  i )  e = i  +  1 ;
+        while  ( e < off[ a + 1 ]  &&  t[ e ] - t[ i ] <= y[ By ] )  e++ ;
+        
+        for  ( j = i + 1 ; j < e ; j++ )
+          if  ( ( b = getbin( t[ j ] - t[ i ] , y , By ) )  <  By )
+            acg[ a * By + b ] += 1 ;
+      }
+    
+    } /* clusters */
+  
+  } /* parallel */
+  
+  mxFree (  l  ) ;
+  mxFree (  off  ) ;
+  mxFree (  t  ) ;
+  
+  /* Return requested outputs */
+  for  ( i = 0 ; i < NARGOUT ; i++ )
+    if  ( i  <  ( mwSize ) ( nlhs < 1 ? 1 : nlhs ) )
+      plhs[ i ] = o[ i ] ;
+    else
+      mxDestroyArray (  o[ i ]  ) ;
+
+
+} /* mexFunction */
+
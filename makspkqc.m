@@ -0,0 +1,41 @@
+
+% [ isi , acg , rv , n ] = makspkqc ( t , c , x , y , ref )
+% 
+% MET Analysis Kit, pre-processing. Spike sorting quality control for all
+% spike clusters at once. Spikes are grouped by cluster with a single
+% counting sort. Then, in one pass over each cluster, its inter-spike-
+% interval ( ISI ) histogram, its autocorrelogram ( ACG ) at short
+% positive lags, and its number of refractory period violations are
+% computed. This replaces separate calls to histogram ( diff( t ) ) and to
+% xcorr on binned spike trains for each cluster.
+% 
+% t is a vector of spike times in seconds, single or double, that are in
+% chronological order within each cluster. c is a vector of the same
+% length with the cluster index of each spike, e.g. from makspkclust or
+% makcmerge ; it is uint8, uint16, uint32, or double with integer values
+% from 1 to K. x is a double vector of ascending ISI histogram bin edges,
+% in seconds, such as 0 : 0.001 : 0.1. y is a double vector of ascending
+% ACG bin edges, in seconds. ref is the refractory period in seconds.
+% 
+% isi is a ( numel( x ) - 1 ) x K matrix of ISI counts per cluster. acg is
+% a ( numel( y ) - 1 ) x K matrix that counts the pairs of spikes from the
+% same cluster that are separated by each lag ; the ACG is symmetric, so
+% only positive lags are returned. rv is a 1 x K vector that counts the
+% ISIs that are less than ref, and n is a 1 x K vector with the number of
+% spikes in each cluster. Clusters with no spikes return zeros. Bins
+% include their left edge, and the last bin also includes its right edge,
+% as for Matlab's histogram ( ).
+% 
+% The ACG uses a two-pointer sweep. The far pointer marks the first spike
+% beyond the last edge of y from the current spike, and it only ever moves
+% forward. Hence, the cost per cluster is O( n ) plus the number of spike
+% pairs within the largest lag.
+% 
+% If MEX is compiled with OpenMP then clusters are divided between threads,
+% e.g.
+% 
+%   mex CFLAGS='$CFLAGS -fopenmp' LDFLAGS='$LDFLAGS -fopenmp' makspkqc.c
+% 
+% Otherwise, it runs on a single thread.
+% 
+% Written by Jackson Smith - October 2026 - ESI (Fries Lab)
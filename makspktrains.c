@@ -0,0 +1,476 @@
+
+/*  makspktrains
+  
+  [ P , u ] = makspktrains ( t , c )
+  [ C , u ] = makspktrains ( t , c , e )
+  
+  MET Analysis Kit. Gathers the spike trains of all units from a list of
+  spike times and final cluster labels , such as those returned by
+  makcmerge or makmergetool. Rather than one pass over all spikes per unit ,
+  as in t( c == u ) , spikes are counting-sorted by label in one pass and
+  written straight into packed spike trains. Labels are first renumbered
+  from 1 to U , so that memory grows with the number of units and not with
+  the largest label.
+  
+  t is a vector of N spike times in seconds , single or double. c is a
+  vector of N cluster labels , uint8 , uint16 , uint32 , or double. Labels
+  must be integers of 0 or more. Spikes with label 0 , such as those that
+  were rejected in makmergetool , are left out.
+  
+  P is a struct of packed spike trains , as returned by makspkpack , with
+  one train per unit in P.size = [ 1 , U ]. u is a 1 x U double vector
+  with the label of each unit , in ascending order. Only labels with at
+  least one spike are included. Spike trains are in chronological order ,
+  even if t is not. P.valid is true.
+  
+  If optional e is given then spikes are also divided into trials. e is a
+  K x 2 or K x 3 double matrix with one row per trial. Spikes of trial k
+  run from time e( k , 1 ) up to , but not including , e( k , 2 ). If e has
+  a third column then e( k , 3 ) is subtracted from the spike times of
+  trial k , such as the time of stimulus onset. C is then a K x U cell
+  array of row vectors , with trials over rows and units over columns ,
+  ready for maksttc or makrccg. A trial with no spikes from a unit gets a
+  1 x 0 double.
+  
+  Compile with OpenMP to divide spikes and units between threads.
+  
+  Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+
+*/
+
+
+/*-- Include block --*/
+
+#include  <stdlib.h>
+#include  <string.h>
+#include     "mex.h"
+#include  "matrix.h"
+#include  "makspk.h"
+
+
+/*-- Define block --*/
+
+#define  NARGINMIN  2
+#define  NARGINMAX  3
+#define    NARGOUT  2
+#define       TARG  0
+#define       CARG  1
+#define       EARG  2
+#define       POUT  0
+#define       UOUT  1
+
+/* Most blocks of spikes that are counted at once , and fewest spikes per
+   label in each block */
+#define  MAXBLK  64
+#define  MINBLK  16
+
+
+/*-- Subroutines --*/
+
+/* Writes the labels of c to l and the largest label to L. Returns
+   non-zero if any label is not an integer of 0 or more. */
+static int  getlabels ( const mxArray * c , mwSize * l , mwSize * L )
+{
+  mwSize  i , N = mxGetNumberOfElements (  c  ) ;
+  double  v ;
+  
+  for  ( *L = 0 , i = 0 ; i < N ; i++ )
+  {
+    switch  ( mxGetClassID(  c  ) )
+    {
+      case  mxUINT8_CLASS:
+        v = ( ( const unsigned char * ) mxGetData( c ) )[ i ] ;  break ;
+      case  mxUINT16_CLASS:
+        v = ( ( const unsigned short * ) mxGetData( c ) )[ i ] ;  break ;
+      case  mxUINT32_CLASS:
+        v = ( ( const unsigned int * ) mxGetData( c ) )[ i ] ;  break ;
+      default:
+        v = mxGetPr (  c  )[ i ] ;
+    }
+    
+    if  ( !( 0 <= v )  ||  v != ( double ) ( mwSize ) v )  return  1 ;
+    
+    l[ i ] = ( mwSize ) v ;
+    if  ( *L  <  l[ i ] )  *L = l[ i ] ;
+  }
+  
+  return  0 ;
+}
+
+/* Ascending order of doubles */
+static int  cmpdbl ( const void * a , const void * b )
+{
+  double  x = *( const double * ) a , y = *( const double * ) b ;
+  return  ( y < x )  -  ( x < y ) ;
+}
+
+/* Ascending order of labels */
+static int  cmplab ( const void * a , const void * b )
+{
+  mwSize  x = *( const mwSize * ) a , y = *( const mwSize * ) b ;
+  return  ( y < x )  -  ( x < y ) ;
+}
+
+/* Renumbers the N labels of l , with largest label L , from 1 to U in
+   ascending order of label. Label 0 stays 0. Returns U , and the label of
+   each unit in v , which must be freed with mxFree. Labels up to N are
+   renumbered through a table of L + 1 entries , larger ones by sorting a
+   copy of the labels and a binary search. Either way , memory grows with N
+   and not with L. */
+static mwSize  compact ( mwSize * l , mwSize N , mwSize L , mwSize ** v )
+{
+  mwSize  i , k , U = 0 , * m ;
+  mwSignedIndex  j ;
+  
+  /* Table from label to unit */
+  if  ( L  <=  N )
+  {
+    m = mxCalloc (  L + 1  ,  sizeof( mwSize )  ) ;
+    *v = mxMalloc (  ( L + 1 ) * sizeof( mwSize )  ) ;
+    
+    for  ( i = 0 ; i < N ; i++ )  m[ l[ i ] ] = 1 ;
+    m[ 0 ] = 0 ;
+    
+    for  ( i = 1 ; i <= L ; i++ )
+      if  ( m[ i ] )  {  ( *v )[ U ] = i ;  m[ i ] = ++U ;  }
+    
+    #pragma omp parallel for schedule( static )
+    for  ( j = 0 ; j < ( mwSignedIndex ) N ; j++ )  l[ j ] = m[ l[ j ] ] ;
+    
+    mxFree (  m  ) ;
+    return  U ;
+  }
+  
+  /* Sorted labels , without repeats */
+  *v = mxMalloc (  ( N + 1 ) * sizeof( mwSize )  ) ;
+  
+  for  ( i = 0 ; i < N ; i++ )  if  ( l[ i ] )  ( *v )[ U++ ] = l[ i ] ;
+  
+  qsort (  *v  ,  U  ,  sizeof( mwSize )  ,  cmplab  ) ;
+  
+  for  ( k = 0 , i = 0 ; i < U ; i++ )
+    if  ( !k  ||  ( *v )[ k - 1 ]  !=  ( *v )[ i ] )
+      ( *v )[ k++ ] = ( *v )[ i ] ;
+  
+  U = k ;
+  
+  /* Unit of each label , by binary search */
+  #pragma omp parallel for schedule( static ) private( k )
+  for  ( j = 0 ; j < ( mwSignedIndex ) N ; j++ )
+  {
+    mwSize  a = 0 , n = U ;
+    
+    if  ( !l[ j ] )  continue ;
+    
+    while  ( n )
+    {
+      k = n  /  2 ;
+      if  ( ( *v )[ a + k ]  <  l[ j ] )  {  a += k + 1 ;  n -= k + 1 ;  }
+      else                                   n  = k ;
+    }
+    
+    l[ j ] = a  +  1 ;
+  }
+  
+  return  U ;
+}
+
+/* Index of the first of n ascending values of x that is not below v */
+static mwSize  lowerbound ( const double * x , mwSize n , double v )
+{
+  mwSize  a = 0 , m ;
+  
+  while  ( n )
+  {
+    m = n  /  2 ;
+    if  ( x[ a + m ]  <  v )  {  a += m + 1 ;  n -= m + 1 ;  }
+    else                         n  = m ;
+  }
+  
+  return  a ;
+}
+
+
+/*** MEX gateway function ***/
+
+void  mexFunction (  int nlhs  ,        mxArray * plhs[ ] ,
+                     int nrhs  ,  const mxArray * prhs[ ]  )
+{
+  
+  
+  /*-- Variables --*/
+  
+  /* Generic counters */
+  mwSize  i , j , k ;
+  mwSignedIndex  b ;
+  
+  /* Number of spikes , largest label , units , blocks , kept spikes , and
+     trials */
+  mwSize  N , L , U , B , S , K = 0 ;
+  
+  /* Spike times , in single or double precision */
+  makspk_t  ts ;
+  
+  /* Labels , the next place of each unit's spikes in each block , and the
+     label of each unit */
+  mwSize  * l , * cnt , * v ;
+  
+  /* Packed spike times and offsets , labels of units , and trial epochs */
+  double  * t , * off , * u , * e = NULL ;
+  
+  /* First and last spike of each trial and unit */
+  mwSize  * lo , * hi ;
+  
+  /* Error flag raised by any block */
+  int  err = 0 ;
+  
+  /* Packed field names */
+  const char  * fld[ MAKSPK_NFLD ] =
+    {  MAKSPK_T  ,  MAKSPK_OFF  ,  MAKSPK_SIZE  ,  MAKSPK_VALID  } ;
+  
+  /* Outputs , and trials of each unit */
+  mxArray  * o[ NARGOUT ] , * a , * C ;
+  
+  
+  /*-- Input check --*/
+  
+  /* Must be 2 or 3 input args */
+  if  ( nrhs < NARGINMIN  ||  NARGINMAX < nrhs )
+    
+    mexErrMsgIdAndTxt (  "MAK:makspktrains:nargsin"  ,
+      "makspktrains: requires %d or %d input arguments"  ,
+      NARGINMIN  ,  NARGINMAX  ) ;
+  
+  /* Must be no more than 2 output args */
+  else if  ( NARGOUT  <  nlhs )
+    
+    mexErrMsgIdAndTxt (  "MAK:makspktrains:nargsout"  ,
+      "makspktrains: returns at most %d output arguments"  ,  NARGOUT  ) ;
+  
+  /* t must be real single or double */
+  else if  (  !( mxIsDouble( prhs[ TARG ] ) || mxIsSingle( prhs[ TARG ] ) )
+              ||  mxIsComplex( prhs[ TARG ] )  ||  mxIsSparse( prhs[ TARG ] ) )
+    
+    mexErrMsgIdAndTxt (  "MAK:makspktrains:t"  ,
+      "makspktrains: t must be a real single or double vector"  ) ;
+  
+  /* c must have one label per spike */
+  else if  (  !( mxIsUint8( prhs[ CARG ] )  ||  mxIsUint16( prhs[ CARG ] )
+                 ||  mxIsUint32( prhs[ CARG ] )  ||
+                 ( mxIsDouble( prhs[ CARG ] ) && !mxIsComplex( prhs[ CARG ] )
+                   && !mxIsSparse( prhs[ CARG ] ) ) )  ||
+              mxGetNumberOfElements( prhs[ CARG ] ) !=
+              mxGetNumberOfElements( prhs[ TARG ] )  )
+    
+    mexErrMsgIdAndTxt (  "MAK:makspktrains:c"  ,
+      "makspktrains: c must be uint8 , uint16 , uint32 , or double with "
+      "one value per spike"  ) ;
+  
+  /* Optional e must be a real double matrix with 2 or 3 columns */
+  if  ( NARGINMAX  ==  nrhs )
+  {
+    if  (  !mxIsDouble( prhs[ EARG ] )  ||  mxIsComplex( prhs[ EARG ] )  ||
+           mxIsSparse( prhs[ EARG ] )  ||
+           mxGetNumberOfDimensions( prhs[ EARG ] ) != 2  ||
+           mxGetN( prhs[ EARG ] ) < 2  ||  3 < mxGetN( prhs[ EARG ] )  )
+      
+      mexErrMsgIdAndTxt (  "MAK:makspktrains:e"  ,
+        "makspktrains: e must be a real double matrix with 2 or 3 columns" );
+    
+    e = mxGetPr (  prhs[ EARG ]  ) ;
+    K = mxGetM (  prhs[ EARG ]  ) ;
+    
+    for  ( k = 0 ; k < K ; k++ )
+      if  ( !( e[ k ] <= e[ K + k ] ) )
+        
+        mexErrMsgIdAndTxt (  "MAK:makspktrains:eval"  ,
+          "makspktrains: e( k , 1 ) must not be greater than e( k , 2 )"  );
+  }
+  
+  
+  /*-- Count spikes --*/
+  
+  N = mxGetNumberOfElements (  prhs[ TARG ]  ) ;
+  
+  ts.s = mxGetData (  prhs[ TARG ]  ) ;
+  ts.dbl = mxIsDouble (  prhs[ TARG ]  ) ;
+  ts.n = N ;
+  
+  /* Labels */
+  l = mxMalloc (  ( N + 1 ) * sizeof( mwSize )  ) ;
+  
+  if  ( getlabels(  prhs[ CARG ]  ,  l  ,  &L  ) )
+    
+    mexErrMsgIdAndTxt (  "MAK:makspktrains:cval"  ,
+      "makspktrains: c values must be integers of 0 or more"  ) ;
+  
+  /* Units 1 to U , in ascending order of label */
+  U = compact (  l  ,  N  ,  L  ,  &v  ) ;
+  
+  /* Spikes are divided into blocks that are counted in parallel. There are
+     few enough blocks that their counts take less memory than the spikes.
+  */
+  B = N  /  ( MINBLK * ( U + 1 ) ) ;
+  if  ( B  <  1 )  B = 1 ;
+  if  ( MAXBLK  <  B )  B = MAXBLK ;
+  
+  cnt = mxCalloc (  B * ( U + 1 )  ,  sizeof( mwSize )  ) ;
+  
+  #pragma omp parallel for schedule( static ) private( i ) \
+    reduction( | : err )
+  for  ( b = 0 ; b < ( mwSignedIndex ) B ; b++ )
+  {
+    mwSize  * n = cnt  +  b * ( U + 1 ) ;
+    
+    for  ( i = ( mwSize ) b * N / B ; i < ( mwSize ) ( b + 1 ) * N / B ; i++ )
+    {
+      n[ l[ i ] ]++ ;
+      
+      if  ( !isfinite( ts.dbl  ?  ( ( const double * ) ts.s )[ i ]  :
+                                   ( ( const float  * ) ts.s )[ i ] ) )
+        err = 1 ;
+    }
+  }
+  
+  if  ( err )
+    mexErrMsgIdAndTxt (  "MAK:makspktrains:tval"  ,
+      "makspktrains: t values must be finite"  ) ;
+  
+  
+  /*-- Offsets --*/
+  
+  /* Every unit has spikes */
+  o[ UOUT ] = mxCreateDoubleMatrix (  1  ,  U  ,  mxREAL  ) ;
+  u = mxGetPr (  o[ UOUT ]  ) ;
+  
+  a = mxCreateDoubleMatrix (  U + 1  ,  1  ,  mxREAL  ) ;
+  off = mxGetPr (  a  ) ;
+  
+  /* Each block's count becomes the place of its first spike of that unit.
+     Blocks are in order within each unit , so the sort is stable. */
+  for  ( S = 0 , j = 1 ; j <= U ; j++ )
+  {
+    for  ( b = 0 ; b < ( mwSignedIndex ) B ; b++ )
+    {
+      i = cnt[ b * ( U + 1 ) + j ] ;
+      cnt[ b * ( U + 1 ) + j ] = S ;
+      S += i ;
+    }
+    
+    u[ j - 1 ] = ( double ) v[ j - 1 ] ;
+    off[ j ] = ( double ) S ;
+  }
+  
+  mxFree (  v  ) ;
+  
+  
+  /*-- Sort spikes --*/
+  
+  o[ POUT ] = mxCreateStructMatrix (  1  ,  1  ,  MAKSPK_NFLD  ,  fld  ) ;
+  mxSetField (  o[ POUT ]  ,  0  ,  MAKSPK_OFF  ,  a  ) ;
+  
+  a = mxCreateDoubleMatrix (  S  ,  1  ,  mxREAL  ) ;
+  t = mxGetPr (  a  ) ;
+  mxSetField (  o[ POUT ]  ,  0  ,  MAKSPK_T  ,  a  ) ;
+  
+  /* Spikes with label 0 are dropped */
+  #pragma omp parallel for schedule( static ) private( i )
+  for  ( b = 0 ; b < ( mwSignedIndex ) B ; b++ )
+  {
+    mwSize  * n = cnt  +  b * ( U + 1 ) ;
+    
+    for  ( i = ( mwSize ) b * N / B ; i < ( mwSize ) ( b + 1 ) * N / B ; i++ )
+      if  ( l[ i ] )
+        t[ n[ l[ i ] ]++ ] = ts.dbl  ?  ( ( const double * ) ts.s )[ i ]  :
+                                        ( ( const float  * ) ts.s )[ i ] ;
+  }
+  
+  mxFree (  cnt  ) ;
+  mxFree (  l  ) ;
+  
+  /* Spike times stay in the order of t. Sort any train that is not in
+     chronological order. */
+  #pragma omp parallel for schedule( dynamic , 16 ) private( i )
+  for  ( b = 0 ; b < ( mwSignedIndex ) U ; b++ )
+  {
+    mwSize  x = ( mwSize ) off[ b ] , y = ( mwSize ) off[ b + 1 ] ;
+    
+    for  ( i = x + 1 ; i < y ; i++ )
+      if  ( t[ i ]  <  t[ i - 1 ] )
+      {
+        qsort (  t + x  ,  y - x  ,  sizeof( double )  ,  cmpdbl  ) ;
+        break ;
+      }
+  }
+  
+  /* Size and valid flag */
+  a = mxCreateDoubleMatrix (  1  ,  2  ,  mxREAL  ) ;
+  mxGetPr (  a  )[ 0 ] = 1 ;
+  mxGetPr (  a  )[ 1 ] = ( double ) U ;
+  mxSetField (  o[ POUT ]  ,  0  ,  MAKSPK_SIZE  ,  a  ) ;
+  
+  mxSetField (  o[ POUT ]  ,  0  ,  MAKSPK_VALID  ,
+    mxCreateLogicalScalar( 1 )  ) ;
+  
+  
+  /*-- Trials --*/
+  
+  if  ( e )
+  {
+    /* First and last spike of each trial , unit by unit */
+    lo = mxMalloc (  ( K * U + 1 ) * sizeof( mwSize )  ) ;
+    hi = mxMalloc (  ( K * U + 1 ) * sizeof( mwSize )  ) ;
+    
+    #pragma omp parallel for schedule( dynamic , 16 ) private( k )
+    for  ( b = 0 ; b < ( mwSignedIndex ) U ; b++ )
+    {
+      const double  * x = t  +  ( mwSize ) off[ b ] ;
+      mwSize  n = ( mwSize ) ( off[ b + 1 ]  -  off[ b ] ) ;
+      
+      for  ( k = 0 ; k < K ; k++ )
+      {
+        lo[ b * K + k ] = lowerbound (  x  ,  n  ,  e[ k ]  ) ;
+        hi[ b * K + k ] = lowerbound (  x  ,  n  ,  e[ K + k ]  ) ;
+      }
+    }
+    
+    /* Trials over rows and units over columns. MATLAB arrays are made on
+       one thread. */
+    C = mxCreateCellMatrix (  K  ,  U  ) ;
+    
+    for  ( j = 0 ; j < K * U ; j++ )
+    {
+      const double  * x = t  +  ( mwSize ) off[ j / K ]  +  lo[ j ] ;
+      double  * y , z = 0 ;
+      
+      /* Time zero of this trial */
+      if  ( mxGetN(  prhs[ EARG ]  )  ==  3 )  z = e[ 2 * K  +  j % K ] ;
+      
+      a = mxCreateDoubleMatrix (  1  ,  hi[ j ] - lo[ j ]  ,  mxREAL  ) ;
+      y = mxGetPr (  a  ) ;
+      
+      for  ( i = 0 ; i < hi[ j ] - lo[ j ] ; i++ )  y[ i ] = x[ i ]  -  z ;
+      
+      mxSetCell (  C  ,  j  ,  a  ) ;
+    }
+    
+    mxFree (  lo  ) ;
+    mxFree (  hi  ) ;
+    
+    /* C replaces the packed spike trains */
+    mxDestroyArray (  o[ POUT ]  ) ;
+    o[ POUT ] = C ;
+  }
+  
+  
+  /*-- Output --*/
+  
+  for  ( i = 0 ; i < NARGOUT ; i++ )
+    if  ( i  <  ( mwSize ) ( nlhs > 1 ? nlhs : 1 ) )
+      plhs[ i ] = o[ i ] ;
+    else
+      mxDestroyArray (  o[ i ]  ) ;
+
+
+} /* mexFunction */
+
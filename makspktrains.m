@@ -0,0 +1,45 @@
+
+% [ P , u ] = makspktrains ( t , c )
+% [ C , u ] = makspktrains ( t , c , e )
+% 
+% MET Analysis Kit. Gathers the spike trains of all units from a list of
+% spike times and final cluster labels, such as those returned by
+% makcmerge or makmergetool. Rather than one pass over all spikes per
+% unit, as in t( c == u ), spikes are counting-sorted by label in one pass
+% and written straight into packed spike trains. Labels are first
+% renumbered from 1 to U, so that memory grows with the number of units
+% and not with the largest label.
+% 
+% t is a vector of N spike times in seconds, single or double. c is a
+% vector of N cluster labels, uint8, uint16, uint32, or double. Labels
+% must be integers of 0 or more. Spikes with label 0, such as those that
+% were rejected in makmergetool, are left out.
+% 
+% P is a struct of packed spike trains, as returned by makspkpack, with one
+% train per unit and P.size equal to [ 1 , U ]. u is a 1 x U double vector
+% with the label of each unit, in ascending order. Only labels with at
+% least one spike are included. Spike trains are in chronological order,
+% even if t is not. P.valid is true.
+% 
+% If optional e is given then spikes are also divided into trials. e is a
+% K x 2 or K x 3 double matrix with one row per trial. Spikes of trial k
+% run from time e( k , 1 ) up to, but not including, e( k , 2 ). If e has a
+% third column then e( k , 3 ) is subtracted from the spike times of trial
+% k, such as the time of stimulus onset. C is then a K x U cell array of
+% row vectors, with trials over rows and units over columns, ready for
+% maksttc or makrccg. A trial with no spikes from a unit gets a 1 x 0
+% double. For example
+% 
+%   [ n , c ] = makcmerge (  n  ,  c  ,  E  ,  cut  ) ;
+%   [ C , u ] = makspktrains (  t  ,  c  ,  [ ton , toff , ton ]  ) ;
+%   sttc = maksttc (  [ 0 , 0.5 ]  ,  [ ]  ,  C  ) ;
+% 
+% If MEX is compiled with OpenMP then spikes and units are divided between
+% threads, e.g.
+% 
+%   mex CFLAGS='$CFLAGS -fopenmp' LDFLAGS='$LDFLAGS -fopenmp' makspktrains.c
+% 
+% Otherwise, it runs on a single thread.
+% 
+% Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+% 
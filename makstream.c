@@ -0,0 +1,944 @@
+
+/*  makstream
+  
+  makstream ( 'open' , par )
+  makstream ( 'push' , t , u )
+  n = makstream ( 'replay' , file )
+  n = makstream ( 'replay' , file , speed )
+  s = makstream ( 'get' )
+  makstream ( 'close' )
+  
+  MET Analysis Kit. Online analysis of a stream of spike events , for
+  closed-loop experiments. Each event is a spike time in seconds and a unit
+  label from 1 to U , or label 0 for the start of a trial. Events pass
+  through a ring buffer to an engine that updates smoothed firing rates ,
+  running peri-stimulus time histograms ( PSTH ) , and short-window STTC of
+  chosen pairs of units , one event at a time. The engine is held by the
+  MEX function between calls , until it is closed or MEX functions are
+  cleared.
+  
+  'open' starts a new engine with the parameters in struct par. Only .U ,
+  the number of units , is required. Other fields are optional :
+    
+    .Tgrowth , .Tdecay - Time constants of the postsynaptic potential
+      kernel of makpspkern , in seconds , default 0.001 and 0.020.
+    .psth - [ t0 , dt , Q ] , a grid of Q bins dt seconds wide , starting
+      t0 seconds from the start of each trial , default [ 0 , 0.01 , 100 ].
+    .pairs - P x 2 unit labels , the pairs of units for STTC , default none.
+    .win - Duration of the STTC window , in seconds , default 0.5.
+    .dt - delta-t of STTC , in seconds , default 0.01.
+    .hist - Most spikes per unit that are kept for STTC and for PSTH bins
+      before trial start , default 4096.
+    .ring - Events that the ring buffer holds , default 65536.
+  
+  'push' passes spike times t and unit labels u , vectors of equal length ,
+  through the ring buffer. Events must be in chronological order.
+  
+  'replay' stands in for an acquisition system. A producer thread reads
+  events from a binary file and writes them into the ring buffer , while
+  the engine consumes them on another thread. The file holds pairs of
+  doubles , time then label , as written by
+    
+    fwrite (  fid  ,  [ t( : ) , u( : ) ]'  ,  'double'  )
+  
+  If speed is given and greater than zero then events are released at
+  speed times real time , otherwise as fast as possible. n returns the
+  number of events that were replayed.
+  
+  'get' returns struct s with fields :
+    
+    .t - Time of the latest event.
+    .rate - 1 x U firing rates at time .t in spikes per second , the sum
+      of makpspkern's kernel over all past spikes. The kernel is in
+      continuous time , untruncated , and integrates to 1 , as with
+      makpspfilt and par.length of Inf.
+    .psth - Q x U firing rates of each PSTH bin , averaged over trials.
+    .ntrial - Number of trials so far.
+    .sttc - 1 x P STTC of each pair , from the spikes within .win seconds
+      of the latest spike from either unit of the pair. NaN until both
+      units have spikes in the window.
+    .n - Number of events so far.
+    .bad - Events that were dropped , being out of order or with a label
+      above U.
+    .lost - Spikes that were dropped from a full history.
+    .lat - Histogram of update latency. Element i counts events with a
+      latency from i - 1 up to i microseconds , and the last element
+      counts all latencies longer than that.
+    .p50 , .p99 , .max - Median , 99th percentile , and longest latency in
+      seconds.
+  
+  Latency runs from when an event enters the ring buffer until all
+  statistics have been updated for it. Hence it includes time spent
+  waiting in the buffer.
+  
+  'close' frees the engine.
+  
+  Compile with OpenMP so that replay can run the producer and the engine
+  on separate threads. Otherwise , replay alternates between them.
+  
+  Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+
+*/
+
+
+/*-- Include block --*/
+
+#include    <math.h>
+#include   <stdio.h>
+#include  <stdlib.h>
+#include  <string.h>
+#include    <time.h>
+#include     "mex.h"
+#include  "matrix.h"
+
+#ifdef  _OPENMP
+  #include  <omp.h>
+#endif
+
+
+/*-- Define block --*/
+
+#define  NARGINMIN  1
+#define  NARGINMAX  3
+#define    NARGOUT  1
+#define     CMDARG  0
+#define       XARG  1
+#define       YARG  2
+#define       SOUT  0
+
+/* Longest command and file name */
+#define  CMDLEN  7
+#define  FNMLEN  4095
+
+/* Default parameters */
+#define  DEFTG    0.001
+#define  DEFTD    0.020
+#define  DEFT0    0.0
+#define  DEFDT    0.01
+#define  DEFQ     100
+#define  DEFWIN   0.5
+#define  DEFSDT   0.01
+#define  DEFHIST  4096
+#define  DEFRING  65536
+
+/* Latency histogram bins , one per microsecond , plus one overflow bin */
+#define  NLAT  10000
+
+/* Events read from a replay file at a time */
+#define  FILEBLK  4096
+
+/* Fields of output struct */
+#define  NFLD  12
+
+
+/*-- Data types --*/
+
+/* One event , with spike time , the time that it entered the ring buffer ,
+   and unit label */
+typedef struct
+{
+  
+  double  t , s ;
+  mwSize  u ;
+
+} event_t ;
+
+/* Recent spike times of one unit , a ring of cap times starting at h */
+typedef struct
+{
+  
+  double  * t ;
+  mwSize  h , n ;
+
+} hist_t ;
+
+/* The engine */
+typedef struct
+{
+  
+  /* Number of units , pairs , PSTH bins , ring buffer and history
+     capacities */
+  mwSize  U , P , Q , cap , hcap ;
+  
+  /* Decay rates of kernel exponentials , and kernel normaliser */
+  double  ka , kb , norm ;
+  
+  /* Sums of each exponential over the spikes of each unit , at the time of
+     that unit's last spike , which is -Inf before its first */
+  double  * Ea , * Eb , * tl ;
+  
+  /* PSTH grid , time of trial start , spike counts , and trials */
+  double  g0 , gdt , tz , * cnt ;
+  mwSize  ntrial ;
+  
+  /* STTC window , delta-t , and history horizon */
+  double  win , dt , H ;
+  
+  /* Units of each pair , and the pairs of each unit in pidx from
+     poff[ u ] to poff[ u + 1 ] */
+  mwSize  * pa , * pb , * poff , * pidx ;
+  double  * sttc ;
+  
+  /* Spike history of each unit */
+  hist_t  * h ;
+  
+  /* Ring buffer , and the number of events ever written and read */
+  event_t  * ring ;
+  mwSize  head , tail ;
+  
+  /* Latency histogram , and longest latency */
+  double  * lat , lmax ;
+  
+  /* Latest time , events , dropped events , and lost spikes */
+  double  t ;
+  mwSize  n , bad , lost ;
+
+} engine_t ;
+
+/* Replay file , a block of events , and pacing */
+typedef struct
+{
+  
+  FILE  * f ;
+  double  b[ 2 * FILEBLK ] ;
+  mwSize  i , nb , n ;
+  
+  /* Release speed , first event time , and wall time of first release */
+  double  speed , t0 , w0 ;
+  
+  /* Set once the last event is in the ring buffer */
+  int  done ;
+
+} replay_t ;
+
+
+/*-- Global variables --*/
+
+/* Engine , kept between calls */
+static engine_t  * eng = NULL ;
+
+
+/*-- Subroutines --*/
+
+/* Wall time in seconds */
+static double  now ( void )
+{
+#ifdef  _OPENMP
+  return  omp_get_wtime ( ) ;
+#else
+  struct timespec  ts ;
+  clock_gettime (  CLOCK_MONOTONIC  ,  &ts  ) ;
+  return  ( double ) ts.tv_sec  +  1e-9 * ( double ) ts.tv_nsec ;
+#endif
+}
+
+/* Frees engine e */
+static void  freeeng ( engine_t * e )
+{
+  mwSize  i ;
+  
+  if  ( !e )  return ;
+  
+  if  ( e->h )
+    for  ( i = 0 ; i < e->U ; i++ )  free (  e->h[ i ].t  ) ;
+  
+  free (  e->Ea  ) ;  free (  e->Eb  ) ;  free (  e->tl  ) ;
+  free (  e->cnt  ) ;  free (  e->pa  ) ;  free (  e->pb  ) ;
+  free (  e->poff  ) ;  free (  e->pidx  ) ;  free (  e->sttc  ) ;
+  free (  e->h  ) ;  free (  e->ring  ) ;  free (  e->lat  ) ;
+  free (  e  ) ;
+}
+
+/* Frees the global engine when MEX functions are cleared */
+static void  atexitfun ( void )
+{
+  freeeng (  eng  ) ;
+  eng = NULL ;
+}
+
+/* Scalar field f of par , or default d if there is none. Raises an error
+   unless it is a finite real number that is greater than zero , or an
+   integer if n is non-zero. */
+static double  getpar ( const mxArray * par , const char * f , double d ,
+  int n )
+{
+  const mxArray  * a = mxGetField (  par  ,  0  ,  f  ) ;
+  double  v ;
+  
+  if  ( !a )  return  d ;
+  
+  v = mxIsNumeric( a )  &&  !mxIsComplex( a )  &&  mxIsScalar( a )  ?
+    mxGetScalar( a )  :  0 ;
+  
+  if  ( !( 0 < v )  ||  !mxIsFinite( v )  ||  ( n  &&  v != floor( v ) ) )
+    
+    mexErrMsgIdAndTxt (  "MAK:makstream:par"  ,
+      "makstream: par.%s must be a real %s greater than zero"  ,  f  ,
+      n  ?  "integer"  :  "scalar"  ) ;
+  
+  return  v ;
+}
+
+/* Spike k of history h , counting from the oldest */
+static double  spk ( const hist_t * h , mwSize k , mwSize cap )
+{
+  return  h->t[ ( h->h + k ) % cap ] ;
+}
+
+/* Index of the first spike of history h that is not before time v */
+static mwSize  lowerbound ( const hist_t * h , mwSize cap , double v )
+{
+  mwSize  a = 0 , m , n = h->n ;
+  
+  while  ( n )
+  {
+    m = n  /  2 ;
+    
+    if  ( spk( h , a + m , cap )  <  v )
+    {
+      a += m + 1 ;
+      n -= m + 1 ;
+    }
+    else
+      n = m ;
+  }
+  
+  return  a ;
+}
+
+/* Proportion of window w1 to w2 that is within dt of spikes a to na - 1
+   of history x */
+static double  getT ( const hist_t * x , mwSize a , mwSize na , mwSize cap ,
+  double dt , double w1 , double w2 )
+{
+  double  c = 0 , p = w1 , s , z ;
+  
+  for  ( ; a < na ; a++ )
+  {
+    s = spk (  x  ,  a  ,  cap  )  -  dt ;
+    z = spk (  x  ,  a  ,  cap  )  +  dt ;
+    if  ( s  <  p )  s = p ;
+    if  ( w2  <  z )  z = w2 ;
+    if  ( s  <  z )  {  c += z  -  s ;  p = z ;  }
+  }
+  
+  return  c  /  ( w2  -  w1 ) ;
+}
+
+/* Proportion of spikes a to na - 1 of history x that are within dt of any
+   of spikes b to nb - 1 of history y */
+static double  getP ( const hist_t * x , mwSize a , mwSize na ,
+  const hist_t * y , mwSize b , mwSize nb , mwSize cap , double dt )
+{
+  mwSize  c = 0 , n = na - a ;
+  double  v ;
+  
+  for  ( ; a < na ; a++ )
+  {
+    v = spk (  x  ,  a  ,  cap  ) ;
+    while  ( b < nb  &&  spk( y , b , cap ) < v - dt )  b++ ;
+    if  ( b < nb  &&  spk( y , b , cap ) <= v + dt )  c++ ;
+  }
+  
+  return  ( double ) c  /  ( double ) n ;
+}
+
+/* STTC of pair p over the window that ends at time t */
+static double  pairsttc ( const engine_t * e , mwSize p , double t )
+{
+  const hist_t  * x = e->h + e->pa[ p ] , * y = e->h + e->pb[ p ] ;
+  double  w1 = t  -  e->win , Ta , Tb , Pa , Pb ;
+  mwSize  a = lowerbound (  x  ,  e->hcap  ,  w1  ) ;
+  mwSize  b = lowerbound (  y  ,  e->hcap  ,  w1  ) ;
+  
+  /* Undefined without spikes from both units */
+  if  ( a == x->n  ||  b == y->n )  return  mxGetNaN ( ) ;
+  
+  Ta = getT (  x ,  a ,  x->n ,  e->hcap ,  e->dt ,  w1 ,  t  ) ;
+  Tb = getT (  y ,  b ,  y->n ,  e->hcap ,  e->dt ,  w1 ,  t  ) ;
+  Pa = getP (  x ,  a ,  x->n ,  y ,  b ,  y->n ,  e->hcap ,  e->dt  ) ;
+  Pb = getP (  y ,  b ,  y->n ,  x ,  a ,  x->n ,  e->hcap ,  e->dt  ) ;
+  
+  /* As in maksttc , min( ) removes NaN when P and T are both 1 */
+  return  0.5  *  (  fmin( ( Pa - Tb ) / ( 1 - Pa * Tb ) , 1 )  +
+                     fmin( ( Pb - Ta ) / ( 1 - Pb * Ta ) , 1 )  ) ;
+}
+
+/* Updates all statistics with event v , then its latency */
+static void  update ( engine_t * e , const event_t * v )
+{
+  mwSize  i , j , k ;
+  hist_t  * h ;
+  double  b , d ;
+  
+  /* Drop events that are out of order or have a bad label */
+  if  ( !( e->t <= v->t )  ||  e->U < v->u )
+  {
+    e->bad++ ;
+    return ;
+  }
+  
+  e->t = v->t ;
+  e->n++ ;
+  
+  /* Start of trial. PSTH bins before trial start are filled from the spike
+     histories. */
+  if  ( !v->u )
+  {
+    e->tz = v->t ;
+    e->ntrial++ ;
+    
+    if  ( e->g0  <  0 )
+      for  ( j = 0 ; j < e->U ; j++ )
+        for  ( h = e->h + j ,
+               i = lowerbound( h , e->hcap , e->tz + e->g0 ) ; i < h->n ;
+               i++ )
+        {
+          b = floor (  ( spk( h , i , e->hcap ) - e->tz - e->g0 ) / e->gdt );
+          if  ( b < ( double ) e->Q )  e->cnt[ ( mwSize ) b  +  e->Q * j ]++ ;
+        }
+  }
+  
+  /* Spike */
+  else
+  {
+    j = v->u  -  1 ;
+    h = e->h  +  j ;
+    
+    /* Decay each exponential to this spike , and add it. The first spike of
+       a unit has nothing to decay , at any time. */
+    if  ( isinf(  e->tl[ j ]  ) )
+    {
+      e->Ea[ j ] = 1 ;
+      e->Eb[ j ] = 1 ;
+    }
+    else
+    {
+      d = v->t  -  e->tl[ j ] ;
+      e->Ea[ j ] = e->Ea[ j ] * exp( - d * e->ka )  +  1 ;
+      e->Eb[ j ] = e->Eb[ j ] * exp( - d * e->kb )  +  1 ;
+    }
+    
+    e->tl[ j ] = v->t ;
+    
+    /* Add to history , losing the oldest spike if it is full , then forget
+       spikes beyond the horizon */
+    if  ( h->n  ==  e->hcap )
+    {
+      h->h = ( h->h + 1 )  %  e->hcap ;
+      h->n-- ;
+      e->lost++ ;
+    }
+    h->t[ ( h->h + h->n++ ) % e->hcap ] = v->t ;
+    
+    while  ( h->n  &&  spk( h , 0 , e->hcap ) < v->t - e->H )
+    {
+      h->h = ( h->h + 1 )  %  e->hcap ;
+      h->n-- ;
+    }
+    
+    /* PSTH bin , once a trial has started */
+    if  ( e->ntrial )
+    {
+      b = floor (  ( v->t - e->tz - e->g0 )  /  e->gdt  ) ;
+      if  ( 0 <= b  &&  b < ( double ) e->Q )
+        e->cnt[ ( mwSize ) b  +  e->Q * j ]++ ;
+    }
+    
+    /* STTC of each pair with this unit */
+    for  ( k = e->poff[ j ] ; k < e->poff[ j + 1 ] ; k++ )
+      e->sttc[ e->pidx[ k ] ] = pairsttc (  e  ,  e->pidx[ k ]  ,  v->t  ) ;
+  }
+  
+  /* Latency */
+  d = now ( )  -  v->s ;
+  if  ( e->lmax  <  d )  e->lmax = d ;
+  d = floor (  d  *  1e6  ) ;
+  e->lat[ d < NLAT  ?  ( mwSize ) d  :  NLAT ]++ ;
+}
+
+/* Consumes all events in the ring buffer */
+static void  consume ( engine_t * e )
+{
+  mwSize  head , tail ;
+  
+  #pragma omp atomic read seq_cst
+  head = e->head ;
+  
+  for  ( tail = e->tail ; tail < head ; tail++ )
+  {
+    update (  e  ,  e->ring + tail % e->cap  ) ;
+    
+    #pragma omp atomic write seq_cst
+    e->tail = tail  +  1 ;
+  }
+}
+
+/* Writes one event to the ring buffer. Returns zero if it is full. */
+static int  produce ( engine_t * e , double t , double u )
+{
+  mwSize  tail , head = e->head ;
+  event_t  * v ;
+  
+  #pragma omp atomic read seq_cst
+  tail = e->tail ;
+  
+  if  ( head - tail  ==  e->cap )  return  0 ;
+  
+  v = e->ring  +  head % e->cap ;
+  v->t = t ;
+  v->u = 0 <= u  &&  u == floor( u )  &&  u <= ( double ) e->U  ?
+    ( mwSize ) u  :  e->U + 1 ;
+  v->s = now ( ) ;
+  
+  #pragma omp atomic write seq_cst
+  e->head = head  +  1 ;
+  
+  return  1 ;
+}
+
+/* Writes the next replayed event to the ring buffer once it is due.
+   Returns zero when the file is finished , and sets r->done. */
+static int  replay ( engine_t * e , replay_t * r )
+{
+  double  t , u ;
+  
+  /* Next block of events. A partial event at the end is ignored. */
+  if  ( r->i  ==  r->nb )
+  {
+    r->nb = fread (  r->b  ,  2 * sizeof( double )  ,  FILEBLK  ,  r->f  );
+    r->i = 0 ;
+    
+    if  ( !r->nb )
+    {
+      #pragma omp atomic write seq_cst
+      r->done = 1 ;
+      
+      return  0 ;
+    }
+  }
+  
+  t = r->b[ 2 * r->i ] ;
+  u = r->b[ 2 * r->i + 1 ] ;
+  
+  /* Pace events , timed from the first */
+  if  ( !r->n )
+  {
+    r->t0 = t ;
+    r->w0 = now ( ) ;
+  }
+  else if  ( 0  <  r->speed )
+    while  ( now( )  <  r->w0  +  ( t - r->t0 ) / r->speed ) ;
+  
+  /* Wait for space in the ring buffer */
+  while  ( !produce( e , t , u ) ) ;
+  
+  r->i++ ;
+  r->n++ ;
+  
+  return  1 ;
+}
+
+/* Creates a new engine from parameter struct par. All parameters are
+   checked before anything is allocated. */
+static engine_t *  openeng ( const mxArray * par )
+{
+  engine_t  * e ;
+  const mxArray  * a ;
+  const double  * p = NULL ;
+  double  g[ 3 ] = {  DEFT0  ,  DEFDT  ,  DEFQ  } , tg , td , win , dt ;
+  mwSize  i , j , U , P = 0 , hcap , cap ;
+  int  ok ;
+  
+  
+  /*-- Parameters --*/
+  
+  /* Must be a scalar struct with field U */
+  if  ( !mxIsStruct( par )  ||  !mxIsScalar( par )  ||
+        !mxGetField( par , 0 , "U" ) )
+    
+    mexErrMsgIdAndTxt (  "MAK:makstream:par"  ,
+      "makstream: par must be a scalar struct with field .U"  ) ;
+  
+  U    = ( mwSize ) getpar (  par  ,  "U"  ,  0  ,  1  ) ;
+  tg   = getpar (  par  ,  "Tgrowth"  ,  DEFTG  ,  0  ) ;
+  td   = getpar (  par  ,  "Tdecay"  ,  DEFTD  ,  0  ) ;
+  win  = getpar (  par  ,  "win"  ,  DEFWIN  ,  0  ) ;
+  dt   = getpar (  par  ,  "dt"  ,  DEFSDT  ,  0  ) ;
+  hcap = ( mwSize ) getpar (  par  ,  "hist"  ,  DEFHIST  ,  1  ) ;
+  cap  = ( mwSize ) getpar (  par  ,  "ring"  ,  DEFRING  ,  1  ) ;
+  
+  /* PSTH grid */
+  if  ( ( a = mxGetField( par , 0 , "psth" ) ) )
+  {
+    if  ( !mxIsDouble( a )  ||  mxIsComplex( a )  ||
+          mxGetNumberOfElements( a ) != 3  ||
+          !( 0 < mxGetPr( a )[ 1 ] )  ||  !mxIsFinite( mxGetPr( a )[ 0 ] )  ||
+          !mxIsFinite( mxGetPr( a )[ 1 ] )  ||
+          !( 1 <= mxGetPr( a )[ 2 ] )  ||
+          mxGetPr( a )[ 2 ] != floor( mxGetPr( a )[ 2 ] ) )
+      
+      mexErrMsgIdAndTxt (  "MAK:makstream:par"  ,
+        "makstream: par.psth must be [ t0 , dt , Q ] with dt > 0 and "
+        "integer Q of 1 or more"  ) ;
+    
+    memcpy (  g  ,  mxGetPr( a )  ,  3 * sizeof( double )  ) ;
+  }
+  
+  /* Pairs of units , labels from 1 to U */
+  if  ( ( a = mxGetField( par , 0 , "pairs" ) )  &&  !mxIsEmpty( a ) )
+  {
+    ok = mxIsDouble( a )  &&  !mxIsComplex( a )  &&  mxGetN( a ) == 2  &&
+      mxGetNumberOfDimensions( a ) == 2 ;
+    
+    if  ( ok )
+    {
+      P = mxGetM (  a  ) ;
+      p = mxGetPr (  a  ) ;
+    }
+    
+    for  ( i = 0 ; ok  &&  i < 2 * P ; i++ )
+      ok = 1 <= p[ i ]  &&  p[ i ] <= ( double ) U  &&
+        p[ i ] == floor( p[ i ] ) ;
+    
+    if  ( !ok )
+      mexErrMsgIdAndTxt (  "MAK:makstream:par"  ,
+        "makstream: par.pairs must be a P x 2 double matrix of unit "
+        "labels from 1 to %d"  ,  ( int ) U  ) ;
+  }
+  
+  
+  /*-- Allocate --*/
+  
+  e = calloc (  1  ,  sizeof( engine_t )  ) ;
+  
+  if  ( e )
+  {
+    e->U = U ;  e->P = P ;  e->Q = ( mwSize ) g[ 2 ] ;
+    e->hcap = hcap ;  e->cap = cap ;
+    
+    e->Ea   = calloc (  U  ,  sizeof( double )  ) ;
+    e->Eb   = calloc (  U  ,  sizeof( double )  ) ;
+    e->tl   = calloc (  U  ,  sizeof( double )  ) ;
+    e->cnt  = calloc (  e->Q * U  ,  sizeof( double )  ) ;
+    e->pa   = calloc (  P + 1  ,  sizeof( mwSize )  ) ;
+    e->pb   = calloc (  P + 1  ,  sizeof( mwSize )  ) ;
+    e->poff = calloc (  U + 1  ,  sizeof( mwSize )  ) ;
+    e->pidx = calloc (  2 * P + 1  ,  sizeof( mwSize )  ) ;
+    e->sttc = calloc (  P + 1  ,  sizeof( double )  ) ;
+    e->h    = calloc (  U  ,  sizeof( hist_t )  ) ;
+    e->ring = calloc (  cap  ,  sizeof( event_t )  ) ;
+    e->lat  = calloc (  NLAT + 1  ,  sizeof( double )  ) ;
+    
+    ok = e->Ea  &&  e->Eb  &&  e->tl  &&  e->cnt  &&  e->pa  &&  e->pb  &&
+      e->poff  &&  e->pidx  &&  e->sttc  &&  e->h  &&  e->ring  &&  e->lat ;
+    
+    for  ( i = 0 ; ok  &&  i < U ; i++ )
+      ok = ( e->h[ i ].t = malloc( hcap * sizeof( double ) ) )  !=  NULL ;
+  }
+  
+  if  ( !e  ||  !ok )
+  {
+    freeeng (  e  ) ;
+    mexErrMsgIdAndTxt (  "MAK:makstream:mem"  ,  "makstream: out of memory" );
+  }
+  
+  
+  /*-- Initialise --*/
+  
+  /* Kernel of makpspkern in continuous time , integrating to 1 */
+  e->ka = 1  /  td ;
+  e->kb = 1  /  tg  +  1  /  td ;
+  e->norm = 1  /  ( 1 / e->ka  -  1 / e->kb ) ;
+  
+  e->g0 = g[ 0 ] ;
+  e->gdt = g[ 1 ] ;
+  e->win = win ;
+  e->dt = dt ;
+  
+  /* History must reach back over the STTC window and the PSTH bins before
+     trial start */
+  e->H = -e->g0  <  win  ?  win  :  -e->g0 ;
+  
+  /* Units of each pair , and pairs of each unit , counting-sorted */
+  for  ( i = 0 ; i < P ; i++ )
+  {
+    e->pa[ i ] = ( mwSize ) p[ i ]  -  1 ;
+    e->pb[ i ] = ( mwSize ) p[ i + P ]  -  1 ;
+    e->poff[ e->pa[ i ] + 1 ]++ ;
+    if  ( e->pb[ i ]  !=  e->pa[ i ] )  e->poff[ e->pb[ i ] + 1 ]++ ;
+    e->sttc[ i ] = mxGetNaN ( ) ;
+  }
+  
+  for  ( j = 0 ; j < U ; j++ )  e->poff[ j + 1 ] += e->poff[ j ] ;
+  
+  for  ( i = 0 ; i < P ; i++ )
+  {
+    e->pidx[ e->poff[ e->pa[ i ] ]++ ] = i ;
+    if  ( e->pb[ i ]  !=  e->pa[ i ] )  e->pidx[ e->poff[ e->pb[ i ] ]++ ] = i;
+  }
+  
+  for  ( j = U ; j ; j-- )  e->poff[ j ] = e->poff[ j - 1 ] ;
+  e->poff[ 0 ] = 0 ;
+  
+  /* No event yet , and no spike from any unit */
+  e->t = -mxGetInf ( ) ;
+  for  ( j = 0 ; j < U ; j++ )  e->tl[ j ] = -mxGetInf ( ) ;
+  
+  return  e ;
+}
+
+/* Smallest latency that is not below proportion q of all events */
+static double  latq ( const engine_t * e , double q )
+{
+  double  c = 0 , n = 0 ;
+  mwSize  i ;
+  
+  for  ( i = 0 ; i <= NLAT ; i++ )  n += e->lat[ i ] ;
+  
+  if  ( !n )  return  mxGetNaN ( ) ;
+  
+  for  ( i = 0 ; i < NLAT ; i++ )
+    if  ( q * n  <=  ( c += e->lat[ i ] ) )
+      return  ( double ) ( i + 1 )  /  1e6 ;
+  
+  return  e->lmax ;
+}
+
+/* Struct of all statistics */
+static mxArray *  get ( const engine_t * e )
+{
+  const char  * fld[ NFLD ] = {  "t"  ,  "rate"  ,  "psth"  ,  "ntrial"  ,
+    "sttc"  ,  "n"  ,  "bad"  ,  "lost"  ,  "lat"  ,  "p50"  ,  "p99"  ,
+    "max"  } ;
+  mxArray  * s = mxCreateStructMatrix (  1  ,  1  ,  NFLD  ,  fld  ) ;
+  mxArray  * a ;
+  double  * x , d ;
+  mwSize  i ;
+  
+  mxSetField (  s  ,  0  ,  "t"  ,  mxCreateDoubleScalar( e->t )  ) ;
+  
+  /* Rates at the latest time */
+  a = mxCreateDoubleMatrix (  1  ,  e->U  ,  mxREAL  ) ;
+  x = mxGetPr (  a  ) ;
+  for  ( i = 0 ; i < e->U ; i++ )
+  {
+    /* No spike yet */
+    if  ( isinf(  e->tl[ i ]  ) )  {  x[ i ] = 0 ;  continue ;  }
+    
+    d = e->t  -  e->tl[ i ] ;
+    x[ i ] = e->norm  *  ( e->Ea[ i ] * exp( - d * e->ka )  -
+                           e->Eb[ i ] * exp( - d * e->kb ) ) ;
+  }
+  mxSetField (  s  ,  0  ,  "rate"  ,  a  ) ;
+  
+  /* PSTH in spikes per second */
+  a = mxCreateDoubleMatrix (  e->Q  ,  e->U  ,  mxREAL  ) ;
+  x = mxGetPr (  a  ) ;
+  for  ( i = 0 ; i < e->Q * e->U ; i++ )
+    x[ i ] = e->ntrial  ?  e->cnt[ i ] / ( double ) e->ntrial / e->gdt  : 0;
+  mxSetField (  s  ,  0  ,  "psth"  ,  a  ) ;
+  
+  mxSetField (  s  ,  0  ,  "ntrial"  ,
+    mxCreateDoubleScalar( ( double ) e->ntrial )  ) ;
+  
+  a = mxCreateDoubleMatrix (  1  ,  e->P  ,  mxREAL  ) ;
+  if  ( e->P )  memcpy (  mxGetPr( a )  ,  e->sttc  ,
+    e->P * sizeof( double )  ) ;
+  mxSetField (  s  ,  0  ,  "sttc"  ,  a  ) ;
+  
+  mxSetField (  s  ,  0  ,  "n"  ,  mxCreateDoubleScalar( ( double ) e->n ) );
+  mxSetField (  s  ,  0  ,  "bad"  ,
+    mxCreateDoubleScalar( ( double ) e->bad )  ) ;
+  mxSetField (  s  ,  0  ,  "lost"  ,
+    mxCreateDoubleScalar( ( double ) e->lost )  ) ;
+  
+  /* Latency */
+  a = mxCreateDoubleMatrix (  NLAT + 1  ,  1  ,  mxREAL  ) ;
+  memcpy (  mxGetPr( a )  ,  e->lat  ,  ( NLAT + 1 ) * sizeof( double )  ) ;
+  mxSetField (  s  ,  0  ,  "lat"  ,  a  ) ;
+  mxSetField (  s  ,  0  ,  "p50"  ,
+    mxCreateDoubleScalar( latq( e , 0.50 ) )  ) ;
+  mxSetField (  s  ,  0  ,  "p99"  ,
+    mxCreateDoubleScalar( latq( e , 0.99 ) )  ) ;
+  mxSetField (  s  ,  0  ,  "max"  ,  mxCreateDoubleScalar( e->lmax )  ) ;
+  
+  return  s ;
+}
+
+
+/*** MEX gateway function ***/
+
+void  mexFunction (  int nlhs  ,        mxArray * plhs[ ] ,
+                     int nrhs  ,  const mxArray * prhs[ ]  )
+{
+  
+  
+  /*-- Variables --*/
+  
+  /* Generic counter */
+  mwSize  i ;
+  
+  /* Command and file name */
+  char  cmd[ CMDLEN + 1 ] , fnm[ FNMLEN + 1 ] ;
+  
+  /* Replay */
+  replay_t  * r ;
+  
+  /* Events */
+  const double  * t , * u ;
+  mwSize  n ;
+  
+  
+  /*-- Input check --*/
+  
+  /* Number of input args */
+  if  ( nrhs < NARGINMIN  ||  NARGINMAX < nrhs )
+    
+    mexErrMsgIdAndTxt (  "MAK:makstream:nargsin"  ,
+      "makstream: takes %d to %d input arguments"  ,  NARGINMIN  ,  NARGINMAX);
+  
+  /* Number of output args */
+  else if  ( NARGOUT  <  nlhs )
+    
+    mexErrMsgIdAndTxt (  "MAK:makstream:nargsout"  ,
+      "makstream: returns at most %d output argument"  ,  NARGOUT  ) ;
+  
+  /* Command string */
+  else if  (  !mxIsChar( prhs[ CMDARG ] )  ||
+              CMDLEN < mxGetNumberOfElements( prhs[ CMDARG ] )  ||
+              mxGetString( prhs[ CMDARG ] , cmd , CMDLEN + 1 )  )
+    
+    mexErrMsgIdAndTxt (  "MAK:makstream:cmd"  ,
+      "makstream: first input must be a command string"  ) ;
+  
+  mexAtExit (  atexitfun  ) ;
+  
+  
+  /*-- Open and close --*/
+  
+  if  ( !strcmp(  cmd  ,  "open"  ) )
+  {
+    if  ( nrhs  !=  2 )
+      mexErrMsgIdAndTxt (  "MAK:makstream:nargsin"  ,
+        "makstream: 'open' requires a parameter struct"  ) ;
+    
+    atexitfun ( ) ;
+    eng = openeng (  prhs[ XARG ]  ) ;
+    return ;
+  }
+  
+  else if  ( !strcmp(  cmd  ,  "close"  ) )
+  {
+    atexitfun ( ) ;
+    return ;
+  }
+  
+  else if  (  strcmp( cmd , "push" )  &&  strcmp( cmd , "replay" )  &&
+              strcmp( cmd , "get" )  )
+    
+    mexErrMsgIdAndTxt (  "MAK:makstream:cmd"  ,
+      "makstream: unknown command '%s'"  ,  cmd  ) ;
+  
+  /* All other commands need an engine */
+  if  ( !eng )
+    mexErrMsgIdAndTxt (  "MAK:makstream:open"  ,
+      "makstream: no stream is open"  ) ;
+  
+  
+  /*-- Statistics --*/
+  
+  if  ( !strcmp(  cmd  ,  "get"  ) )
+  {
+    plhs[ SOUT ] = get (  eng  ) ;
+    return ;
+  }
+  
+  
+  /*-- Push events --*/
+  
+  if  ( !strcmp(  cmd  ,  "push"  ) )
+  {
+    if  (  nrhs != NARGINMAX  ||
+           !mxIsDouble( prhs[ XARG ] )  ||  mxIsComplex( prhs[ XARG ] )  ||
+           !mxIsDouble( prhs[ YARG ] )  ||  mxIsComplex( prhs[ YARG ] )  ||
+           mxGetNumberOfElements( prhs[ XARG ] ) !=
+             mxGetNumberOfElements( prhs[ YARG ] )  )
+      
+      mexErrMsgIdAndTxt (  "MAK:makstream:push"  ,
+        "makstream: 'push' requires double vectors t and u of equal "
+        "length"  ) ;
+    
+    t = mxGetPr (  prhs[ XARG ]  ) ;
+    u = mxGetPr (  prhs[ YARG ]  ) ;
+    n = mxGetNumberOfElements (  prhs[ XARG ]  ) ;
+    
+    /* Consume whenever the ring buffer is full */
+    for  ( i = 0 ; i < n ; i++ )
+      while  ( !produce( eng , t[ i ] , u[ i ] ) )  consume (  eng  ) ;
+    
+    consume (  eng  ) ;
+    return ;
+  }
+  
+  
+  /*-- Replay a file --*/
+  
+  if  (  nrhs < 2  ||  !mxIsChar( prhs[ XARG ] )  ||
+         FNMLEN < mxGetNumberOfElements( prhs[ XARG ] )  ||
+         mxGetString( prhs[ XARG ] , fnm , FNMLEN + 1 )  )
+    
+    mexErrMsgIdAndTxt (  "MAK:makstream:file"  ,
+      "makstream: 'replay' requires a file name"  ) ;
+  
+  else if  (  nrhs == NARGINMAX  &&  ( !mxIsNumeric( prhs[ YARG ] )  ||
+              !mxIsScalar( prhs[ YARG ] )  ||  mxIsComplex( prhs[ YARG ] ) ) )
+    
+    mexErrMsgIdAndTxt (  "MAK:makstream:speed"  ,
+      "makstream: speed must be a real scalar"  ) ;
+  
+  r = mxCalloc (  1  ,  sizeof( replay_t )  ) ;
+  r->speed = nrhs  ==  NARGINMAX  ?  mxGetScalar( prhs[ YARG ] )  :  0 ;
+  
+  if  ( !( r->f = fopen( fnm , "rb" ) ) )
+    mexErrMsgIdAndTxt (  "MAK:makstream:file"  ,
+      "makstream: cannot open %s"  ,  fnm  ) ;
+  
+  /* Producer and engine on separate threads , if there are two. With one
+     thread , each event is consumed as soon as it is written. */
+  #pragma omp parallel num_threads( 2 )
+  {
+    int  thr = -1 , d = 0 ;
+
+#ifdef  _OPENMP
+    if  ( omp_get_num_threads( )  ==  2 )  thr = omp_get_thread_num ( ) ;
+#endif
+    
+    /* Producer */
+    if  ( thr  ==  0 )
+      while  ( replay( eng , r ) ) ;
+    
+    /* Engine , until the producer is done and the buffer is empty */
+    else if  ( thr  ==  1 )
+      while  ( !d )
+      {
+        #pragma omp atomic read seq_cst
+        d = r->done ;
+        
+        consume (  eng  ) ;
+      }
+    
+    /* One thread does both */
+    else
+      while  ( replay( eng , r ) )  consume (  eng  ) ;
+  
+  } /* parallel */
+  
+  fclose (  r->f  ) ;
+  
+  plhs[ SOUT ] = mxCreateDoubleScalar (  ( double ) r->n  ) ;
+  mxFree (  r  ) ;
+
+
+} /* mexFunction */
+
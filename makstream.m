@@ -0,0 +1,116 @@
+
+% makstream (  'open'  ,  par  )
+% makstream (  'push'  ,  t  ,  u  )
+% n = makstream (  'replay'  ,  file  )
+% n = makstream (  'replay'  ,  file  ,  speed  )
+% s = makstream (  'get'  )
+% makstream (  'close'  )
+% 
+% MET Analysis Kit. Online analysis of a stream of spike events, for
+% closed-loop experiments. Every other MAK function works offline, on
+% whole trials. Here, each event is a spike time in seconds and a unit
+% label from 1 to U, or label 0 for the start of a trial. Events pass
+% through a ring buffer to a native engine that updates smoothed firing
+% rates, running peri-stimulus time histograms ( PSTH ), and short-window
+% STTC of chosen pairs of units, one event at a time. The engine is kept
+% by the MEX function between calls, until it is closed or MEX functions
+% are cleared.
+% 
+% 'open' starts a new engine with the parameters in struct par. Any engine
+% that was already open is closed. Only .U, the number of units, is
+% required. Other fields are optional:
+% 
+%   .Tgrowth, .Tdecay - Time constants of the postsynaptic potential
+%     kernel of makpspkern, in seconds. Default 0.001 and 0.020.
+% 
+%   .psth - [ t0 , dt , Q ], a grid of Q bins that are dt seconds wide,
+%     starting t0 seconds from the start of each trial. t0 may be
+%     negative. Default [ 0 , 0.01 , 100 ].
+% 
+%   .pairs - P x 2 matrix of unit labels. Each row is a pair of units for
+%     STTC. Default none.
+% 
+%   .win - Duration of the STTC window, in seconds. Default 0.5.
+% 
+%   .dt - The one delta-t of STTC, in seconds. Default 0.01.
+% 
+%   .hist - Most spikes per unit that are kept for STTC, and for PSTH bins
+%     before the start of a trial. Default 4096.
+% 
+%   .ring - Number of events that the ring buffer holds. Default 65536.
+% 
+% 'push' passes spike times t and unit labels u through the ring buffer.
+% These are double vectors of equal length, and events must be in
+% chronological order.
+% 
+% 'replay' stands in for an acquisition system. A producer thread reads
+% events from a binary file and writes them into the ring buffer, while the
+% engine consumes them on another thread. The file holds pairs of doubles,
+% time then label, as written by
+% 
+%   fid = fopen (  file  ,  'w'  ) ;
+%   fwrite (  fid  ,  [ t( : ) , u( : ) ]'  ,  'double'  ) ;
+%   fclose (  fid  ) ;
+% 
+% If speed is given and greater than zero then events are released at
+% speed times real time. Otherwise, they are released as fast as possible.
+% n returns the number of events that were replayed.
+% 
+% 'get' returns struct s with fields:
+% 
+%   .t - Time of the latest event.
+%   .rate - 1 x U firing rates at time .t, in spikes per second. This is
+%     the sum of makpspkern's kernel over all past spikes. The kernel is in
+%     continuous time, untruncated, and integrates to 1, as in makpspfilt
+%     with par.length of Inf. Zero for a unit that has no spike yet. Spike
+%     times may be negative.
+%   .psth - Q x U firing rates of each PSTH bin, averaged over trials.
+%   .ntrial - Number of trials so far.
+%   .sttc - 1 x P STTC of each pair, from the spikes within .win seconds
+%     of the latest spike from either unit of the pair. A spike is within
+%     delta-t of another if they are no more than .dt apart. NaN until
+%     both units have spikes in the window.
+%   .n - Number of events so far.
+%   .bad - Events that were dropped, being out of order or with a label
+%     that is not from 0 to U.
+%   .lost - Spikes that were dropped from a full history.
+%   .lat - ( 10 ^ 4 + 1 ) x 1 histogram of update latency. Element i
+%     counts events with a latency from i - 1 up to i microseconds, and the
+%     last element counts all longer latencies.
+%   .p50, .p99, .max - Median, 99th percentile, and longest latency, in
+%     seconds.
+% 
+% Latency runs from when an event enters the ring buffer until all
+% statistics have been updated for it. Hence, it includes time spent
+% waiting in the buffer. Events that are released faster than the engine
+% can consume them will queue, and their latency grows.
+% 
+% For example
+% 
+%   makstream (  'open'  ,  struct( 'U' , 32 , 'pairs' , [ 1 , 2 ] )  ) ;
+%   makstream (  'replay'  ,  'session.bin'  ,  1  ) ;
+%   s = makstream (  'get'  ) ;
+%   makstream (  'close'  ) ;
+% 
+% 
+% Algorithm:
+% 
+% Each unit keeps the sum of each exponential of the kernel over its past
+% spikes. On a new spike, the sums decay to the spike time and 1 is added.
+% Hence, a rate costs O( 1 ) per spike. PSTH bins are counted as spikes
+% arrive, and bins before the start of a trial are filled from each unit's
+% history of recent spikes. STTC of the pairs with the spiking unit is
+% found from the spikes of both units that are inside the window, in
+% O( n ) time for n spikes.
+% 
+% The ring buffer has one producer and one consumer, and each side only
+% writes its own position. If MEX is compiled with OpenMP then replay runs
+% the producer and the engine on separate threads, e.g.
+% 
+%   mex CFLAGS='$CFLAGS -fopenmp' LDFLAGS='$LDFLAGS -fopenmp' makstream.c
+% 
+% Both threads wait by spinning, so two free CPU cores are needed. Without
+% OpenMP, each replayed event is consumed as soon as it is written.
+% 
+% Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+% 
@@ -35,7 +35,8 @@ function  varargout = maksttc (  varargin  )
 % double floating point numbers that provide spike times ( in seconds ) in
 % chronological order. Empty [ ] place holders can be used when there is no
 % data available ; but the corresponding STTC value is undefined, so NaN
-% will be returned.
+% will be returned. C may also be a struct of packed spike trains from
+% makspkpack.
 % 
 % sttc contains the STTC values. If A and B are given then sttc is a W x T
 % matrix of STTC values. The W Delta-t values are indexed over rows ( order
@@ -86,6 +87,12 @@ function  varargout = maksttc (  varargin  )
 % Given Tab, Fi, and N, w is uneccesary and maxdt is inferred. As input
 % arguments, Tab must have 2 columns while Fi and N must have 2 rows, each.
 % 
+% To compute STTC between each neurone/spike-cluster and the pooled spike
+% trains of all the others, use makpopsttc.
+% 
+% sttc can be kept as int16 fixed-point values in half the memory by
+% makq16 (  sttc  ), and decoded again by makq16 when it is needed.
+% 
 % 
 % Algorithm:
 % 
@@ -354,6 +361,9 @@ function  varargout = maksttc (  varargin  )
   
   end % less than 5 input arg forms
   
+  % Spike trains are checked , unless they were packed and checked already
+  chk = true ;
+  
   % A and B form of input
   if  nargin  >=  NARGAB
     
@@ -389,6 +399,14 @@ function  varargout = maksttc (  varargin  )
     % Get C
     C = varargin{ end } ;
     
+    % Packed spike trains from makspkpack. If C.valid is true then their
+    % spike times were checked when they were packed , and makspkpack only
+    % checks the offsets as it unpacks them.
+    if  isstruct (  C  )
+      chk = ~ ( isfield( C , 'valid' )  &&  isequal( C.valid , true ) ) ;
+      C = makspkpack (  C  ) ;
+    end
+    
     % Must be a cell array
     if  ~ iscell (  C  )
       
@@ -410,28 +428,18 @@ function  varargout = maksttc (  varargin  )
     
   end % get input
   
-  % Check elements of C
-  parfor  i = 1 : numel( C )
+  % Check elements of C , in one pass over all spike trains
+  if  chk
     
-    % This spike train
-    c = C{ i } ;
+    [ ok , k , why ] = makspkchk (  C  ) ;
     
-    % Check that it has all these attributes
-    X( i ) = ( isvector( c ) || isempty( c ) )  &&  ...
-    isnumeric( c )  &&  ~isinteger( c )  &&  isreal( c ) ;
-  
-  end
-          
-  % All spike trains must have listed attributes
-	if  any (  ~ X( : )  )
-    
-    error (  'MAK:maksttc:spktrains'  ,  [ 'maksttc: all spike ' , ...
-      'trains must be real-numbered vectors of type single or ' , ...
-        'double , or empty' ]  )
+    % All spike trains must be valid
+    if  ~ ok
       
-  else
-    
-    clear  X
+      error (  'MAK:maksttc:spktrains'  ,  ...
+        'maksttc: spike train %d %s'  ,  k  ,  why  )
+      
+    end
     
   end % check elements of C
   
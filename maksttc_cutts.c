@@ -34,6 +34,7 @@
 #include    <math.h>
 #include     "mex.h"
 #include  "matrix.h"
+#include  "makspk.h"
 
 
 /*-- Define block --*/
@@ -265,6 +266,14 @@ void  mexFunction (  int nlhs  ,        mxArray * plhs[ ] ,
     mexErrMsgIdAndTxt (  "MAK:maksttc_cutts:AB"  ,  
       "maksttc_cutts: A and B must be doubles"  ) ;
   
+  /* A and B must be finite vectors of spike times in chronological order */
+  else if  (  makspk_check( prhs[ AARG ] , 1 )  ||
+              makspk_check( prhs[ BARG ] , 1 )  )
+    
+    mexErrMsgIdAndTxt (  "MAK:maksttc_cutts:order"  ,  
+      "maksttc_cutts: A and B must be vectors of finite spike times in "
+      "chronological order"  ) ;
+  
   /* Access delta-t value */
   dtv = mxGetScalar (  prhs[ DTARG ]  ) ;
   
@@ -0,0 +1,273 @@
+
+function  p = maktune (  cmd  )
+% 
+% p = maktune
+% p = maktune (  'run'  )
+% p = maktune (  'default'  )
+% maktune (  p  )
+% 
+% MET Analysis Kit. Machine-specific tuning profile. Some functions choose
+% between two ways of doing the same thing, and the faster way depends on
+% the computer. maktune measures the crossover points on this computer and
+% saves them in a profile that those functions then load.
+% 
+% Without an input argument, maktune returns the profile of this computer.
+% It is loaded from file the first time, and kept in memory after that. If
+% there is no profile then the default profile is returned. The default
+% keeps the original behaviour of each function.
+% 
+% maktune (  'run'  ) runs a set of benchmarks on this computer and saves
+% the results as its profile. This takes a few minutes. The profile is
+% saved in MATLAB's prefdir, in a file named after the computer's host
+% name, so that computers sharing one home directory each get their own
+% profile. maktune (  'default'  ) returns the default profile. Given a
+% profile struct p, maktune (  p  ) uses it for the rest of the session
+% without saving it, e.g. to apply a plan from makplan.
+% 
+% 
+% Profile struct
+% 
+% p is a struct with fields:
+% 
+%   .host - Host name of the computer that ran the benchmarks.
+% 
+%   .date - Date of the benchmarks, as a string.
+% 
+%   .convnf - Row vector of FFT lengths, in ascending order.
+% 
+%   .convK - Row vector with the longest kernel at each FFT length in
+%     .convnf for which direct convolution is faster than FFT convolution.
+%     makconv uses direct convolution when its kernel is no longer than
+%     this, at the smallest .convnf that is at least its FFT length.
+%     Default zeros, always use FFTs.
+% 
+%   .energytile - Number of spikes per tile when makenergymat computes
+%     the pairwise distances between two clusters. Tiles keep the distance
+%     matrix in cache. Default Inf, no tiling.
+% 
+%   .opsrate - Number of simple floating point operations per second on
+%     one core, timed with exp( ) over a large vector on one computational
+%     thread. makplan uses this to predict run times. Default 1e8.
+% 
+% Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+% 
+  
+  
+  %%% Global constants %%%
+  
+  % FFT lengths to benchmark for makconv
+  CONVNF = 2 .^ ( 8 : 2 : 18 ) ;
+  
+  % Number of columns convolved in makconv benchmark
+  CONVCOL = 8 ;
+  
+  % Tile sizes to benchmark for makenergymat , and the number of spikes
+  % and components in each benchmark cluster
+  TILES = 2 .^ ( 5 : 12 ) ;
+  ENSPK = 4096 ;
+  ENCOM = 16 ;
+  
+  % Vector length for timing operations per second
+  OPSN = 2 ^ 20 ;
+  
+  
+  %%% Check input %%%
+  
+  % Profile loaded into memory
+  persistent  prof
+  
+  % Number of input and output args
+  narginchk  (  0  ,  1  )
+  nargoutchk (  0  ,  1  )
+  
+  % Default command
+  if  nargin  <  1  ,  cmd = 'profile' ;  end
+  
+  % Profile struct given , use it for the rest of the session
+  if  isstruct (  cmd  )
+    
+    % Must have the same fields as the default profile
+    if  ~ isscalar (  cmd  )  ||  ...
+        ~ isempty ( setxor(  fieldnames( cmd )  ,  ...
+                             fieldnames( defprof( CONVNF ) )  ) )
+      
+      error (  'MAK:maktune:p'  ,  ...
+        'maktune: p must be a profile struct, see help maktune'  )
+    
+    end
+    
+    prof = cmd ;
+    p = prof ;
+    return
+  
+  % Must be a known string
+  elseif  ~ ischar (  cmd  )  ||  ...
+      ~ any (  strcmp( cmd , { 'profile' , 'run' , 'default' } )  )
+    
+    error (  'MAK:maktune:cmd'  ,  ...
+      [ 'maktune: input must be ''run'', ''default'', or a ' , ...
+      'profile struct' ]  )
+  
+  end % check input
+  
+  
+  %%% Commands %%%
+  
+  switch  cmd
+    
+    % Profile of this computer
+    case  'profile'
+      
+      % Load once
+      if  isempty (  prof  )
+        
+        % Profile file exists
+        if  exist (  proffile  ,  'file'  )
+          
+          s = load (  proffile  ,  'p'  ) ;
+          prof = s.p ;
+          
+          % Fields added since the profile was saved take default values
+          d = defprof (  CONVNF  ) ;
+          f = setdiff (  fieldnames( d )  ,  fieldnames( prof )  ) ;
+          for  i = 1 : numel (  f  )  ,  prof.( f{ i } ) = d.( f{ i } ) ;  end
+        
+        % Otherwise , use defaults
+        else
+          
+          prof = defprof (  CONVNF  ) ;
+        
+        end % load
+      
+      end % once
+      
+      p = prof ;
+    
+    % Default profile
+    case  'default'  ,  p = defprof (  CONVNF  ) ;
+    
+    % Benchmark this computer
+    case  'run'
+      
+      p = defprof (  CONVNF  ) ;
+      p.host = hostname ;
+      p.date = datestr (  now  ) ;
+      
+      % makconv , FFT versus direct convolution
+      for  i = 1 : numel (  CONVNF  )
+        
+        % Signal length that gives FFT length CONVNF( i ) , with half of
+        % the FFT taken by the kernel at most
+        M = CONVNF( i )  /  2 ;
+        x = randn (  M  ,  CONVCOL  ) ;
+        
+        % Kernel lengths , doubling
+        for  K = 2 .^ ( 1 : log2( M ) )
+          
+          k = randn (  K  ,  1  ) ;
+          nf = 2  ^  ceil( log2(  M + K - 1  ) ) ;
+          
+          % Time each way
+          tf = timeit (  @( ) ifft( fft( x , nf ) .* fft( k , nf ) )  ) ;
+          td = timeit (  @( ) conv2( x , k )  ) ;
+          
+          % Direct is slower , stop here
+          if  tf  <  td  ,  break  ,  end
+          
+          p.convK( i ) = K ;
+        
+        end % kernel lengths
+      
+      end % FFT lengths
+      
+      % Operations per second , single core. exp( ) is multithreaded , so
+      % the probe runs on one computational thread , and the old number of
+      % threads is put back afterwards.
+      x = rand (  OPSN  ,  1  ) ;
+      n = maxNumCompThreads (  1  ) ;
+      p.opsrate = OPSN  /  timeit (  @( ) exp( x )  ) ;
+      maxNumCompThreads (  n  ) ;
+      
+      % makenergymat , tiles of pairwise distances
+      a = randn (  ENSPK  ,  ENCOM  ,  'single'  ) ;
+      b = randn (  ENSPK  ,  ENCOM  ,  'single'  ) ;
+      t = zeros (  size( TILES )  ) ;
+      
+      for  i = 1 : numel (  TILES  )
+        t( i ) = timeit (  @( ) tilesum( a , b , TILES( i ) )  ) ;
+      end
+      
+      [ ~ , i ] = min (  t  ) ;
+      p.energytile = TILES( i ) ;
+      
+      % Save , and use from now on
+      save (  proffile  ,  'p'  )
+      prof = p ;
+  
+  end % commands
+  
+  
+end % maktune
+  
+  
+%%% Sub-routines %%%
+  
+% Default profile , keeps the original behaviour of each function
+function  p = defprof (  convnf  )
+  
+  p.host = '' ;
+  p.date = '' ;
+  p.convnf = convnf ;
+  p.convK = zeros (  size( convnf )  ) ;
+  p.energytile = Inf ;
+  p.opsrate = 1e8 ;
+  
+end % defprof
+  
+  
+% Host name of this computer
+function  h = hostname
+  
+  [ s , h ] = system (  'hostname'  ) ;
+  if  s  ,  h = 'unknown' ;  end
+  h = strtrim (  h  ) ;
+  
+end % hostname
+  
+  
+% Name of the profile file of this computer
+function  f = proffile
+  
+  f = fullfile (  prefdir  ,  [ 'maktune_' , hostname , '.mat' ]  ) ;
+  
+end % proffile
+  
+  
+% Energy sum in tiles of n rows of a , as in makenergymat
+function  e = tilesum (  a  ,  b  ,  n  )
+  
+  e = zeros (  size( a , 1 )  ,  1  ) ;
+  
+  for  r = 1 : n : numel (  e  )
+    i = r : min (  r + n - 1  ,  numel( e )  ) ;
+    d = pdist2 (  a( i , : )  ,  b  ) ;
+    e( i ) = pairsum (  exp( - double( d ) )  ) ;
+  end
+  
+  e = pairsum (  e'  ) ;
+  
+end % tilesum
+
+
+% Sum over columns by adding halves , as in makenergymat
+function  x = pairsum (  x  )
+  
+  if  isempty (  x  )  ,  x = zeros (  size( x , 1 )  ,  1  ) ;  return  ,  end
+  
+  while  1  <  size (  x  ,  2  )
+    if  mod (  size( x , 2 )  ,  2  )  ,  x( : , end + 1 ) = 0 ;  end
+    x = x( : , 1 : 2 : end )  +  x( : , 2 : 2 : end ) ;
+  end
+  
+end % pairsum
+
@@ -0,0 +1,615 @@
+
+/*  makunitmatch
+  
+  [ m , s , K , S ] = makunitmatch ( W , A , g , k , smin )
+  
+  MET Analysis Kit. Matches sorted units across recording sessions by the
+  similarity of their mean waveforms and autocorrelograms. Each unit gets
+  a feature vector with its zero-mean , unit-length waveform stacked on
+  its zero-mean , unit-length autocorrelogram , divided by sqrt( 2 ). The
+  dot product of two feature vectors is then the average of the waveform
+  and the autocorrelogram correlation coefficients. All dot products are
+  computed by single precision matrix multiplication in blocks of units.
+  The top k candidates of each unit in each other session are kept in a
+  heap. Units are then paired for each pair of sessions by solving the
+  assignment problem on these candidates.
+  
+  W is an L x U matrix of mean waveforms , one column per unit. A is a
+  B x U matrix of autocorrelograms , or empty to use waveforms only. Both
+  are single or double. g is a vector with the session index of each unit,
+  integers from 1 to G. k is optional , default 5 , the number of
+  candidates per unit and session. smin is optional , default 0 , the
+  least similarity of a match.
+  
+  m is a 2 x M uint32 matrix of matched units , where m( 1 , i ) comes from
+  an earlier session than m( 2 , i ). s is the 1 x M single similarity of
+  each match. K is a k x G x U uint32 array where K( : , h , u ) lists the
+  candidates of unit u in session h , most similar first , padded with
+  zeros. S is the k x G x U single array of their similarities , padded
+  with NaN.
+  
+  Link against Matlab's BLAS library , and compile with OpenMP to divide
+  units and session pairs between threads , e.g.
+    
+    mex CFLAGS='$CFLAGS -fopenmp' LDFLAGS='$LDFLAGS -fopenmp' ...
+      makunitmatch.c -lmwblas
+  
+  Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+
+*/
+
+
+/*-- Include block --*/
+
+#include    <math.h>
+#include  <stdlib.h>
+#include  <string.h>
+#include     "mex.h"
+#include  "matrix.h"
+#include    "blas.h"
+
+#ifdef  _OPENMP
+  #include  <omp.h>
+#endif
+
+
+/*-- Define block --*/
+
+#define  NARGINMIN  3
+#define  NARGINMAX  5
+#define    NARGOUT  4
+#define       WARG  0
+#define       AARG  1
+#define       GARG  2
+#define       KARG  3
+#define    SMINARG  4
+#define       MOUT  0
+#define       SOUT  1
+#define       KOUT  2
+#define      SSOUT  3
+
+/* Default number of candidates per unit and session */
+#define  KDEF  5
+
+/* Number of units in each block of the similarity matrix */
+#define  NBLK  256
+
+
+/*-- Subroutines --*/
+
+/* Value i of numeric array x , in double precision */
+static double  getval ( const mxArray * x , mwSize i )
+{
+  switch  ( mxGetClassID(  x  ) )
+  {
+    case  mxSINGLE_CLASS:
+      return  ( ( const float * ) mxGetData( x ) )[ i ] ;
+    case  mxUINT8_CLASS:
+      return  ( ( const unsigned char * ) mxGetData( x ) )[ i ] ;
+    case  mxUINT16_CLASS:
+      return  ( ( const unsigned short * ) mxGetData( x ) )[ i ] ;
+    case  mxUINT32_CLASS:
+      return  ( ( const unsigned int * ) mxGetData( x ) )[ i ] ;
+    default:
+      return  mxGetPr (  x  )[ i ] ;
+  }
+}
+
+/* Copies column u of the R x U matrix x into f , with its mean removed
+   and scaled to length c. A column of constant values becomes zeros. */
+static void  normcol ( float * f , const mxArray * x , mwSize u , double c )
+{
+  mwSize  i , R = mxGetM (  x  ) ;
+  double  m , l ;
+  
+  for  ( m = 0 , i = 0 ; i < R ; i++ )  m += getval (  x  ,  u * R + i  ) ;
+  m /= R ;
+  
+  for  ( l = 0 , i = 0 ; i < R ; i++ )
+  {
+    f[ i ] = ( float ) ( getval( x , u * R + i )  -  m ) ;
+    l += ( double ) f[ i ]  *  f[ i ] ;
+  }
+  
+  l = 0 < l  ?  c / sqrt( l )  :  0 ;
+  for  ( i = 0 ; i < R ; i++ )  f[ i ] = ( float ) ( f[ i ]  *  l ) ;
+}
+
+/* Offers candidate j with similarity v to the min-heap of n of at most k
+   candidates , where the least similar is at the root */
+static void  heappush ( mwSize * hj , float * hv , mwSize * n , mwSize k ,
+  mwSize j , float v )
+{
+  mwSize  i , c ;
+  
+  /* Heap is full , and v is no better than the worst candidate */
+  if  ( *n == k  &&  !( hv[ 0 ] < v ) )  return ;
+  
+  /* Heap has room , sift up from the new leaf */
+  if  ( *n  <  k )
+  {
+    for  ( i = ( *n )++ ; i  &&  v < hv[ ( i - 1 ) / 2 ] ; i = ( i - 1 ) / 2 )
+    {
+      hj[ i ] = hj[ ( i - 1 ) / 2 ] ;
+      hv[ i ] = hv[ ( i - 1 ) / 2 ] ;
+    }
+  }
+  
+  /* Replace the root , sift down */
+  else
+  {
+    for  ( i = 0 ; ( c = 2 * i + 1 ) < k ; i = c )
+    {
+      if  ( c + 1 < k  &&  hv[ c + 1 ] < hv[ c ] )  c++ ;
+      if  ( v <= hv[ c ] )  break ;
+      hj[ i ] = hj[ c ] ;
+      hv[ i ] = hv[ c ] ;
+    }
+  }
+  
+  hj[ i ] = j ;
+  hv[ i ] = v ;
+}
+
+/* Removes the least similar candidate from the min-heap of n , returning
+   it in j and v */
+static void  heappop ( mwSize * hj , float * hv , mwSize * n , mwSize * j ,
+  float * v )
+{
+  mwSize  i , c , x ;
+  
+  *j = hj[ 0 ] ;
+  *v = hv[ 0 ] ;
+  
+  /* Move the last leaf to the root and sift it down */
+  x = --( *n ) ;
+  for  ( i = 0 ; ( c = 2 * i + 1 ) < *n ; i = c )
+  {
+    if  ( c + 1 < *n  &&  hv[ c + 1 ] < hv[ c ] )  c++ ;
+    if  ( hv[ x ] <= hv[ c ] )  break ;
+    hj[ i ] = hj[ c ] ;
+    hv[ i ] = hv[ c ] ;
+  }
+  
+  hj[ i ] = hj[ x ] ;
+  hv[ i ] = hv[ x ] ;
+}
+
+/* Solves the assignment problem for the n x n benefit matrix b ,
+   column-major , maximising the total benefit. Shortest augmenting path
+   with potentials , O( n ^ 3 ). On return , p[ j ] is the 1-based row
+   assigned to 1-based column j. Work arrays u , v , mv , way , and used
+   have n + 1 elements. */
+static void  assign ( const double * b , mwSize n , mwSize * p ,
+  double * u , double * v , double * mv , mwSize * way , char * used )
+{
+  mwSize  i , j , i0 , j0 , j1 ;
+  double  c , d ;
+  
+  memset (  u  ,  0  ,  ( n + 1 ) * sizeof( double )  ) ;
+  memset (  v  ,  0  ,  ( n + 1 ) * sizeof( double )  ) ;
+  memset (  p  ,  0  ,  ( n + 1 ) * sizeof( mwSize )  ) ;
+  
+  for  ( i = 1 ; i <= n ; i++ )
+  {
+    p[ 0 ] = i ;
+    j0 = 0 ;
+    for  ( j = 0 ; j <= n ; j++ )  {  mv[ j ] = HUGE_VAL ;  used[ j ] = 0 ;  }
+    
+    /* Grow the alternating tree until an unassigned column is reached */
+    do
+    {
+      used[ j0 ] = 1 ;
+      i0 = p[ j0 ] ;
+      d = HUGE_VAL ;
+      j1 = 0 ;
+      
+      for  ( j = 1 ; j <= n ; j++ )
+        if  ( !used[ j ] )
+        {
+          c = - b[ ( i0 - 1 ) + ( j - 1 ) * n ]  -  u[ i0 ]  -  v[ j ] ;
+          if  ( c < mv[ j ] )  {  mv[ j ] = c ;  way[ j ] = j0 ;  }
+          if  ( mv[ j ] < d )  {  d = mv[ j ] ;  j1 = j ;  }
+        }
+      
+      for  ( j = 0 ; j <= n ; j++ )
+        if  ( used[ j ] )  {  u[ p[ j ] ] += d ;  v[ j ] -= d ;  }
+        else  mv[ j ] -= d ;
+      
+      j0 = j1 ;
+    
+    } while  ( p[ j0 ] ) ;
+    
+    /* Flip the augmenting path */
+    do
+    {
+      j1 = way[ j0 ] ;
+      p[ j0 ] = p[ j1 ] ;
+      j0 = j1 ;
+    } while  ( j0 ) ;
+  }
+}
+
+
+/*** MEX gateway function ***/
+
+void  mexFunction (  int nlhs  ,        mxArray * plhs[ ] ,
+                     int nrhs  ,  const mxArray * prhs[ ]  )
+{
+  
+  
+  /*-- Variables --*/
+  
+  /* Generic counters */
+  mwSize  i , j , x ;
+  
+  /* Number of units , sessions , features , candidates , matches , and the
+     most units in any session */
+  mwSize  U , G , D , k , M , nmax ;
+  
+  /* Least similarity of a match */
+  double  smin = 0 ;
+  
+  /* Session of each unit , units in session order and the first of each
+     session , and the position in that order of each unit */
+  mwSize  * gs , * ord , * go ;
+  
+  /* Feature matrix , one column per unit in session order , and one block
+     of the similarity matrix */
+  float  * F , * C ;
+  
+  /* Candidate heaps for each unit and session , and heap sizes */
+  mwSize  * hj , * hn ;
+  float  * hv ;
+  
+  /* Session pairs , first match of each , and matches */
+  mwSize  Np , * po , * mm ;
+  float  * ms ;
+  
+  /* Out of memory in any thread */
+  int  err = 0 ;
+  
+  /* Outputs */
+  mxArray  * o[ NARGOUT ] ;
+  mwSize  dims[ 3 ] ;
+  
+  
+  /*-- Input check --*/
+  
+  /* Must be 3 to 5 input args */
+  if  ( nrhs < NARGINMIN  ||  NARGINMAX < nrhs )
+    
+    mexErrMsgIdAndTxt (  "MAK:makunitmatch:nargsin"  ,
+      "makunitmatch: requires %d to %d input arguments"  ,
+      NARGINMIN  ,  NARGINMAX  ) ;
+  
+  /* Must be no more than 4 output args */
+  else if  ( NARGOUT  <  nlhs )
+    
+    mexErrMsgIdAndTxt (  "MAK:makunitmatch:nargsout"  ,
+      "makunitmatch: returns at most %d output arguments"  ,  NARGOUT  ) ;
+  
+  /* W must be a real single or double matrix */
+  else if  (  !( mxIsDouble( prhs[ WARG ] ) || mxIsSingle( prhs[ WARG ] ) )
+              ||  mxIsComplex( prhs[ WARG ] )  ||  mxIsSparse( prhs[ WARG ] )
+              ||  mxGetNumberOfDimensions( prhs[ WARG ] ) != 2  ||
+              mxIsEmpty( prhs[ WARG ] )  )
+    
+    mexErrMsgIdAndTxt (  "MAK:makunitmatch:W"  ,
+      "makunitmatch: W must be a non-empty real single or double matrix" ) ;
+  
+  U = mxGetN (  prhs[ WARG ]  ) ;
+  
+  /* A must be empty , or real single or double with one column per unit */
+  if  (  !mxIsEmpty( prhs[ AARG ] )  &&
+         ( !( mxIsDouble( prhs[ AARG ] ) || mxIsSingle( prhs[ AARG ] ) )
+           ||  mxIsComplex( prhs[ AARG ] )  ||  mxIsSparse( prhs[ AARG ] )
+           ||  mxGetNumberOfDimensions( prhs[ AARG ] ) != 2  ||
+           mxGetN( prhs[ AARG ] ) != U )  )
+    
+    mexErrMsgIdAndTxt (  "MAK:makunitmatch:A"  ,
+      "makunitmatch: A must be empty or a real single or double matrix "
+      "with %d columns"  ,  ( int ) U  ) ;
+  
+  /* g must have one session index per unit */
+  else if  (  !( mxIsDouble( prhs[ GARG ] )  ||  mxIsUint8( prhs[ GARG ] )
+                 ||  mxIsUint16( prhs[ GARG ] )  ||
+                 mxIsUint32( prhs[ GARG ] ) )  ||  mxIsComplex( prhs[ GARG ] )
+              ||  mxGetNumberOfElements( prhs[ GARG ] ) != U  )
+    
+    mexErrMsgIdAndTxt (  "MAK:makunitmatch:g"  ,
+      "makunitmatch: g must be double , uint8 , uint16 , or uint32 with %d "
+      "elements"  ,  ( int ) U  ) ;
+  
+  /* Optional number of candidates */
+  k = KDEF ;
+  if  ( KARG  <  nrhs  &&  !mxIsEmpty( prhs[ KARG ] ) )
+  {
+    if  (  !mxIsScalar( prhs[ KARG ] )  ||  !mxIsNumeric( prhs[ KARG ] )  ||
+           !( 1 <= mxGetScalar( prhs[ KARG ] ) )  ||
+           mxGetScalar( prhs[ KARG ] ) != floor( mxGetScalar( prhs[ KARG ] ) )
+           )
+      
+      mexErrMsgIdAndTxt (  "MAK:makunitmatch:k"  ,
+        "makunitmatch: k must be an integer scalar of 1 or more"  ) ;
+    
+    k = ( mwSize ) mxGetScalar (  prhs[ KARG ]  ) ;
+  }
+  
+  /* Optional least similarity */
+  if  ( SMINARG  <  nrhs  &&  !mxIsEmpty( prhs[ SMINARG ] ) )
+  {
+    if  (  !mxIsScalar( prhs[ SMINARG ] )  ||
+           !mxIsNumeric( prhs[ SMINARG ] )  ||
+           !( 0 <= mxGetScalar( prhs[ SMINARG ] ) )  )
+      
+      mexErrMsgIdAndTxt (  "MAK:makunitmatch:smin"  ,
+        "makunitmatch: smin must be a non-negative scalar"  ) ;
+    
+    smin = mxGetScalar (  prhs[ SMINARG ]  ) ;
+  }
+  
+  
+  /*-- Sessions --*/
+  
+  /* Session of each unit , 0-based */
+  gs = mxMalloc (  U * sizeof( mwSize )  ) ;
+  
+  for  ( G = 0 , i = 0 ; i < U ; i++ )
+  {
+    double  x = getval (  prhs[ GARG ]  ,  i  ) ;
+    
+    if  ( !( 1 <= x )  ||  x != floor( x ) )
+      mexErrMsgIdAndTxt (  "MAK:makunitmatch:gval"  ,
+        "makunitmatch: g values must be integers of 1 or more"  ) ;
+    
+    gs[ i ] = ( mwSize ) x  -  1 ;
+    if  ( G  <=  gs[ i ] )  G = gs[ i ]  +  1 ;
+  }
+  
+  /* Counting sort of units by session */
+   go = mxCalloc (  G + 1  ,  sizeof( mwSize )  ) ;
+  ord = mxMalloc (  U * sizeof( mwSize )  ) ;
+  
+  for  ( i = 0 ; i < U ; i++ )  go[ gs[ i ] + 1 ]++ ;
+  for  ( nmax = 0 , i = 1 ; i <= G ; i++ )
+  {
+    if  ( nmax  <  go[ i ] )  nmax = go[ i ] ;
+    go[ i ] += go[ i - 1 ] ;
+  }
+  for  ( i = 0 ; i < U ; i++ )  ord[ go[ gs[ i ] ]++ ] = i ;
+  for  ( i = G ; i ; i-- )  go[ i ] = go[ i - 1 ] ;
+  go[ 0 ] = 0 ;
+  
+  
+  /*-- Features --*/
+  
+  /* Waveform and autocorrelogram rows */
+  i = mxGetM (  prhs[ WARG ]  ) ;
+  j = mxIsEmpty (  prhs[ AARG ]  )  ?  0  :  mxGetM (  prhs[ AARG ]  ) ;
+  D = i  +  j ;
+  
+  F = mxMalloc (  D * U * sizeof( float )  ) ;
+  
+  for  ( i = 0 ; i < U ; i++ )
+  {
+    normcol (  F + i * D ,  prhs[ WARG ] ,  ord[ i ] ,
+      j  ?  sqrt( 0.5 )  :  1  ) ;
+    if  ( j )  normcol (  F + i * D + mxGetM( prhs[ WARG ] ) ,
+      prhs[ AARG ] ,  ord[ i ] ,  sqrt( 0.5 )  ) ;
+  }
+  
+  
+  /*-- Similarity and candidates --*/
+  
+  hj = mxMalloc (  U * G * k * sizeof( mwSize )  ) ;
+  hv = mxMalloc (  U * G * k * sizeof( float )  ) ;
+  hn = mxCalloc (  U * G  ,  sizeof( mwSize )  ) ;
+   C = mxMalloc (  U * NBLK * sizeof( float )  ) ;
+  
+  for  ( i = 0 ; i < U ; i += NBLK )
+  {
+    /* Similarity of every unit with units i to i + nb - 1. Column r of C
+       holds unit i + r. */
+    char  tt[ ] = "T" , tn[ ] = "N" ;
+    float  one = 1 , zero = 0 ;
+    ptrdiff_t  m = U , n = U - i < NBLK ? U - i : NBLK , d = D ;
+    mwSignedIndex  r ;
+    
+    sgemm (  tt ,  tn ,  &m ,  &n ,  &d ,  &one ,  F ,  &d ,  F + i * D ,
+      &d ,  &zero ,  C ,  &m  ) ;
+    
+    /* Offer each unit in another session to the candidate heaps */
+    #pragma omp parallel for
+    for  ( r = 0 ; r < ( mwSignedIndex ) n ; r++ )
+    {
+      mwSize  a = i + r , h , x , q ;
+      
+      for  ( h = 0 ; h < G ; h++ )
+      {
+        if  ( h  ==  gs[ ord[ a ] ] )  continue ;
+        q = a * G  +  h ;
+        
+        for  ( x = go[ h ] ; x < go[ h + 1 ] ; x++ )
+          if  ( !isnan(  C[ r * U + x ]  ) )
+            heappush (  hj + q * k ,  hv + q * k ,  hn + q ,  k ,  x ,
+              C[ r * U + x ]  ) ;
+      }
+    }
+  }
+  
+  mxFree (  C  ) ;
+  mxFree (  F  ) ;
+  
+  
+  /*-- Assignment for each pair of sessions --*/
+  
+  /* Pairs are numbered in order , ( 1 , 2 ) , ( 1 , 3 ) , ... , ( 2 , 3 ) ,
+     ... and each has room for as many matches as its smaller session */
+  Np = G * ( G - 1 )  /  2 ;
+  po = mxCalloc (  Np + 1  ,  sizeof( mwSize )  ) ;
+  
+  for  ( j = 0 , i = 0 ; i < G ; i++ )
+  {
+    mwSize  h , ni = go[ i + 1 ] - go[ i ] , nh ;
+    
+    for  ( h = i + 1 ; h < G ; h++ , j++ )
+    {
+      nh = go[ h + 1 ]  -  go[ h ] ;
+      po[ j + 1 ] = po[ j ]  +  ( ni < nh ? ni : nh ) ;
+    }
+  }
+  
+  mm = mxMalloc (  ( 2 * po[ Np ] + 1 ) * sizeof( mwSize )  ) ;
+  ms = mxMalloc (  ( po[ Np ] + 1 ) * sizeof( float )  ) ;
+  for  ( i = 0 ; i < po[ Np ] ; i++ )  ms[ i ] = ( float ) mxGetNaN ( ) ;
+  
+  #pragma omp parallel
+  {
+    
+    /* Benefit matrix and assignment work arrays */
+    double  * b = malloc (  ( nmax * nmax + 1 ) * sizeof( double )  ) ,
+            * u = malloc (  ( nmax + 1 ) * sizeof( double )  ) ,
+            * v = malloc (  ( nmax + 1 ) * sizeof( double )  ) ,
+            * mv = malloc (  ( nmax + 1 ) * sizeof( double )  ) ;
+    mwSize  * p = malloc (  ( nmax + 1 ) * sizeof( mwSize )  ) ,
+            * way = malloc (  ( nmax + 1 ) * sizeof( mwSize )  ) ;
+    char  * used = malloc (  nmax + 1  ) ;
+    
+    mwSignedIndex  pr ;
+    mwSize  ga , gb , na , nb , n , x , y , q , r , c ;
+    int  e = !b  ||  !u  ||  !v  ||  !mv  ||  !p  ||  !way  ||  !used ;
+    
+    /* Session pairs , the small ones are quick */
+    #pragma omp for schedule( dynamic )
+    for  ( pr = 0 ; pr < ( mwSignedIndex ) Np ; pr++ )
+    {
+      
+      if  ( e )  continue ;
+      
+      /* Find the two sessions of this pair */
+      for  ( ga = 0 , q = pr ; G - 1 - ga <= q ; ga++ )  q -= G - 1 - ga ;
+      gb = ga  +  1  +  q ;
+      
+      na = go[ ga + 1 ]  -  go[ ga ] ;
+      nb = go[ gb + 1 ]  -  go[ gb ] ;
+      n = na < nb  ?  nb  :  na ;
+      if  ( !na  ||  !nb )  continue ;
+      
+      /* Benefit of each candidate edge , from either end. Other pairs of
+         units have none , and are left unmatched. */
+      memset (  b  ,  0  ,  n * n * sizeof( double )  ) ;
+      
+      for  ( x = 0 ; x < na ; x++ )
+      {
+        q = ( go[ ga ] + x ) * G  +  gb ;
+        for  ( r = 0 ; r < hn[ q ] ; r++ )
+          if  ( smin <= hv[ q * k + r ]  &&  0 < hv[ q * k + r ] )
+          {
+            c = x  +  ( hj[ q * k + r ] - go[ gb ] ) * n ;
+            if  ( b[ c ] < hv[ q * k + r ] )  b[ c ] = hv[ q * k + r ] ;
+          }
+      }
+      
+      for  ( y = 0 ; y < nb ; y++ )
+      {
+        q = ( go[ gb ] + y ) * G  +  ga ;
+        for  ( r = 0 ; r < hn[ q ] ; r++ )
+          if  ( smin <= hv[ q * k + r ]  &&  0 < hv[ q * k + r ] )
+          {
+            c = ( hj[ q * k + r ] - go[ ga ] )  +  y * n ;
+            if  ( b[ c ] < hv[ q * k + r ] )  b[ c ] = hv[ q * k + r ] ;
+          }
+      }
+      
+      assign (  b ,  n ,  p ,  u ,  v ,  mv ,  way ,  used  ) ;
+      
+      /* Keep assigned candidate edges , in order of the earlier session.
+         way is re-used to find the column assigned to each row. */
+      for  ( y = 1 ; y <= n ; y++ )  way[ p[ y ] ] = y ;
+      
+      for  ( c = po[ pr ] , x = 0 ; x < na ; x++ )
+      {
+        y = way[ x + 1 ]  -  1 ;
+        if  ( nb <= y  ||  !( 0 < b[ x + y * n ] ) )  continue ;
+        
+        mm[ 2 * c     ] = go[ ga ]  +  x ;
+        mm[ 2 * c + 1 ] = go[ gb ]  +  y ;
+        ms[ c++ ] = ( float ) b[ x + y * n ] ;
+      }
+    
+    } /* session pairs */
+    
+    #pragma omp critical
+    err |= e ;
+    
+    free (  b  ) ;  free (  u  ) ;  free (  v  ) ;  free (  mv  ) ;
+    free (  p  ) ;  free (  way  ) ;  free (  used  ) ;
+  
+  } /* parallel */
+  
+  if  ( err )
+    mexErrMsgIdAndTxt (  "MAK:makunitmatch:mem"  ,
+      "makunitmatch: out of memory"  ) ;
+  
+  
+  /*-- Outputs --*/
+  
+  /* Matches , unit indices from 1 */
+  for  ( M = 0 , i = 0 ; i < po[ Np ] ; i++ )  M += !isnan (  ms[ i ]  ) ;
+  
+  o[ MOUT ] = mxCreateNumericMatrix (  2  ,  M  ,  mxUINT32_CLASS  ,
+    mxREAL  ) ;
+  o[ SOUT ] = mxCreateNumericMatrix (  1  ,  M  ,  mxSINGLE_CLASS  ,
+    mxREAL  ) ;
+  
+  for  ( j = 0 , i = 0 ; i < po[ Np ] ; i++ )
+  {
+    if  ( isnan(  ms[ i ]  ) )  continue ;
+    ( ( unsigned int * ) mxGetData( o[ MOUT ] ) )[ 2 * j     ] =
+      ( unsigned int ) ord[ mm[ 2 * i ] ]  +  1 ;
+    ( ( unsigned int * ) mxGetData( o[ MOUT ] ) )[ 2 * j + 1 ] =
+      ( unsigned int ) ord[ mm[ 2 * i + 1 ] ]  +  1 ;
+    ( ( float * ) mxGetData( o[ SOUT ] ) )[ j++ ] = ms[ i ] ;
+  }
+  
+  /* Candidates of each unit , in the original unit order , most similar
+     first */
+  dims[ 0 ] = k ;  dims[ 1 ] = G ;  dims[ 2 ] = U ;
+  o[ KOUT  ] = mxCreateNumericArray (  3  ,  dims  ,  mxUINT32_CLASS  ,
+    mxREAL  ) ;
+  o[ SSOUT ] = mxCreateNumericArray (  3  ,  dims  ,  mxSINGLE_CLASS  ,
+    mxREAL  ) ;
+  
+  for  ( i = 0 ; i < U ; i++ )
+    for  ( j = 0 ; j < G ; j++ )
+    {
+      mwSize  q = i * G + j , r ;
+      unsigned int  * ko = ( unsigned int * ) mxGetData( o[ KOUT ] )  +
+        ( ord[ i ] * G + j ) * k ;
+      float  * so = ( float * ) mxGetData( o[ SSOUT ] )  +
+        ( ord[ i ] * G + j ) * k ;
+      
+      /* Pop the heap , least similar first , into the back of the list */
+      for  ( r = hn[ q ] ; r < k ; r++ )  so[ r ] = ( float ) mxGetNaN ( ) ;
+      for  ( r = hn[ q ] ; r-- ; )
+      {
+        heappop (  hj + q * k ,  hv + q * k ,  hn + q ,  &x ,  so + r  ) ;
+        ko[ r ] = ( unsigned int ) ord[ x ]  +  1 ;
+      }
+    }
+  
+  mxFree (  gs  ) ;  mxFree (  go  ) ;  mxFree (  ord  ) ;
+  mxFree (  hj  ) ;  mxFree (  hv  ) ;  mxFree (  hn  ) ;
+  mxFree (  po  ) ;  mxFree (  mm  ) ;  mxFree (  ms  ) ;
+  
+  /* Return requested outputs */
+  for  ( i = 0 ; i < NARGOUT ; i++ )
+    if  ( i  <  ( mwSize ) ( nlhs < 1 ? 1 : nlhs ) )
+      plhs[ i ] = o[ i ] ;
+    else
+      mxDestroyArray (  o[ i ]  ) ;
+
+
+} /* mexFunction */
+
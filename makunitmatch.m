@@ -0,0 +1,60 @@
+
+% [ m , s , K , S ] = makunitmatch ( W , A , g , k , smin )
+% 
+% MET Analysis Kit, pre-processing. Tracks sorted units across recording
+% sessions, e.g. over days, by matching the mean waveforms and the
+% autocorrelograms of units from different sessions. All units of all
+% sessions are compared in a single call, rather than each unit against
+% every unit of the other sessions in a loop.
+% 
+% W is an L x U matrix of mean waveforms, one column per unit, for
+% instance the average waveforms that makmergetool shows for each cluster.
+% A is a B x U matrix of autocorrelograms, such as acg from makspkqc, or
+% an empty matrix [ ] to match waveforms only. W and A are single or
+% double. g is a vector with the session index of each unit, integers from
+% 1 to G. k is optional, default 5 ; it is the number of candidate matches
+% kept for each unit in each other session. smin is optional, default 0 ;
+% it is the least similarity that two units can have to be matched.
+% 
+% m is a 2 x M uint32 matrix of matched units, where unit m( 1 , i ) comes
+% from an earlier session than unit m( 2 , i ). s is the 1 x M single
+% similarity of each match. K is a k x G x U uint32 array, where
+% K( : , h , u ) lists the candidate matches of unit u in session h, most
+% similar first. Empty places are zero, as are all candidates in a unit's
+% own session. S is the k x G x U single array of candidate similarities,
+% with NaN in empty places.
+% 
+% 
+% Algorithm:
+% 
+% Each unit gets a feature vector. Its waveform and autocorrelogram each
+% have their mean removed and are scaled to unit length. These are stacked
+% and divided by sqrt( 2 ). The dot product of two feature vectors is
+% then the average of the waveform and the autocorrelogram correlation
+% coefficients, from -1 to 1. The similarity of all units with a block of
+% 256 units at a time is computed by a single precision matrix
+% multiplication ( BLAS sgemm ). So memory grows only with the number of
+% units, U, and not with U ^ 2. A min-heap keeps the k most similar units
+% from each session for each unit.
+% 
+% For each pair of sessions, the candidate edges of both sessions with a
+% similarity of at least smin are placed in a benefit matrix. The
+% assignment that maximises total similarity is found with the shortest
+% augmenting path method, in O( n ^ 3 ) time for n units per session.
+% Each unit is matched to at most one unit of any other session. Matches
+% are not forced to be transitive across three or more sessions.
+% 
+% Link against Matlab's BLAS library, and compile with OpenMP to divide
+% units and session pairs between threads, e.g.
+% 
+%   mex CFLAGS='$CFLAGS -fopenmp' LDFLAGS='$LDFLAGS -fopenmp' ...
+%     makunitmatch.c -lmwblas
+% 
+% Without OpenMP, it runs on a single thread.
+% 
+% Reference:
+% 
+% Kuhn HW. 1955. The Hungarian method for the assignment problem. Naval
+%   Research Logistics Quarterly, 2:83-97.
+% 
+% Written by Jackson Smith - October 2026 - ESI (Fries Lab)
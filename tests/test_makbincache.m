@@ -0,0 +1,101 @@
+
+function  tests = test_makbincache
+% 
+% tests = test_makbincache
+% 
+% MET Analysis Kit, tests. Counts from a makbincache session cache must be
+% the same as those of histcounts, so that makrccg returns the same
+% result with or without the cache. This includes spikes at the very end
+% of the window, which histcounts puts into its last bin. Each unit
+% counts as one hit or miss of the cache per call to get.
+% 
+% Run from the MAK folder after compiling the MEX functions, with
+% 
+%   runtests (  'tests'  )
+% 
+% Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+% 
+  
+  tests = functiontests (  localfunctions  ) ;
+  
+end % test_makbincache
+
+
+%%% Fixtures %%%
+
+function  setupOnce (  t  )
+  
+  % Window , and the end of the last bin of makrccg
+  w = [ 0 , 0.5 ] ;
+  e = w( 1 )  +  ceil (  diff( w ) / 1e-3  )  *  1e-3 ;
+  
+  % 4 trials over rows and 3 units over columns. Some spikes fall at the
+  % end of the last bin.
+  rng (  1  )
+  C = cell (  4  ,  3  ) ;
+  
+  for  i = 1 : numel (  C  )
+    C{ i } = sort (  rand( 1 , 40 ) * diff( w )  +  w( 1 )  ) ;
+    if  mod (  i  ,  2  )  ,  C{ i } = [ C{ i } , e ] ;  end
+  end
+  
+  t.TestData.w = w ;
+  t.TestData.C = C ;
+  
+end % setupOnce
+
+
+%%% Tests %%%
+
+% The last bin counts spikes at its end , as histcounts does
+function  testLastBinClosed (  t  )
+  
+  w = t.TestData.w ;
+  C = t.TestData.C ;
+  b = makbincache (  C  ) ;
+  
+  % Grid of makrccg
+  Q = ceil (  diff( w ) / 1e-3  ) ;
+  e = w( 1 )  +  ( 0 : Q )  *  1e-3 ;
+  X = b.get (  'count'  ,  [ w( 1 ) , 1e-3 , Q ]  ) ;
+  
+  for  i = 1 : numel (  C  )
+    [ r , u ] = ind2sub (  size( C )  ,  i  ) ;
+    t.verifyEqual (  X( r , : , u )  ,  histcounts( C{ i } , e )  )
+  end
+  
+end % testLastBinClosed
+
+
+% makrccg is the same with or without the cache
+function  testRccgSame (  t  )
+  
+  w = t.TestData.w ;
+  C = t.TestData.C ;
+  
+  [ r , ~ , n ] = makrccg (  w  ,  C  ) ;
+  [ rb , ~ , nb ] = makrccg (  w  ,  makbincache( C )  ) ;
+  
+  t.verifyEqual (  rb  ,  r  )
+  t.verifyEqual (  nb  ,  n  )
+  
+end % testRccgSame
+
+
+% Each unit is a hit or a miss once per call to get , for any kind
+function  testHitsMisses (  t  )
+  
+  b = makbincache (  t.TestData.C  ) ;
+  g = [ 0 , 0.01 , 50 ] ;
+  
+  b.get (  'cumsum'  ,  g  ) ;
+  t.verifyEqual (  [ b.hits , b.misses ]  ,  [ 0 , b.U ]  )
+  
+  % Counts were cached on the way
+  b.get (  'count'  ,  g  ) ;
+  t.verifyEqual (  [ b.hits , b.misses ]  ,  [ b.U , b.U ]  )
+  
+  b.get (  'fft'  ,  g  ,  [ 1 , 1 ]  ) ;
+  t.verifyEqual (  [ b.hits , b.misses ]  ,  [ b.U , b.U + 1 ]  )
+  
+end % testHitsMisses
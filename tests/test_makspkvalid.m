@@ -0,0 +1,155 @@
+
+function  tests = test_makspkvalid
+% 
+% tests = test_makspkvalid
+% 
+% MET Analysis Kit, tests. Packed spike trains from makspkpack that have a
+% true .valid field are not checked again by maksttc or makrccg. But their
+% fields and offsets are always checked, so that a bad struct cannot index
+% outside of its spike times. A stand-in for makspkchk that raises an
+% error is put on the path, to show when it is called. Integer spike times
+% are still accepted by makrccg and makrastplot, as is NaN by makrccg.
+% 
+% Run from the MAK folder after compiling the MEX functions, with
+% 
+%   runtests (  'tests'  )
+% 
+% Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+% 
+  
+  tests = functiontests (  localfunctions  ) ;
+  
+end % test_makspkvalid
+
+
+%%% Fixtures %%%
+
+function  setupOnce (  t  )
+  
+  % Folder with a makspkchk that says it was called
+  d = tempname ;
+  mkdir (  d  )
+  
+  f = fopen (  fullfile( d , 'makspkchk.m' )  ,  'w'  ) ;
+  fprintf (  f  ,  'function  varargout = makspkchk (  varargin  )\n'  ) ;
+  fprintf (  f  ,  [ '  error (  ''MAK:test:makspkchk''  ,  ' , ...
+    '''makspkchk was called''  )\n' ]  ) ;
+  fprintf (  f  ,  'end\n'  ) ;
+  fclose (  f  ) ;
+  
+  t.TestData.dir = d ;
+  
+  % Valid packed spike trains , 3 trials over rows and 2 clusters
+  C = {  [ 0.1 , 0.2 ]  ,  [ 0.15 , 0.3 ]  ;
+                    0.1  ,            0.2  ;
+                    [ ]  ,  [ 0.05 , 0.4 ]  } ;
+  
+  t.TestData.P = makspkpack (  C  ) ;
+  
+end % setupOnce
+
+
+function  teardownOnce (  t  )
+  
+  rmdir (  t.TestData.dir  ,  's'  )
+  
+end % teardownOnce
+
+
+%%% Tests %%%
+
+% A true .valid field skips makspkchk
+function  testValidSkipsCheck (  t  )
+  
+  P = t.TestData.P ;
+  
+  addpath (  t.TestData.dir  )
+  c = onCleanup (  @( ) rmpath( t.TestData.dir )  ) ;
+  
+  maksttc (  [ 0 , 0.5 ]  ,  [ ]  ,  P  ) ;
+  makrccg (  [ 0 , 0.5 ]  ,  P  ) ;
+  
+end % testValidSkipsCheck
+
+
+% Without it , makspkchk is called
+function  testInvalidIsChecked (  t  )
+  
+  P = t.TestData.P ;
+  P.valid = false ;
+  
+  addpath (  t.TestData.dir  )
+  c = onCleanup (  @( ) rmpath( t.TestData.dir )  ) ;
+  
+  t.verifyError (  @( ) maksttc( [ 0 , 0.5 ] , [ ] , P )  ,  ...
+    'MAK:test:makspkchk'  )
+  t.verifyError (  @( ) makrccg( [ 0 , 0.5 ] , P )  ,  ...
+    'MAK:test:makspkchk'  )
+  
+end % testInvalidIsChecked
+
+
+% Spike times out of order are trusted when .valid is true , but not when
+% it is false
+function  testValidSkipsSpikeTimes (  t  )
+  
+  P = t.TestData.P ;
+  P.t( 1 : 2 ) = P.t( [ 2 , 1 ] ) ;
+  
+  [ ok , k ] = makspkchk (  P  ) ;
+  t.verifyTrue (  ok  )
+  t.verifyEqual (  k  ,  0  )
+  
+  P.valid = false ;
+  [ ok , k ] = makspkchk (  P  ) ;
+  t.verifyFalse (  ok  )
+  t.verifyEqual (  k  ,  1  )
+  
+end % testValidSkipsSpikeTimes
+
+
+% Bad offsets are caught even when .valid is true
+function  testValidChecksOffsets (  t  )
+  
+  % Each way of breaking the offsets
+  P = t.TestData.P ;
+  Q = repmat (  P  ,  4  ,  1  ) ;
+  Q( 1 ).off( 1 ) = 1 ;
+  Q( 2 ).off( 2 ) = Q( 2 ).off( 2 )  +  0.5 ;
+  Q( 3 ).off( 3 ) = Q( 3 ).off( 2 )  -  1 ;
+  Q( 4 ).off( end ) = Q( 4 ).off( end )  +  1 ;
+  
+  for  i = 1 : numel (  Q  )
+    
+    t.verifyError (  @( ) makspkpack( Q( i ) )  ,  'MAK:makspkpack:P'  )
+    t.verifyError (  @( ) makspkcount( Q( i ) , [ 0 , 1 ] )  ,  ...
+      'MAK:makspkcount:C'  )
+    t.verifyFalse (  makspkchk(  Q( i )  )  )
+    
+  end % offsets
+  
+end % testValidChecksOffsets
+
+
+% Integer spike times are accepted as doubles , and makrccg ignores NaN as
+% histcounts does
+function  testOtherTypes (  t  )
+  
+  % Sample stamps at 1kHz
+  C = {  int32( [ 10 , 20 , 35 ] )  ,  int32( [ 12 , 30 ] )  ;
+         int32( 15 )                ,  int32( [ 5 , 25 , 40 ] )  } ;
+  D = cellfun (  @double  ,  C  ,  'UniformOutput'  ,  false  ) ;
+  w = [ 0 , 50 ] ;
+  
+  t.verifyEqual (  makrccg( w , C )  ,  makrccg( w , D )  )
+  
+  E = D ;
+  E{ 1 , 2 } = [ E{ 1 , 2 } , NaN ] ;
+  t.verifyEqual (  makrccg( w , E )  ,  makrccg( w , D )  )
+  
+  f = figure (  'Visible'  ,  'off'  ) ;
+  c = onCleanup (  @( ) close( f )  ) ;
+  h = makrastplot (  C( : )'  ) ;
+  t.verifyEqual (  sort( h.XData )  ,  sort( [ D{ : } ] )  )
+  
+end % testOtherTypes
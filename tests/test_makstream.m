@@ -0,0 +1,73 @@
+
+function  tests = test_makstream
+% 
+% tests = test_makstream
+% 
+% MET Analysis Kit, tests. Online firing rates from makstream must be
+% finite when spike times are negative, as they are when a stream is
+% timed from an event that comes after the first spikes. The rate of each
+% unit is compared with the sum of makpspkern's kernel over its spikes.
+% 
+% Run from the MAK folder after compiling the MEX functions, with
+% 
+%   runtests (  'tests'  )
+% 
+% Written by Jackson Smith - October 2026 - ESI (Fries Lab)
+% 
+  
+  tests = functiontests (  localfunctions  ) ;
+  
+end % test_makstream
+
+
+%%% Fixtures %%%
+
+function  setup (  t  )
+  
+  % Three units with default kernel time constants
+  makstream (  'open'  ,  struct( 'U' , 3 )  )
+  
+  t.TestData.c = onCleanup (  @( ) makstream( 'close' )  ) ;
+  
+end % setup
+
+
+%%% Tests %%%
+
+% No spike yet means a rate of zero
+function  testNoSpikes (  t  )
+  
+  s = makstream (  'get'  ) ;
+  
+  t.verifyEqual (  s.rate  ,  zeros( 1 , 3 )  )
+  
+end % testNoSpikes
+
+
+% Negative spike times give finite rates that match the kernel
+function  testNegativeTimes (  t  )
+  
+  % Spike times and unit labels , unit 3 has no spikes
+  T = [ -5 , -4.99 , -4.98 , -4.95 , -4.9 ] ;
+  U = [  1 ,     2 ,     1 ,     1 ,    2 ] ;
+  
+  makstream (  'push'  ,  T  ,  U  )
+  s = makstream (  'get'  ) ;
+  
+  t.verifyTrue (  all( isfinite( s.rate ) )  )
+  t.verifyEqual (  s.t  ,  T( end )  )
+  
+  % Kernel of makpspkern with default time constants , integrating to 1
+  ka = 1 / 0.020 ;
+  kb = 1 / 0.001  +  ka ;
+  k = @( d ) ( exp( - d * ka )  -  exp( - d * kb ) )  /  ( 1/ka - 1/kb ) ;
+  
+  r = zeros (  1  ,  3  ) ;
+  for  i = 1 : 3
+    r( i ) = sum (  k(  s.t  -  T( U == i )  )  ) ;
+  end
+  
+  t.verifyEqual (  s.rate  ,  r  ,  'RelTol'  ,  1e-12  )
+  
+end % testNegativeTimes
+